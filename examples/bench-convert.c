@@ -0,0 +1,148 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Pixel format conversion benchmark
+ *
+ * Converts a PAL sized test image of every supported pixel format to
+ * grey with every kernel this processor runs, and prints the source
+ * bytes converted per second.
+ */
+#include <libgen.h>
+#include <multi-gee/mg_convert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <asm/types.h> /* needed for videodev2.h */
+#include <linux/videodev2.h>
+
+/**
+ * @brief A pixel format to benchmark
+ */
+struct format
+{
+	const char *name; /**< Format name */
+	uint32_t pixelformat; /**< video4linux2 fourcc code */
+	uint32_t bpp; /**< Source bytes per pixel */
+};
+
+static const struct format formats[] = {
+	{"GREY", V4L2_PIX_FMT_GREY, 1},
+	{"YUYV", V4L2_PIX_FMT_YUYV, 2},
+	{"UYVY", V4L2_PIX_FMT_UYVY, 2},
+	{"RGB24", V4L2_PIX_FMT_RGB24, 3},
+	{"BGR24", V4L2_PIX_FMT_BGR24, 3},
+	{"SGRBG8", V4L2_PIX_FMT_SGRBG8, 1},
+};
+
+static
+double
+seconds(struct timeval a,
+	struct timeval b)
+{
+	return (b.tv_sec - a.tv_sec) + (b.tv_usec - a.tv_usec) / 1e6;
+}
+
+static
+void
+usage(char *progname)
+{
+	printf("\nUsage : %s [options]\n", basename(progname));
+	printf("\n"
+	       " options:\n"
+	       "   -h             : print this message\n"
+	       "   -n <frames>    : frames converted per kernel (int >0)\n"
+	       "   -x <width>     : image width (int >1)\n"
+	       "   -y <height>    : image height (int >1)\n"
+	      );
+	exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char *argv[])
+{
+	int frames = 500;
+	int width = 768;
+	int height = 576;
+
+	int c;
+	while (-1 != (c = getopt(argc, argv, "hn:x:y:"))) {
+		switch (c) {
+		case 'n':
+			frames = atoi(optarg);
+			break;
+		case 'x':
+			width = atoi(optarg);
+			break;
+		case 'y':
+			height = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			break;
+		}
+	}
+
+	if (frames <= 0 || width <= 1 || height <= 1) {
+		usage(argv[0]);
+	}
+
+	enum mg_simd best = mg_simd_detect();
+	printf("%dx%d, %d frames, best kernel %s\n",
+	       width, height, frames, mg_simd_name(best));
+
+	for (unsigned int f = 0; f < sizeof(formats) / sizeof(*formats); f++) {
+		const struct format *fmt = &formats[f];
+		struct mg_image src = {0, width, height, width * fmt->bpp};
+		struct mg_image dst = {0, 0, 0, 0};
+
+		mg_convert_size(fmt->pixelformat, width, height,
+				&dst.width, &dst.height);
+		dst.stride = (dst.width + 63) & ~63;
+
+		size_t size = (size_t) src.stride * height;
+		src.data = malloc(size);
+		dst.data = malloc((size_t) dst.stride * dst.height);
+		for (size_t i = 0; i < size; i++) {
+			((unsigned char *) src.data)[i] = rand();
+		}
+
+		printf("%-7s", fmt->name);
+		for (int simd = MG_SIMD_SCALAR; simd <= (int) best; simd++) {
+			struct timeval start;
+			struct timeval end;
+			gettimeofday(&start, 0);
+			for (int n = 0; n < frames; n++) {
+				mg_convert_grey(fmt->pixelformat, &src, &dst, simd);
+			}
+			gettimeofday(&end, 0);
+
+			double rate = size * (double) frames
+				/ seconds(start, end) / 1e9;
+			printf("  %s %6.2f GB/s", mg_simd_name(simd), rate);
+		}
+		printf("\n");
+
+		free(dst.data);
+		free(src.data);
+	}
+
+	return EXIT_SUCCESS;
+}
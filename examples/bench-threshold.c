@@ -0,0 +1,247 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Threshold benchmark
+ *
+ * Thresholds a PAL sized grey test image with bright round markers on
+ * a noisy dark background, over the full frame and over a search window
+ * per marker, with every kernel this processor runs.  Prints the time
+ * per frame and the number of cameras one core keeps up with at the
+ * given frame rate.  Then labels the markers and fits their ellipses,
+ * as for every camera of a frameset, and times the packed mask path:
+ * threshold into a mask, open it, take away an exclusion mask and
+ * label the blobs left.
+ */
+#include <libgen.h>
+#include <multi-gee/mg_ellipse.h>
+#include <multi-gee/mg_threshold.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static
+double
+seconds(struct timeval a,
+	struct timeval b)
+{
+	return (b.tv_sec - a.tv_sec) + (b.tv_usec - a.tv_usec) / 1e6;
+}
+
+static
+void
+usage(char *progname)
+{
+	printf("\nUsage : %s [options]\n", basename(progname));
+	printf("\n"
+	       " options:\n"
+	       "   -h             : print this message\n"
+	       "   -c <cameras>   : cameras that must be kept up with (int >0)\n"
+	       "   -f <rate>      : frame rate per camera (int >0)\n"
+	       "   -m <markers>   : markers in the test image (int >=0)\n"
+	       "   -n <frames>    : frames thresholded per kernel (int >0)\n"
+	       "   -x <width>     : image width (int >1)\n"
+	       "   -y <height>    : image height (int >1)\n"
+	      );
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Time one kernel and print the result
+ *
+ * @return frames per second
+ */
+static
+double
+run(const struct mg_image *image,
+    const struct mg_rect *window,
+    unsigned int num_windows,
+    struct mg_span *span,
+    unsigned int max,
+    int frames,
+    enum mg_simd simd,
+    unsigned int *found)
+{
+	struct timeval start;
+	struct timeval end;
+	gettimeofday(&start, 0);
+	for (int n = 0; n < frames; n++) {
+		if (window) {
+			*found = mg_threshold_windows(image, window, num_windows,
+						      128, span, max, simd);
+		} else {
+			*found = mg_threshold(image, 128, span, max, simd);
+		}
+	}
+	gettimeofday(&end, 0);
+
+	return frames / seconds(start, end);
+}
+
+int
+main(int argc, char *argv[])
+{
+	int cameras = 8;
+	int rate = 25;
+	int markers = 40;
+	int frames = 2000;
+	int width = 768;
+	int height = 576;
+
+	int c;
+	while (-1 != (c = getopt(argc, argv, "c:f:hm:n:x:y:"))) {
+		switch (c) {
+		case 'c':
+			cameras = atoi(optarg);
+			break;
+		case 'f':
+			rate = atoi(optarg);
+			break;
+		case 'm':
+			markers = atoi(optarg);
+			break;
+		case 'n':
+			frames = atoi(optarg);
+			break;
+		case 'x':
+			width = atoi(optarg);
+			break;
+		case 'y':
+			height = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			break;
+		}
+	}
+
+	if (cameras <= 0 || rate <= 0 || markers < 0 || frames <= 0
+	    || width <= 1 || height <= 1) {
+		usage(argv[0]);
+	}
+
+	/* dark noisy background */
+	struct mg_image image = {0, width, height, (width + 63) & ~63};
+	size_t size = (size_t) image.stride * height;
+	unsigned char *pixel = malloc(size);
+	for (size_t i = 0; i < size; i++) {
+		pixel[i] = rand() % 48;
+	}
+	image.data = pixel;
+
+	/* markers of radius 3 to 8, with a search window around each */
+	struct mg_rect *window = malloc((markers + 1) * sizeof(*window));
+	for (int m = 0; m < markers; m++) {
+		int r = 3 + rand() % 6;
+		int cx = r + rand() % (width - 2 * r);
+		int cy = r + rand() % (height - 2 * r);
+		for (int y = -r; y <= r; y++) {
+			for (int x = -r; x <= r; x++) {
+				if (x * x + y * y <= r * r) {
+					pixel[(size_t) (cy + y) * image.stride
+					      + cx + x] = 200 + rand() % 56;
+				}
+			}
+		}
+		window[m].left = cx - 2 * r;
+		window[m].top = cy - 2 * r;
+		window[m].width = 4 * r + 1;
+		window[m].height = 4 * r + 1;
+	}
+
+	unsigned int max = width * height / 2 + 1;
+	struct mg_span *span = malloc(max * sizeof(*span));
+
+	enum mg_simd best = mg_simd_detect();
+	printf("%dx%d, %d markers, %d frames, best kernel %s\n",
+	       width, height, markers, frames, mg_simd_name(best));
+
+	double needed = (double) cameras * rate;
+	double fastest = 0;
+	for (int simd = MG_SIMD_SCALAR; simd <= (int) best; simd++) {
+		unsigned int full_spans;
+		unsigned int window_spans;
+		double full = run(&image, 0, 0, span, max, frames, simd,
+				  &full_spans);
+		double windows = run(&image, window, markers, span, max,
+				     frames, simd, &window_spans);
+		printf("%-7s full frame %8.3f ms %6u spans %7.1f cameras,"
+		       " windows %8.3f ms %6u spans\n",
+		       mg_simd_name(simd),
+		       1e3 / full, full_spans, full / rate,
+		       1e3 / windows, window_spans);
+		if (full > fastest) {
+			fastest = full;
+		}
+	}
+
+	printf("%d cameras at %d fps need %.0f frames/s, one core does %.0f:"
+	       " %s\n", cameras, rate, needed, fastest,
+	       (fastest >= needed) ? "ok" : "too slow");
+
+	/* label and fit the markers of every camera of a frameset */
+	unsigned int num_spans = mg_threshold(&image, 128, span, max, best);
+	mg_blobs_t blobs = mg_blobs_create();
+	struct mg_ellipse *ellipse = malloc((markers + 1) * sizeof(*ellipse));
+	unsigned int num_blobs = 0;
+	struct timeval start;
+	struct timeval end;
+	gettimeofday(&start, 0);
+	for (int n = 0; n < frames; n++) {
+		for (int i = 0; i < cameras; i++) {
+			mg_blobs_label(blobs, span, num_spans, 4);
+			num_blobs = mg_ellipse_fit_grey(&image,
+							mg_blobs_get_table(blobs),
+							128, ellipse, markers + 1,
+							best);
+		}
+	}
+	gettimeofday(&end, 0);
+	printf("label and fit %d cameras of %u blobs: %.3f ms per frameset\n",
+	       cameras, num_blobs, 1e3 * seconds(start, end) / frames);
+
+	/* the left eighth of the image is damaged */
+	mg_mask_t mask = mg_mask_create(width, height);
+	mg_mask_t exclude = mg_mask_create(width, height);
+	struct mg_rect damaged = {0, 0, width / 8, height};
+	mg_mask_fill(exclude, &damaged, true);
+	for (int simd = MG_SIMD_SCALAR; simd <= (int) best; simd++) {
+		gettimeofday(&start, 0);
+		for (int n = 0; n < frames; n++) {
+			mg_threshold_mask(&image, 128, mask, simd);
+			mg_mask_open(mask, simd);
+			mg_mask_combine(mask, exclude, MG_MASK_AND_NOT, simd);
+		}
+		gettimeofday(&end, 0);
+		num_blobs = mg_blobs_label_mask(blobs, mask, 4);
+		printf("%-7s mask, open and exclude %8.3f ms %6u blobs\n",
+		       mg_simd_name(simd),
+		       1e3 * seconds(start, end) / frames, num_blobs);
+	}
+	exclude = mg_mask_destroy(exclude);
+	mask = mg_mask_destroy(mask);
+
+	free(ellipse);
+	blobs = mg_blobs_destroy(blobs);
+	free(span);
+	free(window);
+	free(pixel);
+
+	return (fastest >= needed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
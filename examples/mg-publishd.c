@@ -0,0 +1,188 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Frameset publisher daemon
+ *
+ * Owns the capture devices, runs the sync engine and publishes every
+ * in-sync frameset into a shared memory ring.  Tracking, recording and
+ * preview processes attach with mg_subscriber_create() and read the
+ * framesets at their own pace.
+ */
+#include <libgen.h>
+#include <multi-gee/multi-gee.h>
+#include <multi-gee/mg_publisher.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static mg_publisher_t publisher = 0;
+static volatile sig_atomic_t stop = 0;
+
+static
+void
+on_signal(int sig)
+{
+	(void) sig;
+	stop = 1;
+}
+
+static
+void
+publish(multi_gee_t mg, sllist_t frame_list)
+{
+	if (stop) {
+		mg_capture_halt(mg);
+		return;
+	}
+
+	mg_publisher_serve(publisher);
+	mg_publisher_publish(publisher, frame_list);
+}
+
+static
+void
+usage(char *progname)
+{
+	printf("\nUsage : %s [options] device...\n", basename(progname));
+	printf("\n"
+	       " options:\n"
+	       "   -h             : print this message\n"
+	       "   -b <buffers>   : number of capture buffers (int >1)\n"
+	       "   -g <step>      : export image statistics of every step-th line (int)\n"
+	       "   -n <slots>     : number of framesets kept in the ring (int)\n"
+	       "   -s <socket>    : socket path subscribers connect to\n"
+	       "   -w             : let unplugged cameras rejoin when plugged in\n"
+	       "   -z <size>      : image bytes reserved per device (int)\n"
+	      );
+	exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char *argv[])
+{
+	int buffers = 3;
+	int slots = 8;
+	const char *socket_path = "/tmp/multi-gee.sock";
+	long size = 768 * 576;
+	bool watch = false;
+	int step = 0;
+
+	int c;
+	while (-1 != (c = getopt(argc, argv, "b:g:hn:s:wz:"))) {
+		switch (c) {
+		case 'b':
+			buffers = atoi(optarg);
+			break;
+		case 'g':
+			step = atoi(optarg);
+			break;
+		case 'n':
+			slots = atoi(optarg);
+			break;
+		case 's':
+			socket_path = optarg;
+			break;
+		case 'w':
+			watch = true;
+			break;
+		case 'z':
+			size = atol(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			break;
+		}
+	}
+
+	if (optind >= argc || buffers <= 1 || slots < 2 || size <= 0
+	    || step < 0) {
+		usage(argv[0]);
+	}
+
+	struct sigaction sa;
+	sa.sa_handler = on_signal;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sigaction(SIGINT, &sa, 0);
+	sigaction(SIGTERM, &sa, 0);
+
+	struct timeval in_sync = {0, 21000};
+	struct timeval no_sync = {0, 168000};
+	multi_gee_t mg = mg_create_special("stderr",
+					   in_sync,
+					   no_sync,
+					   buffers);
+	log_t log = lg_create(basename(argv[0]), "stderr");
+
+	publisher = mg_publisher_create(socket_path, slots, size, log);
+	if (!publisher) {
+		exit(EXIT_FAILURE);
+	}
+
+	/* bring the cameras up together, so they start streaming in step */
+	unsigned int n = argc - optind;
+	mg_config_t config[n];
+	for (unsigned int i = 0; i < n; i++) {
+		config[i] = mg_config_create();
+		mg_config_set_stats(config[i], step);
+	}
+	int id[n];
+	unsigned int registered =
+		mg_register_devices(mg, n, (const char *const *) &argv[optind],
+				    0, config, id);
+	for (unsigned int i = 0; i < n; i++) {
+		config[i] = mg_config_destroy(config[i]);
+	}
+	if (n != registered) {
+		for (unsigned int i = 0; i < n; i++) {
+			if (-1 == id[i]) {
+				lg_log(log, "cannot register %s", argv[optind + i]);
+			}
+		}
+		exit(EXIT_FAILURE);
+	}
+
+	if (watch && !mg_watch_devices(mg, 0)) {
+		exit(EXIT_FAILURE);
+	}
+
+	mg_register_callback(mg, publish);
+
+	/* a sync failure is not the end of the daemon, restart capture */
+	while (!stop) {
+		int ret = mg_capture(mg, -1);
+		if (RET_DEVICE == ret && watch) {
+			/* wait for a camera to be plugged back in */
+			sleep(1);
+			continue;
+		}
+		if (RET_SYNC != ret) {
+			lg_log(log, "capture ended: %d", ret);
+			break;
+		}
+		lg_log(log, "sync lost, restarting capture");
+	}
+
+	mg_destroy(mg);
+	publisher = mg_publisher_destroy(publisher);
+	log = lg_destroy(log);
+
+	return EXIT_SUCCESS;
+}
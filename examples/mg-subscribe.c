@@ -0,0 +1,103 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Frameset subscriber example
+ *
+ * Attaches to mg-publishd and prints the frames of every frameset it
+ * manages to read.  Framesets that are overwritten before they are
+ * read are counted as skipped.  Frames the publisher exports image
+ * statistics for get their mean, saturated pixels and focus printed.
+ */
+#include <multi-gee/mg_subscriber.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+int
+main(int argc, char *argv[])
+{
+	const char *socket_path = (argc > 1) ? argv[1] : "/tmp/multi-gee.sock";
+
+	log_t log = lg_create("mg-subscribe", "stderr");
+	mg_subscriber_t sub = mg_subscriber_create(socket_path, log);
+	if (!sub) {
+		exit(EXIT_FAILURE);
+	}
+
+	struct timeval timeout = {1, 0};
+	uint64_t seen = mg_subscriber_get_published(sub);
+	unsigned long skipped = 0;
+
+	while (mg_subscriber_wait(sub, seen, timeout)) {
+		uint64_t latest = mg_subscriber_get_published(sub) - 1;
+		skipped += latest - seen;
+		seen = latest + 1;
+
+		uint32_t lock;
+		const struct mg_ring_slot *slot =
+			mg_subscriber_begin(sub, latest, &lock);
+		if (!slot) {
+			skipped++;
+			continue;
+		}
+
+		/* process in place, without copying the images */
+		unsigned int n = slot->num_frames;
+		struct mg_ring_frame frame[MG_RING_MAX_DEVICES];
+		unsigned long sum[MG_RING_MAX_DEVICES];
+		for (unsigned int i = 0; i < n; i++) {
+			frame[i] = slot->frame[i];
+			const unsigned char *image =
+				mg_subscriber_get_image(sub, slot, i);
+			sum[i] = 0;
+			for (uint64_t b = 0; b < frame[i].bytes; b += 64) {
+				sum[i] += image[b];
+			}
+		}
+
+		if (!mg_subscriber_end(sub, slot, lock)) {
+			skipped++;
+			continue;
+		}
+
+		printf("frameset %llu (skipped %lu)\n",
+		       (unsigned long long) latest, skipped);
+		for (unsigned int i = 0; i < n; i++) {
+			const struct mg_ring_frame *f = &frame[i];
+			printf("  %s: sequence %u, %lld.%06lld, %ux%u, sum %lu\n",
+			       mg_subscriber_get_device_name(sub, f->device),
+			       f->sequence,
+			       (long long) f->tv_sec,
+			       (long long) f->tv_usec,
+			       f->width,
+			       f->height,
+			       sum[i]);
+			if (f->stats.pixels) {
+				printf("    mean %.1f, saturated %u, focus %.0f\n",
+				       f->stats.mean,
+				       f->stats.saturated,
+				       f->stats.focus);
+			}
+		}
+	}
+
+	sub = mg_subscriber_destroy(sub);
+	log = lg_destroy(log);
+
+	return EXIT_SUCCESS;
+}
@@ -133,6 +133,7 @@ multi_gee(int buffers,
 	  struct timeval in_sync,
 	  int masterdev,
 	  struct timeval no_sync,
+	  bool pause,
 	  int sleeptime,
 	  int startdev,
 	  bool verbose)
@@ -163,6 +164,9 @@ multi_gee(int buffers,
 
 	for (int i = 0; i < count; i++) {
 
+		if (pause)
+			mg_capture_pause(mg);
+
 		if (verbose)
 			printf("sleep a while\n");
 		usleep(sleeptime);
@@ -188,6 +192,7 @@ multi_gee(int buffers,
 		timersub(&tv_diff, &tv_sub, &tv_diff);
 
 		print_tv(" ** overhead: ", tv_diff ); printf("\n");
+		print_tv(" **    first: ", mg_get_first_frameset_time(mg)); printf("\n");
 
 		// handle return value
 		switch (ret) {
@@ -220,6 +225,7 @@ usage(char *progname)
 	       "   -n <frames>    : number of frames to capture (int)\n"
 	       "   -o <no_sync>   : min timestamp difference for fatal sync -- number of frames (float)\n"
 	       "   -p <percent>   : percentage error to add to frame times (int)\n"
+	       "   -P             : pause streaming between captures\n"
 	       "   -s <sleeptime> : microseconds to sleep between captures (int)\n"
 	       "   -S <startdev>  : first device to register (int)\n"
 	       "   -v             : verbose output\n"
@@ -272,6 +278,7 @@ main(int argc, char *argv[])
 	int devices = 3;
 	int frames = 5;
 	int masterdev = -1;
+	bool pause = false;
 	int percent = 5;
 	int sleeptime = 1000000;
 	int startdev = 0;
@@ -279,7 +286,7 @@ main(int argc, char *argv[])
 	struct timeval no_sync = frame_time(25, .05);
 
 	while (true) {
-		char c = getopt(argc, argv, "b:c:d:hi:m:n:o:p:s:S:v?");
+		char c = getopt(argc, argv, "b:c:d:hi:m:n:o:p:Ps:S:v?");
 
 		if (c == -1)
 			break;
@@ -321,6 +328,10 @@ main(int argc, char *argv[])
 				percent = arg_to_l(argv[0], optarg);
 				break;
 
+			case 'P':
+				pause = !pause;
+				break;
+
 			case 's':
 				sleeptime = arg_to_l(argv[0], optarg);
 				break;
@@ -366,6 +377,7 @@ main(int argc, char *argv[])
 		print_tv("  in_sync: ", in_sync); printf("\n");
 		printf("masterdev: %d\n", masterdev);
 		print_tv("  no_sync: ", no_sync); printf("\n");
+		printf("    pause: %s\n", pause ? "yes" : "no");
 		printf("  percent: %d\n", percent);
 		printf("sleeptime: %d\n", sleeptime);
 		printf(" startdev: %d\n", startdev);
@@ -379,6 +391,7 @@ main(int argc, char *argv[])
 		  in_sync,
 		  masterdev,
 		  no_sync,
+		  pause,
 		  sleeptime,
 		  startdev,
 		  verbose);
@@ -21,7 +21,9 @@
  * @brief Frame grabber interface utility definition
  */
 #include <errno.h> /* errno */
+#include <fcntl.h> /* O_CLOEXEC */
 #include <string.h> /* memset */
+#include <unistd.h> /* close */
 
 #include <sys/mman.h> /* mmap */
 #include <sys/ioctl.h> /* ioctl */
@@ -33,6 +35,7 @@
 #include "fg_util.h" /* declarations implemented */
 #include "log.h"
 #include "mg_buffer.h"
+#include "mg_convert.h"
 #include "mg_device.h"
 
 /**
@@ -40,21 +43,87 @@
  */
 #define CLEAR(x) memset (&(x), 0, sizeof (x))
 
-#define FIELD         V4L2_FIELD_INTERLACED
 #define MEMORY        V4L2_MEMORY_MMAP
-#define PIXELFORMAT   V4L2_PIX_FMT_GREY
-#define STANDARD      V4L2_STD_PAL
 #define STREAMING     V4L2_CAP_STREAMING
 #define TYPE          V4L2_BUF_TYPE_VIDEO_CAPTURE
+#define TYPE_MPLANE   V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE
 #define VIDEO_CAPTURE V4L2_CAP_VIDEO_CAPTURE
+#define VIDEO_CAPTURE_MPLANE V4L2_CAP_VIDEO_CAPTURE_MPLANE
 
-#define WIDTH         768
-#define HEIGHT        576
+/**
+ * @brief Buffer type the device streams through
+ *
+ * @param device  device object handle
+ *
+ * @return the multi-planar capture type if the device only offers that,
+ * else the single-planar capture type
+ */
+static
+enum v4l2_buf_type
+buf_type(mg_device_t device);
+
+/**
+ * @brief Convert a video4linux2 format to a capture format
+ *
+ * @param fmt  single-planar or multi-planar video4linux2 format
+ * @param format  capture format to fill in
+ *
+ * @return the image size summed over the planes
+ */
+static
+uint32_t
+get_format(const struct v4l2_format *fmt,
+	   struct mg_format *format);
+
+/**
+ * @brief Query and map a capture buffer
+ *
+ * every plane of the buffer is mapped separately.
+ *
+ * @param fd  file descriptor
+ * @param type  buffer type
+ * @param log  to log possible errors to
+ * @param buffer  device buffer
+ * @param index  buffer index
+ *
+ * @return
+ * - @c false on any failure, else
+ * - @c true
+ */
+static
+bool
+query_buffer(int fd,
+	     enum v4l2_buf_type type,
+	     log_t log,
+	     mg_buffer_t buffer,
+	     int index);
+
+/**
+ * @brief Export a capture buffer as a DMABUF file descriptor
+ *
+ * Failure to export is not fatal, as not all drivers support
+ * VIDIOC_EXPBUF.  The buffer is then only reachable through its
+ * process-local mapping.
+ *
+ * @param fd  file descriptor
+ * @param type  buffer type
+ * @param buffer  device buffer
+ * @param index  buffer index
+ * @param log  to log possible errors to
+ */
+static
+void
+export_buffer(int fd,
+	      enum v4l2_buf_type type,
+	      mg_buffer_t buffer,
+	      unsigned int index,
+	      log_t log);
 
 /**
  * @brief Initialise memory mapping
  *
  * @param fd  file descriptor
+ * @param type  buffer type
  * @param name  device name
  * @param buffer  device buffer
  * @param log  to log possible errors to
@@ -67,6 +136,7 @@
 static
 bool
 init_mmap(int fd,
+	  enum v4l2_buf_type type,
 	  const char *name,
 	  mg_buffer_t buffer,
 	  unsigned int num_bufs,
@@ -76,6 +146,7 @@ init_mmap(int fd,
  * @brief Call Initiate Memory Mapping IOCTL
  *
  * @param fd  file descriptor
+ * @param type  buffer type
  * @param name  device name
  * @param log  to log possible errors to
  * @param num_bufs  number of capture buffers
@@ -87,14 +158,35 @@ init_mmap(int fd,
 static
 bool
 request_buffers(int fd,
+		enum v4l2_buf_type type,
 		const char *name,
 		unsigned int req_bufs,
 		log_t log);
 
+/**
+ * @brief Test whether the device offers a pixel format
+ *
+ * @param fd  file descriptor
+ * @param type  buffer type
+ * @param pixelformat  video4linux2 fourcc code
+ *
+ * @return
+ * - @c false if the format is not enumerated, else
+ * - @c true
+ */
+static
+bool
+has_format(int fd,
+	   enum v4l2_buf_type type,
+	   uint32_t pixelformat);
+
 /**
  * @brief Select video input and video standard
  *
+ * either is left alone if the configuration says so.
+ *
  * @param fd  file descriptor
+ * @param config  capture configuration
  * @param log  to log possible errors to
  *
  * @return
@@ -104,10 +196,11 @@ request_buffers(int fd,
 static
 bool
 select_input(int fd,
+	     mg_config_t config,
 	     log_t log);
 
 /**
- * @brief Reset cropping
+ * @brief Reset the hardware crop to the default rectangle
  *
  * @param fd  file descriptor
  *
@@ -116,38 +209,30 @@ select_input(int fd,
  * - @c true
  */
 static
-void
-set_crop(int fd);
+bool
+reset_selection(int fd);
 
 /**
- * @brief Set capture format
- *
- * set the following parameters:
- *  - height
- *  - width
- *  - depth
- *  - interlacing
+ * @brief Reset cropping
  *
  * @param fd  file descriptor
- * @param log  to log possible errors to
  *
  * @return
  * - @c false on any failure, else
  * - @c true
  */
 static
-bool
-set_format(int fd,
-	   log_t log);
+void
+set_crop(int fd);
 
 /**
- * @brief Test device capabilities
+ * @brief Negotiate and set the capture format
  *
- * This function will not return if insufficient capabilities is
- * detected.
+ * tries every pixel format the configuration accepts, at the requested
+ * size and field order, and sets the one with the smallest image size.
+ * the format the driver settles on is stored on the device.
  *
- * @param fd  file descriptor
- * @param name  device name, for logging
+ * @param device  device object handle
  * @param log  to log possible errors to
  *
  * @return
@@ -156,9 +241,8 @@ set_format(int fd,
  */
 static
 bool
-test_capability(int fd,
-		const char *name,
-		log_t log);
+set_format(mg_device_t device,
+	   log_t log);
 
 /**
  * @brief Retry ioctl until it happens
@@ -174,14 +258,22 @@ xioctl(int fd,
        void *arg);
 
 bool
-fg_dequeue(int fd,
+fg_dequeue(mg_device_t dev,
 	   struct v4l2_buffer *buf,
 	   log_t log)
 {
+	int fd = mg_device_get_fd(dev);
+	mg_buffer_t dev_buf = mg_device_get_buffer(dev);
+	struct v4l2_plane planes[VIDEO_MAX_PLANES];
+
 	CLEAR(*buf);
 
-	buf->type = TYPE;
+	buf->type = buf_type(dev);
 	buf->memory = MEMORY;
+	if (TYPE_MPLANE == buf->type) {
+		buf->m.planes = planes;
+		buf->length = VIDEO_MAX_PLANES;
+	}
 
 	if (-1 == xioctl(fd, VIDIOC_DQBUF, buf)) {
 		switch (errno) {
@@ -196,27 +288,119 @@ fg_dequeue(int fd,
 		}
 	}
 
-	return buf;
+	/* the plane array does not outlive the call, the first plane's
+	   size goes with the format's sizeimage */
+	if (TYPE_MPLANE == buf->type) {
+		buf->bytesused = planes[0].bytesused;
+		buf->m.planes = 0;
+	}
+
+	mg_buffer_set_state(dev_buf, buf->index, MG_BUFFER_HELD);
+	mg_buffer_set_frame(dev_buf, buf->index, buf->sequence, buf->timestamp);
+	mg_device_settle_view(dev, buf->bytesused, buf->sequence);
+
+	return true;
 }
 
 bool
-fg_enqueue(int fd,
+fg_enqueue(mg_device_t dev,
 	   int i,
 	   log_t log)
 {
+	int fd = mg_device_get_fd(dev);
+	mg_buffer_t dev_buf = mg_device_get_buffer(dev);
 	struct v4l2_buffer buf;
+	struct v4l2_plane planes[VIDEO_MAX_PLANES];
 
 	CLEAR(buf);
+	CLEAR(planes);
 
-	buf.type = TYPE;
+	buf.type = buf_type(dev);
 	buf.memory = MEMORY;
 	buf.index = i;
+	if (TYPE_MPLANE == buf.type) {
+		buf.m.planes = planes;
+		buf.length = mg_buffer_get_planes(dev_buf);
+	}
 
 	if (-1 == xioctl(fd, VIDIOC_QBUF, &buf)) {
 		lg_errno(log, "VIDIOC_QBUF on fd %d", fd);
+		mg_buffer_set_state(dev_buf, i, MG_BUFFER_LOST);
+		return false;
+	}
+
+	mg_buffer_set_state(dev_buf, i, MG_BUFFER_QUEUED);
+
+	return true;
+}
+
+bool
+fg_create_buffers(mg_device_t dev,
+		  unsigned int count,
+		  log_t log)
+{
+	int fd = mg_device_get_fd(dev);
+	enum v4l2_buf_type type = buf_type(dev);
+	mg_buffer_t dev_buf = mg_device_get_buffer(dev);
+
+	struct v4l2_create_buffers create;
+	CLEAR(create);
+
+	create.count = count;
+	create.memory = MEMORY;
+	create.format.type = type;
+
+	if (-1 == xioctl(fd, VIDIOC_G_FMT, &create.format)) {
+		lg_errno(log, "VIDIOC_G_FMT on fd %d", fd);
 		return false;
 	}
 
+	if (-1 == xioctl(fd, VIDIOC_CREATE_BUFS, &create)) {
+		lg_errno(log, "VIDIOC_CREATE_BUFS on fd %d", fd);
+		return false;
+	}
+
+	if (create.count < count) {
+		lg_log(log, "Insufficient buffer memory on %s",
+		       mg_device_get_name(dev));
+	}
+
+	if (!mg_buffer_grow(dev_buf, create.index + create.count)) {
+		return false;
+	}
+
+	for (unsigned int i = create.index;
+	     i < create.index + create.count;
+	     i++) {
+		if (!query_buffer(fd, type, log, dev_buf, i)) {
+			return false;
+		}
+		export_buffer(fd, type, dev_buf, i, log);
+		if (!fg_enqueue(dev, i, log)) {
+			return false;
+		}
+	}
+
+	return 0 < create.count;
+}
+
+bool
+fg_drain(mg_device_t dev,
+	 log_t log)
+{
+	unsigned int bufs = mg_buffer_get_number(mg_device_get_buffer(dev));
+
+	/* bounded, in case the driver fills buffers as fast as we drain */
+	for (unsigned int i = 0; i < bufs; i++) {
+		struct v4l2_buffer buf;
+		if (!fg_dequeue(dev, &buf, log)) {
+			break;
+		}
+		if (!fg_enqueue(dev, buf.index, log)) {
+			return false;
+		}
+	}
+
 	return true;
 }
 
@@ -227,21 +411,22 @@ fg_init_device(mg_device_t dev,
 	int fd = mg_device_get_fd(dev);
 	char *dev_name = mg_device_get_name(dev);
 
-	if (!test_capability(fd, dev_name, log)) {
+	if (!fg_test_capability(dev, log)) {
 		return false;
 	}
 
-	if (!select_input(fd, log)) {
+	if (!select_input(fd, mg_device_get_config(dev), log)) {
 		return false;
 	}
 
 	set_crop(fd);
 
-	if (!set_format(fd, log)) {
+	if (!set_format(dev, log)) {
 		return false;
 	}
 
 	if (!init_mmap(fd,
+		       buf_type(dev),
 		       dev_name,
 		       mg_device_get_buffer(dev),
 		       mg_device_get_no_bufs(dev),
@@ -252,19 +437,204 @@ fg_init_device(mg_device_t dev,
 	return true;
 }
 
+bool
+fg_present(mg_device_t dev)
+{
+	struct v4l2_capability cap;
+
+	/* a disconnected device fails every ioctl with ENODEV */
+	return -1 != xioctl(mg_device_get_fd(dev), VIDIOC_QUERYCAP, &cap)
+		|| ENODEV != errno;
+}
+
+void
+fg_queue_buffers(mg_device_t dev,
+		 log_t log)
+{
+	mg_buffer_t dev_buf = mg_device_get_buffer(dev);
+	unsigned int bufs = mg_buffer_get_number(dev_buf);
+
+	for (unsigned int i = 0; i < bufs; i++) {
+		if (MG_BUFFER_RETIRED != mg_buffer_get_state(dev_buf, i)) {
+			fg_enqueue(dev, i, log);
+		}
+	}
+}
+
+bool
+fg_set_controls(mg_device_t dev,
+		const struct mg_control *control,
+		unsigned int n,
+		uint32_t sequence,
+		log_t log)
+{
+	int fd = mg_device_get_fd(dev);
+	struct v4l2_ext_control ctrl[n];
+	memset(ctrl, 0, sizeof(ctrl));
+	for (unsigned int i = 0; i < n; i++) {
+		ctrl[i].id = control[i].id;
+		ctrl[i].value = control[i].value;
+	}
+
+	/* controls of any class go in one call */
+	struct v4l2_ext_controls ctrls;
+	CLEAR(ctrls);
+	ctrls.which = V4L2_CTRL_WHICH_CUR_VAL;
+	ctrls.count = n;
+	ctrls.controls = ctrl;
+
+	unsigned int applied = n;
+	bool ok = -1 != xioctl(fd, VIDIOC_S_EXT_CTRLS, &ctrls);
+	if (!ok) {
+		lg_errno(log, "VIDIOC_S_EXT_CTRLS on fd %d, control 0x%08x",
+			 fd,
+			 ctrls.error_idx < n ? ctrl[ctrls.error_idx].id : 0);
+
+		/* an error index of count means nothing was applied */
+		applied = ctrls.error_idx < n ? ctrls.error_idx : 0;
+	}
+
+	for (unsigned int i = 0; i < applied; i++) {
+		mg_device_set_control(dev, ctrl[i].id, ctrl[i].value, sequence);
+	}
+
+	return ok;
+}
+
+bool
+fg_set_roi(mg_device_t dev,
+	   struct mg_rect roi,
+	   uint32_t sequence,
+	   log_t log)
+{
+	int fd = mg_device_get_fd(dev);
+	struct mg_format full = mg_device_get_format(dev);
+	bool cropped = mg_device_get_cropped(dev);
+
+	if (roi.width && roi.height) {
+		struct v4l2_selection sel;
+		CLEAR(sel);
+
+		/* the selection API takes the single-planar type for both */
+		sel.type = TYPE;
+		sel.target = V4L2_SEL_TGT_CROP;
+		sel.r.left = roi.left;
+		sel.r.top = roi.top;
+		sel.r.width = roi.width;
+		sel.r.height = roi.height;
+
+		if (-1 != xioctl(fd, VIDIOC_S_SELECTION, &sel)) {
+			struct v4l2_format fmt;
+			CLEAR(fmt);
+			fmt.type = buf_type(dev);
+
+			struct mg_format format;
+			memset(&format, 0, sizeof(format));
+			if (-1 != xioctl(fd, VIDIOC_G_FMT, &fmt)) {
+				get_format(&fmt, &format);
+			}
+
+			/* only a crop that shrinks the image saves bandwidth */
+			if (format.width == sel.r.width
+			    && format.height == sel.r.height) {
+				struct mg_rect rect = {
+					sel.r.left, sel.r.top,
+					sel.r.width, sel.r.height
+				};
+				mg_device_set_roi(dev, rect, format, true, sequence);
+				return true;
+			}
+
+			/* the driver scales, undo the crop */
+			cropped = true;
+		}
+	}
+
+	if (cropped) {
+		if (!reset_selection(fd)) {
+			lg_log(log, "cannot reset the crop of %s",
+			       mg_device_get_name(dev));
+			return false;
+		}
+	}
+
+	/* fall back to a view on the full frame */
+	struct mg_rect rect = {0, 0, 0, 0};
+	if (roi.width && roi.height) {
+		int32_t right = roi.left + roi.width;
+		int32_t bottom = roi.top + roi.height;
+
+		/* keep chroma pairs and Bayer quads whole */
+		rect.left = (roi.left < 0) ? 0 : roi.left & ~1;
+		rect.top = (roi.top < 0) ? 0 : roi.top & ~1;
+		if (right > (int32_t) full.width) {
+			right = full.width;
+		}
+		if (bottom > (int32_t) full.height) {
+			bottom = full.height;
+		}
+		if (right > rect.left && bottom > rect.top) {
+			rect.width = right - rect.left;
+			rect.height = bottom - rect.top;
+		} else {
+			lg_log(log, "region of interest outside %s",
+			       mg_device_get_name(dev));
+			return false;
+		}
+	}
+
+	/* a view needs no new frames, unless the crop was reset */
+	mg_device_set_roi(dev, rect, full, false, cropped ? sequence : 0);
+
+	return true;
+}
+
 bool
 fg_start_capture(mg_device_t dev,
 		 log_t log)
+{
+	fg_queue_buffers(dev, log);
+
+	return fg_stream_on(dev, log);
+}
+
+bool
+fg_stop_capture(mg_device_t dev,
+		log_t log)
 {
 	enum v4l2_buf_type type;
 	int fd = mg_device_get_fd(dev);
-	unsigned int bufs = mg_buffer_get_number(mg_device_get_buffer(dev));
 
+	type = buf_type(dev);
+
+	if (-1 == xioctl(fd, VIDIOC_STREAMOFF, &type)) {
+		lg_errno(log, "VIDIOC_STREAMOFF on fd %d", fd);
+		return false;
+	}
+
+	/* the driver numbers frames from 0 again on VIDIOC_STREAMON */
+	struct timeval never = {0, 0};
+	mg_buffer_t dev_buf = mg_device_get_buffer(dev);
+	unsigned int bufs = mg_buffer_get_number(dev_buf);
 	for (unsigned int i = 0; i < bufs; i++) {
-		fg_enqueue(fd, i, log);
+		if (MG_BUFFER_RETIRED != mg_buffer_get_state(dev_buf, i)) {
+			mg_buffer_set_state(dev_buf, i, MG_BUFFER_IDLE);
+		}
+		mg_buffer_set_frame(dev_buf, i, 0, never);
 	}
+	mg_device_restart(dev);
 
-	type = TYPE;
+	return true;
+}
+
+bool
+fg_stream_on(mg_device_t dev,
+	     log_t log)
+{
+	enum v4l2_buf_type type;
+	int fd = mg_device_get_fd(dev);
+
+	type = buf_type(dev);
 
 	if (-1 == xioctl(fd, VIDIOC_STREAMON, &type)) {
 		lg_errno(log, "VIDIOC_STREAMON on fd %d", fd);
@@ -275,16 +645,45 @@ fg_start_capture(mg_device_t dev,
 }
 
 bool
-fg_stop_capture(mg_device_t dev,
-		log_t log)
+fg_test_capability(mg_device_t dev,
+		   log_t log)
 {
-	enum v4l2_buf_type type;
 	int fd = mg_device_get_fd(dev);
+	char *dev_name = mg_device_get_name(dev);
+	struct v4l2_capability cap;
+
+	if (-1 == xioctl(fd, VIDIOC_QUERYCAP, &cap)) {
+		if (EINVAL == errno) {
+			lg_log(log, "%s is no V4L2 device",
+				dev_name);
+			return false;
+		} else {
+			lg_errno(log, "VIDIOC_QUERYCAP on fd %d", fd);
+			return false;
+		}
+	}
 
-	type = TYPE;
+	/* the bus position survives the device being plugged in again */
+	mg_device_set_bus_info(dev, (char *) cap.bus_info);
 
-	if (-1 == xioctl(fd, VIDIOC_STREAMOFF, &type)) {
-		lg_errno(log, "VIDIOC_STREAMOFF on fd %d", fd);
+	/* the capabilities of the whole driver may include other nodes */
+	uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS)
+		? cap.device_caps
+		: cap.capabilities;
+
+	if (!(caps & (VIDEO_CAPTURE | VIDEO_CAPTURE_MPLANE))) {
+		lg_log(log, "%s is no video capture device",
+			dev_name);
+		return false;
+	}
+
+	/* single-planar is kept for drivers that offer both */
+	mg_device_set_mplane(dev, !(caps & VIDEO_CAPTURE));
+
+	if (!(caps & STREAMING)) {
+		lg_log(log,
+			"%s does not support streaming i/o",
+			dev_name);
 		return false;
 	}
 
@@ -297,64 +696,185 @@ fg_uninit_device(mg_device_t dev,
 {
 	mg_buffer_t dev_buf = mg_device_get_buffer(dev);
 	unsigned int bufs = mg_buffer_get_number(dev_buf);
+	unsigned int planes = mg_buffer_get_planes(dev_buf);
 
 	for (unsigned int i = 0; i < bufs; i++) {
-		if (-1 == munmap(mg_buffer_get_start(dev_buf, i),
-				 mg_buffer_get_length(dev_buf, i))) {
-			lg_errno(log, "munmap");
-			return false;
+		for (unsigned int p = 0; p < planes; p++) {
+			int dmabuf = mg_buffer_get_plane_dmabuf(dev_buf, i, p);
+			if (-1 != dmabuf) {
+				if (-1 == close(dmabuf)) {
+					lg_errno(log, "close DMABUF fd %d",
+						 dmabuf);
+				}
+				mg_buffer_set_plane_dmabuf(dev_buf, i, p, -1);
+			}
+
+			/* later planes are not mapped if mapping failed */
+			void *start = mg_buffer_get_plane_start(dev_buf, i, p);
+			if (p && !start) {
+				continue;
+			}
+
+			if (-1 == munmap(start,
+					 mg_buffer_get_plane_length(dev_buf,
+								    i, p))) {
+				lg_errno(log, "munmap");
+				return false;
+			}
 		}
 	}
 
 	return true;
 }
 
-static
+enum v4l2_buf_type
+buf_type(mg_device_t dev)
+{
+	return mg_device_get_mplane(dev) ? TYPE_MPLANE : TYPE;
+}
+
+uint32_t
+get_format(const struct v4l2_format *fmt,
+	   struct mg_format *format)
+{
+	uint32_t size = 0;
+
+	memset(format, 0, sizeof(*format));
+
+	if (TYPE_MPLANE == fmt->type) {
+		const struct v4l2_pix_format_mplane *pix = &fmt->fmt.pix_mp;
+		format->width = pix->width;
+		format->height = pix->height;
+		format->pixelformat = pix->pixelformat;
+		format->field = pix->field;
+		format->num_planes = (pix->num_planes < MG_MAX_PLANES)
+			? pix->num_planes
+			: MG_MAX_PLANES;
+		for (unsigned int p = 0; p < format->num_planes; p++) {
+			format->plane[p].bytesperline =
+				pix->plane_fmt[p].bytesperline;
+			format->plane[p].sizeimage =
+				pix->plane_fmt[p].sizeimage;
+			size += pix->plane_fmt[p].sizeimage;
+		}
+		format->bytesperline = format->plane[0].bytesperline;
+		format->sizeimage = format->plane[0].sizeimage;
+	} else {
+		const struct v4l2_pix_format *pix = &fmt->fmt.pix;
+		format->width = pix->width;
+		format->height = pix->height;
+		format->bytesperline = pix->bytesperline;
+		format->sizeimage = pix->sizeimage;
+		format->pixelformat = pix->pixelformat;
+		format->field = pix->field;
+		format->num_planes = 1;
+		format->plane[0].bytesperline = pix->bytesperline;
+		format->plane[0].sizeimage = pix->sizeimage;
+		size = pix->sizeimage;
+	}
+
+	return size;
+}
+
 bool
 query_buffer(int fd,
+	     enum v4l2_buf_type type,
 	     log_t log,
 	     mg_buffer_t dev_buf,
 	     int index)
 {
 	struct v4l2_buffer buf;
+	struct v4l2_plane planes[VIDEO_MAX_PLANES];
 	CLEAR(buf);
+	CLEAR(planes);
 
-	buf.type = TYPE;
+	buf.type = type;
 	buf.memory = MEMORY;
 	buf.index = index;
+	if (TYPE_MPLANE == type) {
+		buf.m.planes = planes;
+		buf.length = VIDEO_MAX_PLANES;
+	}
 
 	if (-1 == xioctl(fd, VIDIOC_QUERYBUF, &buf)) {
 		lg_errno(log, "VIDIOC_QUERYBUF on fd %d", fd);
 		return false;
 	}
 
-	void *start = mmap(NULL /* start anywhere */,
-			   buf.length,
-			   PROT_READ | PROT_WRITE /* required */,
-			   MAP_SHARED /* recommended */,
-			   fd,
-			   buf.m.offset);
+	/* a single-planar buffer is its own first plane */
+	unsigned int n = 1;
+	if (TYPE_MPLANE == type) {
+		n = buf.length;
+	} else {
+		planes[0].length = buf.length;
+		planes[0].m.mem_offset = buf.m.offset;
+	}
 
-	if (MAP_FAILED == start) {
-		lg_errno(log, "mmap");
+	if (!mg_buffer_set_planes(dev_buf, n)) {
+		lg_log(log, "%u planes per buffer on fd %d, at most %d "
+		       "supported", n, fd, MG_MAX_PLANES);
 		return false;
 	}
 
-	if (!mg_buffer_set(dev_buf, index, start, buf.length)) {
-		return false;
+	for (unsigned int p = 0; p < n; p++) {
+		void *start = mmap(NULL /* start anywhere */,
+				   planes[p].length,
+				   PROT_READ | PROT_WRITE /* required */,
+				   MAP_SHARED /* recommended */,
+				   fd,
+				   planes[p].m.mem_offset);
+
+		if (MAP_FAILED == start) {
+			lg_errno(log, "mmap");
+			return false;
+		}
+
+		if (!mg_buffer_set_plane(dev_buf, index, p,
+					 start, planes[p].length)) {
+			return false;
+		}
 	}
 
 	return true;
 }
 
+void
+export_buffer(int fd,
+	      enum v4l2_buf_type type,
+	      mg_buffer_t dev_buf,
+	      unsigned int index,
+	      log_t log)
+{
+	unsigned int n = mg_buffer_get_planes(dev_buf);
+	for (unsigned int p = 0; p < n; p++) {
+		struct v4l2_exportbuffer expbuf;
+		CLEAR(expbuf);
+
+		expbuf.type = type;
+		expbuf.index = index;
+		expbuf.plane = p;
+		expbuf.flags = O_RDONLY | O_CLOEXEC;
+
+		if (-1 == xioctl(fd, VIDIOC_EXPBUF, &expbuf)) {
+			if (EINVAL != errno && ENOTTY != errno) {
+				lg_errno(log, "VIDIOC_EXPBUF on fd %d", fd);
+			}
+			return;
+		}
+
+		mg_buffer_set_plane_dmabuf(dev_buf, index, p, expbuf.fd);
+	}
+}
+
 bool
 init_mmap(int fd,
+	  enum v4l2_buf_type type,
 	  const char *dev_name,
 	  mg_buffer_t dev_buf,
 	  unsigned int req_bufs,
 	  log_t log)
 {
-	if (!request_buffers(fd, dev_name, req_bufs, log)) {
+	if (!request_buffers(fd, type, dev_name, req_bufs, log)) {
 		return false;
 	}
 
@@ -364,9 +884,10 @@ init_mmap(int fd,
 	}
 
 	for (unsigned int i = 0; i < req_bufs; i++) {
-		if (!query_buffer(fd, log, dev_buf, i)) {
+		if (!query_buffer(fd, type, log, dev_buf, i)) {
 			return false;
 		}
+		export_buffer(fd, type, dev_buf, i, log);
 	}
 
 	return true;
@@ -374,6 +895,7 @@ init_mmap(int fd,
 
 bool
 request_buffers(int fd,
+		enum v4l2_buf_type type,
 		const char *dev_name,
 		unsigned int req_bufs,
 		log_t log)
@@ -382,7 +904,7 @@ request_buffers(int fd,
 	CLEAR(req);
 
 	req.count = req_bufs;
-	req.type = TYPE;
+	req.type = type;
 	req.memory = MEMORY;
 
 	if (-1 == xioctl(fd, VIDIOC_REQBUFS, &req)) {
@@ -405,18 +927,38 @@ request_buffers(int fd,
 	return true;
 }
 
+bool
+has_format(int fd,
+	   enum v4l2_buf_type type,
+	   uint32_t pixelformat)
+{
+	struct v4l2_fmtdesc desc;
+	CLEAR(desc);
+
+	desc.type = type;
+	while (-1 != xioctl(fd, VIDIOC_ENUM_FMT, &desc)) {
+		if (desc.pixelformat == pixelformat) {
+			return true;
+		}
+		desc.index++;
+	}
+
+	return false;
+}
+
 bool
 select_input(int fd,
+	     mg_config_t config,
 	     log_t log)
 {
-	int index = 0; /* Changed to television input 2005-06-14 - NM */
-	if (-1 == xioctl(fd, VIDIOC_S_INPUT, &index)) {
+	int index = mg_config_get_input(config);
+	if (0 <= index && -1 == xioctl(fd, VIDIOC_S_INPUT, &index)) {
 		lg_errno(log, "VIDIOC_S_INPUT on fd %d", fd);
 		return false;
 	}
 
-	v4l2_std_id std = STANDARD;
-	if (-1 == xioctl(fd, VIDIOC_S_STD, &std)) {
+	v4l2_std_id std = mg_config_get_standard(config);
+	if (std && -1 == xioctl(fd, VIDIOC_S_STD, &std)) {
 		lg_errno(log, "VIDIOC_S_STD on fd %d", fd);
 		return false;
 	}
@@ -424,6 +966,26 @@ select_input(int fd,
 	return true;
 }
 
+bool
+reset_selection(int fd)
+{
+	struct v4l2_selection sel;
+	CLEAR(sel);
+
+	sel.type = TYPE;
+	sel.target = V4L2_SEL_TGT_CROP_DEFAULT;
+	if (-1 == xioctl(fd, VIDIOC_G_SELECTION, &sel)) {
+		return false;
+	}
+
+	sel.target = V4L2_SEL_TGT_CROP;
+	if (-1 == xioctl(fd, VIDIOC_S_SELECTION, &sel)) {
+		return false;
+	}
+
+	return true;
+}
+
 void
 set_crop(int fd)
 {
@@ -451,71 +1013,96 @@ set_crop(int fd)
 }
 
 bool
-set_format(int fd,
+set_format(mg_device_t dev,
 	   log_t log)
 {
-	struct v4l2_format fmt;
-
-	CLEAR(fmt);
-
-	fmt.type = TYPE;
-	fmt.fmt.pix.width = WIDTH;
-	fmt.fmt.pix.height = HEIGHT;
-	fmt.fmt.pix.pixelformat = PIXELFORMAT;
-	fmt.fmt.pix.field = FIELD;
-
-	if (-1 == xioctl(fd, VIDIOC_S_FMT, &fmt)) {
-		lg_errno(log, "VIDIOC_S_FMT on fd %d", fd);
-		return false;
-	}
-
-	/* Note VIDIOC_S_FMT may change width and height. */
-
-	/* Buggy driver paranoia. */
-	unsigned int min;
-	min = fmt.fmt.pix.width * 2;
-	if (fmt.fmt.pix.bytesperline < min) {
-		fmt.fmt.pix.bytesperline = min;
-	}
-	min = fmt.fmt.pix.bytesperline * fmt.fmt.pix.height;
-	if (fmt.fmt.pix.sizeimage < min) {
-		fmt.fmt.pix.sizeimage = min;
-	}
+	int fd = mg_device_get_fd(dev);
+	enum v4l2_buf_type type = buf_type(dev);
+	mg_config_t config = mg_device_get_config(dev);
+
+	struct v4l2_format best;
+	CLEAR(best);
+	uint32_t best_size = 0;
+	bool found = false;
+
+	unsigned int n = mg_config_get_num_pixelformats(config);
+	for (unsigned int i = 0; i < n; i++) {
+		uint32_t pixelformat = mg_config_get_pixelformat(config, i);
+		if (!has_format(fd, type, pixelformat)) {
+			continue;
+		}
 
-	return true;
-}
+		struct v4l2_format fmt;
+		CLEAR(fmt);
 
-bool
-test_capability(int fd,
-		const char *dev_name,
-		log_t log)
-{
-	struct v4l2_capability cap;
+		fmt.type = type;
+		if (TYPE_MPLANE == type) {
+			fmt.fmt.pix_mp.width = mg_config_get_width(config);
+			fmt.fmt.pix_mp.height = mg_config_get_height(config);
+			fmt.fmt.pix_mp.pixelformat = pixelformat;
+			fmt.fmt.pix_mp.field = mg_config_get_field(config);
+		} else {
+			fmt.fmt.pix.width = mg_config_get_width(config);
+			fmt.fmt.pix.height = mg_config_get_height(config);
+			fmt.fmt.pix.pixelformat = pixelformat;
+			fmt.fmt.pix.field = mg_config_get_field(config);
+		}
 
-	if (-1 == xioctl(fd, VIDIOC_QUERYCAP, &cap)) {
-		if (EINVAL == errno) {
-			lg_log(log, "%s is no V4L2 device",
-				dev_name);
-			return false;
+		uint32_t size = 0;
+		if (-1 == xioctl(fd, VIDIOC_TRY_FMT, &fmt)) {
+			if (ENOTTY != errno) {
+				continue;
+			}
+			/* VIDIOC_TRY_FMT is optional, let S_FMT decide */
 		} else {
-			lg_errno(log, "VIDIOC_QUERYCAP on fd %d", fd);
-			return false;
+			struct mg_format format;
+			size = get_format(&fmt, &format);
+			if (format.pixelformat != pixelformat) {
+				continue;
+			}
+		}
+
+		/* the first of equally expensive formats is preferred */
+		if (!found || size < best_size) {
+			best = fmt;
+			best_size = size;
+			found = true;
 		}
 	}
 
-	if (!(cap.capabilities & VIDEO_CAPTURE)) {
-		lg_log(log, "%s is no video capture device",
-			dev_name);
+	if (!found) {
+		lg_log(log, "%s offers none of the accepted pixel formats",
+		       mg_device_get_name(dev));
 		return false;
 	}
 
-	if (!(cap.capabilities & STREAMING)) {
-		lg_log(log,
-			"%s does not support streaming i/o",
-			dev_name);
+	if (-1 == xioctl(fd, VIDIOC_S_FMT, &best)) {
+		lg_errno(log, "VIDIOC_S_FMT on fd %d", fd);
 		return false;
 	}
 
+	/* Note VIDIOC_S_FMT may change width and height. */
+	struct mg_format format;
+	get_format(&best, &format);
+
+	/* Buggy driver paranoia, for the packed formats we know. */
+	uint32_t bpp = mg_convert_bytes_per_pixel(format.pixelformat);
+	if (bpp) {
+		unsigned int min;
+		min = format.width * bpp;
+		if (format.bytesperline < min) {
+			format.bytesperline = min;
+		}
+		min = format.bytesperline * format.height;
+		if (format.sizeimage < min) {
+			format.sizeimage = min;
+		}
+		format.plane[0].bytesperline = format.bytesperline;
+		format.plane[0].sizeimage = format.sizeimage;
+	}
+
+	mg_device_set_format(dev, format);
+
 	return true;
 }
 
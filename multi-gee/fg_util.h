@@ -33,31 +33,70 @@ struct v4l2_buffer;
 /**
  * @brief Dequeue a buffer for user processing
  *
- * @param fd  file descriptor
+ * the buffer is marked as held, and its sequence number and time stamp
+ * are recorded.
+ *
+ * @param device  device to dequeue from
  * @param buffer  video4linux2 buffer to dequeue
  * @param log  to log possible errors to
  *
  * @return \c true on success, \c false on failure to dequeue buffer
  */
 bool
-fg_dequeue(int fd,
+fg_dequeue(mg_device_t device,
 	   struct v4l2_buffer *buffer,
 	   log_t log);
 
 /**
  * @brief Enqueue a capture buffer for filling by the driver
  *
- * @param fd  file descriptor
+ * the buffer is marked as queued, or as lost if the driver refuses it.
+ *
+ * @param device  device to enqueue to
  * @param index   buffer index
  * @param log  to log possible errors to
  *
  * @return \c true on success, \c false on failure to enqueue buffer
  */
 bool
-fg_enqueue(int fd,
+fg_enqueue(mg_device_t device,
 	   int index,
 	   log_t log);
 
+/**
+ * @brief Add capture buffers to a device
+ *
+ * allocates the buffers with VIDIOC_CREATE_BUFS, in the current
+ * capture format, maps and exports them and hands them to the driver.
+ * this may be done while streaming.
+ *
+ * @param device  device to add buffers to
+ * @param count  number of buffers to add
+ * @param log  to log possible errors to
+ *
+ * @return \c true on success, \c false if the driver cannot add the
+ * buffers
+ */
+bool
+fg_create_buffers(mg_device_t device,
+		  unsigned int count,
+		  log_t log);
+
+/**
+ * @brief Drain stale buffers from the device
+ *
+ * dequeues every buffer the driver has already filled and enqueues it
+ * again, so that the next buffer dequeued holds a fresh frame.
+ *
+ * @param device  device to drain
+ * @param log  to log possible errors to
+ *
+ * @return \c true on success, \c false on failure to requeue a buffer
+ */
+bool
+fg_drain(mg_device_t device,
+	 log_t log);
+
 /**
  * @brief Initialise frame capture device
  *
@@ -65,8 +104,10 @@ fg_enqueue(int fd,
  *  - test capabilities
  *  - select input source
  *  - reset the cropping
- *  - set the capture format
+ *  - negotiate the capture format with the device's configuration
  *  - initialise the memory-mapping
+ *  - export the capture buffers as DMABUF file descriptors, where the
+ *    driver supports it
  *
  * @param device  device object handle
  * @param log  to log possible errors to
@@ -77,9 +118,82 @@ bool
 fg_init_device(mg_device_t device,
 	       log_t log);
 
+/**
+ * @brief Test whether a device is still connected
+ *
+ * @param device  device object handle
+ *
+ * @return \c false if the device has been unplugged, else \c true
+ */
+bool
+fg_present(mg_device_t device);
+
+/**
+ * @brief Hand the capture buffers to the driver
+ *
+ * queues every buffer that is not retired, ahead of fg_stream_on().
+ *
+ * @param device  device object handle
+ * @param log  to log possible errors to
+ */
+void
+fg_queue_buffers(mg_device_t device,
+		 log_t log);
+
+/**
+ * @brief Set controls of a device
+ *
+ * the controls are set with one VIDIOC_S_EXT_CTRLS, and the values the
+ * driver settles on are recorded on the device with
+ * mg_device_set_control().
+ *
+ * @param device  device object handle
+ * @param control  control changes
+ * @param n  number of control changes
+ * @param sequence  sequence number of the first frame captured with the
+ * new values
+ * @param log  to log possible errors to
+ *
+ * @return \c true on success, \c false if any control could not be set
+ */
+bool
+fg_set_controls(mg_device_t device,
+		const struct mg_control *control,
+		unsigned int n,
+		uint32_t sequence,
+		log_t log);
+
+/**
+ * @brief Change the region of interest of a streaming device
+ *
+ * the hardware is asked to crop to the region with VIDIOC_S_SELECTION.
+ * if it refuses, or scales the cropped region back to the frame size,
+ * the hardware crop is reset and the region becomes a view on the full
+ * frame instead.
+ *
+ * @param device  device to change
+ * @param roi  region of interest, in full frame coordinates, or a zero
+ * width for the full frame
+ * @param sequence  estimated sequence number of the first frame that
+ * can be captured with a new hardware crop; frames that change size
+ * are told apart by their size instead
+ * @param log  to log possible errors to
+ *
+ * @return \c true on success, \c false if the region of interest could
+ * not be changed
+ */
+bool
+fg_set_roi(mg_device_t device,
+	   struct mg_rect roi,
+	   uint32_t sequence,
+	   log_t log);
+
 /**
  * @brief Start streaming capturing on device
  *
+ * hands every buffer that is not retired to the driver, before
+ * starting the stream; fg_queue_buffers() followed by fg_stream_on().
+ *
  * @param device  device to start streaming
  * @param log  to log possible errors to
  *
@@ -92,6 +206,10 @@ fg_start_capture(mg_device_t device,
 /**
  * @brief Stop streaming capturing on device
  *
+ * the driver gives up all buffers, so every buffer that is not retired
+ * becomes idle.  the next stream numbers its frames from 0, so the
+ * buffer and device sequence numbers restart as well.
+ *
  * @param device  device to stop streaming
  * @param log  to log possible errors to
  *
@@ -101,6 +219,33 @@ bool
 fg_stop_capture(mg_device_t device,
 		log_t log);
 
+/**
+ * @brief Start the stream of a device with queued buffers
+ *
+ * @param device  device object handle
+ * @param log  to log possible errors to
+ *
+ * @return \c true on success, \c false on failure to start the stream
+ */
+bool
+fg_stream_on(mg_device_t device,
+	     log_t log);
+
+/**
+ * @brief Test device capabilities
+ *
+ * tests for video capture and streaming i/o, and stores the bus
+ * information of the device on the device object.
+ *
+ * @param device  device object handle, with an open file descriptor
+ * @param log  to log possible errors to
+ *
+ * @return \c true if the device can be captured from, else \c false
+ */
+bool
+fg_test_capability(mg_device_t device,
+		   log_t log);
+
 /**
  * @brief Uninitialise frame capture device
  *
@@ -119,18 +119,21 @@ lg_errno(log_t log,
 	 ...)
 {
 	VERIFYZ(log) {
+		int err = errno;
 		va_list ap;
 		va_start(ap, format);
 
-		FILE* out = stderr;
+		/* keep lines of concurrent threads whole */
+		FILE* out = log->file ? log->file : stderr;
+		flockfile(out);
 		if (log->file) {
-			out = log->file;
 			put_header(out, log->name);
 		}
 
 		vfprintf(out, format, ap);
-		fprintf(out, " error %d, %s\n", errno, strerror(errno));
+		fprintf(out, " error %d, %s\n", err, strerror(err));
 		fflush(out);
+		funlockfile(out);
 
 		va_end(ap);
 	}
@@ -145,15 +148,16 @@ lg_log(log_t log,
 		va_list ap;
 		va_start(ap, format);
 
-		FILE* out = stderr;
+		FILE* out = log->file ? log->file : stderr;
+		flockfile(out);
 		if (log->file) {
-			out = log->file;
 			put_header(out, log->name);
 		}
 
 		vfprintf(out, format, ap);
 		fprintf(out, "\n");
 		fflush(out);
+		funlockfile(out);
 
 		va_end(ap);
 	}
@@ -214,5 +218,6 @@ put_time(char *buffer,
 {
 	struct timeval tv;
 	gettimeofday(&tv, 0);
-	strftime(buffer, size, "%F %H:%M:%S", localtime(&tv.tv_sec));
+	struct tm tm;
+	strftime(buffer, size, "%F %H:%M:%S", localtime_r(&tv.tv_sec, &tm));
 }
@@ -0,0 +1,723 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee background model definition
+ */
+#include <string.h> /* memset */
+
+#include "mg_background.h" /* class implemented */
+
+#ifdef MG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Start the model from an image
+ *
+ * @param background  object handle
+ * @param image  8-bit image
+ * @param dst  output image, cleared
+ *
+ * @return \c true on success, \c false if out of memory
+ */
+static
+bool
+start(mg_background_t background,
+      const struct mg_image *image,
+      const struct mg_image *dst);
+
+/**
+ * @brief Background model object structure
+ */
+CLASS(mg_background, mg_background_t)
+{
+	enum mg_background_model model; /**< Kind of model */
+	enum mg_background_output output; /**< What is stored */
+	uint8_t margin; /**< Grey levels above the model that count */
+	unsigned int shift; /**< Learning rate */
+	bool learning; /**< Model follows the images? */
+	uint32_t width; /**< Width of the model */
+	uint32_t height; /**< Height of the model */
+	uint16_t *average; /**< Exponential average per pixel, in 1/256 */
+	uint8_t *maximum; /**< Running maximum per pixel */
+	unsigned int count; /**< Images learned from */
+};
+
+/**
+ * @brief Apply and learn a line of an average model
+ *
+ * @param src  image line
+ * @param model  model line
+ * @param dst  output line
+ * @param width  number of pixels
+ * @param shift  learning rate
+ * @param margin  grey levels above the model that count
+ * @param suppress  store suppressed image rather than difference?
+ * @param learn  update the model?
+ */
+typedef void (*average_fn)(const uint8_t *src,
+			   uint16_t *model,
+			   uint8_t *dst,
+			   unsigned int width,
+			   unsigned int shift,
+			   uint8_t margin,
+			   bool suppress,
+			   bool learn);
+
+/**
+ * @brief Apply and learn a line of a maximum model
+ *
+ * @param src  image line
+ * @param model  model line
+ * @param dst  output line
+ * @param width  number of pixels
+ * @param decay  grey levels the model decays before it learns
+ * @param margin  grey levels above the model that count
+ * @param suppress  store suppressed image rather than difference?
+ * @param learn  update the model?
+ */
+typedef void (*maximum_fn)(const uint8_t *src,
+			   uint8_t *model,
+			   uint8_t *dst,
+			   unsigned int width,
+			   uint8_t decay,
+			   uint8_t margin,
+			   bool suppress,
+			   bool learn);
+
+static
+void
+average_scalar(const uint8_t *src,
+	       uint16_t *model,
+	       uint8_t *dst,
+	       unsigned int width,
+	       unsigned int shift,
+	       uint8_t margin,
+	       bool suppress,
+	       bool learn)
+{
+	for (unsigned int i = 0; i < width; i++) {
+		uint8_t x = src[i];
+		uint16_t m = model[i];
+		unsigned int limit = (m >> 8) + margin;
+		uint8_t d = (x > limit) ? x - limit : 0;
+		dst[i] = suppress ? (d ? x : 0) : d;
+
+		if (learn) {
+			uint16_t x8 = x << 8;
+			uint16_t up = (x8 > m) ? (x8 - m) >> shift : 0;
+			uint16_t down = (m > x8) ? (m - x8) >> shift : 0;
+			model[i] = m + up - down;
+		}
+	}
+}
+
+static
+void
+maximum_scalar(const uint8_t *src,
+	       uint8_t *model,
+	       uint8_t *dst,
+	       unsigned int width,
+	       uint8_t decay,
+	       uint8_t margin,
+	       bool suppress,
+	       bool learn)
+{
+	for (unsigned int i = 0; i < width; i++) {
+		uint8_t x = src[i];
+		uint8_t m = model[i];
+		unsigned int limit = m + margin;
+		uint8_t d = (x > limit) ? x - limit : 0;
+		dst[i] = suppress ? (d ? x : 0) : d;
+
+		if (learn) {
+			m = (m > decay) ? m - decay : 0;
+			model[i] = (x > m) ? x : m;
+		}
+	}
+}
+
+#ifdef MG_SIMD_X86
+
+MG_TARGET_SSE2
+static
+void
+average_sse2(const uint8_t *src,
+	     uint16_t *model,
+	     uint8_t *dst,
+	     unsigned int width,
+	     unsigned int shift,
+	     uint8_t margin,
+	     bool suppress,
+	     bool learn)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lift = _mm_set1_epi8(margin);
+	const __m128i rate = _mm_cvtsi32_si128(shift);
+	unsigned int i = 0;
+	for (; i + 16 <= width; i += 16) {
+		__m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+		__m128i lo = _mm_loadu_si128((const __m128i *) (model + i));
+		__m128i hi = _mm_loadu_si128((const __m128i *) (model + i + 8));
+		__m128i b = _mm_packus_epi16(_mm_srli_epi16(lo, 8),
+					     _mm_srli_epi16(hi, 8));
+		__m128i d = _mm_subs_epu8(x, _mm_adds_epu8(b, lift));
+		if (suppress) {
+			d = _mm_andnot_si128(_mm_cmpeq_epi8(d, zero), x);
+		}
+		_mm_storeu_si128((__m128i *) (dst + i), d);
+
+		if (learn) {
+			/* x in the high byte is x in 1/256 grey levels */
+			__m128i x8 = _mm_unpacklo_epi8(zero, x);
+			__m128i up = _mm_srl_epi16(_mm_subs_epu16(x8, lo), rate);
+			__m128i down = _mm_srl_epi16(_mm_subs_epu16(lo, x8),
+						     rate);
+			lo = _mm_sub_epi16(_mm_add_epi16(lo, up), down);
+			x8 = _mm_unpackhi_epi8(zero, x);
+			up = _mm_srl_epi16(_mm_subs_epu16(x8, hi), rate);
+			down = _mm_srl_epi16(_mm_subs_epu16(hi, x8), rate);
+			hi = _mm_sub_epi16(_mm_add_epi16(hi, up), down);
+			_mm_storeu_si128((__m128i *) (model + i), lo);
+			_mm_storeu_si128((__m128i *) (model + i + 8), hi);
+		}
+	}
+	if (i < width) {
+		average_scalar(src + i, model + i, dst + i, width - i,
+			       shift, margin, suppress, learn);
+	}
+}
+
+MG_TARGET_SSE2
+static
+void
+maximum_sse2(const uint8_t *src,
+	     uint8_t *model,
+	     uint8_t *dst,
+	     unsigned int width,
+	     uint8_t decay,
+	     uint8_t margin,
+	     bool suppress,
+	     bool learn)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lift = _mm_set1_epi8(margin);
+	const __m128i fall = _mm_set1_epi8(decay);
+	unsigned int i = 0;
+	for (; i + 16 <= width; i += 16) {
+		__m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+		__m128i m = _mm_loadu_si128((const __m128i *) (model + i));
+		__m128i d = _mm_subs_epu8(x, _mm_adds_epu8(m, lift));
+		if (suppress) {
+			d = _mm_andnot_si128(_mm_cmpeq_epi8(d, zero), x);
+		}
+		_mm_storeu_si128((__m128i *) (dst + i), d);
+
+		if (learn) {
+			m = _mm_max_epu8(_mm_subs_epu8(m, fall), x);
+			_mm_storeu_si128((__m128i *) (model + i), m);
+		}
+	}
+	if (i < width) {
+		maximum_scalar(src + i, model + i, dst + i, width - i,
+			       decay, margin, suppress, learn);
+	}
+}
+
+MG_TARGET_AVX2
+static
+void
+average_avx2(const uint8_t *src,
+	     uint16_t *model,
+	     uint8_t *dst,
+	     unsigned int width,
+	     unsigned int shift,
+	     uint8_t margin,
+	     bool suppress,
+	     bool learn)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i lift = _mm256_set1_epi8(margin);
+	const __m128i rate = _mm_cvtsi32_si128(shift);
+	unsigned int i = 0;
+	for (; i + 32 <= width; i += 32) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (src + i));
+		__m256i lo = _mm256_loadu_si256((const __m256i *) (model + i));
+		__m256i hi = _mm256_loadu_si256((const __m256i *)
+						(model + i + 16));
+		/* packing works per 128-bit lane, put the quarters back */
+		__m256i b = _mm256_permute4x64_epi64(
+			_mm256_packus_epi16(_mm256_srli_epi16(lo, 8),
+					    _mm256_srli_epi16(hi, 8)),
+			0xd8);
+		__m256i d = _mm256_subs_epu8(x, _mm256_adds_epu8(b, lift));
+		if (suppress) {
+			d = _mm256_andnot_si256(_mm256_cmpeq_epi8(d, zero), x);
+		}
+		_mm256_storeu_si256((__m256i *) (dst + i), d);
+
+		if (learn) {
+			/* so is unpacking: pixels 0-15 to the low half */
+			__m256i q = _mm256_permute4x64_epi64(x, 0xd8);
+			__m256i x8 = _mm256_unpacklo_epi8(zero, q);
+			__m256i up = _mm256_srl_epi16(
+				_mm256_subs_epu16(x8, lo), rate);
+			__m256i down = _mm256_srl_epi16(
+				_mm256_subs_epu16(lo, x8), rate);
+			lo = _mm256_sub_epi16(_mm256_add_epi16(lo, up), down);
+			x8 = _mm256_unpackhi_epi8(zero, q);
+			up = _mm256_srl_epi16(_mm256_subs_epu16(x8, hi), rate);
+			down = _mm256_srl_epi16(_mm256_subs_epu16(hi, x8),
+						rate);
+			hi = _mm256_sub_epi16(_mm256_add_epi16(hi, up), down);
+			_mm256_storeu_si256((__m256i *) (model + i), lo);
+			_mm256_storeu_si256((__m256i *) (model + i + 16), hi);
+		}
+	}
+	if (i < width) {
+		average_sse2(src + i, model + i, dst + i, width - i,
+			     shift, margin, suppress, learn);
+	}
+}
+
+MG_TARGET_AVX2
+static
+void
+maximum_avx2(const uint8_t *src,
+	     uint8_t *model,
+	     uint8_t *dst,
+	     unsigned int width,
+	     uint8_t decay,
+	     uint8_t margin,
+	     bool suppress,
+	     bool learn)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i lift = _mm256_set1_epi8(margin);
+	const __m256i fall = _mm256_set1_epi8(decay);
+	unsigned int i = 0;
+	for (; i + 32 <= width; i += 32) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (src + i));
+		__m256i m = _mm256_loadu_si256((const __m256i *) (model + i));
+		__m256i d = _mm256_subs_epu8(x, _mm256_adds_epu8(m, lift));
+		if (suppress) {
+			d = _mm256_andnot_si256(_mm256_cmpeq_epi8(d, zero), x);
+		}
+		_mm256_storeu_si256((__m256i *) (dst + i), d);
+
+		if (learn) {
+			m = _mm256_max_epu8(_mm256_subs_epu8(m, fall), x);
+			_mm256_storeu_si256((__m256i *) (model + i), m);
+		}
+	}
+	if (i < width) {
+		maximum_sse2(src + i, model + i, dst + i, width - i,
+			     decay, margin, suppress, learn);
+	}
+}
+
+/**
+ * @brief Average kernel per instruction set level
+ */
+static const average_fn average_line[] = {
+	average_scalar,
+	average_sse2,
+	average_avx2
+};
+
+/**
+ * @brief Maximum kernel per instruction set level
+ */
+static const maximum_fn maximum_line[] = {
+	maximum_scalar,
+	maximum_sse2,
+	maximum_avx2
+};
+
+#else /* MG_SIMD_X86 */
+
+static const average_fn average_line[] = {
+	average_scalar,
+	average_scalar,
+	average_scalar
+};
+
+static const maximum_fn maximum_line[] = {
+	maximum_scalar,
+	maximum_scalar,
+	maximum_scalar
+};
+
+#endif /* MG_SIMD_X86 */
+
+mg_background_t
+mg_background_create(enum mg_background_model model)
+{
+	mg_background_t mg_background;
+	NEWOBJ(mg_background);
+
+	mg_background->model = model;
+	mg_background->output = MG_BACKGROUND_SUPPRESS;
+	mg_background->margin = 16;
+	mg_background->shift = 5;
+	mg_background->learning = true;
+	mg_background->width = 0;
+	mg_background->height = 0;
+	mg_background->average = 0;
+	mg_background->maximum = 0;
+	mg_background->count = 0;
+
+	return mg_background;
+}
+
+mg_background_t
+mg_background_destroy(mg_background_t mg_background)
+{
+	VERIFYZ(mg_background) {
+		FREEOBJ(mg_background->average);
+		FREEOBJ(mg_background->maximum);
+
+		FREEOBJ(mg_background);
+	}
+
+	return 0;
+}
+
+bool
+mg_background_apply(mg_background_t mg_background,
+		    const struct mg_image *image,
+		    const struct mg_image *dst,
+		    enum mg_simd simd)
+{
+	bool ok = false;
+
+	VERIFY(mg_background) {
+		uint32_t w = image->width;
+		uint32_t h = image->height;
+		if (!image->data || !dst->data || !w || !h
+		    || dst->width != w || dst->height != h) {
+			return false;
+		}
+
+		if (!mg_background->count
+		    || w != mg_background->width
+		    || h != mg_background->height) {
+			return start(mg_background, image, dst);
+		}
+
+		if (simd > mg_simd_detect()) {
+			simd = mg_simd_detect();
+		}
+
+		bool suppress = MG_BACKGROUND_SUPPRESS == mg_background->output;
+		bool learn = mg_background->learning;
+		unsigned int period = 1u << mg_background->shift;
+		uint8_t decay = (learn && !(mg_background->count % period))
+			? 1 : 0;
+		for (uint32_t y = 0; y < h; y++) {
+			const uint8_t *s = (const uint8_t *) image->data
+				+ (size_t) y * image->stride;
+			uint8_t *d = (uint8_t *) dst->data
+				+ (size_t) y * dst->stride;
+			size_t i = (size_t) y * w;
+			if (MG_BACKGROUND_AVERAGE == mg_background->model) {
+				average_line[simd](s, mg_background->average + i,
+						   d, w, mg_background->shift,
+						   mg_background->margin,
+						   suppress, learn);
+			} else {
+				maximum_line[simd](s, mg_background->maximum + i,
+						   d, w, decay,
+						   mg_background->margin,
+						   suppress, learn);
+			}
+		}
+		if (learn) {
+			mg_background->count++;
+		}
+		ok = true;
+	}
+
+	return ok;
+}
+
+unsigned int
+mg_background_get_count(mg_background_t mg_background)
+{
+	unsigned int count = 0;
+
+	VERIFY(mg_background) {
+		count = mg_background->count;
+	}
+
+	return count;
+}
+
+mg_background_t
+mg_background_reset(mg_background_t mg_background)
+{
+	mg_background_t p = 0;
+
+	VERIFY(mg_background) {
+		mg_background->count = 0;
+		p = mg_background;
+	}
+
+	return p;
+}
+
+mg_background_t
+mg_background_set_learning(mg_background_t mg_background,
+			   bool learning)
+{
+	mg_background_t p = 0;
+
+	VERIFY(mg_background) {
+		mg_background->learning = learning;
+		p = mg_background;
+	}
+
+	return p;
+}
+
+mg_background_t
+mg_background_set_margin(mg_background_t mg_background,
+			 uint8_t margin)
+{
+	mg_background_t p = 0;
+
+	VERIFY(mg_background) {
+		mg_background->margin = margin;
+		p = mg_background;
+	}
+
+	return p;
+}
+
+mg_background_t
+mg_background_set_output(mg_background_t mg_background,
+			 enum mg_background_output output)
+{
+	mg_background_t p = 0;
+
+	VERIFY(mg_background) {
+		mg_background->output = output;
+		p = mg_background;
+	}
+
+	return p;
+}
+
+mg_background_t
+mg_background_set_rate(mg_background_t mg_background,
+		       unsigned int shift)
+{
+	mg_background_t p = 0;
+
+	VERIFY(mg_background) {
+		if (1 <= shift && shift <= 8) {
+			mg_background->shift = shift;
+			p = mg_background;
+		}
+	}
+
+	return p;
+}
+
+bool
+start(mg_background_t background,
+      const struct mg_image *image,
+      const struct mg_image *dst)
+{
+	uint32_t w = image->width;
+	uint32_t h = image->height;
+	size_t n = (size_t) w * h;
+
+	FREEOBJ(background->average);
+	FREEOBJ(background->maximum);
+	background->width = 0;
+	background->height = 0;
+	background->count = 0;
+	if (MG_BACKGROUND_AVERAGE == background->model) {
+		background->average = MALLOC(n * sizeof(*background->average));
+	} else {
+		background->maximum = MALLOC(n * sizeof(*background->maximum));
+	}
+	if (!background->average && !background->maximum) {
+		return false;
+	}
+
+	for (uint32_t y = 0; y < h; y++) {
+		const uint8_t *s = (const uint8_t *) image->data
+			+ (size_t) y * image->stride;
+		size_t i = (size_t) y * w;
+		if (background->average) {
+			for (uint32_t x = 0; x < w; x++) {
+				background->average[i + x] = s[x] << 8;
+			}
+		} else {
+			memcpy(background->maximum + i, s, w);
+		}
+		memset((uint8_t *) dst->data + (size_t) y * dst->stride, 0, w);
+	}
+	background->width = w;
+	background->height = h;
+	background->count = 1;
+
+	return true;
+}
+
+#ifdef TEST_MULTI_GEE_MG_BACKGROUND
+
+#include <stdio.h>
+#include <stdlib.h>
+
+USE_XASSERT
+
+/**
+ * @brief Image width, not a multiple of the kernel widths
+ */
+#define W 77
+
+/**
+ * @brief Image height
+ */
+#define H 9
+
+/**
+ * @brief Noisy scene with a lamp at (10, 3) and a marker moving along
+ * line 6
+ */
+static
+void
+scene(uint8_t *image,
+      unsigned int t)
+{
+	for (unsigned int i = 0; i < W * H; i++) {
+		image[i] = 40 + rand() % 8;
+	}
+	image[3 * W + 10] = 230;
+	image[6 * W + 20 + t] = 250;
+}
+
+void
+mg_background_test()
+{
+	printf("%s: %s\n", __func__, mg_simd_name(mg_simd_detect()));
+
+	uint8_t image[W * H];
+	uint8_t out[W * H];
+	struct mg_image in = {image, W, H, W};
+	struct mg_image dst = {out, W, H, W};
+
+	for (int model = MG_BACKGROUND_AVERAGE;
+	     model <= MG_BACKGROUND_MAXIMUM; model++) {
+		/* the kernels agree on models and outputs */
+		mg_background_t bg[MG_SIMD_AVX2 + 1];
+		for (int simd = 0; simd <= MG_SIMD_AVX2; simd++) {
+			bg[simd] = mg_background_create(model);
+			bg[simd] = mg_background_set_rate(bg[simd], 2);
+		}
+		XASSERT(!mg_background_set_rate(bg[0], 9)) {
+			/* empty */
+		}
+		srand(1);
+		for (unsigned int t = 0; t < 40; t++) {
+			scene(image, t);
+			uint8_t ref[W * H];
+			struct mg_image r = {ref, W, H, W};
+			for (int simd = 0; simd <= (int) mg_simd_detect();
+			     simd++) {
+				bg[simd] = mg_background_set_output(
+					bg[simd], (t & 1)
+					? MG_BACKGROUND_DIFFERENCE
+					: MG_BACKGROUND_SUPPRESS);
+				XASSERT(mg_background_apply(bg[simd], &in,
+							    simd ? &dst : &r,
+							    simd)) {
+					/* empty */
+				}
+				XASSERT(!simd || !memcmp(ref, out, sizeof(out))) {
+					/* empty */
+				}
+			}
+			if (!t) {
+				continue;
+			}
+
+			/* the lamp is background, the marker is not */
+			XASSERT(ref[3 * W + 10] == 0 || t < 4) {
+				/* empty */
+			}
+			XASSERT((t & 1) ? ref[6 * W + 20 + t] > 150
+				: ref[6 * W + 20 + t] == 250) {
+				/* empty */
+			}
+			XASSERT(ref[6 * W + 21 + t] == 0) {
+				/* empty */
+			}
+		}
+		XASSERT(mg_background_get_count(bg[0]) == 40) {
+			/* empty */
+		}
+
+		/* a frozen model keeps a marker that stands still */
+		bg[0] = mg_background_set_learning(bg[0], false);
+		bg[0] = mg_background_set_output(bg[0], MG_BACKGROUND_SUPPRESS);
+		for (unsigned int t = 0; t < 20; t++) {
+			scene(image, 50);
+			mg_background_apply(bg[0], &in, &dst, MG_SIMD_SCALAR);
+		}
+		XASSERT(out[6 * W + 70] == 250) {
+			/* empty */
+		}
+		XASSERT(mg_background_get_count(bg[0]) == 40) {
+			/* empty */
+		}
+
+		/* in place, and a new size starts over */
+		struct mg_image half = {image, W / 2, H, W};
+		XASSERT(mg_background_apply(bg[0], &half, &half,
+					    MG_SIMD_SCALAR)) {
+			/* empty */
+		}
+		XASSERT(image[6 * W + 10] == 0) {
+			/* empty */
+		}
+		XASSERT(mg_background_get_count(bg[0]) == 1) {
+			/* empty */
+		}
+		XASSERT(!mg_background_apply(bg[0], &in, &half,
+					     MG_SIMD_SCALAR)) {
+			/* empty */
+		}
+
+		for (int simd = 0; simd <= MG_SIMD_AVX2; simd++) {
+			bg[simd] = mg_background_destroy(bg[simd]);
+		}
+	}
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_background_test));
+}
+
+#endif /* TEST_MULTI_GEE_MG_BACKGROUND */
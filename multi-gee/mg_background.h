@@ -0,0 +1,196 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee background model declaration
+ *
+ * Reflections off the set and lamps in view are as bright as markers,
+ * but stay where they are.  A background model learns what every pixel
+ * of a camera looks like without markers, and takes it away from later
+ * images, so the threshold only sees what is brighter than usual.  The
+ * model is either an exponential average, for scenes with slowly
+ * changing light, or a running maximum, which also swallows flicker and
+ * noise.  Markers are brighter than the background, so only light
+ * above the model counts.
+ */
+#ifndef ITL_MULTI_GEE_MG_BACKGROUND_H
+#define ITL_MULTI_GEE_MG_BACKGROUND_H
+
+#include <stdbool.h> /* bool */
+#include <stdint.h> /* uint8_t */
+
+#include <cclass/classdef.h>
+#include <multi-gee/mg_image.h>
+#include <multi-gee/mg_simd.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Multi-gee background model object handle
+ */
+NEWHANDLE(mg_background_t);
+
+/**
+ * @brief Kind of background model
+ */
+enum mg_background_model
+{
+	MG_BACKGROUND_AVERAGE, /**< exponential average, in 1/256 grey
+				 levels */
+	MG_BACKGROUND_MAXIMUM /**< running maximum, slowly decaying */
+};
+
+/**
+ * @brief What mg_background_apply() stores
+ */
+enum mg_background_output
+{
+	MG_BACKGROUND_DIFFERENCE, /**< how far every pixel is above the
+				    model and margin, 0 if not above */
+	MG_BACKGROUND_SUPPRESS /**< the image, with every pixel that is
+				 not above the model and margin set to 0 */
+};
+
+/**
+ * @brief Create background model object
+ *
+ * the model learns from every image, moves 1/32 of the way towards it
+ * or decays one grey level every 32 images, and suppresses all that is
+ * not at least 16 grey levels above it.
+ *
+ * @param model  kind of model
+ *
+ * @return a newly created background model object handle
+ */
+mg_background_t
+mg_background_create(enum mg_background_model model);
+
+/**
+ * @brief Destroy background model object
+ *
+ * @param background  object handle
+ *
+ * @return 0
+ */
+mg_background_t
+mg_background_destroy(mg_background_t background);
+
+/**
+ * @brief Take the background away from an image, and learn from it
+ *
+ * the image is compared with the model before the model learns from
+ * it.  the first image, or the first of a new size, only starts the
+ * model, and its output is all 0.  images must be applied one after the
+ * other, in the order they were captured.
+ *
+ * @param background  object handle
+ * @param image  8-bit image, such as mg_frame_get_grey() returns
+ * @param dst  8-bit image of the same size, for the output; may be the
+ * image itself
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return \c true on success, \c false if the images do not match
+ */
+bool
+mg_background_apply(mg_background_t background,
+		    const struct mg_image *image,
+		    const struct mg_image *dst,
+		    enum mg_simd simd);
+
+/**
+ * @brief Number of images learned accessor
+ *
+ * @param background  object handle
+ *
+ * @return the number of images the model has learned from since it
+ * was started
+ */
+unsigned int
+mg_background_get_count(mg_background_t background);
+
+/**
+ * @brief Forget the model
+ *
+ * the next image starts a new one, for instance after the camera was
+ * moved.
+ *
+ * @param background  object handle
+ *
+ * @return object handle
+ */
+mg_background_t
+mg_background_reset(mg_background_t background);
+
+/**
+ * @brief Set whether the model learns
+ *
+ * a model learned with the markers out of view can be kept as it is
+ * while they are tracked, so a marker that stands still is not learned
+ * into the background.
+ *
+ * @param background  object handle
+ * @param learning  \c true for the model to follow the images
+ *
+ * @return object handle
+ */
+mg_background_t
+mg_background_set_learning(mg_background_t background,
+			   bool learning);
+
+/**
+ * @brief Set the margin above the model
+ *
+ * @param background  object handle
+ * @param margin  grey levels a pixel must be above the model to count
+ *
+ * @return object handle
+ */
+mg_background_t
+mg_background_set_margin(mg_background_t background,
+			 uint8_t margin);
+
+/**
+ * @brief Set the output
+ *
+ * @param background  object handle
+ * @param output  what mg_background_apply() stores
+ *
+ * @return object handle
+ */
+mg_background_t
+mg_background_set_output(mg_background_t background,
+			 enum mg_background_output output);
+
+/**
+ * @brief Set the learning rate
+ *
+ * an average moves 1/2^shift of the way towards every image; a maximum
+ * decays one grey level every 2^shift images.
+ *
+ * @param background  object handle
+ * @param shift  rate, 1 to 8
+ *
+ * @return object handle, or 0 if the rate is out of range
+ */
+mg_background_t
+mg_background_set_rate(mg_background_t background,
+		       unsigned int shift);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_BACKGROUND_H */
@@ -0,0 +1,650 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee blob labeller definition
+ */
+#include <pthread.h>
+#include <stdbool.h> /* bool */
+#include <stdlib.h> /* realloc */
+
+#include "mg_blobs.h" /* class implemented */
+
+USE_XASSERT
+
+/**
+ * @brief Union-find node of a span, with the totals of its blob
+ *
+ * the totals are only valid for the root of a blob.
+ */
+struct node
+{
+	uint32_t parent; /**< Parent node, the node itself for a root */
+	uint32_t area; /**< Number of pixels */
+	uint16_t left; /**< First column */
+	uint16_t top; /**< First line */
+	uint16_t right; /**< Last column */
+	uint16_t bottom; /**< Last line */
+	uint64_t sx; /**< Sum of columns */
+	uint64_t sy; /**< Sum of lines */
+	uint64_t sxx; /**< Sum of squared columns */
+	uint64_t sxy; /**< Sum of column times line */
+	uint64_t syy; /**< Sum of squared lines */
+};
+
+/**
+ * @brief Blob labeller object structure
+ */
+CLASS(mg_blobs, mg_blobs_t)
+{
+	struct node *node; /**< Node per span */
+	int32_t *blob; /**< Blob index per span */
+	struct mg_blob_table table; /**< Blobs of the last labelling */
+	unsigned int capacity; /**< Spans the arrays hold */
+	struct mg_span *span; /**< Spans of the last labelled mask */
+	unsigned int span_capacity; /**< Spans the span array holds */
+	unsigned int num_spans; /**< Number of spans labelled */
+	unsigned int connectivity; /**< 4 or 8 */
+};
+
+/**
+ * @brief Find the root of a node
+ *
+ * halves the path on the way.
+ *
+ * @param node  union-find nodes
+ * @param i  node to start at
+ *
+ * @return index of the root
+ */
+static
+uint32_t
+find(struct node *node,
+     uint32_t i);
+
+/**
+ * @brief Make room for a number of spans
+ *
+ * @param blobs  object handle
+ * @param n  number of spans
+ *
+ * @return
+ * - @c false on failure to allocate memory, else
+ * - @c true
+ */
+static
+bool
+grow(mg_blobs_t blobs,
+     unsigned int n);
+
+/**
+ * @brief Join the blobs of two nodes
+ *
+ * the root with the lower index stays root, so a blob's root is its
+ * first span in raster order.
+ *
+ * @param node  union-find nodes
+ * @param a  first node
+ * @param b  second node
+ */
+static
+void
+join(struct node *node,
+     uint32_t a,
+     uint32_t b);
+
+/**
+ * @brief Thread body of mg_blobs_label_parallel()
+ *
+ * @param arg  labelling job
+ *
+ * @return 0
+ */
+static
+void *
+label_job(void *arg);
+
+/**
+ * @brief Start a blob with one span
+ *
+ * @param node  node of the span
+ * @param i  index of the node
+ * @param span  the span
+ */
+static
+void
+start_blob(struct node *node,
+	   uint32_t i,
+	   const struct mg_span *span);
+
+mg_blobs_t
+mg_blobs_create()
+{
+	mg_blobs_t mg_blobs;
+	NEWOBJ(mg_blobs);
+
+	mg_blobs->node = 0;
+	mg_blobs->blob = 0;
+	mg_blobs->table.count = 0;
+	mg_blobs->table.area = 0;
+	mg_blobs->table.left = 0;
+	mg_blobs->table.top = 0;
+	mg_blobs->table.right = 0;
+	mg_blobs->table.bottom = 0;
+	mg_blobs->table.x = 0;
+	mg_blobs->table.y = 0;
+	mg_blobs->table.xx = 0;
+	mg_blobs->table.xy = 0;
+	mg_blobs->table.yy = 0;
+	mg_blobs->capacity = 0;
+	mg_blobs->span = 0;
+	mg_blobs->span_capacity = 0;
+	mg_blobs->num_spans = 0;
+	mg_blobs->connectivity = 8;
+
+	return mg_blobs;
+}
+
+mg_blobs_t
+mg_blobs_destroy(mg_blobs_t mg_blobs)
+{
+	VERIFYZ(mg_blobs) {
+		FREEOBJ(mg_blobs->node);
+		FREEOBJ(mg_blobs->blob);
+		FREEOBJ(mg_blobs->table.area);
+		FREEOBJ(mg_blobs->table.left);
+		FREEOBJ(mg_blobs->table.top);
+		FREEOBJ(mg_blobs->table.right);
+		FREEOBJ(mg_blobs->table.bottom);
+		FREEOBJ(mg_blobs->table.x);
+		FREEOBJ(mg_blobs->table.y);
+		FREEOBJ(mg_blobs->table.xx);
+		FREEOBJ(mg_blobs->table.xy);
+		FREEOBJ(mg_blobs->table.yy);
+		FREEOBJ(mg_blobs->span);
+
+		FREEOBJ(mg_blobs);
+	}
+
+	return 0;
+}
+
+int
+mg_blobs_get_blob(mg_blobs_t mg_blobs,
+		  unsigned int span)
+{
+	int blob = -1;
+
+	VERIFY(mg_blobs) {
+		if (span < mg_blobs->num_spans) {
+			blob = mg_blobs->blob[span];
+		}
+	}
+
+	return blob;
+}
+
+const struct mg_blob_table *
+mg_blobs_get_table(mg_blobs_t mg_blobs)
+{
+	const struct mg_blob_table *table = 0;
+
+	VERIFY(mg_blobs) {
+		table = &mg_blobs->table;
+	}
+
+	return table;
+}
+
+unsigned int
+mg_blobs_label(mg_blobs_t mg_blobs,
+	       const struct mg_span *span,
+	       unsigned int num_spans,
+	       uint32_t min_area)
+{
+	unsigned int count = 0;
+
+	VERIFY(mg_blobs) {
+		mg_blobs->table.count = 0;
+		mg_blobs->num_spans = 0;
+		if (!grow(mg_blobs, num_spans)) {
+			return 0;
+		}
+
+		struct node *node = mg_blobs->node;
+		int32_t slack = (8 == mg_blobs->connectivity) ? 1 : 0;
+
+		/* spans of the line above are [prev, line) */
+		unsigned int prev = 0;
+		unsigned int line = 0;
+		unsigned int p = 0;
+		for (unsigned int i = 0; i < num_spans; i++) {
+			const struct mg_span *s = &span[i];
+			if (!i || s->y != span[line].y) {
+				bool above = i && s->y == span[line].y + 1;
+				prev = above ? line : i;
+				line = i;
+				p = prev;
+			}
+
+			start_blob(node, i, s);
+
+			/* skip the spans above that end left of this one */
+			int32_t lo = (int32_t) s->x - slack;
+			int32_t hi = (int32_t) s->x + s->length - 1 + slack;
+			while (p < line
+			       && (int32_t) span[p].x + span[p].length - 1 < lo) {
+				p++;
+			}
+			for (unsigned int q = p;
+			     q < line && (int32_t) span[q].x <= hi;
+			     q++) {
+				join(node, i, q);
+			}
+		}
+
+		/* roots come before the other spans of their blob */
+		struct mg_blob_table *t = &mg_blobs->table;
+		for (unsigned int i = 0; i < num_spans; i++) {
+			uint32_t r = find(node, i);
+			if (r != i) {
+				mg_blobs->blob[i] = mg_blobs->blob[r];
+				continue;
+			}
+
+			struct node *n = &node[i];
+			if (n->area < min_area) {
+				mg_blobs->blob[i] = -1;
+				continue;
+			}
+
+			double a = n->area;
+			double x = n->sx / a;
+			double y = n->sy / a;
+			t->area[count] = n->area;
+			t->left[count] = n->left;
+			t->top[count] = n->top;
+			t->right[count] = n->right;
+			t->bottom[count] = n->bottom;
+			t->x[count] = x;
+			t->y[count] = y;
+			t->xx[count] = n->sxx / a - x * x;
+			t->xy[count] = n->sxy / a - x * y;
+			t->yy[count] = n->syy / a - y * y;
+			mg_blobs->blob[i] = count++;
+		}
+
+		t->count = count;
+		mg_blobs->num_spans = num_spans;
+	}
+
+	return count;
+}
+
+unsigned int
+mg_blobs_label_mask(mg_blobs_t mg_blobs,
+		    mg_mask_t mask,
+		    uint32_t min_area)
+{
+	unsigned int count = 0;
+
+	VERIFY(mg_blobs) {
+		unsigned int n = mg_mask_get_spans(mask, mg_blobs->span,
+						   mg_blobs->span_capacity);
+		if (n > mg_blobs->span_capacity) {
+			unsigned int capacity = n + n / 2;
+			void *q = realloc(mg_blobs->span,
+					  capacity * sizeof(*mg_blobs->span));
+			if (!q) {
+				mg_blobs->table.count = 0;
+				mg_blobs->num_spans = 0;
+				return 0;
+			}
+			mg_blobs->span = q;
+			mg_blobs->span_capacity = capacity;
+			mg_mask_get_spans(mask, mg_blobs->span, capacity);
+		}
+
+		count = mg_blobs_label(mg_blobs, mg_blobs->span, n, min_area);
+	}
+
+	return count;
+}
+
+void
+mg_blobs_label_parallel(const struct mg_blobs_job *job,
+			unsigned int num_jobs)
+{
+	if (!num_jobs) {
+		return;
+	}
+
+	pthread_t thread[num_jobs];
+	bool started[num_jobs];
+	for (unsigned int i = 1; i < num_jobs; i++) {
+		started[i] = 0 == pthread_create(&thread[i], 0, label_job,
+						 (void *) &job[i]);
+	}
+
+	/* the calling thread takes the first job */
+	label_job((void *) &job[0]);
+
+	for (unsigned int i = 1; i < num_jobs; i++) {
+		if (started[i]) {
+			pthread_join(thread[i], 0);
+		} else {
+			label_job((void *) &job[i]);
+		}
+	}
+}
+
+mg_blobs_t
+mg_blobs_set_connectivity(mg_blobs_t mg_blobs,
+			  unsigned int connectivity)
+{
+	mg_blobs_t p = 0;
+
+	VERIFY(mg_blobs) {
+		if (4 == connectivity || 8 == connectivity) {
+			mg_blobs->connectivity = connectivity;
+			p = mg_blobs;
+		}
+	}
+
+	return p;
+}
+
+uint32_t
+find(struct node *node,
+     uint32_t i)
+{
+	while (node[i].parent != i) {
+		node[i].parent = node[node[i].parent].parent;
+		i = node[i].parent;
+	}
+
+	return i;
+}
+
+bool
+grow(mg_blobs_t mg_blobs,
+     unsigned int n)
+{
+	if (n <= mg_blobs->capacity) {
+		return true;
+	}
+
+	/* grow by half again, to label growing span lists in few steps */
+	unsigned int capacity = n + n / 2;
+	struct mg_blob_table *t = &mg_blobs->table;
+
+#define GROW(p) do { \
+		void *q = realloc((p), capacity * sizeof(*(p))); \
+		if (!q) { \
+			return false; \
+		} \
+		(p) = q; \
+	} while (0)
+
+	GROW(mg_blobs->node);
+	GROW(mg_blobs->blob);
+	GROW(t->area);
+	GROW(t->left);
+	GROW(t->top);
+	GROW(t->right);
+	GROW(t->bottom);
+	GROW(t->x);
+	GROW(t->y);
+	GROW(t->xx);
+	GROW(t->xy);
+	GROW(t->yy);
+
+#undef GROW
+
+	mg_blobs->capacity = capacity;
+
+	return true;
+}
+
+void
+join(struct node *node,
+     uint32_t a,
+     uint32_t b)
+{
+	a = find(node, a);
+	b = find(node, b);
+	if (a == b) {
+		return;
+	}
+	if (b < a) {
+		uint32_t t = a;
+		a = b;
+		b = t;
+	}
+
+	struct node *r = &node[a];
+	struct node *o = &node[b];
+	o->parent = a;
+	r->area += o->area;
+	if (o->left < r->left) {
+		r->left = o->left;
+	}
+	if (o->top < r->top) {
+		r->top = o->top;
+	}
+	if (o->right > r->right) {
+		r->right = o->right;
+	}
+	if (o->bottom > r->bottom) {
+		r->bottom = o->bottom;
+	}
+	r->sx += o->sx;
+	r->sy += o->sy;
+	r->sxx += o->sxx;
+	r->sxy += o->sxy;
+	r->syy += o->syy;
+}
+
+void *
+label_job(void *arg)
+{
+	const struct mg_blobs_job *job = arg;
+
+	mg_blobs_label(job->blobs, job->span, job->num_spans, job->min_area);
+
+	return 0;
+}
+
+void
+start_blob(struct node *node,
+	   uint32_t i,
+	   const struct mg_span *span)
+{
+	/* sums over the columns a to b of one line */
+	uint64_t n = span->length;
+	uint64_t a = span->x;
+	uint64_t b = a + n - 1;
+	uint64_t y = span->y;
+	uint64_t sx = n * a + n * (n - 1) / 2;
+	uint64_t sxx = b * (b + 1) * (2 * b + 1) / 6
+		- (a ? (a - 1) * a * (2 * a - 1) / 6 : 0);
+
+	struct node *p = &node[i];
+	p->parent = i;
+	p->area = n;
+	p->left = a;
+	p->top = y;
+	p->right = b;
+	p->bottom = y;
+	p->sx = sx;
+	p->sy = n * y;
+	p->sxx = sxx;
+	p->sxy = sx * y;
+	p->syy = n * y * y;
+}
+
+#ifdef TEST_MULTI_GEE_MG_BLOBS
+
+static
+bool
+near(double a,
+     double b)
+{
+	return a - b < 1e-4 && b - a < 1e-4;
+}
+
+void
+mg_blobs_test()
+{
+	/*
+	 * 0 ##.#....##
+	 * 1 #..#....##
+	 * 2 ####..#...
+	 * 3 .......#..
+	 */
+	const char *picture[] = {
+		"##.#....##",
+		"#..#....##",
+		"####..#...",
+		".......#..",
+	};
+	uint8_t pixel[4 * 10];
+	for (unsigned int y = 0; y < 4; y++) {
+		for (unsigned int x = 0; x < 10; x++) {
+			pixel[y * 10 + x] = ('#' == picture[y][x]) ? 255 : 0;
+		}
+	}
+	struct mg_image image = {pixel, 10, 4, 10};
+	struct mg_span span[40];
+	unsigned int n = mg_threshold(&image, 128, span, 40, MG_SIMD_SCALAR);
+
+	mg_blobs_t blobs = mg_blobs_create();
+	const struct mg_blob_table *t = mg_blobs_get_table(blobs);
+	XASSERT(t && t->count == 0) {
+		/* empty */
+	}
+
+	/* the U joins on its last line, the diagonal pair touches */
+	XASSERT(3 == mg_blobs_label(blobs, span, n, 1)) {
+		/* empty */
+	}
+	XASSERT(t->area[0] == 9 && t->left[0] == 0 && t->right[0] == 3) {
+		/* empty */
+	}
+	XASSERT(t->top[0] == 0 && t->bottom[0] == 2) {
+		/* empty */
+	}
+	XASSERT(t->area[1] == 4 && near(t->x[1], 8.5) && near(t->y[1], 0.5)) {
+		/* empty */
+	}
+	XASSERT(near(t->xx[1], 0.25) && near(t->xy[1], 0)
+		&& near(t->yy[1], 0.25)) {
+		/* empty */
+	}
+	XASSERT(t->area[2] == 2 && near(t->xy[2], 0.25)) {
+		/* empty */
+	}
+	XASSERT(mg_blobs_get_blob(blobs, 0) == 0
+		&& mg_blobs_get_blob(blobs, 1) == 0
+		&& mg_blobs_get_blob(blobs, 2) == 1
+		&& mg_blobs_get_blob(blobs, n) == -1) {
+		/* empty */
+	}
+
+	/* without corners the diagonal pair falls apart */
+	XASSERT(!mg_blobs_set_connectivity(blobs, 6)) {
+		/* empty */
+	}
+	blobs = mg_blobs_set_connectivity(blobs, 4);
+	XASSERT(4 == mg_blobs_label(blobs, span, n, 1)) {
+		/* empty */
+	}
+
+	/* small blobs are dropped */
+	XASSERT(2 == mg_blobs_label(blobs, span, n, 2)) {
+		/* empty */
+	}
+	XASSERT(t->area[1] == 4 && mg_blobs_get_blob(blobs, n - 1) == -1) {
+		/* empty */
+	}
+
+	/* moments of a filled 5x3 rectangle at (100, 200) */
+	struct mg_span rect[3];
+	for (unsigned int i = 0; i < 3; i++) {
+		rect[i].y = 200 + i;
+		rect[i].x = 100;
+		rect[i].length = 5;
+	}
+	XASSERT(1 == mg_blobs_label(blobs, rect, 3, 1)) {
+		/* empty */
+	}
+	XASSERT(near(t->x[0], 102) && near(t->y[0], 201)) {
+		/* empty */
+	}
+	XASSERT(near(t->xx[0], 2) && near(t->yy[0], 2.0 / 3)
+		&& near(t->xy[0], 0)) {
+		/* empty */
+	}
+
+	/* and from a packed mask */
+	mg_mask_t mask = mg_mask_create(0, 0);
+	XASSERT(mg_threshold_mask(&image, 128, mask, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	blobs = mg_blobs_set_connectivity(blobs, 8);
+	XASSERT(3 == mg_blobs_label_mask(blobs, mask, 1)) {
+		/* empty */
+	}
+	XASSERT(t->area[0] == 9 && t->area[1] == 4 && t->area[2] == 2) {
+		/* empty */
+	}
+	XASSERT(mg_blobs_get_blob(blobs, 2) == 1) {
+		/* empty */
+	}
+	mask = mg_mask_destroy(mask);
+
+	/* the same labelling on several threads */
+	struct mg_blobs_job job[4];
+	for (unsigned int i = 0; i < 4; i++) {
+		job[i].blobs = mg_blobs_create();
+		job[i].span = (i & 1) ? rect : span;
+		job[i].num_spans = (i & 1) ? 3 : n;
+		job[i].min_area = 1;
+	}
+	mg_blobs_label_parallel(job, 4);
+	for (unsigned int i = 0; i < 4; i++) {
+		t = mg_blobs_get_table(job[i].blobs);
+		XASSERT(t->count == ((i & 1) ? 1 : 3)) {
+			/* empty */
+		}
+		job[i].blobs = mg_blobs_destroy(job[i].blobs);
+	}
+
+	blobs = mg_blobs_destroy(blobs);
+	XASSERT(blobs == 0) {
+		/* empty */
+	}
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_blobs_test));
+}
+
+#endif /* TEST_MULTI_GEE_MG_BLOBS */
@@ -0,0 +1,190 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee blob labeller declaration
+ *
+ * The labeller joins the foreground spans of a thresholded image into
+ * connected blobs with a union-find over the spans, without a label
+ * image.  Area, bounding box and moments are gathered while the spans
+ * are joined, so the pixels are never looked at again.  The blobs of an
+ * image end up in a table with one array per quantity, ready for
+ * fitting many blobs at once.
+ */
+#ifndef ITL_MULTI_GEE_MG_BLOBS_H
+#define ITL_MULTI_GEE_MG_BLOBS_H
+
+#include <stdint.h> /* uint32_t */
+
+#include <cclass/classdef.h>
+#include <multi-gee/mg_threshold.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Multi-gee blob labeller object handle
+ */
+NEWHANDLE(mg_blobs_t);
+
+/**
+ * @brief Blob table
+ *
+ * entry i of every array describes blob i.  coordinates are those of
+ * the spans, with pixel centres on whole numbers.  the second moments
+ * are central, divided by the area.  the arrays belong to the labeller
+ * and are reused by the next mg_blobs_label() call.
+ */
+struct mg_blob_table
+{
+	unsigned int count; /**< Number of blobs */
+	uint32_t *area; /**< Number of pixels */
+	uint16_t *left; /**< First column */
+	uint16_t *top; /**< First line */
+	uint16_t *right; /**< Last column */
+	uint16_t *bottom; /**< Last line */
+	float *x; /**< Centroid column */
+	float *y; /**< Centroid line */
+	float *xx; /**< Column variance */
+	float *xy; /**< Covariance */
+	float *yy; /**< Line variance */
+};
+
+/**
+ * @brief Labelling of one image
+ *
+ * see mg_blobs_label_parallel().
+ */
+struct mg_blobs_job
+{
+	mg_blobs_t blobs; /**< Labeller, one per image */
+	const struct mg_span *span; /**< Spans of the image, in raster order */
+	unsigned int num_spans; /**< Number of spans */
+	uint32_t min_area; /**< Smallest blob kept */
+};
+
+/**
+ * @brief Create blob labeller object
+ *
+ * the labeller joins diagonal neighbours, see
+ * mg_blobs_set_connectivity().
+ *
+ * @return a newly created blob labeller object handle
+ */
+mg_blobs_t
+mg_blobs_create();
+
+/**
+ * @brief Destroy blob labeller object
+ *
+ * @param blobs  handle of object to be destroyed
+ *
+ * @return 0
+ */
+mg_blobs_t
+mg_blobs_destroy(mg_blobs_t blobs);
+
+/**
+ * @brief Blob of a span accessor
+ *
+ * @param blobs  object handle
+ * @param span  index of the span in the last labelled span list
+ *
+ * @return the index of the blob the span belongs to, or -1 if the blob
+ * was too small or the span does not exist
+ */
+int
+mg_blobs_get_blob(mg_blobs_t blobs,
+		  unsigned int span);
+
+/**
+ * @brief Blob table accessor
+ *
+ * @param blobs  object handle
+ *
+ * @return the blobs found by the last mg_blobs_label() call, or 0 if
+ * the object handle is not valid
+ */
+const struct mg_blob_table *
+mg_blobs_get_table(mg_blobs_t blobs);
+
+/**
+ * @brief Label the spans of an image
+ *
+ * spans on neighbouring lines that touch are joined into blobs.  blobs
+ * come in raster order of their first span.
+ *
+ * @param blobs  object handle
+ * @param span  spans of the image, in raster order, see mg_threshold()
+ * @param num_spans  number of spans
+ * @param min_area  smallest blob kept, in pixels
+ *
+ * @return the number of blobs kept
+ */
+unsigned int
+mg_blobs_label(mg_blobs_t blobs,
+	       const struct mg_span *span,
+	       unsigned int num_spans,
+	       uint32_t min_area);
+
+/**
+ * @brief Label the pixels of a binary mask
+ *
+ * the mask is turned into spans, see mg_mask_get_spans(), kept by the
+ * labeller, and labelled as mg_blobs_label() does.  span indices given
+ * to mg_blobs_get_blob() are those of the mask's spans.
+ *
+ * @param blobs  object handle
+ * @param mask  binary mask, such as mg_threshold_mask() fills in
+ * @param min_area  smallest blob kept, in pixels
+ *
+ * @return the number of blobs kept
+ */
+unsigned int
+mg_blobs_label_mask(mg_blobs_t blobs,
+		    mg_mask_t mask,
+		    uint32_t min_area);
+
+/**
+ * @brief Label the spans of several images at the same time
+ *
+ * the images of a frameset are independent, each job is run on a
+ * thread of its own.  the call returns when all jobs are done.
+ *
+ * @param job  labelling jobs, each with its own labeller
+ * @param num_jobs  number of jobs
+ */
+void
+mg_blobs_label_parallel(const struct mg_blobs_job *job,
+			unsigned int num_jobs);
+
+/**
+ * @brief Set which neighbours touch
+ *
+ * @param blobs  object handle
+ * @param connectivity  4 to join spans that share an edge, 8 to also
+ * join spans that only share a corner
+ *
+ * @return object handle, or 0 if the connectivity is neither 4 nor 8
+ */
+mg_blobs_t
+mg_blobs_set_connectivity(mg_blobs_t blobs,
+			  unsigned int connectivity);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_BLOBS_H */
@@ -28,9 +28,21 @@ USE_XASSERT
  */
 CLASS(mg_buffer, mg_buffer_t)
 {
-	void **start; /**< Pointer to first byte of buffer memory */
-	size_t *length; /**< Size of buffer memory area */
+	void **start; /**< Pointer to first byte of each plane */
+	size_t *length; /**< Size of each plane memory area */
+	int *dmabuf; /**< Exported DMABUF file descriptor per plane, or -1 */
+	enum mg_buffer_state *state; /**< Where the buffer is */
+	uint32_t *sequence; /**< Sequence number of last frame */
+	struct timeval *timestamp; /**< Time stamp of last frame */
+	struct timeval *since; /**< Time of last state change */
+	struct timeval *hold_time; /**< Time last held */
 	unsigned int number; /**< Number of allocated buffers */
+	unsigned int planes; /**< Memory planes per buffer */
+	unsigned int retiring; /**< Buffers waiting to be retired */
+	unsigned int limit; /**< Most active buffers, 0 if not known */
+	unsigned long dequeued; /**< Number of dequeues */
+	unsigned long enqueued; /**< Number of enqueues */
+	unsigned long lost; /**< Number of failed enqueues */
 };
 
 mg_buffer_t
@@ -41,7 +53,19 @@ mg_buffer_create()
 
 	mg_buffer->start = 0;
 	mg_buffer->length = 0;
+	mg_buffer->dmabuf = 0;
+	mg_buffer->state = 0;
+	mg_buffer->sequence = 0;
+	mg_buffer->timestamp = 0;
+	mg_buffer->since = 0;
+	mg_buffer->hold_time = 0;
 	mg_buffer->number = 0;
+	mg_buffer->planes = 1;
+	mg_buffer->retiring = 0;
+	mg_buffer->limit = 0;
+	mg_buffer->dequeued = 0;
+	mg_buffer->enqueued = 0;
+	mg_buffer->lost = 0;
 
 	return mg_buffer;
 }
@@ -52,6 +76,12 @@ mg_buffer_destroy(mg_buffer_t mg_buffer)
 	VERIFYZ(mg_buffer) {
 		FREEOBJ(mg_buffer->start);
 		FREEOBJ(mg_buffer->length);
+		FREEOBJ(mg_buffer->dmabuf);
+		FREEOBJ(mg_buffer->state);
+		FREEOBJ(mg_buffer->sequence);
+		FREEOBJ(mg_buffer->timestamp);
+		FREEOBJ(mg_buffer->since);
+		FREEOBJ(mg_buffer->hold_time);
 
 		FREEOBJ(mg_buffer);
 	}
@@ -67,9 +97,7 @@ mg_buffer_alloc(mg_buffer_t mg_buffer,
 
 	VERIFY(mg_buffer) {
 		if (!mg_buffer->number) {
-			mg_buffer->start = MALLOC(n * sizeof(mg_buffer->start));
-			mg_buffer->length = MALLOC(n * sizeof(mg_buffer->length));
-			mg_buffer->number = n;
+			p = mg_buffer_grow(mg_buffer, n);
 		}
 		p = mg_buffer;
 	}
@@ -77,18 +105,105 @@ mg_buffer_alloc(mg_buffer_t mg_buffer,
 	return p;
 }
 
+unsigned int
+mg_buffer_get_active(mg_buffer_t mg_buffer)
+{
+	unsigned int active = 0;
+
+	VERIFY(mg_buffer) {
+		for (unsigned int i = 0; i < mg_buffer->number; i++) {
+			if (MG_BUFFER_RETIRED != mg_buffer->state[i])
+				active++;
+		}
+	}
+
+	return active;
+}
+
+unsigned int
+mg_buffer_get_count(mg_buffer_t mg_buffer,
+		    enum mg_buffer_state state)
+{
+	unsigned int count = 0;
+
+	VERIFY(mg_buffer) {
+		for (unsigned int i = 0; i < mg_buffer->number; i++) {
+			if (state == mg_buffer->state[i])
+				count++;
+		}
+	}
+
+	return count;
+}
+
+unsigned long
+mg_buffer_get_dequeued(mg_buffer_t mg_buffer)
+{
+	unsigned long dequeued = 0;
+
+	VERIFY(mg_buffer) {
+		dequeued = mg_buffer->dequeued;
+	}
+
+	return dequeued;
+}
+
+int
+mg_buffer_get_dmabuf(mg_buffer_t mg_buffer,
+		     unsigned int n)
+{
+	return mg_buffer_get_plane_dmabuf(mg_buffer, n, 0);
+}
+
+unsigned long
+mg_buffer_get_enqueued(mg_buffer_t mg_buffer)
+{
+	unsigned long enqueued = 0;
+
+	VERIFY(mg_buffer) {
+		enqueued = mg_buffer->enqueued;
+	}
+
+	return enqueued;
+}
+
+struct timeval
+mg_buffer_get_hold_time(mg_buffer_t mg_buffer,
+			unsigned int n)
+{
+	struct timeval tv = {0, 0};
+
+	VERIFY(mg_buffer) {
+		if (mg_buffer->number > n) {
+			if (MG_BUFFER_HELD == mg_buffer->state[n]) {
+				gettimeofday(&tv, 0);
+				timersub(&tv, &mg_buffer->since[n], &tv);
+			} else {
+				tv = mg_buffer->hold_time[n];
+			}
+		}
+	}
+
+	return tv;
+}
+
 size_t
 mg_buffer_get_length(mg_buffer_t mg_buffer,
 		 unsigned int n)
 {
-	size_t s = 0;
+	return mg_buffer_get_plane_length(mg_buffer, n, 0);
+}
+
+unsigned int
+mg_buffer_get_limit(mg_buffer_t mg_buffer)
+{
+	unsigned int limit = 0;
 
 	VERIFY(mg_buffer) {
-		if (mg_buffer->number > n)
-			s = mg_buffer->length[n];
+		limit = mg_buffer->limit;
 	}
 
-	return s;
+	return limit;
 }
 
 unsigned int
@@ -103,15 +218,208 @@ mg_buffer_get_number(mg_buffer_t mg_buffer)
 	return number;
 }
 
+unsigned long
+mg_buffer_get_lost(mg_buffer_t mg_buffer)
+{
+	unsigned long lost = 0;
+
+	VERIFY(mg_buffer) {
+		lost = mg_buffer->lost;
+	}
+
+	return lost;
+}
+
+int
+mg_buffer_get_plane_dmabuf(mg_buffer_t mg_buffer,
+			   unsigned int n,
+			   unsigned int plane)
+{
+	int fd = -1;
+
+	VERIFY(mg_buffer) {
+		if (mg_buffer->number > n && MG_MAX_PLANES > plane)
+			fd = mg_buffer->dmabuf[n * MG_MAX_PLANES + plane];
+	}
+
+	return fd;
+}
+
+size_t
+mg_buffer_get_plane_length(mg_buffer_t mg_buffer,
+			   unsigned int n,
+			   unsigned int plane)
+{
+	size_t s = 0;
+
+	VERIFY(mg_buffer) {
+		if (mg_buffer->number > n && MG_MAX_PLANES > plane)
+			s = mg_buffer->length[n * MG_MAX_PLANES + plane];
+	}
+
+	return s;
+}
+
+void *
+mg_buffer_get_plane_start(mg_buffer_t mg_buffer,
+			  unsigned int n,
+			  unsigned int plane)
+{
+	void *p = 0;
+
+	VERIFY(mg_buffer) {
+		if (mg_buffer->number > n && MG_MAX_PLANES > plane)
+			p = mg_buffer->start[n * MG_MAX_PLANES + plane];
+	}
+
+	return p;
+}
+
+unsigned int
+mg_buffer_get_planes(mg_buffer_t mg_buffer)
+{
+	unsigned int planes = 0;
+
+	VERIFY(mg_buffer) {
+		planes = mg_buffer->planes;
+	}
+
+	return planes;
+}
+
+unsigned int
+mg_buffer_get_retiring(mg_buffer_t mg_buffer)
+{
+	unsigned int retiring = 0;
+
+	VERIFY(mg_buffer) {
+		retiring = mg_buffer->retiring;
+	}
+
+	return retiring;
+}
+
+uint32_t
+mg_buffer_get_sequence(mg_buffer_t mg_buffer,
+		       unsigned int n)
+{
+	uint32_t sequence = 0;
+
+	VERIFY(mg_buffer) {
+		if (mg_buffer->number > n)
+			sequence = mg_buffer->sequence[n];
+	}
+
+	return sequence;
+}
+
 void *
 mg_buffer_get_start(mg_buffer_t mg_buffer,
 		unsigned int n)
 {
-	void *p = 0;
+	return mg_buffer_get_plane_start(mg_buffer, n, 0);
+}
+
+enum mg_buffer_state
+mg_buffer_get_state(mg_buffer_t mg_buffer,
+		    unsigned int n)
+{
+	enum mg_buffer_state state = MG_BUFFER_IDLE;
+
+	VERIFY(mg_buffer) {
+		if (mg_buffer->number > n)
+			state = mg_buffer->state[n];
+	}
+
+	return state;
+}
+
+struct timeval
+mg_buffer_get_timestamp(mg_buffer_t mg_buffer,
+			unsigned int n)
+{
+	struct timeval tv = {0, 0};
 
 	VERIFY(mg_buffer) {
 		if (mg_buffer->number > n)
-			p = mg_buffer->start[n];
+			tv = mg_buffer->timestamp[n];
+	}
+
+	return tv;
+}
+
+mg_buffer_t
+mg_buffer_grow(mg_buffer_t mg_buffer,
+	       unsigned int n)
+{
+	mg_buffer_t p = 0;
+
+	VERIFY(mg_buffer) {
+		if (n > mg_buffer->number) {
+			unsigned int slots = n * MG_MAX_PLANES;
+			void **start = MALLOC(slots * sizeof(*start));
+			size_t *length = MALLOC(slots * sizeof(*length));
+			int *dmabuf = MALLOC(slots * sizeof(*dmabuf));
+			enum mg_buffer_state *state =
+				MALLOC(n * sizeof(*state));
+			uint32_t *sequence = MALLOC(n * sizeof(*sequence));
+			struct timeval *timestamp =
+				MALLOC(n * sizeof(*timestamp));
+			struct timeval *since = MALLOC(n * sizeof(*since));
+			struct timeval *hold_time =
+				MALLOC(n * sizeof(*hold_time));
+
+			struct timeval now;
+			gettimeofday(&now, 0);
+
+			for (unsigned int i = 0; i < slots; i++) {
+				if (i < mg_buffer->number * MG_MAX_PLANES) {
+					start[i] = mg_buffer->start[i];
+					length[i] = mg_buffer->length[i];
+					dmabuf[i] = mg_buffer->dmabuf[i];
+				} else {
+					start[i] = 0;
+					length[i] = 0;
+					dmabuf[i] = -1;
+				}
+			}
+
+			for (unsigned int i = 0; i < n; i++) {
+				if (i < mg_buffer->number) {
+					state[i] = mg_buffer->state[i];
+					sequence[i] = mg_buffer->sequence[i];
+					timestamp[i] = mg_buffer->timestamp[i];
+					since[i] = mg_buffer->since[i];
+					hold_time[i] = mg_buffer->hold_time[i];
+				} else {
+					state[i] = MG_BUFFER_IDLE;
+					sequence[i] = 0;
+					timerclear(&timestamp[i]);
+					since[i] = now;
+					timerclear(&hold_time[i]);
+				}
+			}
+
+			FREEOBJ(mg_buffer->start);
+			FREEOBJ(mg_buffer->length);
+			FREEOBJ(mg_buffer->dmabuf);
+			FREEOBJ(mg_buffer->state);
+			FREEOBJ(mg_buffer->sequence);
+			FREEOBJ(mg_buffer->timestamp);
+			FREEOBJ(mg_buffer->since);
+			FREEOBJ(mg_buffer->hold_time);
+
+			mg_buffer->start = start;
+			mg_buffer->length = length;
+			mg_buffer->dmabuf = dmabuf;
+			mg_buffer->state = state;
+			mg_buffer->sequence = sequence;
+			mg_buffer->timestamp = timestamp;
+			mg_buffer->since = since;
+			mg_buffer->hold_time = hold_time;
+			mg_buffer->number = n;
+		}
+		p = mg_buffer;
 	}
 
 	return p;
@@ -122,15 +430,156 @@ mg_buffer_set(mg_buffer_t mg_buffer,
 	      unsigned int n,
 	      void *start,
 	      size_t length)
+{
+	return mg_buffer_set_plane(mg_buffer, n, 0, start, length);
+}
+
+mg_buffer_t
+mg_buffer_set_dmabuf(mg_buffer_t mg_buffer,
+		     unsigned int n,
+		     int fd)
+{
+	return mg_buffer_set_plane_dmabuf(mg_buffer, n, 0, fd);
+}
+
+mg_buffer_t
+mg_buffer_set_frame(mg_buffer_t mg_buffer,
+		    unsigned int n,
+		    uint32_t sequence,
+		    struct timeval timestamp)
+{
+	mg_buffer_t p = 0;
+
+	VERIFY(mg_buffer) {
+		if (mg_buffer->number > n) {
+			mg_buffer->sequence[n] = sequence;
+			mg_buffer->timestamp[n] = timestamp;
+		}
+		p = mg_buffer;
+	}
+
+	return p;
+}
+
+mg_buffer_t
+mg_buffer_set_limit(mg_buffer_t mg_buffer,
+		    unsigned int limit)
 {
 	mg_buffer_t p = 0;
 
 	VERIFY(mg_buffer) {
+		mg_buffer->limit = limit;
+		p = mg_buffer;
+	}
+
+	return p;
+}
+
+mg_buffer_t
+mg_buffer_set_plane(mg_buffer_t mg_buffer,
+		    unsigned int n,
+		    unsigned int plane,
+		    void *start,
+		    size_t length)
+{
+	mg_buffer_t p = 0;
+
+	VERIFY(mg_buffer) {
+		unsigned int i = n * MG_MAX_PLANES + plane;
 		if (mg_buffer->number > n
-		    && mg_buffer->start[n] == 0
-		    && mg_buffer->length[n] == 0) {
-			mg_buffer->start[n] = start;
-			mg_buffer->length[n] = length;
+		    && MG_MAX_PLANES > plane
+		    && mg_buffer->start[i] == 0
+		    && mg_buffer->length[i] == 0) {
+			mg_buffer->start[i] = start;
+			mg_buffer->length[i] = length;
+		}
+		p = mg_buffer;
+	}
+
+	return p;
+}
+
+mg_buffer_t
+mg_buffer_set_plane_dmabuf(mg_buffer_t mg_buffer,
+			   unsigned int n,
+			   unsigned int plane,
+			   int fd)
+{
+	mg_buffer_t p = 0;
+
+	VERIFY(mg_buffer) {
+		if (mg_buffer->number > n && MG_MAX_PLANES > plane) {
+			mg_buffer->dmabuf[n * MG_MAX_PLANES + plane] = fd;
+		}
+		p = mg_buffer;
+	}
+
+	return p;
+}
+
+mg_buffer_t
+mg_buffer_set_planes(mg_buffer_t mg_buffer,
+		     unsigned int planes)
+{
+	mg_buffer_t p = 0;
+
+	VERIFY(mg_buffer) {
+		if (0 < planes && MG_MAX_PLANES >= planes) {
+			mg_buffer->planes = planes;
+			p = mg_buffer;
+		}
+	}
+
+	return p;
+}
+
+mg_buffer_t
+mg_buffer_set_retiring(mg_buffer_t mg_buffer,
+		       unsigned int n)
+{
+	mg_buffer_t p = 0;
+
+	VERIFY(mg_buffer) {
+		mg_buffer->retiring = n;
+		p = mg_buffer;
+	}
+
+	return p;
+}
+
+mg_buffer_t
+mg_buffer_set_state(mg_buffer_t mg_buffer,
+		    unsigned int n,
+		    enum mg_buffer_state state)
+{
+	mg_buffer_t p = 0;
+
+	VERIFY(mg_buffer) {
+		if (mg_buffer->number > n) {
+			struct timeval now;
+			gettimeofday(&now, 0);
+
+			if (MG_BUFFER_HELD == mg_buffer->state[n]) {
+				timersub(&now, &mg_buffer->since[n],
+					 &mg_buffer->hold_time[n]);
+			}
+
+			switch (state) {
+			case MG_BUFFER_QUEUED:
+				mg_buffer->enqueued++;
+				break;
+			case MG_BUFFER_HELD:
+				mg_buffer->dequeued++;
+				break;
+			case MG_BUFFER_LOST:
+				mg_buffer->lost++;
+				break;
+			default:
+				break;
+			}
+
+			mg_buffer->state[n] = state;
+			mg_buffer->since[n] = now;
 		}
 		p = mg_buffer;
 	}
@@ -194,6 +643,152 @@ test_buffer(void *start_0,
 	buffer = mg_buffer_set(buffer, 1, start_0, length_0);
 	verify_buffer(buffer, 1, 2, start_1, length_1);
 
+	/* no limit until the driver refuses more buffers */
+	XASSERT(mg_buffer_get_limit(buffer) == 0) {
+		/* empty */
+	}
+	buffer = mg_buffer_set_limit(buffer, 4);
+	XASSERT(mg_buffer_get_limit(buffer) == 4) {
+		/* empty */
+	}
+
+	/* buffers are not exported until told otherwise */
+	XASSERT(mg_buffer_get_dmabuf(buffer, 0) == -1) {
+		/* empty */
+	}
+	buffer = mg_buffer_set_dmabuf(buffer, 1, 7);
+	buffer = mg_buffer_set_dmabuf(buffer, 2, 8);
+	XASSERT(mg_buffer_get_dmabuf(buffer, 0) == -1) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_dmabuf(buffer, 1) == 7) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_dmabuf(buffer, 2) == -1) {
+		/* empty */
+	}
+
+	/* grow, keeping the existing buffers */
+	buffer = mg_buffer_grow(buffer, 3);
+	verify_buffer(buffer, 0, 3, start_0, length_0);
+	verify_buffer(buffer, 1, 3, start_1, length_1);
+	verify_buffer(buffer, 2, 3, 0, 0);
+	XASSERT(mg_buffer_get_dmabuf(buffer, 1) == 7) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_dmabuf(buffer, 2) == -1) {
+		/* empty */
+	}
+	buffer = mg_buffer_grow(buffer, 1);
+	verify_buffer(buffer, 2, 3, 0, 0);
+
+	/* the single-plane accessors see the first plane */
+	XASSERT(mg_buffer_get_planes(buffer) == 1) {
+		/* empty */
+	}
+	XASSERT(!mg_buffer_set_planes(buffer, MG_MAX_PLANES + 1)) {
+		/* empty */
+	}
+	buffer = mg_buffer_set_planes(buffer, 2);
+	XASSERT(mg_buffer_get_planes(buffer) == 2) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_plane_start(buffer, 1, 0) == start_1) {
+		/* empty */
+	}
+	buffer = mg_buffer_set_plane(buffer, 1, 1, start_0, length_0);
+	buffer = mg_buffer_set_plane(buffer, 1, MG_MAX_PLANES, start_0, 1);
+	buffer = mg_buffer_set_plane_dmabuf(buffer, 1, 1, 9);
+	verify_buffer(buffer, 1, 3, start_1, length_1);
+	XASSERT(mg_buffer_get_plane_start(buffer, 1, 1) == start_0) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_plane_length(buffer, 1, 1) == length_0) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_plane_length(buffer, 1, MG_MAX_PLANES) == 0) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_plane_dmabuf(buffer, 1, 1) == 9) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_dmabuf(buffer, 1) == 7) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_plane_dmabuf(buffer, 2, 1) == -1) {
+		/* empty */
+	}
+
+	/* retire and revive a buffer */
+	XASSERT(mg_buffer_get_active(buffer) == 3) {
+		/* empty */
+	}
+	buffer = mg_buffer_set_state(buffer, 1, MG_BUFFER_RETIRED);
+	XASSERT(mg_buffer_get_state(buffer, 1) == MG_BUFFER_RETIRED) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_active(buffer) == 2) {
+		/* empty */
+	}
+	buffer = mg_buffer_set_state(buffer, 1, MG_BUFFER_IDLE);
+	XASSERT(mg_buffer_get_active(buffer) == 3) {
+		/* empty */
+	}
+
+	/* follow a buffer through the driver and the frame list */
+	XASSERT(mg_buffer_get_count(buffer, MG_BUFFER_IDLE) == 3) {
+		/* empty */
+	}
+	buffer = mg_buffer_set_state(buffer, 0, MG_BUFFER_QUEUED);
+	buffer = mg_buffer_set_state(buffer, 1, MG_BUFFER_QUEUED);
+	buffer = mg_buffer_set_state(buffer, 0, MG_BUFFER_HELD);
+	struct timeval tv = {12, 34};
+	buffer = mg_buffer_set_frame(buffer, 0, 56, tv);
+	XASSERT(mg_buffer_get_count(buffer, MG_BUFFER_QUEUED) == 1) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_count(buffer, MG_BUFFER_HELD) == 1) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_sequence(buffer, 0) == 56) {
+		/* empty */
+	}
+	tv = mg_buffer_get_timestamp(buffer, 0);
+	XASSERT(tv.tv_sec == 12 && tv.tv_usec == 34) {
+		/* empty */
+	}
+	tv = mg_buffer_get_hold_time(buffer, 0);
+	XASSERT(0 <= tv.tv_sec) {
+		/* empty */
+	}
+
+	/* a failed enqueue loses the buffer */
+	buffer = mg_buffer_set_state(buffer, 0, MG_BUFFER_LOST);
+	XASSERT(mg_buffer_get_count(buffer, MG_BUFFER_LOST) == 1) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_enqueued(buffer) == 2) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_dequeued(buffer) == 1) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_lost(buffer) == 1) {
+		/* empty */
+	}
+
+	/* state survives growing */
+	buffer = mg_buffer_grow(buffer, 4);
+	XASSERT(mg_buffer_get_state(buffer, 0) == MG_BUFFER_LOST) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_state(buffer, 3) == MG_BUFFER_IDLE) {
+		/* empty */
+	}
+	XASSERT(mg_buffer_get_sequence(buffer, 0) == 56) {
+		/* empty */
+	}
+
 	/* destroy */
 	buffer = mg_buffer_destroy(buffer);
 	XASSERT(buffer == 0) {
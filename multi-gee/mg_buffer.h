@@ -22,7 +22,12 @@
 #ifndef ITL_MULTI_GEE_MG_BUFFER_H
 #define ITL_MULTI_GEE_MG_BUFFER_H
 
+#include <stdbool.h> /* bool */
+#include <stdint.h> /* uint32_t */
+#include <sys/time.h> /* struct timeval */
+
 #include <cclass/classdef.h>
+#include <multi-gee/mg_image.h>
 
 __BEGIN_DECLS
 
@@ -31,6 +36,18 @@ __BEGIN_DECLS
  */
 NEWHANDLE(mg_buffer_t);
 
+/**
+ * @brief Capture buffer state
+ */
+enum mg_buffer_state
+{
+	MG_BUFFER_IDLE, /**< mapped, but neither queued nor held */
+	MG_BUFFER_QUEUED, /**< queued to the driver */
+	MG_BUFFER_HELD, /**< dequeued and held by the frame list */
+	MG_BUFFER_RETIRED, /**< taken out of circulation */
+	MG_BUFFER_LOST /**< failed to queue, nobody owns it */
+};
+
 /**
  * @brief Create buffer object
  *
@@ -61,6 +78,73 @@ mg_buffer_t
 mg_buffer_alloc(mg_buffer_t buffer,
 		unsigned int n);
 
+/**
+ * @brief Number of buffers in circulation
+ *
+ * @param buffer  object handle
+ *
+ * @return the number of buffers that are not retired
+ */
+unsigned int
+mg_buffer_get_active(mg_buffer_t buffer);
+
+/**
+ * @brief Number of buffers in a state
+ *
+ * @param buffer  object handle
+ * @param state  buffer state to count
+ *
+ * @return the number of buffers in the given state
+ */
+unsigned int
+mg_buffer_get_count(mg_buffer_t buffer,
+		    enum mg_buffer_state state);
+
+/**
+ * @brief Number of buffers dequeued accessor
+ *
+ * @param buffer  object handle
+ *
+ * @return the number of times a buffer was dequeued from the driver
+ */
+unsigned long
+mg_buffer_get_dequeued(mg_buffer_t buffer);
+
+/**
+ * @brief Exported DMABUF file descriptor accessor
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ *
+ * @return DMABUF file descriptor, or -1 if the buffer was not exported
+ */
+int
+mg_buffer_get_dmabuf(mg_buffer_t buffer,
+		     unsigned int index);
+
+/**
+ * @brief Number of buffers enqueued accessor
+ *
+ * @param buffer  object handle
+ *
+ * @return the number of times a buffer was queued to the driver
+ */
+unsigned long
+mg_buffer_get_enqueued(mg_buffer_t buffer);
+
+/**
+ * @brief Buffer hold time accessor
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ *
+ * @return the time the buffer has been held so far if it is held, else
+ * the time it was held the last time
+ */
+struct timeval
+mg_buffer_get_hold_time(mg_buffer_t buffer,
+			unsigned int index);
+
 /**
  * @brief Buffer length accessor
  *
@@ -73,6 +157,16 @@ size_t
 mg_buffer_get_length(mg_buffer_t buffer,
 		     unsigned int index);
 
+/**
+ * @brief Active buffer limit accessor
+ *
+ * @param buffer  object handle
+ *
+ * @return the most buffers the driver can have, 0 if not known
+ */
+unsigned int
+mg_buffer_get_limit(mg_buffer_t buffer);
+
 /**
  * @brief Number of buffers accessor
  *
@@ -83,6 +177,93 @@ mg_buffer_get_length(mg_buffer_t buffer,
 unsigned int
 mg_buffer_get_number(mg_buffer_t buffer);
 
+/**
+ * @brief Number of buffers lost accessor
+ *
+ * @param buffer  object handle
+ *
+ * @return the number of times a buffer failed to be queued
+ */
+unsigned long
+mg_buffer_get_lost(mg_buffer_t buffer);
+
+/**
+ * @brief Plane DMABUF file descriptor accessor
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ * @param plane  plane index
+ *
+ * @return DMABUF file descriptor, or -1 if the plane was not exported
+ */
+int
+mg_buffer_get_plane_dmabuf(mg_buffer_t buffer,
+			   unsigned int index,
+			   unsigned int plane);
+
+/**
+ * @brief Plane length accessor
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ * @param plane  plane index
+ *
+ * @return length of the plane, 0 if the plane is not mapped
+ */
+size_t
+mg_buffer_get_plane_length(mg_buffer_t buffer,
+			   unsigned int index,
+			   unsigned int plane);
+
+/**
+ * @brief Plane start address accessor
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ * @param plane  plane index
+ *
+ * @return plane start pointer, 0 if the plane is not mapped
+ */
+void *
+mg_buffer_get_plane_start(mg_buffer_t buffer,
+			  unsigned int index,
+			  unsigned int plane);
+
+/**
+ * @brief Number of memory planes accessor
+ *
+ * @param buffer  object handle
+ *
+ * @return the number of memory planes per buffer, 1 unless the device
+ * uses the multi-planar API
+ */
+unsigned int
+mg_buffer_get_planes(mg_buffer_t buffer);
+
+/**
+ * @brief Number of buffers waiting to be retired
+ *
+ * @param buffer  object handle
+ *
+ * @return the number of buffers to retire as they are returned by the
+ * user
+ */
+unsigned int
+mg_buffer_get_retiring(mg_buffer_t buffer);
+
+/**
+ * @brief Sequence number of last frame accessor
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ *
+ * @return the sequence number of the last frame captured into the
+ * buffer
+ */
+uint32_t
+mg_buffer_get_sequence(mg_buffer_t buffer,
+		       unsigned int index);
+
 /**
  * @brief Buffer start address accessor
  *
@@ -95,9 +276,50 @@ void *
 mg_buffer_get_start(mg_buffer_t buffer,
 		    unsigned int index);
 
+/**
+ * @brief Buffer state accessor
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ *
+ * @return buffer state
+ */
+enum mg_buffer_state
+mg_buffer_get_state(mg_buffer_t buffer,
+		    unsigned int index);
+
+/**
+ * @brief Time stamp of last frame accessor
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ *
+ * @return the time stamp of the last frame captured into the buffer
+ */
+struct timeval
+mg_buffer_get_timestamp(mg_buffer_t buffer,
+			unsigned int index);
+
+/**
+ * @brief Grow the number of buffers
+ *
+ * new buffers have no start address or length yet.  the number of
+ * buffers never shrinks.
+ *
+ * @param buffer  object handle
+ * @param n  new number of buffers
+ *
+ * @return object handled
+ */
+mg_buffer_t
+mg_buffer_grow(mg_buffer_t buffer,
+	       unsigned int n);
+
 /**
  * @brief Set the start address and length of a buffer
  *
+ * sets the first plane, see mg_buffer_set_plane().
+ *
  * @param buffer  object handle
  * @param index  buffer index
  * @param start  buffer start pointer
@@ -111,6 +333,135 @@ mg_buffer_set(mg_buffer_t buffer,
 	      void *start,
 	      size_t length);
 
+/**
+ * @brief Set the exported DMABUF file descriptor of a buffer
+ *
+ * the buffer object does not take ownership of the file descriptor; it
+ * is closed by the frame grabber utility when the device is
+ * uninitialised.
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ * @param fd  DMABUF file descriptor
+ *
+ * @return object handled
+ */
+mg_buffer_t
+mg_buffer_set_dmabuf(mg_buffer_t buffer,
+		     unsigned int index,
+		     int fd);
+
+/**
+ * @brief Record the frame captured into a buffer
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ * @param sequence  frame sequence number
+ * @param timestamp  frame time stamp
+ *
+ * @return object handled
+ */
+mg_buffer_t
+mg_buffer_set_frame(mg_buffer_t buffer,
+		    unsigned int index,
+		    uint32_t sequence,
+		    struct timeval timestamp);
+
+/**
+ * @brief Set the active buffer limit
+ *
+ * set when the driver fails to add buffers, so that it is not asked
+ * again on every frameset.
+ *
+ * @param buffer  object handle
+ * @param limit  most buffers the driver can have, 0 if not known
+ *
+ * @return object handle
+ */
+mg_buffer_t
+mg_buffer_set_limit(mg_buffer_t buffer,
+		    unsigned int limit);
+
+/**
+ * @brief Set the start address and length of a buffer plane
+ *
+ * a plane that already has a start address or length is left alone.
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ * @param plane  plane index, less than MG_MAX_PLANES
+ * @param start  plane start pointer
+ * @param length  size of plane, in bytes
+ *
+ * @return object handled
+ */
+mg_buffer_t
+mg_buffer_set_plane(mg_buffer_t buffer,
+		    unsigned int index,
+		    unsigned int plane,
+		    void *start,
+		    size_t length);
+
+/**
+ * @brief Set the exported DMABUF file descriptor of a buffer plane
+ *
+ * see mg_buffer_set_dmabuf() for the ownership of the descriptor.
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ * @param plane  plane index, less than MG_MAX_PLANES
+ * @param fd  DMABUF file descriptor
+ *
+ * @return object handled
+ */
+mg_buffer_t
+mg_buffer_set_plane_dmabuf(mg_buffer_t buffer,
+			   unsigned int index,
+			   unsigned int plane,
+			   int fd);
+
+/**
+ * @brief Set the number of memory planes per buffer
+ *
+ * @param buffer  object handle
+ * @param planes  number of planes, 1 to MG_MAX_PLANES
+ *
+ * @return object handle, or 0 if the number is out of range
+ */
+mg_buffer_t
+mg_buffer_set_planes(mg_buffer_t buffer,
+		     unsigned int planes);
+
+/**
+ * @brief Set the number of buffers waiting to be retired
+ *
+ * @param buffer  object handle
+ * @param n  number of buffers to retire as they are returned by the
+ * user
+ *
+ * @return object handled
+ */
+mg_buffer_t
+mg_buffer_set_retiring(mg_buffer_t buffer,
+		       unsigned int n);
+
+/**
+ * @brief Change the state of a buffer
+ *
+ * updates the counters, and the hold time when a buffer stops being
+ * held.
+ *
+ * @param buffer  object handle
+ * @param index  buffer index
+ * @param state  new buffer state
+ *
+ * @return object handled
+ */
+mg_buffer_t
+mg_buffer_set_state(mg_buffer_t buffer,
+		    unsigned int index,
+		    enum mg_buffer_state state);
+
 __END_DECLS
 
 #endif /* ITL_MULTI_GEE_MG_BUFFER_H */
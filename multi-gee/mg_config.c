@@ -0,0 +1,464 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee capture configuration definition
+ */
+#include <stdlib.h> /* struct timeval, needed for videodev2.h */
+#include <asm/types.h> /* needed for videodev2.h */
+#include <linux/videodev2.h>
+
+#include "mg_config.h" /* class implemented */
+#include "mg_convert.h" /* MG_PYRAMID_LEVELS */
+
+USE_XASSERT
+
+/**
+ * @brief Maximum number of accepted pixel formats
+ */
+#define MAX_PIXELFORMATS 16
+
+/**
+ * @brief Configuration object structure
+ */
+CLASS(mg_config, mg_config_t)
+{
+	uint32_t width; /**< Requested image width */
+	uint32_t height; /**< Requested image height */
+	uint32_t field; /**< Requested field order */
+	uint64_t standard; /**< Video standard, or 0 */
+	int input; /**< Video input, or -1 */
+	uint32_t pixelformat[MAX_PIXELFORMATS]; /**< Accepted formats */
+	unsigned int num_pixelformats; /**< Number of accepted formats */
+	unsigned int pyramid; /**< Image pyramid levels */
+	unsigned int stats; /**< Image statistics line step, or 0 */
+	unsigned int sweep; /**< Full frame sweep interval */
+};
+
+mg_config_t
+mg_config_create()
+{
+	mg_config_t mg_config;
+	NEWOBJ(mg_config);
+
+	mg_config->width = 768;
+	mg_config->height = 576;
+	mg_config->field = V4L2_FIELD_INTERLACED;
+	mg_config->standard = V4L2_STD_PAL;
+	mg_config->input = 0;
+	mg_config->num_pixelformats = 0;
+	mg_config->pyramid = 0;
+	mg_config->stats = 0;
+	mg_config->sweep = 25;
+
+	return mg_config;
+}
+
+mg_config_t
+mg_config_destroy(mg_config_t mg_config)
+{
+	VERIFYZ(mg_config) {
+		FREEOBJ(mg_config);
+	}
+
+	return 0;
+}
+
+mg_config_t
+mg_config_add_pixelformat(mg_config_t mg_config,
+			  uint32_t pixelformat)
+{
+	mg_config_t p = 0;
+
+	VERIFY(mg_config) {
+		if (mg_config->num_pixelformats < MAX_PIXELFORMATS) {
+			mg_config->pixelformat[mg_config->num_pixelformats++] =
+				pixelformat;
+		}
+		p = mg_config;
+	}
+
+	return p;
+}
+
+mg_config_t
+mg_config_copy(mg_config_t mg_config)
+{
+	mg_config_t p = 0;
+
+	VERIFY(mg_config) {
+		p = mg_config_create();
+		p->width = mg_config->width;
+		p->height = mg_config->height;
+		p->field = mg_config->field;
+		p->standard = mg_config->standard;
+		p->input = mg_config->input;
+		for (unsigned int i = 0; i < mg_config->num_pixelformats; i++) {
+			p->pixelformat[i] = mg_config->pixelformat[i];
+		}
+		p->num_pixelformats = mg_config->num_pixelformats;
+		p->pyramid = mg_config->pyramid;
+		p->stats = mg_config->stats;
+		p->sweep = mg_config->sweep;
+	}
+
+	return p;
+}
+
+uint32_t
+mg_config_get_field(mg_config_t mg_config)
+{
+	uint32_t field = V4L2_FIELD_ANY;
+
+	VERIFY(mg_config) {
+		field = mg_config->field;
+	}
+
+	return field;
+}
+
+uint32_t
+mg_config_get_height(mg_config_t mg_config)
+{
+	uint32_t height = 0;
+
+	VERIFY(mg_config) {
+		height = mg_config->height;
+	}
+
+	return height;
+}
+
+int
+mg_config_get_input(mg_config_t mg_config)
+{
+	int input = -1;
+
+	VERIFY(mg_config) {
+		input = mg_config->input;
+	}
+
+	return input;
+}
+
+unsigned int
+mg_config_get_num_pixelformats(mg_config_t mg_config)
+{
+	unsigned int n = 0;
+
+	VERIFY(mg_config) {
+		n = mg_config->num_pixelformats;
+		if (!n)
+			n = 1;
+	}
+
+	return n;
+}
+
+uint32_t
+mg_config_get_pixelformat(mg_config_t mg_config,
+			  unsigned int n)
+{
+	uint32_t pixelformat = 0;
+
+	VERIFY(mg_config) {
+		if (!mg_config->num_pixelformats) {
+			if (0 == n)
+				pixelformat = V4L2_PIX_FMT_GREY;
+		} else if (mg_config->num_pixelformats > n) {
+			pixelformat = mg_config->pixelformat[n];
+		}
+	}
+
+	return pixelformat;
+}
+
+unsigned int
+mg_config_get_pyramid(mg_config_t mg_config)
+{
+	unsigned int pyramid = 0;
+
+	VERIFY(mg_config) {
+		pyramid = mg_config->pyramid;
+	}
+
+	return pyramid;
+}
+
+uint64_t
+mg_config_get_standard(mg_config_t mg_config)
+{
+	uint64_t standard = 0;
+
+	VERIFY(mg_config) {
+		standard = mg_config->standard;
+	}
+
+	return standard;
+}
+
+unsigned int
+mg_config_get_stats(mg_config_t mg_config)
+{
+	unsigned int stats = 0;
+
+	VERIFY(mg_config) {
+		stats = mg_config->stats;
+	}
+
+	return stats;
+}
+
+unsigned int
+mg_config_get_sweep(mg_config_t mg_config)
+{
+	unsigned int sweep = 0;
+
+	VERIFY(mg_config) {
+		sweep = mg_config->sweep;
+	}
+
+	return sweep;
+}
+
+uint32_t
+mg_config_get_width(mg_config_t mg_config)
+{
+	uint32_t width = 0;
+
+	VERIFY(mg_config) {
+		width = mg_config->width;
+	}
+
+	return width;
+}
+
+mg_config_t
+mg_config_set_field(mg_config_t mg_config,
+		    uint32_t field)
+{
+	mg_config_t p = 0;
+
+	VERIFY(mg_config) {
+		mg_config->field = field;
+		p = mg_config;
+	}
+
+	return p;
+}
+
+mg_config_t
+mg_config_set_input(mg_config_t mg_config,
+		    int input)
+{
+	mg_config_t p = 0;
+
+	VERIFY(mg_config) {
+		mg_config->input = input;
+		p = mg_config;
+	}
+
+	return p;
+}
+
+mg_config_t
+mg_config_set_pyramid(mg_config_t mg_config,
+		      unsigned int levels)
+{
+	mg_config_t p = 0;
+
+	VERIFY(mg_config) {
+		if (levels <= MG_PYRAMID_LEVELS) {
+			mg_config->pyramid = levels;
+			p = mg_config;
+		}
+	}
+
+	return p;
+}
+
+mg_config_t
+mg_config_set_size(mg_config_t mg_config,
+		   uint32_t width,
+		   uint32_t height)
+{
+	mg_config_t p = 0;
+
+	VERIFY(mg_config) {
+		mg_config->width = width;
+		mg_config->height = height;
+		p = mg_config;
+	}
+
+	return p;
+}
+
+mg_config_t
+mg_config_set_standard(mg_config_t mg_config,
+		       uint64_t standard)
+{
+	mg_config_t p = 0;
+
+	VERIFY(mg_config) {
+		mg_config->standard = standard;
+		p = mg_config;
+	}
+
+	return p;
+}
+
+mg_config_t
+mg_config_set_stats(mg_config_t mg_config,
+		    unsigned int step)
+{
+	mg_config_t p = 0;
+
+	VERIFY(mg_config) {
+		mg_config->stats = step;
+		p = mg_config;
+	}
+
+	return p;
+}
+
+mg_config_t
+mg_config_set_sweep(mg_config_t mg_config,
+		    unsigned int interval)
+{
+	mg_config_t p = 0;
+
+	VERIFY(mg_config) {
+		mg_config->sweep = interval;
+		p = mg_config;
+	}
+
+	return p;
+}
+
+#ifdef TEST_MULTI_GEE_MG_CONFIG
+
+#include <stdlib.h>
+#include <stdio.h>
+
+void
+mg_config()
+{
+	/* create, with the defaults */
+	mg_config_t config = mg_config_create();
+	XASSERT(mg_config_get_width(config) == 768) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_height(config) == 576) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_field(config) == V4L2_FIELD_INTERLACED) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_standard(config) == V4L2_STD_PAL) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_input(config) == 0) {
+		/* empty */
+	}
+
+	/* grey is accepted until told otherwise */
+	XASSERT(mg_config_get_num_pixelformats(config) == 1) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_pixelformat(config, 0) == V4L2_PIX_FMT_GREY) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_pixelformat(config, 1) == 0) {
+		/* empty */
+	}
+
+	config = mg_config_add_pixelformat(config, V4L2_PIX_FMT_YUYV);
+	config = mg_config_add_pixelformat(config, V4L2_PIX_FMT_SBGGR8);
+	XASSERT(mg_config_get_num_pixelformats(config) == 2) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_pixelformat(config, 0) == V4L2_PIX_FMT_YUYV) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_pixelformat(config, 1) == V4L2_PIX_FMT_SBGGR8) {
+		/* empty */
+	}
+
+	/* a USB camera */
+	config = mg_config_set_size(config, 640, 480);
+	config = mg_config_set_field(config, V4L2_FIELD_NONE);
+	config = mg_config_set_standard(config, 0);
+	config = mg_config_set_input(config, -1);
+	XASSERT(!mg_config_set_pyramid(config, MG_PYRAMID_LEVELS + 1)) {
+		/* empty */
+	}
+	config = mg_config_set_pyramid(config, 2);
+	XASSERT(mg_config_get_sweep(config) == 25) {
+		/* empty */
+	}
+	config = mg_config_set_sweep(config, 50);
+	XASSERT(mg_config_get_stats(config) == 0) {
+		/* empty */
+	}
+	config = mg_config_set_stats(config, 4);
+
+	/* copy */
+	mg_config_t copy = mg_config_copy(config);
+	config = mg_config_destroy(config);
+	XASSERT(config == 0) {
+		/* empty */
+	}
+
+	XASSERT(mg_config_get_width(copy) == 640) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_height(copy) == 480) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_field(copy) == V4L2_FIELD_NONE) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_standard(copy) == 0) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_input(copy) == -1) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_pyramid(copy) == 2) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_sweep(copy) == 50) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_stats(copy) == 4) {
+		/* empty */
+	}
+	XASSERT(mg_config_get_pixelformat(copy, 1) == V4L2_PIX_FMT_SBGGR8) {
+		/* empty */
+	}
+
+	copy = mg_config_destroy(copy);
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_config));
+}
+
+#endif /* TEST_MULTI_GEE_MG_CONFIG */
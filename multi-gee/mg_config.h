@@ -0,0 +1,327 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee capture configuration declaration
+ *
+ * A capture configuration lists what the consumer of the images wants
+ * from a device: the frame size, the field order, the video standard,
+ * the input and the pixel formats it can process.  The device picks
+ * the accepted pixel format that costs the least memory per frame.
+ */
+#ifndef ITL_MULTI_GEE_MG_CONFIG_H
+#define ITL_MULTI_GEE_MG_CONFIG_H
+
+#include <stdint.h> /* uint32_t */
+
+#include <cclass/classdef.h>
+#include <multi-gee/mg_image.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Multi-gee capture configuration object handle
+ */
+NEWHANDLE(mg_config_t);
+
+/**
+ * @brief Layout of one memory plane of a capture format
+ */
+struct mg_plane_format
+{
+	uint32_t bytesperline; /**< Line stride in bytes */
+	uint32_t sizeimage; /**< Plane size in bytes */
+};
+
+/**
+ * @brief Capture format negotiated with a device
+ *
+ * @c bytesperline and @c sizeimage describe the first memory plane.  a
+ * format without planes is a single-planar format.
+ */
+struct mg_format
+{
+	uint32_t width; /**< Image width in pixels */
+	uint32_t height; /**< Image height in lines */
+	uint32_t bytesperline; /**< Line stride in bytes */
+	uint32_t sizeimage; /**< Image size in bytes */
+	uint32_t pixelformat; /**< video4linux2 fourcc code */
+	uint32_t field; /**< video4linux2 field order */
+	uint32_t num_planes; /**< Number of memory planes */
+	struct mg_plane_format plane[MG_MAX_PLANES]; /**< Layout per plane */
+};
+
+/**
+ * @brief Create configuration object
+ *
+ * the defaults are those of the original frame grabbers: 768x576
+ * interlaced PAL from input 0.  if no pixel format is added, 8-bit
+ * grey is accepted.
+ *
+ * @return a newly created configuration object handle
+ */
+mg_config_t
+mg_config_create();
+
+/**
+ * @brief Destroy configuration object
+ *
+ * @param config  handle of object to be destroyed
+ *
+ * @return 0
+ */
+mg_config_t
+mg_config_destroy(mg_config_t config);
+
+/**
+ * @brief Add an accepted pixel format
+ *
+ * @param config  object handle
+ * @param pixelformat  video4linux2 fourcc code, e.g. V4L2_PIX_FMT_GREY
+ *
+ * @return object handle
+ */
+mg_config_t
+mg_config_add_pixelformat(mg_config_t config,
+			  uint32_t pixelformat);
+
+/**
+ * @brief Copy configuration object
+ *
+ * @param config  object handle
+ *
+ * @return a newly created copy of the configuration
+ */
+mg_config_t
+mg_config_copy(mg_config_t config);
+
+/**
+ * @brief Field order accessor
+ *
+ * @param config  object handle
+ *
+ * @return video4linux2 field order
+ */
+uint32_t
+mg_config_get_field(mg_config_t config);
+
+/**
+ * @brief Image height accessor
+ *
+ * @param config  object handle
+ *
+ * @return requested image height in lines
+ */
+uint32_t
+mg_config_get_height(mg_config_t config);
+
+/**
+ * @brief Video input accessor
+ *
+ * @param config  object handle
+ *
+ * @return video input index, or -1 to leave the input unchanged
+ */
+int
+mg_config_get_input(mg_config_t config);
+
+/**
+ * @brief Number of accepted pixel formats accessor
+ *
+ * @param config  object handle
+ *
+ * @return the number of accepted pixel formats
+ */
+unsigned int
+mg_config_get_num_pixelformats(mg_config_t config);
+
+/**
+ * @brief Accepted pixel format accessor
+ *
+ * @param config  object handle
+ * @param index  pixel format index
+ *
+ * @return video4linux2 fourcc code, or 0 if the index is not valid
+ */
+uint32_t
+mg_config_get_pixelformat(mg_config_t config,
+			  unsigned int index);
+
+/**
+ * @brief Image pyramid depth accessor
+ *
+ * @param config  object handle
+ *
+ * @return number of pyramid levels built for every frame, 0 if none
+ */
+unsigned int
+mg_config_get_pyramid(mg_config_t config);
+
+/**
+ * @brief Video standard accessor
+ *
+ * @param config  object handle
+ *
+ * @return video4linux2 standard id, or 0 to leave the standard unchanged
+ */
+uint64_t
+mg_config_get_standard(mg_config_t config);
+
+/**
+ * @brief Image statistics line step accessor
+ *
+ * @param config  object handle
+ *
+ * @return every how many lines image statistics are gathered, 0 if they
+ * are not gathered in advance
+ */
+unsigned int
+mg_config_get_stats(mg_config_t config);
+
+/**
+ * @brief Full frame sweep interval accessor
+ *
+ * @param config  object handle
+ *
+ * @return every how many frames the search windows are ignored, 0 for
+ * never
+ */
+unsigned int
+mg_config_get_sweep(mg_config_t config);
+
+/**
+ * @brief Image width accessor
+ *
+ * @param config  object handle
+ *
+ * @return requested image width in pixels
+ */
+uint32_t
+mg_config_get_width(mg_config_t config);
+
+/**
+ * @brief Set the field order
+ *
+ * @param config  object handle
+ * @param field  video4linux2 field order, e.g. V4L2_FIELD_INTERLACED
+ *
+ * @return object handle
+ */
+mg_config_t
+mg_config_set_field(mg_config_t config,
+		    uint32_t field);
+
+/**
+ * @brief Set the video input
+ *
+ * @param config  object handle
+ * @param input  video input index, or -1 to leave the input unchanged
+ *
+ * @return object handle
+ */
+mg_config_t
+mg_config_set_input(mg_config_t config,
+		    int input);
+
+/**
+ * @brief Set the image pyramid depth
+ *
+ * frames of the device get their grey image reduced this many times,
+ * each level half the size of the one above, on a worker thread while
+ * the callback function runs.  levels that are not built in advance
+ * are built on first use by mg_frame_get_level().
+ *
+ * @param config  object handle
+ * @param levels  number of levels, at most MG_PYRAMID_LEVELS, 0 for
+ * none
+ *
+ * @return object handle, or 0 if there are too many levels
+ */
+mg_config_t
+mg_config_set_pyramid(mg_config_t config,
+		      unsigned int levels);
+
+/**
+ * @brief Set the image size
+ *
+ * the driver may adjust the size to the nearest one it supports.
+ *
+ * @param config  object handle
+ * @param width  image width in pixels
+ * @param height  image height in lines
+ *
+ * @return object handle
+ */
+mg_config_t
+mg_config_set_size(mg_config_t config,
+		   uint32_t width,
+		   uint32_t height);
+
+/**
+ * @brief Set the video standard
+ *
+ * @param config  object handle
+ * @param standard  video4linux2 standard id, e.g. V4L2_STD_PAL, or 0
+ * for devices without analogue video standards
+ *
+ * @return object handle
+ */
+mg_config_t
+mg_config_set_standard(mg_config_t config,
+		       uint64_t standard);
+
+/**
+ * @brief Set the image statistics line step
+ *
+ * frames of the device get the histogram, mean, saturated pixel count
+ * and focus of their grey image worked out on a worker thread while
+ * the callback function runs, looking at every step-th line.  the
+ * publisher exports them with every frame.  without a step the
+ * statistics are worked out on first use by mg_frame_get_stats(),
+ * looking at every fourth line.
+ *
+ * @param config  object handle
+ * @param step  every how many lines, 0 for on first use only
+ *
+ * @return object handle
+ */
+mg_config_t
+mg_config_set_stats(mg_config_t config,
+		    unsigned int step);
+
+/**
+ * @brief Set the full frame sweep interval
+ *
+ * frames whose sequence number is a multiple of the interval are
+ * searched as a whole, whatever the search windows, so markers that
+ * were lost, or never tracked, are found again.  the default is 25,
+ * once a second for PAL cameras.
+ *
+ * @param config  object handle
+ * @param interval  every how many frames the full frame is searched, 1
+ * for every frame, 0 for never
+ *
+ * @return object handle
+ */
+mg_config_t
+mg_config_set_sweep(mg_config_t config,
+		    unsigned int interval);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_CONFIG_H */
@@ -0,0 +1,794 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee pixel format conversion definition
+ */
+#include <string.h> /* memcpy */
+
+#include <stdlib.h> /* struct timeval, needed for videodev2.h */
+#include <asm/types.h> /* needed for videodev2.h */
+#include <linux/videodev2.h>
+
+#include "mg_convert.h" /* declarations implemented */
+
+#ifdef MG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Convert one line
+ *
+ * @param src  source line
+ * @param next  next source line, used by the Bayer kernels only
+ * @param dst  destination line
+ * @param n  number of destination pixels
+ */
+typedef void (*row_fn)(const uint8_t *src,
+		       const uint8_t *next,
+		       uint8_t *dst,
+		       uint32_t n);
+
+/**
+ * @brief Luma weight of red, in 1/256
+ */
+#define WR 77
+/**
+ * @brief Luma weight of green, in 1/256
+ */
+#define WG 150
+/**
+ * @brief Luma weight of blue, in 1/256
+ */
+#define WB 29
+
+static
+void
+grey_row(const uint8_t *src,
+	 const uint8_t *next,
+	 uint8_t *dst,
+	 uint32_t n)
+{
+	(void) next;
+	memcpy(dst, src, n);
+}
+
+static
+void
+yuyv_row_scalar(const uint8_t *src,
+		const uint8_t *next,
+		uint8_t *dst,
+		uint32_t n)
+{
+	(void) next;
+	for (uint32_t i = 0; i < n; i++) {
+		dst[i] = src[2 * i];
+	}
+}
+
+static
+void
+uyvy_row_scalar(const uint8_t *src,
+		const uint8_t *next,
+		uint8_t *dst,
+		uint32_t n)
+{
+	(void) next;
+	for (uint32_t i = 0; i < n; i++) {
+		dst[i] = src[2 * i + 1];
+	}
+}
+
+static
+void
+rgb_row_scalar(const uint8_t *src,
+	       const uint8_t *next,
+	       uint8_t *dst,
+	       uint32_t n)
+{
+	(void) next;
+	for (uint32_t i = 0; i < n; i++) {
+		const uint8_t *p = src + 3 * i;
+		dst[i] = (WR * p[0] + WG * p[1] + WB * p[2] + 128) >> 8;
+	}
+}
+
+static
+void
+bgr_row_scalar(const uint8_t *src,
+	       const uint8_t *next,
+	       uint8_t *dst,
+	       uint32_t n)
+{
+	(void) next;
+	for (uint32_t i = 0; i < n; i++) {
+		const uint8_t *p = src + 3 * i;
+		dst[i] = (WB * p[0] + WG * p[1] + WR * p[2] + 128) >> 8;
+	}
+}
+
+static
+void
+bayer_row_scalar(const uint8_t *src,
+		 const uint8_t *next,
+		 uint8_t *dst,
+		 uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		dst[i] = (src[2 * i] + src[2 * i + 1]
+			  + next[2 * i] + next[2 * i + 1] + 2) >> 2;
+	}
+}
+
+#ifdef MG_SIMD_X86
+
+MG_TARGET_SSE2
+static
+void
+yuyv_row_sse2(const uint8_t *src,
+	      const uint8_t *next,
+	      uint8_t *dst,
+	      uint32_t n)
+{
+	const __m128i mask = _mm_set1_epi16(0x00ff);
+	uint32_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i *) (src + 2 * i));
+		__m128i b = _mm_loadu_si128((const __m128i *) (src + 2 * i + 16));
+		a = _mm_and_si128(a, mask);
+		b = _mm_and_si128(b, mask);
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(a, b));
+	}
+	yuyv_row_scalar(src + 2 * i, next, dst + i, n - i);
+}
+
+MG_TARGET_SSE2
+static
+void
+uyvy_row_sse2(const uint8_t *src,
+	      const uint8_t *next,
+	      uint8_t *dst,
+	      uint32_t n)
+{
+	uint32_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i *) (src + 2 * i));
+		__m128i b = _mm_loadu_si128((const __m128i *) (src + 2 * i + 16));
+		a = _mm_srli_epi16(a, 8);
+		b = _mm_srli_epi16(b, 8);
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(a, b));
+	}
+	uyvy_row_scalar(src + 2 * i, next, dst + i, n - i);
+}
+
+/**
+ * @brief Luma of four packed 24-bit pixels
+ *
+ * @param p  first pixel; reads one byte past the fourth pixel
+ * @param w0  weight of the first byte of a pixel
+ * @param w2  weight of the third byte of a pixel
+ *
+ * @return luma in the low byte of each 32-bit lane
+ */
+MG_TARGET_SSE2
+static
+__m128i
+luma4_sse2(const uint8_t *p,
+	   int w0,
+	   int w2)
+{
+	int32_t v[4];
+	memcpy(&v[0], p, 4);
+	memcpy(&v[1], p + 3, 4);
+	memcpy(&v[2], p + 6, 4);
+	memcpy(&v[3], p + 9, 4);
+
+	const __m128i mask = _mm_set1_epi32(0xff);
+	__m128i x = _mm_setr_epi32(v[0], v[1], v[2], v[3]);
+	__m128i c0 = _mm_and_si128(x, mask);
+	__m128i c1 = _mm_and_si128(_mm_srli_epi32(x, 8), mask);
+	__m128i c2 = _mm_and_si128(_mm_srli_epi32(x, 16), mask);
+
+	__m128i y = _mm_set1_epi32(128);
+	y = _mm_add_epi32(y, _mm_mullo_epi16(c0, _mm_set1_epi32(w0)));
+	y = _mm_add_epi32(y, _mm_mullo_epi16(c1, _mm_set1_epi32(WG)));
+	y = _mm_add_epi32(y, _mm_mullo_epi16(c2, _mm_set1_epi32(w2)));
+
+	return _mm_srli_epi32(y, 8);
+}
+
+/**
+ * @brief Luma of a line of packed 24-bit pixels
+ *
+ * @param src  source line
+ * @param dst  destination line
+ * @param n  number of pixels
+ * @param w0  weight of the first byte of a pixel
+ * @param w2  weight of the third byte of a pixel
+ *
+ * @return number of pixels converted
+ */
+MG_TARGET_SSE2
+static
+uint32_t
+luma_row_sse2(const uint8_t *src,
+	      uint8_t *dst,
+	      uint32_t n,
+	      int w0,
+	      int w2)
+{
+	uint32_t i = 0;
+	/* the last pixel is read as four bytes */
+	for (; i + 17 <= n; i += 16) {
+		const uint8_t *p = src + 3 * i;
+		__m128i a = _mm_packs_epi32(luma4_sse2(p, w0, w2),
+					    luma4_sse2(p + 12, w0, w2));
+		__m128i b = _mm_packs_epi32(luma4_sse2(p + 24, w0, w2),
+					    luma4_sse2(p + 36, w0, w2));
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(a, b));
+	}
+
+	return i;
+}
+
+MG_TARGET_SSE2
+static
+void
+rgb_row_sse2(const uint8_t *src,
+	     const uint8_t *next,
+	     uint8_t *dst,
+	     uint32_t n)
+{
+	uint32_t i = luma_row_sse2(src, dst, n, WR, WB);
+	rgb_row_scalar(src + 3 * i, next, dst + i, n - i);
+}
+
+MG_TARGET_SSE2
+static
+void
+bgr_row_sse2(const uint8_t *src,
+	     const uint8_t *next,
+	     uint8_t *dst,
+	     uint32_t n)
+{
+	uint32_t i = luma_row_sse2(src, dst, n, WB, WR);
+	bgr_row_scalar(src + 3 * i, next, dst + i, n - i);
+}
+
+/**
+ * @brief Sum horizontal byte pairs of two lines
+ *
+ * @param a  16 bytes of the first line
+ * @param b  16 bytes of the second line
+ *
+ * @return eight 2x2 sums
+ */
+MG_TARGET_SSE2
+static
+__m128i
+quad8_sse2(__m128i a,
+	   __m128i b)
+{
+	const __m128i mask = _mm_set1_epi16(0x00ff);
+	__m128i s = _mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8));
+	__m128i t = _mm_add_epi16(_mm_and_si128(b, mask), _mm_srli_epi16(b, 8));
+
+	return _mm_add_epi16(s, t);
+}
+
+MG_TARGET_SSE2
+static
+void
+bayer_row_sse2(const uint8_t *src,
+	       const uint8_t *next,
+	       uint8_t *dst,
+	       uint32_t n)
+{
+	const __m128i two = _mm_set1_epi16(2);
+	uint32_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		const __m128i *s = (const __m128i *) (src + 2 * i);
+		const __m128i *t = (const __m128i *) (next + 2 * i);
+		__m128i a = quad8_sse2(_mm_loadu_si128(s), _mm_loadu_si128(t));
+		__m128i b = quad8_sse2(_mm_loadu_si128(s + 1),
+				       _mm_loadu_si128(t + 1));
+		a = _mm_srli_epi16(_mm_add_epi16(a, two), 2);
+		b = _mm_srli_epi16(_mm_add_epi16(b, two), 2);
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(a, b));
+	}
+	bayer_row_scalar(src + 2 * i, next + 2 * i, dst + i, n - i);
+}
+
+/**
+ * @brief Pack two vectors of 16-bit values to bytes, in order
+ *
+ * undoes the lane interleaving of _mm256_packus_epi16().
+ *
+ * @param a  first 16 values
+ * @param b  next 16 values
+ *
+ * @return 32 bytes
+ */
+MG_TARGET_AVX2
+static
+__m256i
+pack_avx2(__m256i a,
+	  __m256i b)
+{
+	return _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b),
+					_MM_SHUFFLE(3, 1, 2, 0));
+}
+
+MG_TARGET_AVX2
+static
+void
+yuyv_row_avx2(const uint8_t *src,
+	      const uint8_t *next,
+	      uint8_t *dst,
+	      uint32_t n)
+{
+	const __m256i mask = _mm256_set1_epi16(0x00ff);
+	uint32_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		__m256i a = _mm256_loadu_si256((const __m256i *) (src + 2 * i));
+		__m256i b = _mm256_loadu_si256((const __m256i *) (src + 2 * i + 32));
+		a = _mm256_and_si256(a, mask);
+		b = _mm256_and_si256(b, mask);
+		_mm256_storeu_si256((__m256i *) (dst + i), pack_avx2(a, b));
+	}
+	yuyv_row_sse2(src + 2 * i, next, dst + i, n - i);
+}
+
+MG_TARGET_AVX2
+static
+void
+uyvy_row_avx2(const uint8_t *src,
+	      const uint8_t *next,
+	      uint8_t *dst,
+	      uint32_t n)
+{
+	uint32_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		__m256i a = _mm256_loadu_si256((const __m256i *) (src + 2 * i));
+		__m256i b = _mm256_loadu_si256((const __m256i *) (src + 2 * i + 32));
+		a = _mm256_srli_epi16(a, 8);
+		b = _mm256_srli_epi16(b, 8);
+		_mm256_storeu_si256((__m256i *) (dst + i), pack_avx2(a, b));
+	}
+	uyvy_row_sse2(src + 2 * i, next, dst + i, n - i);
+}
+
+/**
+ * @brief Luma of eight packed 24-bit pixels
+ *
+ * @param p  first pixel; reads four bytes past the eighth pixel
+ * @param w0  weight of the first byte of a pixel
+ * @param w2  weight of the third byte of a pixel
+ *
+ * @return luma in the low byte of each 32-bit lane
+ */
+MG_TARGET_AVX2
+static
+__m256i
+luma8_avx2(const uint8_t *p,
+	   int w0,
+	   int w2)
+{
+	const __m256i spread = _mm256_setr_epi8(
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i mask = _mm256_set1_epi32(0xff);
+
+	__m256i x = _mm256_inserti128_si256(
+		_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) p)),
+		_mm_loadu_si128((const __m128i *) (p + 12)), 1);
+	x = _mm256_shuffle_epi8(x, spread);
+
+	__m256i c0 = _mm256_and_si256(x, mask);
+	__m256i c1 = _mm256_and_si256(_mm256_srli_epi32(x, 8), mask);
+	__m256i c2 = _mm256_srli_epi32(x, 16);
+
+	__m256i y = _mm256_set1_epi32(128);
+	y = _mm256_add_epi32(y, _mm256_mullo_epi16(c0, _mm256_set1_epi32(w0)));
+	y = _mm256_add_epi32(y, _mm256_mullo_epi16(c1, _mm256_set1_epi32(WG)));
+	y = _mm256_add_epi32(y, _mm256_mullo_epi16(c2, _mm256_set1_epi32(w2)));
+
+	return _mm256_srli_epi32(y, 8);
+}
+
+/**
+ * @brief Luma of a line of packed 24-bit pixels
+ *
+ * @param src  source line
+ * @param dst  destination line
+ * @param n  number of pixels
+ * @param w0  weight of the first byte of a pixel
+ * @param w2  weight of the third byte of a pixel
+ *
+ * @return number of pixels converted
+ */
+MG_TARGET_AVX2
+static
+uint32_t
+luma_row_avx2(const uint8_t *src,
+	      uint8_t *dst,
+	      uint32_t n,
+	      int w0,
+	      int w2)
+{
+	uint32_t i = 0;
+	/* the last load reads 16 bytes for 12 */
+	for (; i + 18 <= n; i += 16) {
+		const uint8_t *p = src + 3 * i;
+		__m256i w = _mm256_packs_epi32(luma8_avx2(p, w0, w2),
+					       luma8_avx2(p + 24, w0, w2));
+		w = _mm256_permute4x64_epi64(w, _MM_SHUFFLE(3, 1, 2, 0));
+		__m128i y = _mm_packus_epi16(_mm256_castsi256_si128(w),
+					     _mm256_extracti128_si256(w, 1));
+		_mm_storeu_si128((__m128i *) (dst + i), y);
+	}
+
+	return i;
+}
+
+MG_TARGET_AVX2
+static
+void
+rgb_row_avx2(const uint8_t *src,
+	     const uint8_t *next,
+	     uint8_t *dst,
+	     uint32_t n)
+{
+	uint32_t i = luma_row_avx2(src, dst, n, WR, WB);
+	rgb_row_sse2(src + 3 * i, next, dst + i, n - i);
+}
+
+MG_TARGET_AVX2
+static
+void
+bgr_row_avx2(const uint8_t *src,
+	     const uint8_t *next,
+	     uint8_t *dst,
+	     uint32_t n)
+{
+	uint32_t i = luma_row_avx2(src, dst, n, WB, WR);
+	bgr_row_sse2(src + 3 * i, next, dst + i, n - i);
+}
+
+/**
+ * @brief Sum horizontal byte pairs of two lines
+ *
+ * @param a  32 bytes of the first line
+ * @param b  32 bytes of the second line
+ *
+ * @return sixteen 2x2 sums
+ */
+MG_TARGET_AVX2
+static
+__m256i
+quad16_avx2(__m256i a,
+	    __m256i b)
+{
+	const __m256i mask = _mm256_set1_epi16(0x00ff);
+	__m256i s = _mm256_add_epi16(_mm256_and_si256(a, mask),
+				     _mm256_srli_epi16(a, 8));
+	__m256i t = _mm256_add_epi16(_mm256_and_si256(b, mask),
+				     _mm256_srli_epi16(b, 8));
+
+	return _mm256_add_epi16(s, t);
+}
+
+MG_TARGET_AVX2
+static
+void
+bayer_row_avx2(const uint8_t *src,
+	       const uint8_t *next,
+	       uint8_t *dst,
+	       uint32_t n)
+{
+	const __m256i two = _mm256_set1_epi16(2);
+	uint32_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		const __m256i *s = (const __m256i *) (src + 2 * i);
+		const __m256i *t = (const __m256i *) (next + 2 * i);
+		__m256i a = quad16_avx2(_mm256_loadu_si256(s),
+					_mm256_loadu_si256(t));
+		__m256i b = quad16_avx2(_mm256_loadu_si256(s + 1),
+					_mm256_loadu_si256(t + 1));
+		a = _mm256_srli_epi16(_mm256_add_epi16(a, two), 2);
+		b = _mm256_srli_epi16(_mm256_add_epi16(b, two), 2);
+		_mm256_storeu_si256((__m256i *) (dst + i), pack_avx2(a, b));
+	}
+	bayer_row_sse2(src + 2 * i, next + 2 * i, dst + i, n - i);
+}
+
+#else /* MG_SIMD_X86 */
+
+#define yuyv_row_sse2 0
+#define uyvy_row_sse2 0
+#define rgb_row_sse2 0
+#define bgr_row_sse2 0
+#define bayer_row_sse2 0
+#define yuyv_row_avx2 0
+#define uyvy_row_avx2 0
+#define rgb_row_avx2 0
+#define bgr_row_avx2 0
+#define bayer_row_avx2 0
+
+#endif /* MG_SIMD_X86 */
+
+/**
+ * @brief Conversion of a pixel format
+ */
+struct kernel
+{
+	uint32_t pixelformat; /**< Source video4linux2 fourcc code */
+	uint32_t bpp; /**< Source bytes per pixel */
+	uint32_t shift; /**< Source pixels per grey pixel, log2 */
+	row_fn row[3]; /**< Line kernel per instruction set level */
+};
+
+/**
+ * @brief Conversions of all supported pixel formats
+ */
+static const struct kernel kernels[] = {
+	{V4L2_PIX_FMT_GREY, 1, 0, {grey_row, grey_row, grey_row}},
+	{V4L2_PIX_FMT_YUYV, 2, 0,
+	 {yuyv_row_scalar, yuyv_row_sse2, yuyv_row_avx2}},
+	{V4L2_PIX_FMT_UYVY, 2, 0,
+	 {uyvy_row_scalar, uyvy_row_sse2, uyvy_row_avx2}},
+	{V4L2_PIX_FMT_RGB24, 3, 0,
+	 {rgb_row_scalar, rgb_row_sse2, rgb_row_avx2}},
+	{V4L2_PIX_FMT_BGR24, 3, 0,
+	 {bgr_row_scalar, bgr_row_sse2, bgr_row_avx2}},
+	{V4L2_PIX_FMT_SBGGR8, 1, 1,
+	 {bayer_row_scalar, bayer_row_sse2, bayer_row_avx2}},
+	{V4L2_PIX_FMT_SGBRG8, 1, 1,
+	 {bayer_row_scalar, bayer_row_sse2, bayer_row_avx2}},
+	{V4L2_PIX_FMT_SGRBG8, 1, 1,
+	 {bayer_row_scalar, bayer_row_sse2, bayer_row_avx2}},
+	{V4L2_PIX_FMT_SRGGB8, 1, 1,
+	 {bayer_row_scalar, bayer_row_sse2, bayer_row_avx2}},
+};
+
+/**
+ * @brief Find the conversion of a pixel format
+ *
+ * @param pixelformat  video4linux2 fourcc code
+ *
+ * @return the conversion, or 0 if the pixel format is not supported
+ */
+static
+const struct kernel *
+find_kernel(uint32_t pixelformat)
+{
+	for (unsigned int i = 0; i < sizeof(kernels) / sizeof(*kernels); i++) {
+		if (kernels[i].pixelformat == pixelformat) {
+			return &kernels[i];
+		}
+	}
+
+	return 0;
+}
+
+uint32_t
+mg_convert_bytes_per_pixel(uint32_t pixelformat)
+{
+	const struct kernel *k = find_kernel(pixelformat);
+
+	return k ? k->bpp : 0;
+}
+
+bool
+mg_convert_size(uint32_t pixelformat,
+		uint32_t width,
+		uint32_t height,
+		uint32_t *grey_width,
+		uint32_t *grey_height)
+{
+	const struct kernel *k = find_kernel(pixelformat);
+	if (!k) {
+		return false;
+	}
+
+	*grey_width = width >> k->shift;
+	*grey_height = height >> k->shift;
+
+	return true;
+}
+
+bool
+mg_convert_grey(uint32_t pixelformat,
+		const struct mg_image *src,
+		const struct mg_image *dst,
+		enum mg_simd simd)
+{
+	const struct kernel *k = find_kernel(pixelformat);
+	if (!k) {
+		return false;
+	}
+
+	if (simd > mg_simd_detect()) {
+		simd = mg_simd_detect();
+	}
+	row_fn row = k->row[simd];
+	while (!row) {
+		row = k->row[--simd];
+	}
+
+	const uint8_t *s = src->data;
+	uint8_t *d = dst->data;
+	for (uint32_t y = 0; y < dst->height; y++) {
+		const uint8_t *line = s + ((size_t) y << k->shift) * src->stride;
+		row(line, line + src->stride, d + (size_t) y * dst->stride,
+		    dst->width);
+	}
+
+	return true;
+}
+
+void
+mg_convert_reduce(const struct mg_image *src,
+		  const struct mg_image *dst,
+		  enum mg_simd simd)
+{
+	/* a grey quad is reduced just like a Bayer quad */
+	mg_convert_grey(V4L2_PIX_FMT_SGRBG8, src, dst, simd);
+}
+
+#ifdef TEST_MULTI_GEE_MG_CONVERT
+
+#include <stdio.h>
+
+USE_XASSERT
+
+/**
+ * @brief Compare every kernel of a pixel format with the scalar one
+ *
+ * @param pixelformat  video4linux2 fourcc code
+ * @param bpp  source bytes per pixel
+ * @param width  source width
+ * @param height  source height
+ */
+void
+test_kernels(uint32_t pixelformat,
+	     uint32_t bpp,
+	     uint32_t width,
+	     uint32_t height)
+{
+	struct mg_image src = {0, width, height, width * bpp + 5};
+	src.data = malloc(src.stride * height);
+	for (uint32_t i = 0; i < src.stride * height; i++) {
+		((uint8_t *) src.data)[i] = rand();
+	}
+
+	struct mg_image ref = {0, 0, 0, 0};
+	XASSERT(mg_convert_size(pixelformat, width, height,
+				&ref.width, &ref.height)) {
+		/* empty */
+	}
+	ref.stride = ref.width + 3;
+	ref.data = calloc(1, ref.stride * ref.height + 1);
+	mg_convert_grey(pixelformat, &src, &ref, MG_SIMD_SCALAR);
+
+	for (int simd = MG_SIMD_SSE2; simd <= (int) mg_simd_detect(); simd++) {
+		struct mg_image dst = ref;
+		dst.data = calloc(1, dst.stride * dst.height + 1);
+		mg_convert_grey(pixelformat, &src, &dst, simd);
+		for (uint32_t y = 0; y < ref.height; y++) {
+			XASSERT(!memcmp((uint8_t *) ref.data + y * ref.stride,
+					(uint8_t *) dst.data + y * dst.stride,
+					ref.width)) {
+				/* empty */
+			}
+		}
+		free(dst.data);
+	}
+
+	free(ref.data);
+	free(src.data);
+}
+
+void
+mg_convert()
+{
+	printf("%s: %s\n", __func__, mg_simd_name(mg_simd_detect()));
+
+	/* known values */
+	uint8_t yuyv[] = {10, 128, 20, 128};
+	uint8_t rgb[] = {255, 255, 255, 255, 0, 0, 0, 0, 255};
+	uint8_t bayer[] = {1, 2, 3, 4};
+	uint8_t out[3];
+	struct mg_image src = {yuyv, 2, 1, 4};
+	struct mg_image dst = {out, 2, 1, 3};
+	mg_convert_grey(V4L2_PIX_FMT_YUYV, &src, &dst, MG_SIMD_SCALAR);
+	XASSERT(out[0] == 10 && out[1] == 20) {
+		/* empty */
+	}
+	mg_convert_grey(V4L2_PIX_FMT_UYVY, &src, &dst, MG_SIMD_SCALAR);
+	XASSERT(out[0] == 128 && out[1] == 128) {
+		/* empty */
+	}
+	src.data = rgb;
+	src.width = dst.width = 3;
+	src.stride = 9;
+	mg_convert_grey(V4L2_PIX_FMT_RGB24, &src, &dst, MG_SIMD_SCALAR);
+	XASSERT(out[0] == 255 && out[1] == 77 && out[2] == 29) {
+		/* empty */
+	}
+	mg_convert_grey(V4L2_PIX_FMT_BGR24, &src, &dst, MG_SIMD_SCALAR);
+	XASSERT(out[1] == 29 && out[2] == 77) {
+		/* empty */
+	}
+	src.data = bayer;
+	src.width = src.height = 2;
+	src.stride = 2;
+	dst.width = dst.height = 1;
+	mg_convert_grey(V4L2_PIX_FMT_SRGGB8, &src, &dst, MG_SIMD_SCALAR);
+	XASSERT(out[0] == 3) {
+		/* empty */
+	}
+
+	uint32_t w;
+	uint32_t h;
+	XASSERT(mg_convert_bytes_per_pixel(V4L2_PIX_FMT_YUYV) == 2) {
+		/* empty */
+	}
+	XASSERT(mg_convert_bytes_per_pixel(V4L2_PIX_FMT_RGB24) == 3) {
+		/* empty */
+	}
+	XASSERT(mg_convert_bytes_per_pixel(V4L2_PIX_FMT_MJPEG) == 0) {
+		/* empty */
+	}
+	XASSERT(!mg_convert_size(V4L2_PIX_FMT_MJPEG, 8, 8, &w, &h)) {
+		/* empty */
+	}
+
+	/* vector kernels match the scalar ones, tails included */
+	uint32_t widths[] = {1, 15, 16, 17, 31, 33, 64, 100, 771};
+	for (unsigned int i = 0; i < sizeof(widths) / sizeof(*widths); i++) {
+		uint32_t width = widths[i];
+		test_kernels(V4L2_PIX_FMT_GREY, 1, width, 3);
+		test_kernels(V4L2_PIX_FMT_YUYV, 2, width, 3);
+		test_kernels(V4L2_PIX_FMT_UYVY, 2, width, 3);
+		test_kernels(V4L2_PIX_FMT_RGB24, 3, width, 3);
+		test_kernels(V4L2_PIX_FMT_BGR24, 3, width, 3);
+		test_kernels(V4L2_PIX_FMT_SGRBG8, 1, 2 * width, 4);
+	}
+
+	/* pyramid reduction */
+	uint8_t grey[] = {0, 4, 8, 12, 7, 0, 1, 2, 3, 4, 5, 6};
+	src.data = grey;
+	src.width = 6;
+	src.height = 2;
+	src.stride = 6;
+	dst.width = 3;
+	dst.height = 1;
+	mg_convert_reduce(&src, &dst, mg_simd_detect());
+	XASSERT(out[0] == 2 && out[1] == 7 && out[2] == 5) {
+		/* empty */
+	}
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_convert));
+}
+
+#endif /* TEST_MULTI_GEE_MG_CONVERT */
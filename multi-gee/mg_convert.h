@@ -0,0 +1,120 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee pixel format conversion declaration
+ *
+ * Converts the images of cameras that do not deliver 8-bit grey into
+ * grey images for the tracking code:
+ *  - YUYV and UYVY: the luma bytes
+ *  - RGB24 and BGR24: ITU-R BT.601 luma, (77 R + 150 G + 29 B) / 256
+ *  - 8-bit Bayer, in any order: the mean of every 2x2 quad, which gives
+ *    a grey image of half the width and height
+ *  - GREY: a copy
+ *
+ * Every conversion has a scalar, SSE2 and AVX2 kernel with identical
+ * results.  The 2x2 mean used for Bayer images also reduces grey
+ * images for coarse-to-fine searches, see mg_convert_reduce().
+ */
+#ifndef ITL_MULTI_GEE_MG_CONVERT_H
+#define ITL_MULTI_GEE_MG_CONVERT_H
+
+#include <stdbool.h> /* bool */
+#include <stdint.h> /* uint32_t */
+
+#include <multi-gee/mg_image.h>
+#include <multi-gee/mg_simd.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Bytes per pixel of a packed pixel format
+ *
+ * @param pixelformat  video4linux2 fourcc code
+ *
+ * @return bytes per pixel, or 0 if the pixel format cannot be
+ * converted
+ */
+uint32_t
+mg_convert_bytes_per_pixel(uint32_t pixelformat);
+
+/**
+ * @brief Size of the grey image converted from a frame
+ *
+ * @param pixelformat  video4linux2 fourcc code of the source
+ * @param width  source width in pixels
+ * @param height  source height in lines
+ * @param [out]grey_width  grey image width
+ * @param [out]grey_height  grey image height
+ *
+ * @return \c true if the pixel format can be converted, else \c false
+ */
+bool
+mg_convert_size(uint32_t pixelformat,
+		uint32_t width,
+		uint32_t height,
+		uint32_t *grey_width,
+		uint32_t *grey_height);
+
+/**
+ * @brief Convert an image to grey
+ *
+ * the destination must have the width and height given by
+ * mg_convert_size(), and room for them at its stride.
+ *
+ * @param pixelformat  video4linux2 fourcc code of the source
+ * @param src  source image
+ * @param dst  destination grey image
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return \c true on success, \c false if the pixel format cannot be
+ * converted
+ */
+bool
+mg_convert_grey(uint32_t pixelformat,
+		const struct mg_image *src,
+		const struct mg_image *dst,
+		enum mg_simd simd);
+
+/**
+ * @brief Deepest image pyramid level
+ *
+ * level 1 is half, level 3 an eighth of the grey image size.
+ */
+#define MG_PYRAMID_LEVELS 3
+
+/**
+ * @brief Reduce a grey image to half its width and height
+ *
+ * every destination pixel is the rounded mean of a 2x2 quad of source
+ * pixels, the binomial 2x2 kernel.  an odd last column or line of the
+ * source is dropped.
+ *
+ * @param src  source grey image
+ * @param dst  destination grey image, half the width and height of the
+ * source
+ * @param simd  kernel to use, at most mg_simd_detect()
+ */
+void
+mg_convert_reduce(const struct mg_image *src,
+		  const struct mg_image *dst,
+		  enum mg_simd simd);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_CONVERT_H */
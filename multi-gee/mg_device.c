@@ -22,7 +22,9 @@
 #include <err.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h> /* realloc */
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -32,6 +34,28 @@
 
 USE_XASSERT
 
+/**
+ * @brief Region of interest and the image geometry it gives
+ */
+struct view
+{
+	struct mg_rect roi; /**< Region of interest */
+	struct mg_format format; /**< Format of the captured image */
+	bool cropped; /**< Region cropped by the hardware? */
+};
+
+/**
+ * @brief Control value and the frames it applies to
+ */
+struct control
+{
+	uint32_t id; /**< Control identifier */
+	int32_t value; /**< Value from sequence on */
+	int32_t previous; /**< Value before sequence */
+	bool has_previous; /**< Previous value known? */
+	uint32_t sequence; /**< First frame captured with value */
+};
+
 /**
  * @brief Device object structure
  */
@@ -40,7 +64,27 @@ CLASS(mg_device, mg_device_t)
 	int fd; /**< Device file descriptor */
 	char *name; /**< Device file name */
 	dev_t devno; /**< Device number */
+	char *bus_info; /**< Bus position, 0 until the device is tested */
 	mg_buffer_t buffer; /**< Frame buffer object handle */
+	mg_pool_t pool; /**< Derived image memory */
+	mg_config_t config; /**< Capture configuration */
+	mg_background_t background; /**< Background model, or 0 */
+	struct mg_format format; /**< Negotiated capture format */
+	bool mplane; /**< Streams through the multi-planar API? */
+	int worker; /**< Pool worker of the frames, or -1 */
+	struct mg_rect window[MG_MAX_WINDOWS]; /**< Search windows */
+	unsigned int num_windows; /**< Number of search windows */
+	struct view view; /**< Region of interest of current frames */
+	struct view next; /**< Region of interest of later frames */
+	uint32_t next_sequence; /**< First frame of next region */
+	bool next_pending; /**< Next region not in effect yet? */
+	struct mg_rect roi; /**< Queued region of interest */
+	bool roi_queued; /**< Region of interest queued? */
+	pthread_mutex_t lock; /**< Guards the controls, windows and queued region */
+	struct mg_control *queued; /**< Queued control changes */
+	unsigned int num_queued; /**< Number of queued control changes */
+	struct control *control; /**< Controls set through the device */
+	unsigned int num_controls; /**< Number of controls set */
 	unsigned int no_bufs; /**< Number of capture buffers */
 	void *userptr; /**< User defined pointer */
 };
@@ -58,6 +102,7 @@ mg_device_create(const char *name,
 	mg_device->devno = -1;
 
 	STRDUP(mg_device->name, name);
+	mg_device->bus_info = 0;
 
 	struct stat st;
 	if (0 != stat(name, &st)) {
@@ -70,6 +115,24 @@ mg_device_create(const char *name,
 
 	mg_device->no_bufs = no_bufs;
 	mg_device->buffer = mg_buffer_create();
+	mg_device->config = mg_config_create();
+	mg_device->pool = mg_pool_create();
+	mg_device->background = 0;
+	memset(&mg_device->format, 0, sizeof(mg_device->format));
+	mg_device->mplane = false;
+	mg_device->worker = -1;
+	mg_device->num_windows = 0;
+	memset(&mg_device->view, 0, sizeof(mg_device->view));
+	memset(&mg_device->next, 0, sizeof(mg_device->next));
+	mg_device->next_sequence = 0;
+	mg_device->next_pending = false;
+	memset(&mg_device->roi, 0, sizeof(mg_device->roi));
+	mg_device->roi_queued = false;
+	pthread_mutex_init(&mg_device->lock, 0);
+	mg_device->queued = 0;
+	mg_device->num_queued = 0;
+	mg_device->control = 0;
+	mg_device->num_controls = 0;
 	mg_device->userptr = userptr;
 
 	return mg_device;
@@ -86,7 +149,14 @@ mg_device_destroy(mg_device_t mg_device)
 		}
 
 		FREEOBJ(mg_device->name);
+		FREEOBJ(mg_device->bus_info);
 		mg_buffer_destroy(mg_device->buffer);
+		mg_config_destroy(mg_device->config);
+		mg_pool_destroy(mg_device->pool);
+		mg_background_destroy(mg_device->background);
+		FREEOBJ(mg_device->queued);
+		FREEOBJ(mg_device->control);
+		pthread_mutex_destroy(&mg_device->lock);
 
 		FREEOBJ(mg_device);
 	}
@@ -94,6 +164,17 @@ mg_device_destroy(mg_device_t mg_device)
 	return 0;
 }
 
+mg_background_t
+mg_device_get_background(mg_device_t mg_device)
+{
+	mg_background_t p = 0;
+	VERIFY(mg_device) {
+		p = mg_device->background;
+	}
+
+	return p;
+}
+
 mg_buffer_t
 mg_device_get_buffer(mg_device_t mg_device)
 {
@@ -105,6 +186,76 @@ mg_device_get_buffer(mg_device_t mg_device)
 	return p;
 }
 
+char *
+mg_device_get_bus_info(mg_device_t mg_device)
+{
+	char *bus_info = 0;
+	VERIFY(mg_device) {
+		bus_info = mg_device->bus_info;
+	}
+
+	return bus_info;
+}
+
+mg_config_t
+mg_device_get_config(mg_device_t mg_device)
+{
+	mg_config_t p = 0;
+	VERIFY(mg_device) {
+		p = mg_device->config;
+	}
+
+	return p;
+}
+
+bool
+mg_device_get_cropped(mg_device_t mg_device)
+{
+	bool cropped = false;
+	VERIFY(mg_device) {
+		cropped = mg_device->next_pending
+			? mg_device->next.cropped
+			: mg_device->view.cropped;
+	}
+
+	return cropped;
+}
+
+bool
+mg_device_get_control(mg_device_t mg_device,
+		      uint32_t id,
+		      uint32_t sequence,
+		      int32_t *value,
+		      uint32_t *since)
+{
+	bool found = false;
+	VERIFY(mg_device) {
+		pthread_mutex_lock(&mg_device->lock);
+		for (unsigned int i = 0; i < mg_device->num_controls; i++) {
+			struct control *c = &mg_device->control[i];
+			if (c->id != id) {
+				continue;
+			}
+			if (sequence >= c->sequence || !c->has_previous) {
+				*value = c->value;
+				if (since) {
+					*since = c->sequence;
+				}
+			} else {
+				*value = c->previous;
+				if (since) {
+					*since = 0;
+				}
+			}
+			found = true;
+			break;
+		}
+		pthread_mutex_unlock(&mg_device->lock);
+	}
+
+	return found;
+}
+
 dev_t
 mg_device_get_devno(mg_device_t mg_device)
 {
@@ -127,6 +278,29 @@ mg_device_get_fd(mg_device_t mg_device)
 	return fd;
 }
 
+struct mg_format
+mg_device_get_format(mg_device_t mg_device)
+{
+	struct mg_format format;
+	memset(&format, 0, sizeof(format));
+	VERIFY(mg_device) {
+		format = mg_device->format;
+	}
+
+	return format;
+}
+
+bool
+mg_device_get_mplane(mg_device_t mg_device)
+{
+	bool mplane = false;
+	VERIFY(mg_device) {
+		mplane = mg_device->mplane;
+	}
+
+	return mplane;
+}
+
 char *
 mg_device_get_name(mg_device_t mg_device)
 {
@@ -138,6 +312,23 @@ mg_device_get_name(mg_device_t mg_device)
 	return name;
 }
 
+bool
+mg_device_get_view(mg_device_t mg_device,
+		   struct mg_rect *roi,
+		   struct mg_format *format)
+{
+	bool cropped = false;
+	memset(roi, 0, sizeof(*roi));
+	memset(format, 0, sizeof(*format));
+	VERIFY(mg_device) {
+		*roi = mg_device->view.roi;
+		*format = mg_device->view.format;
+		cropped = mg_device->view.cropped;
+	}
+
+	return cropped;
+}
+
 unsigned int
 mg_device_get_no_bufs(mg_device_t mg_device)
 {
@@ -149,6 +340,18 @@ mg_device_get_no_bufs(mg_device_t mg_device)
 	return no_bufs;
 }
 
+mg_pool_t
+mg_device_get_pool(mg_device_t mg_device)
+{
+	mg_pool_t pool = 0;
+
+	VERIFY(mg_device) {
+		pool = mg_device->pool;
+	}
+
+	return pool;
+}
+
 void *
 mg_device_get_userptr(mg_device_t mg_device)
 {
@@ -160,6 +363,37 @@ mg_device_get_userptr(mg_device_t mg_device)
 	return userptr;
 }
 
+unsigned int
+mg_device_get_windows(mg_device_t mg_device,
+		      uint32_t sequence,
+		      struct mg_rect *window)
+{
+	unsigned int num_windows = 0;
+	VERIFY(mg_device) {
+		unsigned int sweep = mg_config_get_sweep(mg_device->config);
+		if (!sweep || sequence % sweep) {
+			pthread_mutex_lock(&mg_device->lock);
+			num_windows = mg_device->num_windows;
+			memcpy(window, mg_device->window,
+			       num_windows * sizeof(*window));
+			pthread_mutex_unlock(&mg_device->lock);
+		}
+	}
+
+	return num_windows;
+}
+
+int
+mg_device_get_worker(mg_device_t mg_device)
+{
+	int worker = -1;
+	VERIFY(mg_device) {
+		worker = mg_device->worker;
+	}
+
+	return worker;
+}
+
 int
 mg_device_open(mg_device_t mg_device)
 {
@@ -179,6 +413,340 @@ mg_device_open(mg_device_t mg_device)
 	return mg_device->fd;
 }
 
+mg_device_t
+mg_device_queue_control(mg_device_t mg_device,
+			uint32_t id,
+			int32_t value)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		pthread_mutex_lock(&mg_device->lock);
+		unsigned int i = 0;
+		while (i < mg_device->num_queued
+		       && mg_device->queued[i].id != id) {
+			i++;
+		}
+		if (i == mg_device->num_queued) {
+			struct mg_control *queued =
+				realloc(mg_device->queued,
+					(i + 1) * sizeof(*queued));
+			if (queued) {
+				mg_device->queued = queued;
+				mg_device->queued[i].id = id;
+				mg_device->num_queued++;
+			}
+		}
+		if (i < mg_device->num_queued) {
+			mg_device->queued[i].value = value;
+			p = mg_device;
+		}
+		pthread_mutex_unlock(&mg_device->lock);
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_queue_roi(mg_device_t mg_device,
+		    struct mg_rect roi)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		pthread_mutex_lock(&mg_device->lock);
+		mg_device->roi = roi;
+		mg_device->roi_queued = true;
+		pthread_mutex_unlock(&mg_device->lock);
+		p = mg_device;
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_restart(mg_device_t mg_device)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		pthread_mutex_lock(&mg_device->lock);
+		for (unsigned int i = 0; i < mg_device->num_controls; i++) {
+			mg_device->control[i].sequence = 0;
+		}
+		pthread_mutex_unlock(&mg_device->lock);
+		if (mg_device->next_pending) {
+			mg_device->view = mg_device->next;
+			mg_device->next_pending = false;
+		}
+		p = mg_device;
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_set_background(mg_device_t mg_device,
+			 mg_background_t background)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		if (background != mg_device->background) {
+			mg_background_destroy(mg_device->background);
+			mg_device->background = background;
+		}
+		p = mg_device;
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_set_bus_info(mg_device_t mg_device,
+		       const char *bus_info)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		FREEOBJ(mg_device->bus_info);
+		STRDUP(mg_device->bus_info, bus_info);
+		p = mg_device;
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_set_config(mg_device_t mg_device,
+		     mg_config_t config)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		mg_config_t copy = mg_config_copy(config);
+		if (copy) {
+			mg_config_destroy(mg_device->config);
+			mg_device->config = copy;
+		}
+		p = mg_device;
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_set_control(mg_device_t mg_device,
+		      uint32_t id,
+		      int32_t value,
+		      uint32_t sequence)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		pthread_mutex_lock(&mg_device->lock);
+		unsigned int i = 0;
+		while (i < mg_device->num_controls
+		       && mg_device->control[i].id != id) {
+			i++;
+		}
+		if (i == mg_device->num_controls) {
+			struct control *control =
+				realloc(mg_device->control,
+					(i + 1) * sizeof(*control));
+			if (control) {
+				mg_device->control = control;
+				mg_device->control[i].id = id;
+				mg_device->control[i].has_previous = false;
+				mg_device->num_controls++;
+			}
+		} else {
+			struct control *c = &mg_device->control[i];
+			c->previous = c->value;
+			c->has_previous = true;
+		}
+		if (i < mg_device->num_controls) {
+			struct control *c = &mg_device->control[i];
+			c->value = value;
+			c->sequence = sequence;
+			p = mg_device;
+		}
+		pthread_mutex_unlock(&mg_device->lock);
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_set_format(mg_device_t mg_device,
+		     struct mg_format format)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		mg_device->format = format;
+		memset(&mg_device->view, 0, sizeof(mg_device->view));
+		mg_device->view.format = format;
+		mg_device->next_pending = false;
+		p = mg_device;
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_set_mplane(mg_device_t mg_device,
+		     bool mplane)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		mg_device->mplane = mplane;
+		p = mg_device;
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_set_roi(mg_device_t mg_device,
+		  struct mg_rect roi,
+		  struct mg_format format,
+		  bool cropped,
+		  uint32_t sequence)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		mg_device->next.roi = roi;
+		mg_device->next.format = format;
+		mg_device->next.cropped = cropped;
+		mg_device->next_sequence = sequence;
+		mg_device->next_pending = true;
+		p = mg_device;
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_set_userptr(mg_device_t mg_device,
+		      void *userptr)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		mg_device->userptr = userptr;
+		p = mg_device;
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_set_windows(mg_device_t mg_device,
+		      const struct mg_rect *window,
+		      unsigned int num_windows)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		if (num_windows <= MG_MAX_WINDOWS) {
+			pthread_mutex_lock(&mg_device->lock);
+			if (num_windows) {
+				memcpy(mg_device->window, window,
+				       num_windows * sizeof(*window));
+			}
+			mg_device->num_windows = num_windows;
+			pthread_mutex_unlock(&mg_device->lock);
+			p = mg_device;
+		}
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_set_worker(mg_device_t mg_device,
+		     int worker)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		mg_device->worker = worker;
+		p = mg_device;
+	}
+
+	return p;
+}
+
+mg_device_t
+mg_device_settle_view(mg_device_t mg_device,
+		      uint32_t bytesused,
+		      uint32_t sequence)
+{
+	mg_device_t p = 0;
+	VERIFY(mg_device) {
+		uint32_t now = mg_device->view.format.sizeimage;
+		uint32_t later = mg_device->next.format.sizeimage;
+		bool settle = false;
+		if (!mg_device->next_pending) {
+			/* nothing to settle */
+		} else if (bytesused && now != later) {
+			/* the smaller image that holds the frame is its own */
+			settle = (later < now)
+				? bytesused <= later
+				: bytesused > now;
+		} else {
+			/* same image size, only the estimate is left */
+			settle = sequence >= mg_device->next_sequence;
+		}
+		if (settle) {
+			mg_device->view = mg_device->next;
+			mg_device->next_pending = false;
+		}
+		p = mg_device;
+	}
+
+	return p;
+}
+
+unsigned int
+mg_device_take_controls(mg_device_t mg_device,
+			struct mg_control *control,
+			unsigned int max)
+{
+	unsigned int n = 0;
+	VERIFY(mg_device) {
+		pthread_mutex_lock(&mg_device->lock);
+		n = mg_device->num_queued < max ? mg_device->num_queued : max;
+		memcpy(control, mg_device->queued, n * sizeof(*control));
+		memmove(mg_device->queued, mg_device->queued + n,
+			(mg_device->num_queued - n) * sizeof(*control));
+		mg_device->num_queued -= n;
+		pthread_mutex_unlock(&mg_device->lock);
+	}
+
+	return n;
+}
+
+int
+mg_device_take_fd(mg_device_t mg_device)
+{
+	int fd = -1;
+	VERIFY(mg_device) {
+		fd = mg_device->fd;
+		mg_device->fd = -1;
+	}
+
+	return fd;
+}
+
+bool
+mg_device_take_roi(mg_device_t mg_device,
+		   struct mg_rect *roi)
+{
+	bool queued = false;
+	VERIFY(mg_device) {
+		pthread_mutex_lock(&mg_device->lock);
+		queued = mg_device->roi_queued;
+		if (queued) {
+			*roi = mg_device->roi;
+			mg_device->roi_queued = false;
+		}
+		pthread_mutex_unlock(&mg_device->lock);
+	}
+
+	return queued;
+}
+
 #ifdef TEST_MULTI_GEE_MG_DEVICE
 
 #include <stdlib.h>
@@ -245,6 +813,207 @@ test_device(const char *name,
 		/* empty */
 	}
 
+	/* bus information is copied */
+	XASSERT(!mg_device_get_bus_info(dev)) {
+		/* empty */
+	}
+	char bus[] = "usb-0000:00:14.0-1";
+	dev = mg_device_set_bus_info(dev, bus);
+	bus[0] = 'x';
+	XASSERT(!strcmp(mg_device_get_bus_info(dev), "usb-0000:00:14.0-1")) {
+		/* empty */
+	}
+
+	/* single-planar until the capability test says otherwise */
+	XASSERT(!mg_device_get_mplane(dev)) {
+		/* empty */
+	}
+	dev = mg_device_set_mplane(dev, true);
+	XASSERT(mg_device_get_mplane(dev)) {
+		/* empty */
+	}
+
+	/* no worker until the first parallel frameset picks one */
+	XASSERT(-1 == mg_device_get_worker(dev)) {
+		/* empty */
+	}
+	dev = mg_device_set_worker(dev, 2);
+	XASSERT(2 == mg_device_get_worker(dev)) {
+		/* empty */
+	}
+
+	/* control changes queue up, the last value per control wins */
+	struct mg_control ctrl[4];
+	dev = mg_device_queue_control(dev, 0x980900, 10);
+	dev = mg_device_queue_control(dev, 0x980913, 20);
+	dev = mg_device_queue_control(dev, 0x980900, 30);
+	XASSERT(1 == mg_device_take_controls(dev, ctrl, 1)) {
+		/* empty */
+	}
+	XASSERT(ctrl[0].id == 0x980900 && ctrl[0].value == 30) {
+		/* empty */
+	}
+	XASSERT(1 == mg_device_take_controls(dev, ctrl, 4)) {
+		/* empty */
+	}
+	XASSERT(0 == mg_device_take_controls(dev, ctrl, 4)) {
+		/* empty */
+	}
+
+	/* a control value takes effect from its sequence number on */
+	int32_t value;
+	uint32_t since;
+	XASSERT(!mg_device_get_control(dev, 0x980900, 0, &value, &since)) {
+		/* empty */
+	}
+	dev = mg_device_set_control(dev, 0x980900, 30, 10);
+	dev = mg_device_set_control(dev, 0x980900, 40, 20);
+	XASSERT(mg_device_get_control(dev, 0x980900, 19, &value, &since)) {
+		/* empty */
+	}
+	XASSERT(value == 30 && since == 0) {
+		/* empty */
+	}
+	XASSERT(mg_device_get_control(dev, 0x980900, UINT32_MAX, &value, 0)) {
+		/* empty */
+	}
+	XASSERT(value == 40) {
+		/* empty */
+	}
+	XASSERT(mg_device_get_control(dev, 0x980900, 20, &value, &since)) {
+		/* empty */
+	}
+	XASSERT(value == 40 && since == 20) {
+		/* empty */
+	}
+
+	/* a new stream numbers its frames from 0 */
+	dev = mg_device_set_control(dev, 0x980900, 50, 30);
+	dev = mg_device_restart(dev);
+	XASSERT(mg_device_get_control(dev, 0x980900, 0, &value, &since)) {
+		/* empty */
+	}
+	XASSERT(value == 50 && since == 0) {
+		/* empty */
+	}
+
+	/* configuration is copied, format is stored */
+	mg_config_t config = mg_config_create();
+	config = mg_config_set_size(config, 320, 240);
+	dev = mg_device_set_config(dev, config);
+	config = mg_config_set_size(config, 160, 120);
+	XASSERT(mg_config_get_width(mg_device_get_config(dev)) == 320) {
+		/* empty */
+	}
+	config = mg_config_destroy(config);
+
+	struct mg_format format = {320, 240, 320, 320 * 240, 0, 1,
+				   1, {{320, 320 * 240}}};
+	XASSERT(mg_device_get_format(dev).sizeimage == 0) {
+		/* empty */
+	}
+	dev = mg_device_set_format(dev, format);
+	XASSERT(mg_device_get_format(dev).bytesperline == 320) {
+		/* empty */
+	}
+
+	/* a queued region of interest is taken once */
+	struct mg_rect roi = {10, 20, 30, 40};
+	struct mg_rect r;
+	XASSERT(!mg_device_take_roi(dev, &r)) {
+		/* empty */
+	}
+	dev = mg_device_queue_roi(dev, roi);
+	XASSERT(mg_device_take_roi(dev, &r) && r.left == 10) {
+		/* empty */
+	}
+	XASSERT(!mg_device_take_roi(dev, &r)) {
+		/* empty */
+	}
+
+	/* the hardware crop takes effect with the first frame of its size */
+	struct mg_format cropped = {30, 40, 32, 32 * 40, 0, 1,
+				    1, {{32, 32 * 40}}};
+	struct mg_format f;
+	dev = mg_device_set_roi(dev, roi, cropped, true, 100);
+	XASSERT(mg_device_get_cropped(dev)) {
+		/* empty */
+	}
+	dev = mg_device_settle_view(dev, 320 * 240, 101);
+	XASSERT(!mg_device_get_view(dev, &r, &f) && r.width == 0) {
+		/* empty */
+	}
+	XASSERT(f.bytesperline == 320) {
+		/* empty */
+	}
+	dev = mg_device_settle_view(dev, 32 * 40, 99);
+	XASSERT(mg_device_get_view(dev, &r, &f) && r.width == 30) {
+		/* empty */
+	}
+	XASSERT(f.bytesperline == 32) {
+		/* empty */
+	}
+	dev = mg_device_settle_view(dev, 320 * 240, 200);
+	XASSERT(mg_device_get_view(dev, &r, &f) && r.width == 30) {
+		/* empty */
+	}
+
+	/* a view on the full frame takes effect from its sequence number */
+	struct mg_rect full = {0, 0, 0, 0};
+	dev = mg_device_set_roi(dev, full, format, false, 300);
+	dev = mg_device_settle_view(dev, 320 * 240, 300);
+	XASSERT(!mg_device_get_view(dev, &r, &f) && f.bytesperline == 320) {
+		/* empty */
+	}
+	dev = mg_device_set_roi(dev, roi, format, false, 400);
+	dev = mg_device_settle_view(dev, 320 * 240, 399);
+	XASSERT(mg_device_get_view(dev, &r, &f) == false && r.width == 0) {
+		/* empty */
+	}
+	dev = mg_device_restart(dev);
+	XASSERT(!mg_device_get_view(dev, &r, &f) && r.width == 30) {
+		/* empty */
+	}
+
+	/* the user defined pointer can change */
+	dev = mg_device_set_userptr(dev, (void *) 0x1234);
+	XASSERT(mg_device_get_userptr(dev) == (void *) 0x1234) {
+		/* empty */
+	}
+	dev = mg_device_set_userptr(dev, userptr);
+
+	/* search windows, but for the sweep frames */
+	struct mg_rect window[MG_MAX_WINDOWS];
+	XASSERT(mg_device_get_windows(dev, 7, window) == 0) {
+		/* empty */
+	}
+	struct mg_rect predicted[2] = {{100, 50, 16, 16}, {300, 200, 20, 12}};
+	dev = mg_device_set_windows(dev, predicted, 2);
+	XASSERT(mg_device_get_windows(dev, 7, window) == 2) {
+		/* empty */
+	}
+	XASSERT(window[1].left == 300 && window[1].height == 12) {
+		/* empty */
+	}
+	XASSERT(mg_device_get_windows(dev, 50, window) == 0) {
+		/* empty */
+	}
+	XASSERT(!mg_device_set_windows(dev, window, MG_MAX_WINDOWS + 1)) {
+		/* empty */
+	}
+	dev = mg_device_set_windows(dev, 0, 0);
+	XASSERT(mg_device_get_windows(dev, 7, window) == 0) {
+		/* empty */
+	}
+
+	/* a taken file descriptor is left open */
+	XASSERT(mg_device_take_fd(dev) == fd && mg_device_get_fd(dev) == -1) {
+		/* empty */
+	}
+	XASSERT(-1 == fd || close(fd) == 0) {
+		/* empty */
+	}
+
 	/* destroy */
 	dev = mg_device_destroy(dev);
 
@@ -23,10 +23,23 @@
 #define ITL_MULTI_GEE_MG_DEVICE_H
 
 #include <multi-gee/log.h>
+#include <multi-gee/mg_background.h>
 #include <multi-gee/mg_buffer.h>
+#include <multi-gee/mg_config.h>
+#include <multi-gee/mg_image.h>
+#include <multi-gee/mg_pool.h>
 
 __BEGIN_DECLS
 
+/**
+ * @brief Control change
+ */
+struct mg_control
+{
+	uint32_t id; /**< video4linux2 control identifier, V4L2_CID_* */
+	int32_t value; /**< New value */
+};
+
 /**
  * @brief Multi-gee capture device object handle
  */
@@ -62,6 +75,16 @@ mg_device_create(const char *file,
 mg_device_t
 mg_device_destroy(mg_device_t device);
 
+/**
+ * @brief Background model accessor
+ *
+ * @param device  object handle
+ *
+ * @return the background model of the device's frames, or 0 if none
+ */
+mg_background_t
+mg_device_get_background(mg_device_t device);
+
 /**
  * @brief Device buffer container accessor
  *
@@ -72,6 +95,63 @@ mg_device_destroy(mg_device_t device);
 mg_buffer_t
 mg_device_get_buffer(mg_device_t device);
 
+/**
+ * @brief Bus information accessor
+ *
+ * @param device  object handle
+ *
+ * @return the bus position the driver reports, or 0 before the device
+ * is tested with fg_test_capability()
+ */
+char *
+mg_device_get_bus_info(mg_device_t device);
+
+/**
+ * @brief Device capture configuration accessor
+ *
+ * @param device  object handle
+ *
+ * @return configuration object handle, owned by the device
+ */
+mg_config_t
+mg_device_get_config(mg_device_t device);
+
+/**
+ * @brief Hardware cropping indicator
+ *
+ * @param device  object handle
+ *
+ * @return \c true if the latest region of interest is cropped by the
+ * hardware, else \c false
+ */
+bool
+mg_device_get_cropped(mg_device_t device);
+
+/**
+ * @brief Control value of a frame
+ *
+ * a control value set with mg_device_set_control() takes effect from
+ * its sequence number on.  frames with an earlier sequence number get
+ * the previous value.  safe to call from any thread.
+ *
+ * @param device  object handle
+ * @param id  control identifier
+ * @param sequence  frame sequence number, or UINT32_MAX for the latest
+ * value
+ * @param [out]value  control value of the frame
+ * @param [out]since  sequence number from which the value is in effect,
+ * 0 if not known, may be 0
+ *
+ * @return \c true if the control was set through the device, else
+ * \c false
+ */
+bool
+mg_device_get_control(mg_device_t device,
+		      uint32_t id,
+		      uint32_t sequence,
+		      int32_t *value,
+		      uint32_t *since);
+
 /**
  * @brief Device number accessor
  *
@@ -93,6 +173,27 @@ mg_device_get_devno(mg_device_t device);
 int
 mg_device_get_fd(mg_device_t device);
 
+/**
+ * @brief Negotiated capture format accessor
+ *
+ * @param device  object handle
+ *
+ * @return the capture format, all zero before the device is initialised
+ */
+struct mg_format
+mg_device_get_format(mg_device_t device);
+
+/**
+ * @brief Multi-planar API indicator
+ *
+ * @param device  object handle
+ *
+ * @return \c true if the device streams through the multi-planar
+ * buffer type, else \c false
+ */
+bool
+mg_device_get_mplane(mg_device_t device);
+
 /**
  * @brief Device name accessor
  *
@@ -103,6 +204,24 @@ mg_device_get_fd(mg_device_t device);
 char *
 mg_device_get_name(mg_device_t device);
 
+/**
+ * @brief Region of interest of the latest dequeued frame
+ *
+ * a region of interest set with mg_device_set_roi() is in effect once
+ * mg_device_settle_view() saw a frame captured with it.
+ *
+ * @param device  object handle
+ * @param [out]roi  region of interest, in full frame coordinates
+ * @param [out]format  format of the captured image
+ *
+ * @return \c true if the captured image holds only the region of
+ * interest, \c false if it holds the full frame
+ */
+bool
+mg_device_get_view(mg_device_t device,
+		   struct mg_rect *roi,
+		   struct mg_format *format);
+
 /**
  * @brief Query the number of capture buffers
  *
@@ -113,6 +232,16 @@ mg_device_get_name(mg_device_t device);
 unsigned int
 mg_device_get_no_bufs(mg_device_t device);
 
+/**
+ * @brief Derived image memory accessor
+ *
+ * @param device  object handle
+ *
+ * @return memory pool object handle, owned by the device
+ */
+mg_pool_t
+mg_device_get_pool(mg_device_t device);
+
 /**
  * @brief User defined pointer accessor
  *
@@ -123,6 +252,38 @@ mg_device_get_no_bufs(mg_device_t device);
 void *
 mg_device_get_userptr(mg_device_t device);
 
+/**
+ * @brief Search windows accessor
+ *
+ * frames with a sequence number that is a multiple of the sweep
+ * interval of the device's configuration get no windows, see
+ * mg_config_set_sweep().
+ *
+ * @param device  object handle
+ * @param sequence  sequence number of the frame
+ * @param [out]window  search windows, room for MG_MAX_WINDOWS
+ *
+ * @return the number of search windows, 0 if the full frame is to be
+ * searched
+ */
+unsigned int
+mg_device_get_windows(mg_device_t device,
+		      uint32_t sequence,
+		      struct mg_rect *window);
+
+/**
+ * @brief Worker accessor
+ *
+ * see mg_frameset_parallel_for().
+ *
+ * @param device  object handle
+ *
+ * @return the pool worker the device's frames are processed on, or -1
+ * if none has been picked yet
+ */
+int
+mg_device_get_worker(mg_device_t device);
+
 /**
  * @brief Open device
  *
@@ -139,6 +300,266 @@ mg_device_get_userptr(mg_device_t device);
 int
 mg_device_open(mg_device_t device);
 
+/**
+ * @brief Queue a control change
+ *
+ * the value replaces any value queued before for the same control,
+ * until it is taken with mg_device_take_controls().  safe to call from
+ * any thread.
+ *
+ * @param device  object handle
+ * @param id  control identifier
+ * @param value  new value
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_queue_control(mg_device_t device,
+			uint32_t id,
+			int32_t value);
+
+/**
+ * @brief Queue a region of interest
+ *
+ * the region replaces any region queued before, until it is taken
+ * with mg_device_take_roi().  safe to call from any thread.
+ *
+ * @param device  object handle
+ * @param roi  region of interest, in full frame coordinates
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_queue_roi(mg_device_t device,
+		    struct mg_rect roi);
+
+/**
+ * @brief Restart the frame sequence numbers
+ *
+ * the driver numbers frames from 0 again after VIDIOC_STREAMON.  controls
+ * and the region of interest set so far apply to every frame of the next
+ * stream.
+ *
+ * @param device  object handle
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_restart(mg_device_t device);
+
+/**
+ * @brief Set the background model
+ *
+ * the device takes the model over, and destroys it when it is replaced
+ * or the device is destroyed.
+ *
+ * @param device  object handle
+ * @param background  background model, or 0 for none
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_set_background(mg_device_t device,
+			 mg_background_t background);
+
+/**
+ * @brief Set the bus information
+ *
+ * the device keeps a copy of the string.
+ *
+ * @param device  object handle
+ * @param bus_info  bus position the driver reports
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_set_bus_info(mg_device_t device,
+		       const char *bus_info);
+
+/**
+ * @brief Record a control value
+ *
+ * @param device  object handle
+ * @param id  control identifier
+ * @param value  value set on the hardware
+ * @param sequence  sequence number of the first frame captured with the
+ * value
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_set_control(mg_device_t device,
+		      uint32_t id,
+		      int32_t value,
+		      uint32_t sequence);
+
+/**
+ * @brief Set the capture configuration
+ *
+ * the device keeps a copy of the configuration.
+ *
+ * @param device  object handle
+ * @param config  configuration object handle
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_set_config(mg_device_t device,
+		     mg_config_t config);
+
+/**
+ * @brief Set the negotiated capture format
+ *
+ * also resets the region of interest to the full frame.
+ *
+ * @param device  object handle
+ * @param format  capture format
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_set_format(mg_device_t device,
+		     struct mg_format format);
+
+/**
+ * @brief Set the multi-planar API indicator
+ *
+ * set by fg_test_capability() for devices that only offer the
+ * multi-planar buffer type.
+ *
+ * @param device  object handle
+ * @param mplane  stream through the multi-planar buffer type?
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_set_mplane(mg_device_t device,
+		     bool mplane);
+
+/**
+ * @brief Set the region of interest
+ *
+ * @param device  object handle
+ * @param roi  region of interest, in full frame coordinates
+ * @param format  format of the captured image
+ * @param cropped  \c true if the hardware crops to the region
+ * @param sequence  estimated sequence number of the first frame
+ * captured with the region of interest, used only when the image size
+ * does not change
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_set_roi(mg_device_t device,
+		  struct mg_rect roi,
+		  struct mg_format format,
+		  bool cropped,
+		  uint32_t sequence);
+
+/**
+ * @brief Set the user defined pointer
+ *
+ * @param device  object handle
+ * @param userptr  user defined pointer
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_set_userptr(mg_device_t device,
+		      void *userptr);
+
+/**
+ * @brief Set the search windows
+ *
+ * the windows apply to the frames created from then on.  may be called
+ * from any thread.
+ *
+ * @param device  object handle
+ * @param window  search windows, in full frame coordinates
+ * @param num_windows  number of search windows, at most MG_MAX_WINDOWS,
+ * 0 to search the full frame
+ *
+ * @return object handle, or 0 if there are too many windows
+ */
+mg_device_t
+mg_device_set_windows(mg_device_t device,
+		      const struct mg_rect *window,
+		      unsigned int num_windows);
+
+/**
+ * @brief Set the worker
+ *
+ * @param device  object handle
+ * @param worker  pool worker the device's frames are processed on, or
+ * -1 to let mg_frameset_parallel_for() pick one
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_set_worker(mg_device_t device,
+		     int worker);
+
+/**
+ * @brief Put the region of interest of a dequeued frame in effect
+ *
+ * frames are dequeued in order, so once a frame shows the geometry of
+ * the region set with mg_device_set_roi(), so do all later frames.  a
+ * hardware crop that changes the image size is told by the bytes the
+ * driver filled in; otherwise the region's sequence number decides.
+ *
+ * @param device  object handle
+ * @param bytesused  bytes of the frame's first plane, or 0 if unknown
+ * @param sequence  frame sequence number
+ *
+ * @return object handle
+ */
+mg_device_t
+mg_device_settle_view(mg_device_t device,
+		      uint32_t bytesused,
+		      uint32_t sequence);
+
+/**
+ * @brief Take the queued control changes
+ *
+ * changes that do not fit stay queued.
+ *
+ * @param device  object handle
+ * @param [out]control  control changes, in the order they were first
+ * queued
+ * @param max  number of entries in \a control
+ *
+ * @return number of control changes taken
+ */
+unsigned int
+mg_device_take_controls(mg_device_t device,
+			struct mg_control *control,
+			unsigned int max);
+
+/**
+ * @brief Take the file descriptor
+ *
+ * the caller closes the file descriptor; mg_device_destroy() no longer
+ * does.
+ *
+ * @param device  object handle
+ *
+ * @return file descriptor, or -1 if the device is not open
+ */
+int
+mg_device_take_fd(mg_device_t device);
+
+/**
+ * @brief Take the queued region of interest
+ *
+ * @param device  object handle
+ * @param [out]roi  region of interest
+ *
+ * @return \c true if a region of interest was queued, else \c false
+ */
+bool
+mg_device_take_roi(mg_device_t device,
+		   struct mg_rect *roi);
+
 __END_DECLS
 
 #endif /* ITL_MULTI_GEE_MG_DEVICE_H */
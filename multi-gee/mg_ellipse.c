@@ -0,0 +1,483 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee ellipse fitting definition
+ */
+#include <math.h> /* atan2f */
+
+#include "mg_ellipse.h" /* declarations implemented */
+
+#ifdef MG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Number of blobs the kernels fit per step
+ */
+#define CHUNK 64
+
+/**
+ * @brief Variance of a unit square along an axis
+ *
+ * the moments of a blob treat its pixels as points; adding this makes
+ * them those of the squares the pixels cover.
+ */
+#define PIXEL_VARIANCE (1.0f / 12)
+
+/**
+ * @brief Fit the axes and quality of blobs
+ *
+ * @param area  blob areas
+ * @param xx  column variances
+ * @param xy  covariances
+ * @param yy  line variances
+ * @param major  semi-major axes to fill in
+ * @param minor  semi-minor axes to fill in
+ * @param quality  qualities to fill in
+ * @param n  number of blobs
+ */
+typedef void (*fit_fn)(const uint32_t *area,
+		       const float *xx,
+		       const float *xy,
+		       const float *yy,
+		       float *major,
+		       float *minor,
+		       float *quality,
+		       unsigned int n);
+
+static
+void
+fit_scalar(const uint32_t *area,
+	   const float *xx,
+	   const float *xy,
+	   const float *yy,
+	   float *major,
+	   float *minor,
+	   float *quality,
+	   unsigned int n)
+{
+	for (unsigned int i = 0; i < n; i++) {
+		/* eigenvalues of the covariance matrix */
+		float h = (xx[i] + yy[i]) / 2 + PIXEL_VARIANCE;
+		float d = (xx[i] - yy[i]) / 2;
+		float r = sqrtf(d * d + xy[i] * xy[i]);
+		float l2 = (h - r > 0) ? h - r : 0;
+
+		/* a filled ellipse has variance a^2 / 4 along axis a */
+		major[i] = 2 * sqrtf(h + r);
+		minor[i] = 2 * sqrtf(l2);
+
+		float a = area[i];
+		float e = (float) M_PI * major[i] * minor[i];
+		quality[i] = (a < e) ? a / e : e / a;
+	}
+}
+
+#ifdef MG_SIMD_X86
+
+MG_TARGET_SSE2
+static
+void
+fit_sse2(const uint32_t *area,
+	 const float *xx,
+	 const float *xy,
+	 const float *yy,
+	 float *major,
+	 float *minor,
+	 float *quality,
+	 unsigned int n)
+{
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 two = _mm_set1_ps(2);
+	const __m128 pixel = _mm_set1_ps(PIXEL_VARIANCE);
+	const __m128 pi = _mm_set1_ps(M_PI);
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128 vxx = _mm_loadu_ps(xx + i);
+		__m128 vxy = _mm_loadu_ps(xy + i);
+		__m128 vyy = _mm_loadu_ps(yy + i);
+		__m128 h = _mm_add_ps(_mm_mul_ps(_mm_add_ps(vxx, vyy), half),
+				      pixel);
+		__m128 d = _mm_mul_ps(_mm_sub_ps(vxx, vyy), half);
+		__m128 r = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(d, d),
+						  _mm_mul_ps(vxy, vxy)));
+		__m128 l2 = _mm_max_ps(_mm_sub_ps(h, r), _mm_setzero_ps());
+		__m128 a1 = _mm_mul_ps(two, _mm_sqrt_ps(_mm_add_ps(h, r)));
+		__m128 a2 = _mm_mul_ps(two, _mm_sqrt_ps(l2));
+		_mm_storeu_ps(major + i, a1);
+		_mm_storeu_ps(minor + i, a2);
+
+		__m128 a = _mm_cvtepi32_ps(
+			_mm_loadu_si128((const __m128i *) (area + i)));
+		__m128 e = _mm_mul_ps(_mm_mul_ps(pi, a1), a2);
+		_mm_storeu_ps(quality + i, _mm_div_ps(_mm_min_ps(a, e),
+						      _mm_max_ps(a, e)));
+	}
+	if (i < n) {
+		fit_scalar(area + i, xx + i, xy + i, yy + i,
+			   major + i, minor + i, quality + i, n - i);
+	}
+}
+
+MG_TARGET_AVX2
+static
+void
+fit_avx2(const uint32_t *area,
+	 const float *xx,
+	 const float *xy,
+	 const float *yy,
+	 float *major,
+	 float *minor,
+	 float *quality,
+	 unsigned int n)
+{
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 two = _mm256_set1_ps(2);
+	const __m256 pixel = _mm256_set1_ps(PIXEL_VARIANCE);
+	const __m256 pi = _mm256_set1_ps(M_PI);
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 vxx = _mm256_loadu_ps(xx + i);
+		__m256 vxy = _mm256_loadu_ps(xy + i);
+		__m256 vyy = _mm256_loadu_ps(yy + i);
+		__m256 h = _mm256_add_ps(
+			_mm256_mul_ps(_mm256_add_ps(vxx, vyy), half), pixel);
+		__m256 d = _mm256_mul_ps(_mm256_sub_ps(vxx, vyy), half);
+		__m256 r = _mm256_sqrt_ps(
+			_mm256_add_ps(_mm256_mul_ps(d, d),
+				      _mm256_mul_ps(vxy, vxy)));
+		__m256 l2 = _mm256_max_ps(_mm256_sub_ps(h, r),
+					  _mm256_setzero_ps());
+		__m256 a1 = _mm256_mul_ps(two,
+					  _mm256_sqrt_ps(_mm256_add_ps(h, r)));
+		__m256 a2 = _mm256_mul_ps(two, _mm256_sqrt_ps(l2));
+		_mm256_storeu_ps(major + i, a1);
+		_mm256_storeu_ps(minor + i, a2);
+
+		__m256 a = _mm256_cvtepi32_ps(
+			_mm256_loadu_si256((const __m256i *) (area + i)));
+		__m256 e = _mm256_mul_ps(_mm256_mul_ps(pi, a1), a2);
+		_mm256_storeu_ps(quality + i,
+				 _mm256_div_ps(_mm256_min_ps(a, e),
+					       _mm256_max_ps(a, e)));
+	}
+	if (i < n) {
+		fit_sse2(area + i, xx + i, xy + i, yy + i,
+			 major + i, minor + i, quality + i, n - i);
+	}
+}
+
+/**
+ * @brief Fit kernel per instruction set level
+ */
+static const fit_fn fit_blobs[] = {
+	fit_scalar,
+	fit_sse2,
+	fit_avx2
+};
+
+#else /* MG_SIMD_X86 */
+
+static const fit_fn fit_blobs[] = {
+	fit_scalar,
+	fit_scalar,
+	fit_scalar
+};
+
+#endif /* MG_SIMD_X86 */
+
+/**
+ * @brief Grey-weighted centroid around a blob
+ *
+ * leaves the centre alone if no pixel is above the level.
+ *
+ * @param image  image the blob was found in
+ * @param table  blobs
+ * @param i  blob
+ * @param level  threshold level
+ * @param ellipse  ellipse of the blob
+ */
+static
+void
+grey_centre(const struct mg_image *image,
+	    const struct mg_blob_table *table,
+	    unsigned int i,
+	    uint8_t level,
+	    struct mg_ellipse *ellipse)
+{
+	uint32_t left = table->left[i] ? table->left[i] - 1u : 0;
+	uint32_t top = table->top[i] ? table->top[i] - 1u : 0;
+	uint32_t right = table->right[i] + 1u;
+	uint32_t bottom = table->bottom[i] + 1u;
+	if (right >= image->width) {
+		right = image->width - 1;
+	}
+	if (bottom >= image->height) {
+		bottom = image->height - 1;
+	}
+
+	uint64_t sw = 0;
+	uint64_t sx = 0;
+	uint64_t sy = 0;
+	for (uint32_t y = top; y <= bottom; y++) {
+		const uint8_t *line = (const uint8_t *) image->data
+			+ (size_t) y * image->stride;
+		uint64_t lw = 0;
+		for (uint32_t x = left; x <= right; x++) {
+			/* a pixel at the level still counts */
+			uint32_t w = (line[x] >= level) ? line[x] - level + 1u : 0;
+			lw += w;
+			sx += (uint64_t) w * x;
+		}
+		sw += lw;
+		sy += lw * y;
+	}
+
+	if (sw) {
+		ellipse->x = (double) sx / sw;
+		ellipse->y = (double) sy / sw;
+	}
+}
+
+unsigned int
+mg_ellipse_fit(const struct mg_blob_table *table,
+	       struct mg_ellipse *ellipse,
+	       unsigned int max,
+	       enum mg_simd simd)
+{
+	if (!table) {
+		return 0;
+	}
+
+	if (simd > mg_simd_detect()) {
+		simd = mg_simd_detect();
+	}
+
+	unsigned int n = (table->count < max) ? table->count : max;
+	for (unsigned int b = 0; b < n; b += CHUNK) {
+		unsigned int m = (n - b < CHUNK) ? n - b : CHUNK;
+		float major[CHUNK];
+		float minor[CHUNK];
+		float quality[CHUNK];
+		fit_blobs[simd](table->area + b,
+				table->xx + b, table->xy + b, table->yy + b,
+				major, minor, quality, m);
+
+		for (unsigned int i = 0; i < m; i++) {
+			struct mg_ellipse *e = &ellipse[b + i];
+			e->x = table->x[b + i];
+			e->y = table->y[b + i];
+			e->major = major[i];
+			e->minor = minor[i];
+			e->angle = 0.5f * atan2f(2 * table->xy[b + i],
+						 table->xx[b + i]
+						 - table->yy[b + i]);
+			e->quality = quality[i];
+		}
+	}
+
+	return table->count;
+}
+
+unsigned int
+mg_ellipse_fit_grey(const struct mg_image *image,
+		    const struct mg_blob_table *table,
+		    uint8_t level,
+		    struct mg_ellipse *ellipse,
+		    unsigned int max,
+		    enum mg_simd simd)
+{
+	unsigned int count = mg_ellipse_fit(table, ellipse, max, simd);
+
+	if (image && image->data && image->width && image->height) {
+		unsigned int n = (count < max) ? count : max;
+		for (unsigned int i = 0; i < n; i++) {
+			grey_centre(image, table, i, level, &ellipse[i]);
+		}
+	}
+
+	return count;
+}
+
+#ifdef TEST_MULTI_GEE_MG_ELLIPSE
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static
+bool
+near(double a,
+     double b,
+     double tolerance)
+{
+	return fabs(a - b) <= tolerance;
+}
+
+/**
+ * @brief Draw a filled ellipse, or a ring of it
+ */
+static
+void
+draw(uint8_t *pixel,
+     unsigned int stride,
+     double cx,
+     double cy,
+     double a,
+     double b,
+     double angle,
+     double hole)
+{
+	double c = cos(angle);
+	double s = sin(angle);
+	for (int y = (int) (cy - a - 1); y <= (int) (cy + a + 1); y++) {
+		for (int x = (int) (cx - a - 1); x <= (int) (cx + a + 1); x++) {
+			double u = ((x - cx) * c + (y - cy) * s) / a;
+			double v = (-(x - cx) * s + (y - cy) * c) / b;
+			double r = u * u + v * v;
+			if (r <= 1 && r >= hole * hole) {
+				pixel[y * stride + x] = 255;
+			}
+		}
+	}
+}
+
+void
+mg_ellipse_test()
+{
+	enum { W = 128, H = 64 };
+	static uint8_t pixel[W * H];
+	draw(pixel, W, 20, 20, 12, 12, 0, 0);
+	draw(pixel, W, 60, 30, 16, 6, M_PI / 6, 0);
+	draw(pixel, W, 100, 30, 14, 14, 0, 0.85);
+	struct mg_image image = {pixel, W, H, W};
+
+	static struct mg_span span[W * H];
+	unsigned int n = mg_threshold(&image, 128, span, W * H,
+				      MG_SIMD_SCALAR);
+	mg_blobs_t blobs = mg_blobs_create();
+	XASSERT(3 == mg_blobs_label(blobs, span, n, 1)) {
+		/* empty */
+	}
+	const struct mg_blob_table *t = mg_blobs_get_table(blobs);
+
+	struct mg_ellipse e[3];
+	XASSERT(3 == mg_ellipse_fit(t, e, 3, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+
+	/* a disk is a good marker */
+	XASSERT(near(e[0].x, 20, 1e-3) && near(e[0].y, 20, 1e-3)) {
+		/* empty */
+	}
+	XASSERT(near(e[0].major, 12, 0.3) && near(e[0].minor, 12, 0.3)) {
+		/* empty */
+	}
+	XASSERT(e[0].quality > 0.97) {
+		/* empty */
+	}
+
+	/* a ring is not, it starts on a higher line than the slanted one */
+	XASSERT(e[1].quality < 0.5) {
+		/* empty */
+	}
+
+	/* a slanted ellipse is a good marker too */
+	XASSERT(near(e[2].major, 16, 0.3) && near(e[2].minor, 6, 0.3)) {
+		/* empty */
+	}
+	XASSERT(near(e[2].angle, M_PI / 6, 0.02) && e[2].quality > 0.97) {
+		/* empty */
+	}
+
+	/* the table may hold more blobs than the array */
+	struct mg_ellipse one[2];
+	memset(one, 0, sizeof(one));
+	XASSERT(3 == mg_ellipse_fit(t, one, 1, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(one[0].x == e[0].x && one[1].x == 0) {
+		/* empty */
+	}
+
+	/* every kernel fits alike, over whole vectors and tails */
+	enum { N = 37 };
+	uint32_t area[N];
+	float mx[N];
+	float my[N];
+	float xx[N];
+	float xy[N];
+	float yy[N];
+	for (unsigned int i = 0; i < N; i++) {
+		area[i] = 1 + rand() % 400;
+		mx[i] = rand() % 700;
+		my[i] = rand() % 500;
+		xx[i] = (rand() % 1000) / 10.0f;
+		yy[i] = (rand() % 1000) / 10.0f;
+		xy[i] = ((rand() % 1000) / 1000.0f - 0.5f)
+			* sqrtf(xx[i] * yy[i]);
+	}
+	struct mg_blob_table random = {
+		N, area, 0, 0, 0, 0, mx, my, xx, xy, yy
+	};
+	struct mg_ellipse ref[N];
+	XASSERT(N == mg_ellipse_fit(&random, ref, N, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	for (int simd = MG_SIMD_SSE2; simd <= (int) mg_simd_detect();
+	     simd++) {
+		struct mg_ellipse got[N];
+		mg_ellipse_fit(&random, got, N, simd);
+		for (unsigned int i = 0; i < N; i++) {
+			XASSERT(near(got[i].major, ref[i].major, 1e-4)
+				&& near(got[i].minor, ref[i].minor, 1e-4)
+				&& near(got[i].quality, ref[i].quality, 1e-5)
+				&& got[i].angle == ref[i].angle) {
+				/* empty */
+			}
+		}
+	}
+
+	/* grey weights pull the centre towards the bright side */
+	memset(pixel, 0, sizeof(pixel));
+	pixel[10 * W + 10] = 255;
+	pixel[10 * W + 11] = 129;
+	pixel[10 * W + 12] = 100;
+	n = mg_threshold(&image, 128, span, W * H, MG_SIMD_SCALAR);
+	XASSERT(1 == mg_blobs_label(blobs, span, n, 1)) {
+		/* empty */
+	}
+	XASSERT(1 == mg_ellipse_fit_grey(&image, t, 128, e, 3,
+					 MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(near(e[0].x, 10 + 2.0 / 130, 1e-5) && near(e[0].y, 10, 0)) {
+		/* empty */
+	}
+
+	blobs = mg_blobs_destroy(blobs);
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_ellipse_test));
+}
+
+#endif /* TEST_MULTI_GEE_MG_ELLIPSE */
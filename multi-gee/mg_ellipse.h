@@ -0,0 +1,106 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee ellipse fitting declaration
+ *
+ * Markers are round, and show up as ellipses in the image.  The fitter
+ * takes the moments of a blob table and works out the centre, axes and
+ * orientation of the ellipse with the same moments, for many blobs at
+ * once.  The quality of a fit compares the blob to that ellipse, so
+ * damaged, merged or partly hidden markers can be dropped before they
+ * are matched between cameras.
+ */
+#ifndef ITL_MULTI_GEE_MG_ELLIPSE_H
+#define ITL_MULTI_GEE_MG_ELLIPSE_H
+
+#include <stdint.h> /* uint8_t */
+
+#include <multi-gee/mg_blobs.h>
+#include <multi-gee/mg_image.h>
+#include <multi-gee/mg_simd.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Ellipse fitted to a blob
+ *
+ * pixels are taken to be unit squares, with their centres on whole
+ * numbers.
+ */
+struct mg_ellipse
+{
+	float x; /**< Centre column */
+	float y; /**< Centre line */
+	float major; /**< Semi-major axis */
+	float minor; /**< Semi-minor axis */
+	float angle; /**< Major axis direction, from columns towards lines,
+		       in radians from -pi/2 to pi/2 */
+	float quality; /**< Blob area over ellipse area, or the inverse if
+			 that is smaller: 1 for a perfect ellipse */
+};
+
+/**
+ * @brief Fit ellipses to blobs
+ *
+ * the ellipse of a blob has the same area-normalised second moments as
+ * the blob.  ellipse i belongs to blob i of the table.
+ *
+ * @param table  blobs, as mg_blobs_get_table() returns
+ * @param ellipse  array to fill in
+ * @param max  number of ellipses the array holds
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return the number of blobs, of which at most @a max are fitted
+ */
+unsigned int
+mg_ellipse_fit(const struct mg_blob_table *table,
+	       struct mg_ellipse *ellipse,
+	       unsigned int max,
+	       enum mg_simd simd);
+
+/**
+ * @brief Fit ellipses to blobs, with grey-weighted centres
+ *
+ * as mg_ellipse_fit(), but the centre of an ellipse is the centroid of
+ * the pixels around its blob, weighted by how far they are above the
+ * threshold level.  this follows the brightness profile of a marker to
+ * a fraction of a pixel, where the binary centroid moves a whole pixel
+ * at a time as edge pixels cross the level.  pixels of other blobs
+ * inside the bounding box, grown by one pixel, are counted too.
+ *
+ * @param image  image the blobs were found in
+ * @param table  blobs, as mg_blobs_get_table() returns
+ * @param level  threshold level the blobs were found with
+ * @param ellipse  array to fill in
+ * @param max  number of ellipses the array holds
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return the number of blobs, of which at most @a max are fitted
+ */
+unsigned int
+mg_ellipse_fit_grey(const struct mg_image *image,
+		    const struct mg_blob_table *table,
+		    uint8_t level,
+		    struct mg_ellipse *ellipse,
+		    unsigned int max,
+		    enum mg_simd simd);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_ELLIPSE_H */
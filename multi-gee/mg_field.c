@@ -0,0 +1,362 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee interlaced field definition
+ */
+#include <string.h> /* memcpy */
+
+#include <stdlib.h> /* struct timeval, needed for videodev2.h */
+#include <asm/types.h> /* needed for videodev2.h */
+#include <linux/videodev2.h>
+
+#include "mg_field.h" /* declarations implemented */
+
+#ifdef MG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Field period of 625 line standards, in microseconds
+ */
+#define FIELD_PERIOD_625 20000
+/**
+ * @brief Field period of 525 line standards, in microseconds
+ */
+#define FIELD_PERIOD_525 16683
+
+/**
+ * @brief Mean of two lines
+ *
+ * @param a  first line
+ * @param b  second line
+ * @param dst  destination line
+ * @param n  number of pixels
+ */
+typedef void (*mean_fn)(const uint8_t *a,
+			const uint8_t *b,
+			uint8_t *dst,
+			uint32_t n);
+
+static
+void
+mean_row_scalar(const uint8_t *a,
+		const uint8_t *b,
+		uint8_t *dst,
+		uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		dst[i] = (a[i] + b[i] + 1) >> 1;
+	}
+}
+
+#ifdef MG_SIMD_X86
+
+MG_TARGET_SSE2
+static
+void
+mean_row_sse2(const uint8_t *a,
+	      const uint8_t *b,
+	      uint8_t *dst,
+	      uint32_t n)
+{
+	uint32_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m128i x = _mm_loadu_si128((const __m128i *) (a + i));
+		__m128i y = _mm_loadu_si128((const __m128i *) (b + i));
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_avg_epu8(x, y));
+	}
+	mean_row_scalar(a + i, b + i, dst + i, n - i);
+}
+
+MG_TARGET_AVX2
+static
+void
+mean_row_avx2(const uint8_t *a,
+	      const uint8_t *b,
+	      uint8_t *dst,
+	      uint32_t n)
+{
+	uint32_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (a + i));
+		__m256i y = _mm256_loadu_si256((const __m256i *) (b + i));
+		_mm256_storeu_si256((__m256i *) (dst + i),
+				    _mm256_avg_epu8(x, y));
+	}
+	mean_row_sse2(a + i, b + i, dst + i, n - i);
+}
+
+/**
+ * @brief Mean kernel per instruction set level
+ */
+static const mean_fn mean_row[] = {
+	mean_row_scalar,
+	mean_row_sse2,
+	mean_row_avx2
+};
+
+#else /* MG_SIMD_X86 */
+
+static const mean_fn mean_row[] = {
+	mean_row_scalar,
+	mean_row_scalar,
+	mean_row_scalar
+};
+
+#endif /* MG_SIMD_X86 */
+
+struct mg_image
+mg_field_view(const struct mg_image *frame,
+	      uint32_t field_order,
+	      enum mg_field field)
+{
+	struct mg_image view = *frame;
+	view.height = frame->height / 2;
+
+	switch (field_order) {
+	case V4L2_FIELD_SEQ_TB:
+		if (MG_FIELD_BOTTOM == field) {
+			view.data = (uint8_t *) frame->data
+				+ (size_t) view.height * frame->stride;
+		}
+		break;
+	case V4L2_FIELD_SEQ_BT:
+		if (MG_FIELD_TOP == field) {
+			view.data = (uint8_t *) frame->data
+				+ (size_t) view.height * frame->stride;
+		}
+		break;
+	default:
+		if (MG_FIELD_BOTTOM == field) {
+			view.data = (uint8_t *) frame->data + frame->stride;
+		}
+		view.stride = 2 * frame->stride;
+		break;
+	}
+
+	return view;
+}
+
+struct timeval
+mg_field_timestamp(struct timeval timestamp,
+		   uint32_t field_order,
+		   uint64_t standard,
+		   enum mg_field field)
+{
+	bool is_525 = standard && !(standard & ~(uint64_t) V4L2_STD_525_60);
+	enum mg_field first;
+
+	switch (field_order) {
+	case V4L2_FIELD_INTERLACED:
+		first = is_525 ? MG_FIELD_BOTTOM : MG_FIELD_TOP;
+		break;
+	case V4L2_FIELD_INTERLACED_TB:
+	case V4L2_FIELD_SEQ_TB:
+		first = MG_FIELD_TOP;
+		break;
+	case V4L2_FIELD_INTERLACED_BT:
+	case V4L2_FIELD_SEQ_BT:
+		first = MG_FIELD_BOTTOM;
+		break;
+	default:
+		/* progressive */
+		return timestamp;
+	}
+
+	if (field != first) {
+		struct timeval period = {
+			0, is_525 ? FIELD_PERIOD_525 : FIELD_PERIOD_625
+		};
+		timeradd(&timestamp, &period, &timestamp);
+	}
+
+	return timestamp;
+}
+
+void
+mg_field_deinterlace(const struct mg_image *src,
+		     enum mg_field field,
+		     enum mg_deinterlace method,
+		     const struct mg_image *dst,
+		     enum mg_simd simd)
+{
+	if (simd > mg_simd_detect()) {
+		simd = mg_simd_detect();
+	}
+
+	const uint8_t *s = src->data;
+	uint8_t *d = dst->data;
+	uint32_t parity = (MG_FIELD_BOTTOM == field) ? 1 : 0;
+	uint32_t width = dst->width;
+
+	for (uint32_t y = 0; y < dst->height; y++) {
+		uint8_t *line = d + (size_t) y * dst->stride;
+
+		if ((y & 1) == parity) {
+			uint32_t k = (y - parity) / 2;
+			memcpy(line, s + (size_t) k * src->stride, width);
+			continue;
+		}
+
+		/* the neighbouring lines belong to the field */
+		const uint8_t *above = 0;
+		const uint8_t *below = 0;
+		if (y > 0) {
+			above = s + (size_t) ((y - 1 - parity) / 2) * src->stride;
+		}
+		if ((y + 1 - parity) / 2 < src->height) {
+			below = s + (size_t) ((y + 1 - parity) / 2) * src->stride;
+		}
+		if (!above) {
+			above = below;
+		}
+		if (!below) {
+			below = above;
+		}
+
+		if (MG_DEINTERLACE_DOUBLE == method || above == below) {
+			memcpy(line, above, width);
+		} else {
+			mean_row[simd](above, below, line, width);
+		}
+	}
+}
+
+#ifdef TEST_MULTI_GEE_MG_FIELD
+
+#include <stdio.h>
+
+USE_XASSERT
+
+void
+mg_field()
+{
+	printf("%s: %s\n", __func__, mg_simd_name(mg_simd_detect()));
+
+	/* line y of the frame holds the value y */
+	uint8_t frame[8 * 4];
+	for (unsigned int i = 0; i < sizeof(frame); i++) {
+		frame[i] = 10 * (i / 4);
+	}
+	struct mg_image image = {frame, 4, 8, 4};
+
+	struct mg_image top = mg_field_view(&image, V4L2_FIELD_INTERLACED,
+					    MG_FIELD_TOP);
+	struct mg_image bottom = mg_field_view(&image, V4L2_FIELD_INTERLACED,
+					       MG_FIELD_BOTTOM);
+	XASSERT(top.height == 4 && top.stride == 8) {
+		/* empty */
+	}
+	XASSERT(((uint8_t *) top.data)[top.stride] == 20) {
+		/* empty */
+	}
+	XASSERT(((uint8_t *) bottom.data)[bottom.stride] == 30) {
+		/* empty */
+	}
+
+	struct mg_image seq = mg_field_view(&image, V4L2_FIELD_SEQ_TB,
+					    MG_FIELD_BOTTOM);
+	XASSERT(seq.data == frame + 16 && seq.stride == 4) {
+		/* empty */
+	}
+	seq = mg_field_view(&image, V4L2_FIELD_SEQ_BT, MG_FIELD_BOTTOM);
+	XASSERT(seq.data == frame && seq.height == 4) {
+		/* empty */
+	}
+
+	/* field times */
+	struct timeval tv = {10, 990000};
+	struct timeval t;
+	t = mg_field_timestamp(tv, V4L2_FIELD_INTERLACED, V4L2_STD_PAL,
+			       MG_FIELD_BOTTOM);
+	XASSERT(t.tv_sec == 11 && t.tv_usec == 10000) {
+		/* empty */
+	}
+	t = mg_field_timestamp(tv, V4L2_FIELD_INTERLACED, V4L2_STD_PAL,
+			       MG_FIELD_TOP);
+	XASSERT(t.tv_sec == 10 && t.tv_usec == 990000) {
+		/* empty */
+	}
+	t = mg_field_timestamp(tv, V4L2_FIELD_INTERLACED, V4L2_STD_NTSC,
+			       MG_FIELD_TOP);
+	XASSERT(t.tv_sec == 11 && t.tv_usec == 6683) {
+		/* empty */
+	}
+	t = mg_field_timestamp(tv, V4L2_FIELD_NONE, V4L2_STD_NTSC,
+			       MG_FIELD_BOTTOM);
+	XASSERT(t.tv_sec == 10 && t.tv_usec == 990000) {
+		/* empty */
+	}
+
+	/* known values */
+	uint8_t out[8 * 4];
+	struct mg_image dst = {out, 4, 8, 4};
+	mg_field_deinterlace(&top, MG_FIELD_TOP, MG_DEINTERLACE_BOB, &dst,
+			     MG_SIMD_SCALAR);
+	XASSERT(out[0] == 0 && out[4] == 10 && out[8] == 20
+		&& out[28] == 60) {
+		/* empty */
+	}
+	mg_field_deinterlace(&bottom, MG_FIELD_BOTTOM, MG_DEINTERLACE_BOB,
+			     &dst, MG_SIMD_SCALAR);
+	XASSERT(out[0] == 10 && out[4] == 10 && out[8] == 20
+		&& out[28] == 70) {
+		/* empty */
+	}
+	mg_field_deinterlace(&bottom, MG_FIELD_BOTTOM, MG_DEINTERLACE_DOUBLE,
+			     &dst, MG_SIMD_SCALAR);
+	XASSERT(out[0] == 10 && out[8] == 10 && out[12] == 30) {
+		/* empty */
+	}
+
+	/* vector kernels match the scalar one */
+	uint32_t widths[] = {1, 15, 16, 17, 33, 100, 771};
+	for (unsigned int i = 0; i < sizeof(widths) / sizeof(*widths); i++) {
+		uint32_t w = widths[i];
+		struct mg_image src = {malloc(w * 6), w, 6, w};
+		for (uint32_t j = 0; j < w * 6; j++) {
+			((uint8_t *) src.data)[j] = rand();
+		}
+		struct mg_image field = mg_field_view(&src, V4L2_FIELD_INTERLACED,
+						      MG_FIELD_BOTTOM);
+		struct mg_image ref = {malloc(w * 6), w, 6, w};
+		mg_field_deinterlace(&field, MG_FIELD_BOTTOM, MG_DEINTERLACE_BOB,
+				     &ref, MG_SIMD_SCALAR);
+		for (int simd = MG_SIMD_SSE2; simd <= (int) mg_simd_detect();
+		     simd++) {
+			struct mg_image vec = {malloc(w * 6), w, 6, w};
+			mg_field_deinterlace(&field, MG_FIELD_BOTTOM,
+					     MG_DEINTERLACE_BOB, &vec, simd);
+			XASSERT(!memcmp(ref.data, vec.data, w * 6)) {
+				/* empty */
+			}
+			free(vec.data);
+		}
+		free(ref.data);
+		free(src.data);
+	}
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_field));
+}
+
+#endif /* TEST_MULTI_GEE_MG_FIELD */
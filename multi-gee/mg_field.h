@@ -0,0 +1,120 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee interlaced field declaration
+ *
+ * Interlaced cameras expose the two fields of a frame 20 ms (PAL) or
+ * 16.7 ms (NTSC) apart, so moving markers show comb artifacts in the
+ * full frame.  Each field on its own is a consistent, half-height
+ * image.  The fields are views on the frame, without a copy; the
+ * deinterlace kernels build a full-height image from one field.
+ */
+#ifndef ITL_MULTI_GEE_MG_FIELD_H
+#define ITL_MULTI_GEE_MG_FIELD_H
+
+#include <stdbool.h> /* bool */
+#include <stdint.h> /* uint32_t */
+#include <sys/time.h> /* struct timeval */
+
+#include <multi-gee/mg_image.h>
+#include <multi-gee/mg_simd.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Field of an interlaced frame
+ */
+enum mg_field
+{
+	MG_FIELD_TOP, /**< even lines, counting from 0 */
+	MG_FIELD_BOTTOM /**< odd lines */
+};
+
+/**
+ * @brief Deinterlace method
+ */
+enum mg_deinterlace
+{
+	MG_DEINTERLACE_DOUBLE, /**< every field line twice */
+	MG_DEINTERLACE_BOB /**< missing lines are the mean of their neighbours */
+};
+
+/**
+ * @brief Field view on a frame
+ *
+ * interleaved frames give views with twice the frame stride, frames
+ * with sequential fields (V4L2_FIELD_SEQ_TB and V4L2_FIELD_SEQ_BT)
+ * give views on either half.  the views share the frame's data.
+ *
+ * @param frame  full frame
+ * @param field_order  video4linux2 field order of the frame
+ * @param field  field to view
+ *
+ * @return half-height view on the field
+ */
+struct mg_image
+mg_field_view(const struct mg_image *frame,
+	      uint32_t field_order,
+	      enum mg_field field);
+
+/**
+ * @brief Capture time of a field
+ *
+ * the buffer time stamp is taken as the capture time of the field
+ * transmitted first, the other field follows one field period later.
+ * V4L2_FIELD_INTERLACED frames are transmitted bottom field first for
+ * 525 line standards, top field first otherwise.  both fields of a
+ * progressive frame share the frame time stamp.
+ *
+ * @param timestamp  buffer time stamp
+ * @param field_order  video4linux2 field order of the frame
+ * @param standard  video4linux2 standard id, or 0 for 50 Hz fields
+ * @param field  field to time
+ *
+ * @return time stamp of the field
+ */
+struct timeval
+mg_field_timestamp(struct timeval timestamp,
+		   uint32_t field_order,
+		   uint64_t standard,
+		   enum mg_field field);
+
+/**
+ * @brief Full-height image of one field
+ *
+ * the field lines end up on the lines they occupy in the frame, the
+ * lines of the other field are filled in by the method.  the
+ * destination must be as wide as the field and twice as high.
+ *
+ * @param src  8-bit field view, see mg_field_view()
+ * @param field  field the view shows
+ * @param method  how to fill in the missing lines
+ * @param dst  destination image
+ * @param simd  kernel to use, at most mg_simd_detect()
+ */
+void
+mg_field_deinterlace(const struct mg_image *src,
+		     enum mg_field field,
+		     enum mg_deinterlace method,
+		     const struct mg_image *dst,
+		     enum mg_simd simd);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_FIELD_H */
@@ -19,6 +19,8 @@
  * @file
  * @brief Multi-gee Frame definition
  */
+#include <pthread.h>
+#include <string.h> /* memset */
 #include <sys/time.h> /* gettimeofday */
 
 #include <asm/types.h> /* needed for videodev2.h */
@@ -27,11 +29,93 @@
 #include <config.h>
 
 #include "mg_frame.h" /* class implemented */
+#include "mg_convert.h"
 #include "mg_device.h"
+#include "mg_field.h"
 #include "multi-gee.h"
 
 USE_XASSERT
 
+/**
+ * @brief Put the frame's grey image through the background model
+ *
+ * fills in the frame's foreground image on first use, leaving it
+ * without data if the device has no background model.  called with the
+ * frame locked.
+ *
+ * @param frame  object handle
+ *
+ * @return the foreground image
+ */
+static
+struct mg_image
+apply_background(mg_frame_t frame);
+
+/**
+ * @brief Convert the frame's view to grey
+ *
+ * fills in the frame's grey image on first use, leaving it without
+ * data if the pixel format cannot be converted.  called with the frame
+ * locked.
+ *
+ * @param frame  object handle
+ *
+ * @return the grey image
+ */
+static
+struct mg_image
+convert_grey(mg_frame_t frame);
+
+/**
+ * @brief Work out the statistics of the frame's grey image
+ *
+ * fills in the frame's statistics on first use, every step-th line of
+ * the device configuration or every fourth.  called with the frame
+ * locked.
+ *
+ * @param frame  object handle
+ *
+ * @return the statistics, or 0 if there is no grey image
+ */
+static
+const struct mg_stats *
+gather_stats(mg_frame_t frame);
+
+/**
+ * @brief Search windows of a pyramid level
+ *
+ * see mg_frame_get_windows().
+ *
+ * @param frame  object handle
+ * @param level  pyramid level, 0 being the grey image
+ * @param [out]window  search windows
+ * @param max  number of windows the array holds
+ *
+ * @return the number of search windows
+ */
+static
+unsigned int
+level_windows(mg_frame_t frame,
+	      unsigned int level,
+	      struct mg_rect *window,
+	      unsigned int max);
+
+/**
+ * @brief Build a level of the frame's image pyramid
+ *
+ * builds the levels above it first, within the search windows only if
+ * the frame has any.  called with the frame locked.
+ *
+ * @param frame  object handle
+ * @param level  pyramid level, 0 being the grey image
+ *
+ * @return the level, without data if it cannot be built
+ */
+static
+struct mg_image
+reduce_level(mg_frame_t frame,
+	     unsigned int level);
+
 /**
  * @brief Frame object structure
  */
@@ -42,6 +126,24 @@ CLASS(mg_frame, mg_frame_t)
 	struct timeval timestamp; /**< Frame time stamp */
 	uint32_t sequence; /**< Frame sequence number */
 	bool used; /**< Frame already processed by user? */
+	struct mg_rect roi; /**< Region of interest */
+	struct mg_format format; /**< Format of the captured image */
+	bool cropped; /**< Image cropped to the region of interest? */
+	pthread_mutex_t lock; /**< Serialises the grey conversion */
+	struct mg_image grey; /**< Grey image, converted on first use */
+	bool grey_done; /**< Grey conversion attempted? */
+	struct mg_image foreground; /**< Grey image less the background */
+	bool foreground_done; /**< Background model applied? */
+	struct mg_stats stats; /**< Statistics of the grey image */
+	bool stats_done; /**< Statistics attempted? */
+	bool stats_valid; /**< Statistics worked out? */
+	struct mg_image full[2]; /**< Deinterlaced image per field */
+	int method[2]; /**< Deinterlace method per field, -1 if none */
+	struct mg_image level[MG_PYRAMID_LEVELS]; /**< Image pyramid */
+	bool level_done[MG_PYRAMID_LEVELS]; /**< Pyramid level attempted? */
+	struct mg_rect window[MG_MAX_WINDOWS]; /**< Search windows */
+	unsigned int num_windows; /**< Number of search windows, 0 for the
+				    full frame */
 };
 
 mg_frame_t
@@ -64,14 +166,43 @@ mg_frame_create(mg_device_t mg_device,
          }
 #endif
 		mg_frame->sequence = buf->sequence;
+		mg_frame->cropped = mg_device_get_view(mg_device,
+						       &mg_frame->roi,
+						       &mg_frame->format);
+		if (!mg_frame->roi.width || !mg_frame->roi.height) {
+			mg_frame->roi.left = 0;
+			mg_frame->roi.top = 0;
+			mg_frame->roi.width = mg_frame->format.width;
+			mg_frame->roi.height = mg_frame->format.height;
+		}
+		mg_frame->num_windows = mg_device_get_windows(mg_device,
+							      buf->sequence,
+							      mg_frame->window);
 	} else {
 		mg_frame->index = -1;
 		gettimeofday(&mg_frame->timestamp, 0);
 		mg_frame->sequence = -1;
+		memset(&mg_frame->roi, 0, sizeof(mg_frame->roi));
+		memset(&mg_frame->format, 0, sizeof(mg_frame->format));
+		mg_frame->cropped = false;
+		mg_frame->num_windows = 0;
 	}
 
 	mg_frame->used = (buf) ? false : true;
 
+	pthread_mutex_init(&mg_frame->lock, 0);
+	memset(&mg_frame->grey, 0, sizeof(mg_frame->grey));
+	mg_frame->grey_done = false;
+	memset(&mg_frame->foreground, 0, sizeof(mg_frame->foreground));
+	mg_frame->foreground_done = false;
+	mg_frame->stats_done = false;
+	mg_frame->stats_valid = false;
+	memset(mg_frame->full, 0, sizeof(mg_frame->full));
+	mg_frame->method[MG_FIELD_TOP] = -1;
+	mg_frame->method[MG_FIELD_BOTTOM] = -1;
+	memset(mg_frame->level, 0, sizeof(mg_frame->level));
+	memset(mg_frame->level_done, 0, sizeof(mg_frame->level_done));
+
 	return mg_frame;
 }
 
@@ -79,12 +210,70 @@ mg_frame_t
 mg_frame_destroy(mg_frame_t mg_frame)
 {
 	VERIFYZ(mg_frame) {
+		pthread_mutex_destroy(&mg_frame->lock);
 		FREEOBJ(mg_frame);
 	}
 
 	return 0;
 }
 
+bool
+mg_frame_get_control(mg_frame_t mg_frame,
+		     uint32_t id,
+		     int32_t *value)
+{
+	bool known = false;
+
+	VERIFY(mg_frame) {
+		known = mg_device_get_control(mg_frame->device,
+					      id,
+					      mg_frame->sequence,
+					      value,
+					      0);
+	}
+
+	return known;
+}
+
+struct mg_image
+mg_frame_get_deinterlaced(mg_frame_t mg_frame,
+			  enum mg_field field,
+			  enum mg_deinterlace method)
+{
+	struct mg_image full = {0, 0, 0, 0};
+
+	VERIFY(mg_frame) {
+		pthread_mutex_lock(&mg_frame->lock);
+		if (mg_frame->method[field] != (int) method) {
+			struct mg_image grey = convert_grey(mg_frame);
+			struct mg_image src = mg_field_view(&grey,
+							    mg_frame->format.field,
+							    field);
+			struct mg_image dst = {0, src.width, 2 * src.height, 0};
+			dst.stride = (dst.width + MG_POOL_ALIGN - 1)
+				& ~(MG_POOL_ALIGN - 1);
+			if (grey.data) {
+				dst.data = mg_pool_get(
+					mg_device_get_pool(mg_frame->device),
+					mg_frame->index,
+					(MG_FIELD_TOP == field)
+						? MG_POOL_TOP : MG_POOL_BOTTOM,
+					(size_t) dst.stride * dst.height);
+			}
+			if (dst.data) {
+				mg_field_deinterlace(&src, field, method, &dst,
+						     mg_simd_detect());
+				mg_frame->method[field] = method;
+			}
+			mg_frame->full[field] = dst;
+		}
+		full = mg_frame->full[field];
+		pthread_mutex_unlock(&mg_frame->lock);
+	}
+
+	return full;
+}
+
 mg_device_t
 mg_frame_get_device(mg_frame_t mg_frame)
 {
@@ -97,6 +286,96 @@ mg_frame_get_device(mg_frame_t mg_frame)
 	return device;
 }
 
+int
+mg_frame_get_dmabuf_fd(mg_frame_t mg_frame)
+{
+	int fd = -1;
+
+	VERIFY(mg_frame) {
+		mg_buffer_t buf = mg_device_get_buffer(mg_frame->device);
+		fd = mg_buffer_get_dmabuf(buf, mg_frame->index);
+	}
+
+	return fd;
+}
+
+struct mg_image
+mg_frame_get_field(mg_frame_t mg_frame,
+		   enum mg_field field)
+{
+	struct mg_image view = {0, 0, 0, 0};
+
+	VERIFY(mg_frame) {
+		pthread_mutex_lock(&mg_frame->lock);
+		struct mg_image grey = convert_grey(mg_frame);
+		pthread_mutex_unlock(&mg_frame->lock);
+
+		if (grey.data) {
+			view = mg_field_view(&grey, mg_frame->format.field, field);
+		}
+	}
+
+	return view;
+}
+
+struct timeval
+mg_frame_get_field_timestamp(mg_frame_t mg_frame,
+			     enum mg_field field)
+{
+	struct timeval timestamp = {0, 0};
+
+	VERIFY(mg_frame) {
+		mg_config_t config = mg_device_get_config(mg_frame->device);
+		timestamp = mg_field_timestamp(mg_frame->timestamp,
+					       mg_frame->format.field,
+					       mg_config_get_standard(config),
+					       field);
+	}
+
+	return timestamp;
+}
+
+struct mg_image
+mg_frame_get_foreground(mg_frame_t mg_frame)
+{
+	struct mg_image foreground = {0, 0, 0, 0};
+
+	VERIFY(mg_frame) {
+		pthread_mutex_lock(&mg_frame->lock);
+		foreground = apply_background(mg_frame);
+		pthread_mutex_unlock(&mg_frame->lock);
+	}
+
+	return foreground;
+}
+
+struct mg_image
+mg_frame_get_grey(mg_frame_t mg_frame)
+{
+	struct mg_image grey = {0, 0, 0, 0};
+
+	VERIFY(mg_frame) {
+		pthread_mutex_lock(&mg_frame->lock);
+		grey = convert_grey(mg_frame);
+		pthread_mutex_unlock(&mg_frame->lock);
+	}
+
+	return grey;
+}
+
+struct mg_format
+mg_frame_get_format(mg_frame_t mg_frame)
+{
+	struct mg_format format;
+	memset(&format, 0, sizeof(format));
+
+	VERIFY(mg_frame) {
+		format = mg_frame->format;
+	}
+
+	return format;
+}
+
 void *
 mg_frame_get_image(mg_frame_t mg_frame)
 {
@@ -122,6 +401,79 @@ mg_frame_get_index(mg_frame_t mg_frame)
 	return index;
 }
 
+struct mg_image
+mg_frame_get_level(mg_frame_t mg_frame,
+		   unsigned int level)
+{
+	struct mg_image image = {0, 0, 0, 0};
+
+	VERIFY(mg_frame) {
+		if (level <= MG_PYRAMID_LEVELS) {
+			pthread_mutex_lock(&mg_frame->lock);
+			image = reduce_level(mg_frame, level);
+			pthread_mutex_unlock(&mg_frame->lock);
+		}
+	}
+
+	return image;
+}
+
+struct mg_plane
+mg_frame_get_plane(mg_frame_t mg_frame,
+		   unsigned int plane)
+{
+	struct mg_plane p = {0, 0, 0, -1};
+
+	VERIFY(mg_frame) {
+		mg_buffer_t buf = mg_device_get_buffer(mg_frame->device);
+		struct mg_format *format = &mg_frame->format;
+		if (plane < mg_buffer_get_planes(buf)) {
+			unsigned int i = mg_frame->index;
+			p.data = mg_buffer_get_plane_start(buf, i, plane);
+			p.length = mg_buffer_get_plane_length(buf, i, plane);
+			p.dmabuf = mg_buffer_get_plane_dmabuf(buf, i, plane);
+			if (plane < format->num_planes) {
+				struct mg_plane_format *pf =
+					&format->plane[plane];
+				p.stride = pf->bytesperline;
+				/* the mapping may be larger than the image */
+				if (pf->sizeimage && pf->sizeimage < p.length) {
+					p.length = pf->sizeimage;
+				}
+			} else if (0 == plane) {
+				p.stride = format->bytesperline;
+			}
+		}
+	}
+
+	return p;
+}
+
+unsigned int
+mg_frame_get_planes(mg_frame_t mg_frame)
+{
+	unsigned int planes = 0;
+
+	VERIFY(mg_frame) {
+		mg_buffer_t buf = mg_device_get_buffer(mg_frame->device);
+		planes = mg_buffer_get_planes(buf);
+	}
+
+	return planes;
+}
+
+struct mg_rect
+mg_frame_get_roi(mg_frame_t mg_frame)
+{
+	struct mg_rect roi = {0, 0, 0, 0};
+
+	VERIFY(mg_frame) {
+		roi = mg_frame->roi;
+	}
+
+	return roi;
+}
+
 uint32_t
 mg_frame_get_sequence(mg_frame_t mg_frame)
 {
@@ -134,6 +486,20 @@ mg_frame_get_sequence(mg_frame_t mg_frame)
 	return sequence;
 }
 
+const struct mg_stats *
+mg_frame_get_stats(mg_frame_t mg_frame)
+{
+	const struct mg_stats *stats = 0;
+
+	VERIFY(mg_frame) {
+		pthread_mutex_lock(&mg_frame->lock);
+		stats = gather_stats(mg_frame);
+		pthread_mutex_unlock(&mg_frame->lock);
+	}
+
+	return stats;
+}
+
 struct timeval
 mg_frame_get_timestamp(mg_frame_t mg_frame)
 {
@@ -145,6 +511,36 @@ mg_frame_get_timestamp(mg_frame_t mg_frame)
 	return timestamp;
 }
 
+struct mg_image
+mg_frame_get_view(mg_frame_t mg_frame)
+{
+	struct mg_image view = {0, 0, 0, 0};
+
+	VERIFY(mg_frame) {
+		mg_buffer_t buf = mg_device_get_buffer(mg_frame->device);
+		char *data = mg_buffer_get_start(buf, mg_frame->index);
+		struct mg_format *format = &mg_frame->format;
+
+		if (data && !mg_frame->cropped) {
+			/* packed formats only, the stride may be padded */
+			uint32_t bpp =
+				mg_convert_bytes_per_pixel(format->pixelformat);
+			if (!bpp) {
+				bpp = 1;
+			}
+			data += mg_frame->roi.top * format->bytesperline
+				+ mg_frame->roi.left * bpp;
+		}
+
+		view.data = data;
+		view.width = mg_frame->roi.width;
+		view.height = mg_frame->roi.height;
+		view.stride = format->bytesperline;
+	}
+
+	return view;
+}
+
 bool
 mg_frame_get_used(mg_frame_t mg_frame)
 {
@@ -169,6 +565,21 @@ mg_frame_get_userptr(mg_frame_t mg_frame)
 	return userptr;
 }
 
+unsigned int
+mg_frame_get_windows(mg_frame_t mg_frame,
+		     unsigned int level,
+		     struct mg_rect *window,
+		     unsigned int max)
+{
+	unsigned int num_windows = 0;
+
+	VERIFY(mg_frame) {
+		num_windows = level_windows(mg_frame, level, window, max);
+	}
+
+	return num_windows;
+}
+
 mg_frame_t
 mg_frame_set_used(mg_frame_t mg_frame)
 {
@@ -182,6 +593,260 @@ mg_frame_set_used(mg_frame_t mg_frame)
 	return frame;
 }
 
+unsigned int
+mg_frame_threshold(mg_frame_t mg_frame,
+		   unsigned int level,
+		   uint8_t threshold,
+		   struct mg_span *span,
+		   unsigned int max)
+{
+	unsigned int found = 0;
+
+	VERIFY(mg_frame) {
+		struct mg_image image = mg_frame_get_level(mg_frame, level);
+		if (!mg_frame->num_windows) {
+			found = mg_threshold(&image, threshold, span, max,
+					     mg_simd_detect());
+		} else {
+			struct mg_rect window[MG_MAX_WINDOWS];
+			unsigned int n = level_windows(mg_frame, level, window,
+						       MG_MAX_WINDOWS);
+			found = mg_threshold_windows(&image, window, n,
+						     threshold, span, max,
+						     mg_simd_detect());
+		}
+	}
+
+	return found;
+}
+
+struct mg_image
+apply_background(mg_frame_t frame)
+{
+	if (frame->foreground_done) {
+		return frame->foreground;
+	}
+	frame->foreground_done = true;
+
+	mg_background_t background = mg_device_get_background(frame->device);
+	struct mg_image grey = convert_grey(frame);
+	if (!background || !grey.data) {
+		return frame->foreground;
+	}
+
+	struct mg_image image = grey;
+	image.stride = (grey.width + MG_POOL_ALIGN - 1) & ~(MG_POOL_ALIGN - 1);
+	image.data = mg_pool_get(mg_device_get_pool(frame->device),
+				 frame->index,
+				 MG_POOL_FOREGROUND,
+				 (size_t) image.stride * image.height);
+	if (!image.data) {
+		return frame->foreground;
+	}
+
+	if (mg_background_apply(background, &grey, &image, mg_simd_detect())) {
+		frame->foreground = image;
+	}
+
+	return frame->foreground;
+}
+
+struct mg_image
+convert_grey(mg_frame_t frame)
+{
+	if (frame->grey_done) {
+		return frame->grey;
+	}
+	frame->grey_done = true;
+
+	struct mg_image view = mg_frame_get_view(frame);
+	uint32_t pixelformat = frame->format.pixelformat;
+	if (!view.data) {
+		return frame->grey;
+	}
+
+	/* grey frames need no conversion, nor a copy */
+	if (V4L2_PIX_FMT_GREY == pixelformat) {
+		frame->grey = view;
+		return frame->grey;
+	}
+
+	struct mg_image grey;
+	if (!mg_convert_size(pixelformat, view.width, view.height,
+			     &grey.width, &grey.height)) {
+		return frame->grey;
+	}
+	grey.stride = (grey.width + MG_POOL_ALIGN - 1) & ~(MG_POOL_ALIGN - 1);
+	grey.data = mg_pool_get(mg_device_get_pool(frame->device),
+				frame->index,
+				MG_POOL_GREY,
+				(size_t) grey.stride * grey.height);
+	if (!grey.data) {
+		return frame->grey;
+	}
+
+	if (mg_convert_grey(pixelformat, &view, &grey, mg_simd_detect())) {
+		frame->grey = grey;
+	}
+
+	return frame->grey;
+}
+
+const struct mg_stats *
+gather_stats(mg_frame_t frame)
+{
+	if (!frame->stats_done) {
+		frame->stats_done = true;
+
+		struct mg_image grey = convert_grey(frame);
+		mg_config_t config = mg_device_get_config(frame->device);
+		unsigned int step = mg_config_get_stats(config);
+		if (grey.data) {
+			frame->stats_valid = mg_stats_compute(&grey,
+							      step ? step : 4,
+							      &frame->stats,
+							      mg_simd_detect());
+		}
+	}
+
+	return frame->stats_valid ? &frame->stats : 0;
+}
+
+unsigned int
+level_windows(mg_frame_t frame,
+	      unsigned int level,
+	      struct mg_rect *window,
+	      unsigned int max)
+{
+	const struct mg_rect *roi = &frame->roi;
+	uint32_t width;
+	uint32_t height;
+	if (level > MG_PYRAMID_LEVELS || !roi->width || !roi->height
+	    || !mg_convert_size(frame->format.pixelformat,
+				roi->width, roi->height, &width, &height)) {
+		return 0;
+	}
+	int64_t level_width = width >> level;
+	int64_t level_height = height >> level;
+	if (!level_width || !level_height) {
+		return 0;
+	}
+
+	if (!frame->num_windows) {
+		if (max) {
+			window[0].left = 0;
+			window[0].top = 0;
+			window[0].width = level_width;
+			window[0].height = level_height;
+		}
+		return 1;
+	}
+
+	/* to grey image coordinates, aligned so that the levels nest */
+	const int64_t align = 1 << MG_PYRAMID_LEVELS;
+	unsigned int n = 0;
+	for (unsigned int i = 0; i < frame->num_windows; i++) {
+		const struct mg_rect *w = &frame->window[i];
+		int64_t left = (int64_t) w->left - roi->left;
+		int64_t top = (int64_t) w->top - roi->top;
+		int64_t right = left + w->width;
+		int64_t bottom = top + w->height;
+		left = (left < 0) ? 0 : left * width / roi->width;
+		top = (top < 0) ? 0 : top * height / roi->height;
+		right = (right < 0) ? 0
+			: (right * width + roi->width - 1) / roi->width;
+		bottom = (bottom < 0) ? 0
+			: (bottom * height + roi->height - 1) / roi->height;
+
+		left = (left & ~(align - 1)) >> level;
+		top = (top & ~(align - 1)) >> level;
+		right = ((right + align - 1) & ~(align - 1)) >> level;
+		bottom = ((bottom + align - 1) & ~(align - 1)) >> level;
+		if (right > level_width) {
+			right = level_width;
+		}
+		if (bottom > level_height) {
+			bottom = level_height;
+		}
+		if (left >= right || top >= bottom) {
+			continue;
+		}
+
+		if (n < max) {
+			window[n].left = left;
+			window[n].top = top;
+			window[n].width = right - left;
+			window[n].height = bottom - top;
+		}
+		n++;
+	}
+
+	return n;
+}
+
+struct mg_image
+reduce_level(mg_frame_t frame,
+	     unsigned int level)
+{
+	if (!level) {
+		return convert_grey(frame);
+	}
+
+	struct mg_image *dst = &frame->level[level - 1];
+	if (frame->level_done[level - 1]) {
+		return *dst;
+	}
+	frame->level_done[level - 1] = true;
+
+	struct mg_image src = reduce_level(frame, level - 1);
+	if (!src.data || src.width < 2 || src.height < 2) {
+		return *dst;
+	}
+
+	struct mg_image image;
+	image.width = src.width / 2;
+	image.height = src.height / 2;
+	image.stride = (image.width + MG_POOL_ALIGN - 1) & ~(MG_POOL_ALIGN - 1);
+	image.data = mg_pool_get(mg_device_get_pool(frame->device),
+				 frame->index,
+				 MG_POOL_LEVEL1 + level - 1,
+				 (size_t) image.stride * image.height);
+	if (!image.data) {
+		return *dst;
+	}
+
+	if (!frame->num_windows) {
+		mg_convert_reduce(&src, &image, mg_simd_detect());
+		*dst = image;
+		return *dst;
+	}
+
+	/* the window of the level above is twice the size */
+	struct mg_rect window[MG_MAX_WINDOWS];
+	unsigned int n = level_windows(frame, level, window, MG_MAX_WINDOWS);
+	for (unsigned int i = 0; i < n; i++) {
+		const struct mg_rect *w = &window[i];
+		struct mg_image s = {
+			(uint8_t *) src.data + (size_t) 2 * w->top * src.stride
+			+ 2 * w->left,
+			2 * w->width,
+			2 * w->height,
+			src.stride
+		};
+		struct mg_image d = {
+			(uint8_t *) image.data + (size_t) w->top * image.stride
+			+ w->left,
+			w->width,
+			w->height,
+			image.stride
+		};
+		mg_convert_reduce(&s, &d, mg_simd_detect());
+	}
+	*dst = image;
+
+	return *dst;
+}
+
 #ifdef TEST_MULTI_GEE_MG_FRAME
 
 #include <stdlib.h>
@@ -218,6 +883,9 @@ test_frame(mg_device_t device,
 	XASSERT(mg_frame_get_image(frame) == image) {
 		/* empty */
 	}
+	XASSERT(mg_frame_get_dmabuf_fd(frame) == -1) {
+		/* empty */
+	}
 
 	struct timeval tv = mg_frame_get_timestamp(frame);
 	XASSERT(tv.tv_sec == timestamp.tv_sec) {
@@ -248,6 +916,16 @@ test_frame(mg_device_t device,
 		/* empty */
 	}
 
+	/* region of interest, in software */
+	struct mg_rect roi = mg_frame_get_roi(frame);
+	XASSERT(roi.left == 0 && roi.width == 768) {
+		/* empty */
+	}
+	struct mg_image view = mg_frame_get_view(frame);
+	XASSERT(view.data == image && view.stride == 768) {
+		/* empty */
+	}
+
 	mg_frame_destroy(frame);
 }
 
@@ -261,6 +939,11 @@ mg_frame()
 	mg_buffer_t mg_buffer = mg_device_get_buffer(mg_device);
 	mg_buffer_alloc(mg_buffer, 1);
 
+	struct mg_format format = {768, 576, 768, 768 * 576,
+				   V4L2_PIX_FMT_GREY, V4L2_FIELD_INTERLACED,
+				   1, {{768, 768 * 576}}};
+	mg_device_set_format(mg_device, format);
+
 	test_frame(mg_device, 0, timestamp, 0);
 
 	timestamp.tv_sec = 300;
@@ -272,6 +955,256 @@ mg_frame()
 
 	test_frame(mg_device, (void *)3, timestamp, 4);
 
+	/* a software region of interest offsets the view */
+	struct mg_rect roi = {16, 2, 64, 32};
+	mg_device_set_roi(mg_device, roi, format, false, 5);
+
+	struct v4l2_buffer buf;
+	memset(&buf, 0, sizeof(buf));
+	buf.sequence = 5;
+	mg_device_settle_view(mg_device, buf.bytesused, buf.sequence);
+	mg_frame_t frame = mg_frame_create(mg_device, &buf);
+	struct mg_image view = mg_frame_get_view(frame);
+	XASSERT((char *) view.data == (char *) 3 + 2 * 768 + 16) {
+		/* empty */
+	}
+	XASSERT(view.width == 64 && view.height == 32) {
+		/* empty */
+	}
+	XASSERT(mg_frame_get_roi(frame).top == 2) {
+		/* empty */
+	}
+	mg_frame_destroy(frame);
+
+	/* grey frames are their own grey image */
+	frame = mg_frame_create(mg_device, &buf);
+	struct mg_image grey = mg_frame_get_grey(frame);
+	XASSERT(grey.data == view.data && grey.width == 64) {
+		/* empty */
+	}
+	mg_frame_destroy(frame);
+
+	/* a padded stride does not widen the pixels */
+	struct mg_format padded = format;
+	padded.bytesperline = 2 * 768;
+	padded.plane[0].bytesperline = padded.bytesperline;
+	mg_device_set_format(mg_device, padded);
+	mg_device_set_roi(mg_device, roi, padded, false, 5);
+	mg_device_settle_view(mg_device, buf.bytesused, buf.sequence);
+	frame = mg_frame_create(mg_device, &buf);
+	view = mg_frame_get_view(frame);
+	XASSERT((char *) view.data == (char *) 3 + 2 * 2 * 768 + 16) {
+		/* empty */
+	}
+	XASSERT(view.stride == 2 * 768) {
+		/* empty */
+	}
+	mg_frame_destroy(frame);
+
+	/* colour frames are converted into the device's pool */
+	unsigned char yuyv[2 * 4 * 2];
+	for (unsigned int i = 0; i < sizeof(yuyv); i++) {
+		yuyv[i] = (i & 1) ? 128 : i;
+	}
+	mg_buffer_grow(mg_buffer, 2);
+	mg_buffer_set(mg_buffer, 1, yuyv, sizeof(yuyv));
+	buf.index = 1;
+	struct mg_format yuv = {4, 2, 8, sizeof(yuyv),
+				V4L2_PIX_FMT_YUYV, V4L2_FIELD_NONE,
+				1, {{8, sizeof(yuyv)}}};
+	mg_device_set_format(mg_device, yuv);
+	frame = mg_frame_create(mg_device, &buf);
+	grey = mg_frame_get_grey(frame);
+	XASSERT(grey.width == 4 && grey.height == 2) {
+		/* empty */
+	}
+	XASSERT(((unsigned char *) grey.data)[grey.stride + 3] == 14) {
+		/* empty */
+	}
+	XASSERT(mg_frame_get_grey(frame).data == grey.data) {
+		/* empty */
+	}
+
+	/* fields of the grey image, and their times */
+	struct mg_image field = mg_frame_get_field(frame, MG_FIELD_BOTTOM);
+	XASSERT(field.height == 1 && field.data == (char *) grey.data
+		+ grey.stride) {
+		/* empty */
+	}
+	XASSERT(mg_frame_get_field_timestamp(frame, MG_FIELD_BOTTOM).tv_usec
+		== mg_frame_get_timestamp(frame).tv_usec) {
+		/* empty */
+	}
+	/* image pyramid */
+	struct mg_image half = mg_frame_get_level(frame, 1);
+	XASSERT(half.width == 2 && half.height == 1) {
+		/* empty */
+	}
+	XASSERT(((unsigned char *) half.data)[1] == (4 + 6 + 12 + 14 + 2) / 4) {
+		/* empty */
+	}
+	XASSERT(!mg_frame_get_level(frame, 2).data) {
+		/* empty */
+	}
+	XASSERT(mg_frame_get_level(frame, 0).data == grey.data) {
+		/* empty */
+	}
+
+	struct mg_image full = mg_frame_get_deinterlaced(frame, MG_FIELD_BOTTOM,
+							 MG_DEINTERLACE_DOUBLE);
+	XASSERT(full.height == 2
+		&& ((unsigned char *) full.data)[3] == 14) {
+		/* empty */
+	}
+	mg_frame_destroy(frame);
+
+	/* multi-planar frames expose every plane */
+	unsigned char luma[4 * 2];
+	unsigned char chroma[4 * 1];
+	mg_buffer_grow(mg_buffer, 3);
+	mg_buffer_set_planes(mg_buffer, 2);
+	mg_buffer_set_plane(mg_buffer, 2, 0, luma, sizeof(luma));
+	mg_buffer_set_plane(mg_buffer, 2, 1, chroma, sizeof(chroma) + 64);
+	buf.index = 2;
+	struct mg_format nv12 = {4, 2, 4, sizeof(luma),
+				 V4L2_PIX_FMT_NV12M, V4L2_FIELD_NONE,
+				 2, {{4, sizeof(luma)}, {4, sizeof(chroma)}}};
+	mg_device_set_format(mg_device, nv12);
+	frame = mg_frame_create(mg_device, &buf);
+	XASSERT(mg_frame_get_planes(frame) == 2) {
+		/* empty */
+	}
+	XASSERT(mg_frame_get_image(frame) == luma) {
+		/* empty */
+	}
+	struct mg_plane plane = mg_frame_get_plane(frame, 1);
+	XASSERT(plane.data == chroma && plane.stride == 4) {
+		/* empty */
+	}
+	XASSERT(plane.length == sizeof(chroma) && plane.dmabuf == -1) {
+		/* empty */
+	}
+	XASSERT(!mg_frame_get_plane(frame, 2).data) {
+		/* empty */
+	}
+	mg_frame_destroy(frame);
+
+	/* search windows limit the threshold and the pyramid */
+	static unsigned char markers[32 * 64];
+	memset(markers, 10, sizeof(markers));
+	memset(&markers[10 * 64 + 10], 250, 3);
+	memset(&markers[24 * 64 + 40], 250, 3);
+	mg_buffer_grow(mg_buffer, 4);
+	mg_buffer_set_planes(mg_buffer, 1);
+	mg_buffer_set(mg_buffer, 3, markers, sizeof(markers));
+	buf.index = 3;
+	buf.sequence = 26;
+	struct mg_format small = {64, 32, 64, sizeof(markers),
+				  V4L2_PIX_FMT_GREY, V4L2_FIELD_NONE,
+				  1, {{64, sizeof(markers)}}};
+	mg_device_set_format(mg_device, small);
+	struct mg_rect predicted = {9, 9, 5, 3};
+	mg_device_set_windows(mg_device, &predicted, 1);
+	frame = mg_frame_create(mg_device, &buf);
+
+	struct mg_rect window[MG_MAX_WINDOWS];
+	XASSERT(mg_frame_get_windows(frame, 0, window, MG_MAX_WINDOWS) == 1) {
+		/* empty */
+	}
+	XASSERT(window[0].left == 8 && window[0].top == 8
+		&& window[0].width == 8 && window[0].height == 8) {
+		/* empty */
+	}
+	XASSERT(mg_frame_get_windows(frame, 2, window, MG_MAX_WINDOWS) == 1) {
+		/* empty */
+	}
+	XASSERT(window[0].left == 2 && window[0].width == 2) {
+		/* empty */
+	}
+
+	struct mg_span span[8];
+	XASSERT(mg_frame_threshold(frame, 0, 128, span, 8) == 1) {
+		/* empty */
+	}
+	XASSERT(span[0].y == 10 && span[0].x == 10 && span[0].length == 3) {
+		/* empty */
+	}
+	half = mg_frame_get_level(frame, 1);
+	XASSERT(((unsigned char *) half.data)[5 * half.stride + 5] == 130) {
+		/* empty */
+	}
+	XASSERT(mg_frame_threshold(frame, 1, 128, span, 8) == 1) {
+		/* empty */
+	}
+	mg_frame_destroy(frame);
+
+	/* the sweep frames search the full frame */
+	buf.sequence = 25;
+	frame = mg_frame_create(mg_device, &buf);
+	XASSERT(mg_frame_get_windows(frame, 1, window, MG_MAX_WINDOWS) == 1) {
+		/* empty */
+	}
+	XASSERT(window[0].width == 32 && window[0].height == 16) {
+		/* empty */
+	}
+	XASSERT(mg_frame_threshold(frame, 0, 128, span, 8) == 2) {
+		/* empty */
+	}
+	XASSERT(!mg_frame_get_foreground(frame).data) {
+		/* empty */
+	}
+
+	/* statistics of every fourth line miss the markers */
+	const struct mg_stats *stats = mg_frame_get_stats(frame);
+	XASSERT(stats && stats->pixels == 8 * 64) {
+		/* empty */
+	}
+	XASSERT(stats->histogram[10] == 8 * 64 && stats->mean == 10) {
+		/* empty */
+	}
+	XASSERT(mg_frame_get_stats(frame) == stats) {
+		/* empty */
+	}
+	mg_frame_destroy(frame);
+
+	/* every line finds them */
+	mg_config_set_stats(mg_device_get_config(mg_device), 1);
+	frame = mg_frame_create(mg_device, &buf);
+	stats = mg_frame_get_stats(frame);
+	XASSERT(stats->pixels == 30 * 64 && stats->histogram[250] == 6) {
+		/* empty */
+	}
+	XASSERT(stats->saturated == 0 && stats->focus > 0) {
+		/* empty */
+	}
+	mg_frame_destroy(frame);
+	mg_config_set_stats(mg_device_get_config(mg_device), 0);
+
+	/* the background model learns the first frame */
+	mg_device_set_background(mg_device,
+				 mg_background_create(MG_BACKGROUND_MAXIMUM));
+	frame = mg_frame_create(mg_device, &buf);
+	struct mg_image fg = mg_frame_get_foreground(frame);
+	XASSERT(fg.width == 64 && fg.height == 32 && fg.data != markers) {
+		/* empty */
+	}
+	XASSERT(((unsigned char *) fg.data)[10 * fg.stride + 10] == 0) {
+		/* empty */
+	}
+	mg_frame_destroy(frame);
+
+	/* and finds what is new in the next */
+	markers[20 * 64 + 30] = 200;
+	frame = mg_frame_create(mg_device, &buf);
+	fg = mg_frame_get_foreground(frame);
+	XASSERT(((unsigned char *) fg.data)[20 * fg.stride + 30] == 200) {
+		/* empty */
+	}
+	XASSERT(((unsigned char *) fg.data)[10 * fg.stride + 10] == 0) {
+		/* empty */
+	}
+	mg_frame_destroy(frame);
+
 	mg_device = mg_device_destroy(mg_device);
 
 	log = lg_destroy(log);
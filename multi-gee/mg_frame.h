@@ -26,6 +26,9 @@
 #include <stdbool.h> /* bool */
 
 #include <multi-gee/mg_device.h>
+#include <multi-gee/mg_field.h>
+#include <multi-gee/mg_stats.h>
+#include <multi-gee/mg_threshold.h>
 
 struct v4l2_buffer;
 
@@ -65,6 +68,41 @@ mg_frame_create(mg_device_t device,
 mg_frame_t
 mg_frame_destroy(mg_frame_t frame);
 
+/**
+ * @brief Control value the frame was captured with
+ *
+ * only controls set through mg_set_control() are known.
+ *
+ * @param frame  object handle
+ * @param id  control identifier
+ * @param [out]value  control value
+ *
+ * @return \c true if the value is known, else \c false
+ */
+bool
+mg_frame_get_control(mg_frame_t frame,
+		     uint32_t id,
+		     int32_t *value);
+
+/**
+ * @brief Deinterlaced image accessor
+ *
+ * a full-height image of one field of the grey image, see
+ * mg_field_deinterlace().  it is built on first use and kept with the
+ * frame; the memory belongs to the device and is reused once the
+ * capture buffer is requeued.
+ *
+ * @param frame  object handle
+ * @param field  field to keep
+ * @param method  how to fill in the lines of the other field
+ *
+ * @return deinterlaced image, with no data if no grey image exists
+ */
+struct mg_image
+mg_frame_get_deinterlaced(mg_frame_t frame,
+			  enum mg_field field,
+			  enum mg_deinterlace method);
+
 /**
  * @brief Capture device accessor
  *
@@ -75,6 +113,101 @@ mg_frame_destroy(mg_frame_t frame);
 mg_device_t
 mg_frame_get_device(mg_frame_t frame);
 
+/**
+ * @brief DMABUF file descriptor accessor
+ *
+ * the capture buffer holding the image can be exported as a DMABUF
+ * file descriptor.  another process, handed the descriptor over a unix
+ * domain socket, can map the same physical buffer without copying the
+ * image data.  the descriptor is owned by the library and stays valid
+ * until the device is deregistered.
+ *
+ * @param frame  object handle
+ *
+ * @return the DMABUF file descriptor, or -1 if the driver does not
+ * support buffer export
+ */
+int
+mg_frame_get_dmabuf_fd(mg_frame_t frame);
+
+/**
+ * @brief Field view accessor
+ *
+ * a half-height view on one field of the grey image, without a copy,
+ * laid out by the negotiated field order.
+ *
+ * @param frame  object handle
+ * @param field  field to view
+ *
+ * @return field view, with no data if no grey image exists
+ */
+struct mg_image
+mg_frame_get_field(mg_frame_t frame,
+		   enum mg_field field);
+
+/**
+ * @brief Field time stamp accessor
+ *
+ * derived from the buffer time stamp, the field order and the video
+ * standard, see mg_field_timestamp().
+ *
+ * @param frame  object handle
+ * @param field  field to time
+ *
+ * @return the time stamp of the field
+ */
+struct timeval
+mg_frame_get_field_timestamp(mg_frame_t frame,
+			     enum mg_field field);
+
+/**
+ * @brief Foreground image accessor
+ *
+ * the grey image, see mg_frame_get_grey(), put through the background
+ * model of the device, see mg_set_background().  it is made once per
+ * frame, on the pyramid worker thread while the callback function
+ * runs, and the model learns from the frame at the same time.  the
+ * memory belongs to the device and is reused once the capture buffer
+ * is requeued.
+ *
+ * @param frame  object handle
+ *
+ * @return foreground image, with no data if the device has no
+ * background model or no grey image exists
+ */
+struct mg_image
+mg_frame_get_foreground(mg_frame_t frame);
+
+/**
+ * @brief Image format accessor
+ *
+ * the format the frame was captured with, which follows a hardware
+ * crop of the region of interest, see mg_set_roi().
+ *
+ * @param frame  object handle
+ *
+ * @return image format, all zero if the frame holds no image
+ */
+struct mg_format
+mg_frame_get_format(mg_frame_t frame);
+
+/**
+ * @brief Grey image accessor
+ *
+ * the view of the frame converted to 8-bit grey, see mg_convert.h.
+ * the conversion runs on first use and the result is kept with the
+ * frame, so every consumer of the frame shares one conversion.  grey
+ * frames are returned without a copy.  the image memory belongs to
+ * the device and is reused once the capture buffer is requeued.
+ *
+ * @param frame  object handle
+ *
+ * @return grey image, with no data if no image data exists or the
+ * pixel format cannot be converted
+ */
+struct mg_image
+mg_frame_get_grey(mg_frame_t frame);
+
 /**
  * @brief Image data accessor
  *
@@ -98,6 +231,68 @@ mg_frame_get_image(mg_frame_t frame);
 int
 mg_frame_get_index(mg_frame_t frame);
 
+/**
+ * @brief Image pyramid level accessor
+ *
+ * level 0 is the grey image, see mg_frame_get_grey(), every further
+ * level is the one above reduced to half its width and height by a 2x2
+ * mean.  levels are built once per frame and shared by every consumer,
+ * either in advance for devices configured with mg_config_set_pyramid()
+ * or on first use.  frames with search windows only get the windows
+ * reduced, see mg_frame_get_windows(); the rest of levels 1 and up is
+ * left as it was.  the memory belongs to the device and is reused once
+ * the capture buffer is requeued.
+ *
+ * @param frame  object handle
+ * @param level  pyramid level, at most MG_PYRAMID_LEVELS
+ *
+ * @return the level, with no data if the image is too small or no grey
+ * image exists
+ */
+struct mg_image
+mg_frame_get_level(mg_frame_t frame,
+		   unsigned int level);
+
+/**
+ * @brief Memory plane accessor
+ *
+ * devices using the multi-planar API deliver formats such as NV12M with
+ * every plane in its own memory area.  plane 0 of single-planar formats
+ * is the whole image, see mg_frame_get_image().
+ *
+ * @param frame  object handle
+ * @param plane  plane index, less than mg_frame_get_planes()
+ *
+ * @return the plane, with no data if the plane does not exist
+ */
+struct mg_plane
+mg_frame_get_plane(mg_frame_t frame,
+		   unsigned int plane);
+
+/**
+ * @brief Number of memory planes accessor
+ *
+ * @param frame  object handle
+ *
+ * @return the number of memory planes of the capture buffer
+ */
+unsigned int
+mg_frame_get_planes(mg_frame_t frame);
+
+/**
+ * @brief Region of interest accessor
+ *
+ * the region of interest in effect when the frame was captured, see
+ * mg_set_roi().
+ *
+ * @param frame  object handle
+ *
+ * @return region of interest in full frame coordinates, the full frame
+ * if no region of interest is set
+ */
+struct mg_rect
+mg_frame_get_roi(mg_frame_t frame);
+
 /**
  * @brief Sequence number accessor
  *
@@ -111,6 +306,21 @@ mg_frame_get_index(mg_frame_t frame);
 uint32_t
 mg_frame_get_sequence(mg_frame_t frame);
 
+/**
+ * @brief Image statistics accessor
+ *
+ * the statistics of the grey image, worked out on first use unless the
+ * device configuration had them worked out in advance, see
+ * mg_config_set_stats().
+ *
+ * @param frame  object handle
+ *
+ * @return the statistics, valid as long as the frame is, or 0 if the
+ * frame has no grey image
+ */
+const struct mg_stats *
+mg_frame_get_stats(mg_frame_t frame);
+
 /**
  * @brief Time stamp accessor
  *
@@ -125,6 +335,20 @@ mg_frame_get_sequence(mg_frame_t frame);
 struct timeval
 mg_frame_get_timestamp(mg_frame_t frame);
 
+/**
+ * @brief Region of interest image accessor
+ *
+ * the view covers the region of interest only, whether the hardware
+ * cropped the image to the region or not.  pixel (0, 0) of the view is
+ * pixel (roi.left, roi.top) of the full frame.
+ *
+ * @param frame  object handle
+ *
+ * @return view on the image data, with no data if no image data exists
+ */
+struct mg_image
+mg_frame_get_view(mg_frame_t frame);
+
 /**
  * @brief Old frame indicator
  *
@@ -149,6 +373,31 @@ mg_frame_get_used(mg_frame_t frame);
 void *
 mg_frame_get_userptr(mg_frame_t frame);
 
+/**
+ * @brief Search windows accessor
+ *
+ * the search windows set with mg_set_search_windows() when the frame
+ * was captured, in the coordinates of a pyramid level.  the windows are
+ * widened to multiples of 8 grey image pixels, so those of a level are
+ * half those of the level above, and clipped to the level.  a frame
+ * without windows, or one of the periodic full frame sweeps, has a
+ * single window covering the whole level.
+ *
+ * @param frame  object handle
+ * @param level  pyramid level, 0 being the grey image
+ * @param [out]window  search windows
+ * @param max  number of windows the array holds, MG_MAX_WINDOWS is
+ * always enough
+ *
+ * @return the number of search windows, of which at most @a max are
+ * stored, 0 if none fall inside the image
+ */
+unsigned int
+mg_frame_get_windows(mg_frame_t frame,
+		     unsigned int level,
+		     struct mg_rect *window,
+		     unsigned int max);
+
 /**
  * @brief Old frame indicator accessor
  *
@@ -159,6 +408,28 @@ mg_frame_get_userptr(mg_frame_t frame);
 mg_frame_t
 mg_frame_set_used(mg_frame_t frame);
 
+/**
+ * @brief Threshold the search windows of a pyramid level into spans
+ *
+ * see mg_threshold_windows() and mg_frame_get_windows().  the spans
+ * are in the coordinates of the level.
+ *
+ * @param frame  object handle
+ * @param level  pyramid level, 0 being the grey image
+ * @param threshold  lowest foreground value
+ * @param span  array to fill in
+ * @param max  number of spans the array holds
+ *
+ * @return the number of spans found, of which at most @a max are
+ * stored
+ */
+unsigned int
+mg_frame_threshold(mg_frame_t frame,
+		   unsigned int level,
+		   uint8_t threshold,
+		   struct mg_span *span,
+		   unsigned int max);
+
 __END_DECLS
 
 #endif /* ITL_MULTI_GEE_MG_FRAME_H */
@@ -0,0 +1,956 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee hot-plug device watcher definition
+ */
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fg_util.h"
+#include "mg_hotplug.h" /* class implemented */
+#include "sllist.h"
+#include "tv_util.h"
+
+USE_XASSERT
+
+/**
+ * @brief Name prefix of video capture nodes
+ */
+#define NODE_PREFIX "video"
+
+/**
+ * @brief Camera rule
+ */
+struct rule
+{
+	dev_t devno; /**< Device number, 0 for any */
+	char *bus_info; /**< Bus information, 0 for any */
+	void *userptr; /**< User defined pointer */
+	mg_config_t config; /**< Capture configuration */
+	int lost; /**< Identifier of the lost device the rule brings
+		    back, held open on /dev/null, or -1 for a rule of the
+		    application */
+};
+
+/**
+ * @brief Node waiting for the worker thread
+ */
+struct node
+{
+	char *name; /**< Node file name */
+	dev_t devno; /**< Device number at the time of the event */
+};
+
+/**
+ * @brief Test whether a node may match a rule
+ *
+ * @param hotplug  object handle
+ * @param devno  device number of the node
+ *
+ * @return \c true if a rule matches the device number, or does not
+ * name one
+ */
+static
+bool
+candidate(mg_hotplug_t hotplug,
+	  dev_t devno);
+
+/**
+ * @brief Find the rule that names exactly a device number and bus
+ *
+ * @param hotplug  object handle
+ * @param devno  device number, or 0 for any
+ * @param bus_info  bus information, or 0 for any
+ *
+ * @return the rule, or 0 if there is none
+ */
+static
+struct rule *
+find_key(mg_hotplug_t hotplug,
+	 dev_t devno,
+	 const char *bus_info);
+
+/**
+ * @brief Find the rule of a device
+ *
+ * @param hotplug  object handle
+ * @param devno  device number
+ * @param bus_info  bus information, or 0 if not known
+ *
+ * @return the first matching rule, or 0 if none matches
+ */
+static
+struct rule *
+find_rule(mg_hotplug_t hotplug,
+	  dev_t devno,
+	  const char *bus_info);
+
+/**
+ * @brief Free a rule
+ *
+ * the identifier of a lost device is released.
+ *
+ * @param rule  rule, no longer in the rule list
+ */
+static
+void
+free_rule(struct rule *rule);
+
+/**
+ * @brief Keep a file descriptor number from being reused
+ *
+ * the file is replaced by /dev/null, so the node is closed while the
+ * number stays in use.  if /dev/null cannot be opened, the file stays
+ * open.
+ *
+ * @param fd  file descriptor, or -1
+ *
+ * @return \a fd
+ */
+static
+int
+hold_fd(int fd);
+
+/**
+ * @brief Open and initialise a node
+ *
+ * the node is opened once to learn its bus information, and, if it
+ * matches a rule, opened again as the device of the rule.
+ *
+ * @param hotplug  object handle
+ * @param node  node to initialise
+ *
+ * @return initialised device, or 0 if the node matches no rule or
+ * cannot be initialised
+ */
+static
+mg_device_t
+init_node(mg_hotplug_t hotplug,
+	  struct node *node);
+
+/**
+ * @brief Test a rule against a device
+ *
+ * @param rule  camera rule
+ * @param devno  device number
+ * @param bus_info  bus information, or 0 if not known
+ *
+ * @return \c true if the rule matches, else \c false
+ */
+static
+bool
+match_rule(const struct rule *rule,
+	   dev_t devno,
+	   const char *bus_info);
+
+/**
+ * @brief Hand a node to the worker thread
+ *
+ * nodes that are not video capture nodes, that match no rule, that are
+ * known to the caller, or that the worker already has, are skipped.
+ *
+ * @param hotplug  object handle
+ * @param name  node name, relative to the watched directory
+ * @param known  returns \c true for device numbers already in use
+ * @param arg  argument passed to \a known
+ *
+ * @return \c true if the node was handed over, else \c false
+ */
+static
+bool
+queue_node(mg_hotplug_t hotplug,
+	   const char *name,
+	   bool (*known)(void *arg, dev_t devno),
+	   void *arg);
+
+/**
+ * @brief Test whether the worker thread already has a device
+ *
+ * must be called with the lock held.
+ *
+ * @param hotplug  object handle
+ * @param devno  device number
+ *
+ * @return \c true if the device is waiting, being initialised, or
+ * ready, else \c false
+ */
+static
+bool
+queued(mg_hotplug_t hotplug,
+       dev_t devno);
+
+/**
+ * @brief Initialise nodes handed over by mg_hotplug_poll()
+ *
+ * @param arg  hot-plug watcher object handle
+ *
+ * @return 0
+ */
+static
+void *
+worker(void *arg);
+
+/**
+ * @brief Hot-plug watcher object structure
+ */
+CLASS(mg_hotplug, mg_hotplug_t)
+{
+	int fd; /**< Inotify file descriptor */
+	char *dir; /**< Watched directory */
+	unsigned int num_bufs; /**< Capture buffers of new devices */
+	log_t log; /**< Log object handle */
+	bool rescan; /**< Directory to be scanned on the next poll? */
+
+	pthread_t thread; /**< Worker thread */
+	bool running; /**< Worker thread started? */
+	bool stop; /**< Worker thread to exit? */
+	pthread_mutex_t lock; /**< Guards the lists below */
+	pthread_cond_t cond; /**< Signals nodes to initialise */
+	sllist_t rule; /**< Camera rules */
+	sllist_t pending; /**< Nodes to initialise */
+	dev_t current; /**< Node being initialised, 0 if none */
+	sllist_t ready; /**< Initialised devices */
+};
+
+mg_hotplug_t
+mg_hotplug_create(const char *dir,
+		  unsigned int num_bufs,
+		  log_t log)
+{
+	mg_hotplug_t mg_hotplug;
+	NEWOBJ(mg_hotplug);
+
+	STRDUP(mg_hotplug->dir, dir);
+	mg_hotplug->num_bufs = num_bufs;
+	mg_hotplug->log = log;
+	mg_hotplug->rescan = true;
+
+	mg_hotplug->running = false;
+	mg_hotplug->stop = false;
+	pthread_mutex_init(&mg_hotplug->lock, 0);
+	pthread_cond_init(&mg_hotplug->cond, 0);
+	mg_hotplug->rule = 0;
+	mg_hotplug->pending = 0;
+	mg_hotplug->current = 0;
+	mg_hotplug->ready = 0;
+
+	mg_hotplug->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (-1 == mg_hotplug->fd) {
+		lg_errno(log, "inotify_init1");
+		return mg_hotplug_destroy(mg_hotplug);
+	}
+
+	/* udev creates the node first, and sets its permissions after */
+	if (-1 == inotify_add_watch(mg_hotplug->fd, dir,
+				    IN_CREATE | IN_ATTRIB | IN_MOVED_TO)) {
+		lg_errno(log, "cannot watch %s", dir);
+		return mg_hotplug_destroy(mg_hotplug);
+	}
+
+	int err = pthread_create(&mg_hotplug->thread, 0, worker, mg_hotplug);
+	if (err) {
+		errno = err;
+		lg_errno(log, "cannot start hot-plug worker");
+		return mg_hotplug_destroy(mg_hotplug);
+	}
+	mg_hotplug->running = true;
+
+	return mg_hotplug;
+}
+
+mg_hotplug_t
+mg_hotplug_destroy(mg_hotplug_t mg_hotplug)
+{
+	VERIFYZ(mg_hotplug) {
+		if (mg_hotplug->running) {
+			pthread_mutex_lock(&mg_hotplug->lock);
+			mg_hotplug->stop = true;
+			pthread_cond_broadcast(&mg_hotplug->cond);
+			pthread_mutex_unlock(&mg_hotplug->lock);
+			pthread_join(mg_hotplug->thread, 0);
+		}
+
+		for (sllist_t r = mg_hotplug->rule; r; r = sllist_next(r)) {
+			free_rule(sllist_data(r));
+		}
+		mg_hotplug->rule = sllist_empty(mg_hotplug->rule);
+
+		for (sllist_t n = mg_hotplug->pending; n; n = sllist_next(n)) {
+			struct node *node = sllist_data(n);
+			FREEOBJ(node->name);
+			FREEOBJ(node);
+		}
+		mg_hotplug->pending = sllist_empty(mg_hotplug->pending);
+
+		for (sllist_t d = mg_hotplug->ready; d; d = sllist_next(d)) {
+			mg_device_t dev = sllist_data(d);
+			fg_uninit_device(dev, mg_hotplug->log);
+			mg_device_destroy(dev);
+		}
+		mg_hotplug->ready = sllist_empty(mg_hotplug->ready);
+
+		pthread_mutex_destroy(&mg_hotplug->lock);
+		pthread_cond_destroy(&mg_hotplug->cond);
+
+		if (-1 != mg_hotplug->fd) {
+			close(mg_hotplug->fd);
+		}
+		FREEOBJ(mg_hotplug->dir);
+		FREEOBJ(mg_hotplug);
+	}
+
+	return 0;
+}
+
+mg_hotplug_t
+mg_hotplug_add_lost(mg_hotplug_t mg_hotplug,
+		    mg_device_t device)
+{
+	mg_hotplug_t p = 0;
+
+	VERIFY(mg_hotplug) {
+		/* the node may come back under another name and number */
+		const char *bus_info = mg_device_get_bus_info(device);
+		dev_t devno = bus_info ? 0 : mg_device_get_devno(device);
+
+		pthread_mutex_lock(&mg_hotplug->lock);
+		if (!find_key(mg_hotplug, devno, bus_info)) {
+			struct rule *rule = MALLOC(sizeof(*rule));
+			rule->devno = devno;
+			rule->bus_info = 0;
+			if (bus_info) {
+				STRDUP(rule->bus_info, bus_info);
+			}
+			mg_config_t config = mg_device_get_config(device);
+			rule->userptr = mg_device_get_userptr(device);
+			rule->config = config ? mg_config_copy(config) : 0;
+			rule->lost = hold_fd(mg_device_take_fd(device));
+			mg_hotplug->rule =
+				sllist_insert_data(mg_hotplug->rule, rule);
+			mg_hotplug->rescan = true;
+		}
+		pthread_mutex_unlock(&mg_hotplug->lock);
+		p = mg_hotplug;
+	}
+
+	return p;
+}
+
+mg_hotplug_t
+mg_hotplug_add_rule(mg_hotplug_t mg_hotplug,
+		    dev_t devno,
+		    const char *bus_info,
+		    void *userptr,
+		    mg_config_t config)
+{
+	mg_hotplug_t p = 0;
+
+	VERIFY(mg_hotplug) {
+		pthread_mutex_lock(&mg_hotplug->lock);
+
+		struct rule *rule = find_key(mg_hotplug, devno, bus_info);
+		if (rule) {
+			mg_config_destroy(rule->config);
+		} else {
+			rule = MALLOC(sizeof(*rule));
+			rule->devno = devno;
+			rule->bus_info = 0;
+			if (bus_info) {
+				STRDUP(rule->bus_info, bus_info);
+			}
+			mg_hotplug->rule =
+				sllist_insert_data(mg_hotplug->rule, rule);
+		}
+		rule->userptr = userptr;
+		rule->config = config ? mg_config_copy(config) : 0;
+		rule->lost = -1;
+
+		/* the camera may be plugged in already */
+		mg_hotplug->rescan = true;
+
+		pthread_mutex_unlock(&mg_hotplug->lock);
+		p = mg_hotplug;
+	}
+
+	return p;
+}
+
+bool
+mg_hotplug_drop_lost(mg_hotplug_t mg_hotplug,
+		     int id)
+{
+	bool dropped = false;
+
+	VERIFY(mg_hotplug) {
+		pthread_mutex_lock(&mg_hotplug->lock);
+		for (sllist_t r = mg_hotplug->rule; r; r = sllist_next(r)) {
+			struct rule *rule = sllist_data(r);
+			if (-1 != id && rule->lost == id) {
+				mg_hotplug->rule =
+					sllist_remove_data(mg_hotplug->rule,
+							   rule);
+				free_rule(rule);
+				dropped = true;
+				break;
+			}
+		}
+		pthread_mutex_unlock(&mg_hotplug->lock);
+	}
+
+	return dropped;
+}
+
+mg_hotplug_t
+mg_hotplug_found(mg_hotplug_t mg_hotplug,
+		 mg_device_t device)
+{
+	mg_hotplug_t p = 0;
+
+	VERIFY(mg_hotplug) {
+		dev_t devno = mg_device_get_devno(device);
+		const char *bus_info = mg_device_get_bus_info(device);
+
+		pthread_mutex_lock(&mg_hotplug->lock);
+		sllist_t r = mg_hotplug->rule;
+		while (r) {
+			struct rule *rule = sllist_data(r);
+			r = sllist_next(r);
+			if (-1 != rule->lost
+			    && match_rule(rule, devno, bus_info)) {
+				mg_hotplug->rule =
+					sllist_remove_data(mg_hotplug->rule,
+							   rule);
+				free_rule(rule);
+			}
+		}
+		pthread_mutex_unlock(&mg_hotplug->lock);
+		p = mg_hotplug;
+	}
+
+	return p;
+}
+
+int
+mg_hotplug_get_fd(mg_hotplug_t mg_hotplug)
+{
+	int fd = -1;
+	VERIFY(mg_hotplug) {
+		fd = mg_hotplug->fd;
+	}
+
+	return fd;
+}
+
+int
+mg_hotplug_poll(mg_hotplug_t mg_hotplug,
+		bool (*known)(void *arg, dev_t devno),
+		void *arg)
+{
+	int count = -1;
+
+	VERIFY(mg_hotplug) {
+		char buf[4096]
+			__attribute__((aligned(__alignof__(struct inotify_event))));
+
+		count = 0;
+		for (;;) {
+			ssize_t len = read(mg_hotplug->fd, buf, sizeof(buf));
+			if (-1 == len) {
+				if (EINTR == errno) {
+					continue;
+				}
+				if (EAGAIN != errno) {
+					lg_errno(mg_hotplug->log, "read inotify");
+					count = -1;
+				}
+				break;
+			}
+
+			for (char *p = buf; p < buf + len; ) {
+				struct inotify_event *event =
+					(struct inotify_event *) p;
+				p += sizeof(*event) + event->len;
+
+				if (event->mask & IN_Q_OVERFLOW) {
+					/* events were lost */
+					mg_hotplug->rescan = true;
+				} else if (event->len
+					   && queue_node(mg_hotplug,
+							 event->name,
+							 known, arg)) {
+					count++;
+				}
+			}
+		}
+
+		if (mg_hotplug->rescan && -1 != count) {
+			mg_hotplug->rescan = false;
+
+			DIR *dir = opendir(mg_hotplug->dir);
+			if (!dir) {
+				lg_errno(mg_hotplug->log, "cannot scan %s",
+					 mg_hotplug->dir);
+				count = -1;
+			} else {
+				struct dirent *entry;
+				while ((entry = readdir(dir))) {
+					if (queue_node(mg_hotplug,
+						       entry->d_name,
+						       known, arg)) {
+						count++;
+					}
+				}
+				closedir(dir);
+			}
+		}
+	}
+
+	return count;
+}
+
+mg_device_t
+mg_hotplug_take(mg_hotplug_t mg_hotplug)
+{
+	mg_device_t dev = 0;
+
+	VERIFY(mg_hotplug) {
+		pthread_mutex_lock(&mg_hotplug->lock);
+		if (mg_hotplug->ready) {
+			dev = sllist_data(mg_hotplug->ready);
+			mg_hotplug->ready =
+				sllist_remove_data(mg_hotplug->ready, dev);
+		}
+		pthread_mutex_unlock(&mg_hotplug->lock);
+	}
+
+	return dev;
+}
+
+bool
+candidate(mg_hotplug_t mg_hotplug,
+	  dev_t devno)
+{
+	for (sllist_t r = mg_hotplug->rule; r; r = sllist_next(r)) {
+		struct rule *rule = sllist_data(r);
+		if (!rule->devno || rule->devno == devno) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+struct rule *
+find_key(mg_hotplug_t mg_hotplug,
+	 dev_t devno,
+	 const char *bus_info)
+{
+	for (sllist_t r = mg_hotplug->rule; r; r = sllist_next(r)) {
+		struct rule *rule = sllist_data(r);
+		if (rule->devno == devno
+		    && (rule->bus_info == bus_info
+			|| (rule->bus_info && bus_info
+			    && !strcmp(rule->bus_info, bus_info)))) {
+			return rule;
+		}
+	}
+
+	return 0;
+}
+
+struct rule *
+find_rule(mg_hotplug_t mg_hotplug,
+	  dev_t devno,
+	  const char *bus_info)
+{
+	for (sllist_t r = mg_hotplug->rule; r; r = sllist_next(r)) {
+		struct rule *rule = sllist_data(r);
+		if (match_rule(rule, devno, bus_info)) {
+			return rule;
+		}
+	}
+
+	return 0;
+}
+
+void
+free_rule(struct rule *rule)
+{
+	if (-1 != rule->lost) {
+		close(rule->lost);
+	}
+	FREEOBJ(rule->bus_info);
+	mg_config_destroy(rule->config);
+	FREEOBJ(rule);
+}
+
+int
+hold_fd(int fd)
+{
+	if (-1 != fd) {
+		int null = open("/dev/null", O_RDONLY | O_CLOEXEC);
+		if (-1 != null) {
+			dup2(null, fd);
+			close(null);
+		}
+	}
+
+	return fd;
+}
+
+mg_device_t
+init_node(mg_hotplug_t mg_hotplug,
+	  struct node *node)
+{
+	struct timeval start;
+	struct timeval end;
+	gettimeofday(&start, 0);
+
+	/* find out where the camera is plugged in */
+	mg_device_t dev = mg_device_create(node->name, 0, mg_hotplug->log, 0);
+	bool ok = mg_device_get_devno(dev) == node->devno
+		&& -1 != mg_device_open(dev)
+		&& fg_test_capability(dev, mg_hotplug->log);
+
+	pthread_mutex_lock(&mg_hotplug->lock);
+	struct rule *rule = ok
+		? find_rule(mg_hotplug, node->devno,
+			    mg_device_get_bus_info(dev))
+		: 0;
+	mg_device_destroy(dev);
+	dev = 0;
+	if (rule) {
+		dev = mg_device_create(node->name,
+				       mg_hotplug->num_bufs,
+				       mg_hotplug->log,
+				       rule->userptr);
+		if (rule->config) {
+			mg_device_set_config(dev, rule->config);
+		}
+	}
+	pthread_mutex_unlock(&mg_hotplug->lock);
+
+	if (!dev) {
+		return 0;
+	}
+
+	if (mg_device_get_devno(dev) != node->devno
+	    || -1 == mg_device_open(dev)
+	    || !fg_init_device(dev, mg_hotplug->log)) {
+		lg_log(mg_hotplug->log, "cannot initialise %s", node->name);
+		return mg_device_destroy(dev);
+	}
+
+	gettimeofday(&end, 0);
+	timersub(&end, &start, &end);
+	lg_log(mg_hotplug->log, "%s (%s) initialised in %ld.%06ld",
+	       node->name,
+	       mg_device_get_bus_info(dev),
+	       end.tv_sec,
+	       end.tv_usec);
+
+	return dev;
+}
+
+bool
+match_rule(const struct rule *rule,
+	   dev_t devno,
+	   const char *bus_info)
+{
+	if (rule->devno && rule->devno != devno) {
+		return false;
+	}
+	if (rule->bus_info
+	    && (!bus_info || strcmp(rule->bus_info, bus_info))) {
+		return false;
+	}
+
+	return true;
+}
+
+bool
+queue_node(mg_hotplug_t mg_hotplug,
+	   const char *name,
+	   bool (*known)(void *arg, dev_t devno),
+	   void *arg)
+{
+	if (strncmp(name, NODE_PREFIX, strlen(NODE_PREFIX))) {
+		return false;
+	}
+
+	size_t size = strlen(mg_hotplug->dir) + strlen(name) + 2;
+	char path[size];
+	snprintf(path, size, "%s/%s", mg_hotplug->dir, name);
+
+	struct stat st;
+	if (0 != stat(path, &st) || !S_ISCHR(st.st_mode)) {
+		return false;
+	}
+	if (known && known(arg, st.st_rdev)) {
+		return false;
+	}
+
+	bool ok = false;
+	pthread_mutex_lock(&mg_hotplug->lock);
+	if (candidate(mg_hotplug, st.st_rdev)
+	    && !queued(mg_hotplug, st.st_rdev)) {
+		struct node *node = MALLOC(sizeof(*node));
+		STRDUP(node->name, path);
+		node->devno = st.st_rdev;
+		mg_hotplug->pending =
+			sllist_insert_data(mg_hotplug->pending, node);
+		pthread_cond_broadcast(&mg_hotplug->cond);
+		ok = true;
+	}
+	pthread_mutex_unlock(&mg_hotplug->lock);
+
+	return ok;
+}
+
+bool
+queued(mg_hotplug_t mg_hotplug,
+       dev_t devno)
+{
+	if (mg_hotplug->current == devno) {
+		return true;
+	}
+	for (sllist_t n = mg_hotplug->pending; n; n = sllist_next(n)) {
+		struct node *node = sllist_data(n);
+		if (node->devno == devno) {
+			return true;
+		}
+	}
+	for (sllist_t d = mg_hotplug->ready; d; d = sllist_next(d)) {
+		if (mg_device_get_devno(sllist_data(d)) == devno) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void *
+worker(void *arg)
+{
+	mg_hotplug_t mg_hotplug = arg;
+
+	pthread_mutex_lock(&mg_hotplug->lock);
+	for (;;) {
+		while (!mg_hotplug->pending && !mg_hotplug->stop) {
+			pthread_cond_wait(&mg_hotplug->cond,
+					  &mg_hotplug->lock);
+		}
+		if (mg_hotplug->stop) {
+			break;
+		}
+		struct node *node = sllist_data(mg_hotplug->pending);
+		mg_hotplug->pending =
+			sllist_remove_data(mg_hotplug->pending, node);
+		mg_hotplug->current = node->devno;
+		pthread_mutex_unlock(&mg_hotplug->lock);
+
+		/* opening a camera takes long, keep it off the capture loop */
+		mg_device_t dev = init_node(mg_hotplug, node);
+		FREEOBJ(node->name);
+		FREEOBJ(node);
+
+		pthread_mutex_lock(&mg_hotplug->lock);
+		if (dev) {
+			mg_hotplug->ready =
+				sllist_insert_data(mg_hotplug->ready, dev);
+		}
+		mg_hotplug->current = 0;
+	}
+	pthread_mutex_unlock(&mg_hotplug->lock);
+
+	return 0;
+}
+
+#ifdef TEST_MULTI_GEE_MG_HOTPLUG
+
+#include <stdlib.h>
+
+static
+bool
+known_null(void *arg,
+	   dev_t devno)
+{
+	(void) arg;
+	return devno == makedev(1, 3);
+}
+
+static
+void
+link_node(const char *dir,
+	  const char *name,
+	  const char *target)
+{
+	char path[256];
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	XASSERT(0 == symlink(target, path)) {
+		/* empty */
+	}
+}
+
+static
+void
+mg_hotplug()
+{
+	/* rules match on every field they name */
+	struct rule any = {0, 0, 0, 0, -1};
+	struct rule by_devno = {makedev(81, 0), 0, 0, 0, -1};
+	struct rule by_bus = {0, "usb-0000:00:14.0-1", 0, 0, -1};
+	XASSERT(match_rule(&any, makedev(81, 2), 0)) {
+		/* empty */
+	}
+	XASSERT(match_rule(&by_devno, makedev(81, 0), "usb-1")) {
+		/* empty */
+	}
+	XASSERT(!match_rule(&by_devno, makedev(81, 2), 0)) {
+		/* empty */
+	}
+	XASSERT(!match_rule(&by_bus, makedev(81, 0), 0)) {
+		/* empty */
+	}
+	XASSERT(match_rule(&by_bus, makedev(81, 2), "usb-0000:00:14.0-1")) {
+		/* empty */
+	}
+	XASSERT(!match_rule(&by_bus, makedev(81, 2), "usb-0000:00:14.0-2")) {
+		/* empty */
+	}
+
+	char dir[] = "/tmp/mg_hotplug-XXXXXX";
+	XASSERT(mkdtemp(dir)) {
+		/* empty */
+	}
+
+	log_t log = lg_create("mg_hotplug", "stderr");
+	mg_hotplug_t hp = mg_hotplug_create(dir, 3, log);
+	XASSERT(hp && 0 <= mg_hotplug_get_fd(hp)) {
+		/* empty */
+	}
+
+	/* without rules, no node is of interest */
+	link_node(dir, "video0", "/dev/null");
+	link_node(dir, "video1", "/dev/zero");
+	link_node(dir, "audio0", "/dev/null");
+	XASSERT(0 == mg_hotplug_poll(hp, 0, 0)) {
+		/* empty */
+	}
+
+	/* a new rule scans for nodes already there */
+	hp = mg_hotplug_add_rule(hp, makedev(1, 3), 0, 0, 0);
+	XASSERT(1 == mg_hotplug_poll(hp, 0, 0)) {
+		/* empty */
+	}
+	XASSERT(0 == mg_hotplug_poll(hp, 0, 0)) {
+		/* empty */
+	}
+
+	/* a bus rule needs every node opened, except known ones */
+	hp = mg_hotplug_add_rule(hp, 0, "usb-0000:00:14.0-1", 0, 0);
+	XASSERT(1 == mg_hotplug_poll(hp, known_null, 0)) {
+		/* empty */
+	}
+
+	/* nodes that appear later are seen through inotify */
+	link_node(dir, "video2", "/dev/full");
+	link_node(dir, "audio1", "/dev/full");
+	XASSERT(1 == mg_hotplug_poll(hp, known_null, 0)) {
+		/* empty */
+	}
+
+	/* the rule of a lost camera goes when it is back or deregistered */
+	mg_device_t zero = mg_device_create("/dev/zero", 3, log, 0);
+	int id = mg_device_open(zero);
+	hp = mg_hotplug_add_lost(hp, zero);
+	XASSERT(-1 == mg_device_get_fd(zero) && -1 != fcntl(id, F_GETFD)) {
+		/* empty */
+	}
+	XASSERT(mg_hotplug_drop_lost(hp, id)) {
+		/* empty */
+	}
+	XASSERT(!mg_hotplug_drop_lost(hp, id)) {
+		/* empty */
+	}
+	id = mg_device_open(zero);
+	hp = mg_hotplug_add_lost(hp, zero);
+	hp = mg_hotplug_found(hp, zero);
+	XASSERT(!mg_hotplug_drop_lost(hp, id)) {
+		/* empty */
+	}
+	zero = mg_device_destroy(zero);
+
+	/* the identifier is not handed out while the camera is away */
+	mg_device_t full = mg_device_create("/dev/full", 3, log, 0);
+	id = mg_device_open(full);
+	hp = mg_hotplug_add_lost(hp, full);
+	int fd = open("/dev/full", O_RDONLY);
+	XASSERT(-1 != fd && id != fd) {
+		/* empty */
+	}
+	close(fd);
+	XASSERT(mg_hotplug_drop_lost(hp, id) && -1 == fcntl(id, F_GETFD)) {
+		/* empty */
+	}
+	full = mg_device_destroy(full);
+
+	/* a rule of the application stays */
+	mg_device_t null = mg_device_create("/dev/null", 3, log, 0);
+	id = mg_device_open(null);
+	hp = mg_hotplug_add_lost(hp, null);
+	XASSERT(id == mg_device_get_fd(null)) {
+		/* empty */
+	}
+	XASSERT(!mg_hotplug_drop_lost(hp, id)) {
+		/* empty */
+	}
+	null = mg_device_destroy(null);
+
+	/* neither of the nodes is a camera */
+	hp = mg_hotplug_destroy(hp);
+	XASSERT(!hp) {
+		/* empty */
+	}
+
+	const char *name[] = {"video0", "video1", "video2", "audio0", "audio1"};
+	for (unsigned int i = 0; i < sizeof(name) / sizeof(name[0]); i++) {
+		char path[256];
+		snprintf(path, sizeof(path), "%s/%s", dir, name[i]);
+		unlink(path);
+	}
+	rmdir(dir);
+
+	log = lg_destroy(log);
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_hotplug));
+}
+
+#endif /* TEST_MULTI_GEE_MG_HOTPLUG */
@@ -0,0 +1,193 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee hot-plug device watcher declaration
+ *
+ * Watches a device directory with inotify for video capture nodes that
+ * appear, and matches them against rules.  A rule names a camera by its
+ * device number, or by the bus position the driver reports, which stays
+ * the same when a USB camera is plugged into the same port again.
+ * Matching nodes are opened and initialised on a worker thread, so the
+ * capture loop only has to pick up devices that are ready to stream.
+ */
+#ifndef ITL_MULTI_GEE_MG_HOTPLUG_H
+#define ITL_MULTI_GEE_MG_HOTPLUG_H
+
+#include <sys/types.h> /* dev_t */
+
+#include <multi-gee/log.h>
+#include <multi-gee/mg_config.h>
+#include <multi-gee/mg_device.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Multi-gee hot-plug watcher object handle
+ */
+NEWHANDLE(mg_hotplug_t);
+
+/**
+ * @brief Create hot-plug watcher object
+ *
+ * @param dir  directory to watch for \c video* nodes, usually "/dev"
+ * @param num_bufs  number of capture buffers of initialised devices
+ * @param log  object handle, to log error messages to
+ *
+ * @return a newly created hot-plug watcher object handle, or 0 if the
+ * directory cannot be watched
+ */
+mg_hotplug_t
+mg_hotplug_create(const char *dir,
+		  unsigned int num_bufs,
+		  log_t log);
+
+/**
+ * @brief Destroy hot-plug watcher object
+ *
+ * stops the worker thread, and destroys devices that were not taken.
+ *
+ * @param hotplug  handle of object to be destroyed
+ *
+ * @return 0
+ */
+mg_hotplug_t
+mg_hotplug_destroy(mg_hotplug_t hotplug);
+
+/**
+ * @brief Add a rule that brings a lost camera back
+ *
+ * the rule matches the bus position of the device, or its device
+ * number if the bus position is not known, and gives a matching node
+ * the device's configuration and user defined pointer.  a rule the
+ * application added for the same camera is kept as it is.
+ *
+ * the rule takes the device's file descriptor, its device identifier,
+ * and holds the number until the rule is dropped, so no other device
+ * gets the identifier meanwhile.
+ *
+ * @param hotplug  object handle
+ * @param device  the lost device
+ *
+ * @return object handle
+ */
+mg_hotplug_t
+mg_hotplug_add_lost(mg_hotplug_t hotplug,
+		    mg_device_t device);
+
+/**
+ * @brief Add a camera rule
+ *
+ * a rule with the same device number and bus information is replaced,
+ * also one that brings a lost camera back.
+ * a node that matches a rule is initialised with the rule's
+ * configuration, and gets the rule's user defined pointer.
+ *
+ * @param hotplug  object handle
+ * @param devno  device number to match, or 0 to match any
+ * @param bus_info  bus information to match, or 0 to match any
+ * @param userptr  user defined pointer of matching devices
+ * @param config  capture configuration of matching devices, copied,
+ * or 0 for the default configuration
+ *
+ * @return object handle
+ */
+mg_hotplug_t
+mg_hotplug_add_rule(mg_hotplug_t hotplug,
+		    dev_t devno,
+		    const char *bus_info,
+		    void *userptr,
+		    mg_config_t config);
+
+/**
+ * @brief Drop the rule of a lost camera
+ *
+ * @param hotplug  object handle
+ * @param id  device identifier of the lost device
+ *
+ * @return \c true if a rule was dropped, \c false if the device had
+ * none
+ */
+bool
+mg_hotplug_drop_lost(mg_hotplug_t hotplug,
+		     int id);
+
+/**
+ * @brief Drop the rules of lost cameras a device matches
+ *
+ * called once a device that came back is streaming, so a later loss
+ * adds a fresh rule.  rules of the application stay.
+ *
+ * @param hotplug  object handle
+ * @param device  the device that joined
+ *
+ * @return object handle
+ */
+mg_hotplug_t
+mg_hotplug_found(mg_hotplug_t hotplug,
+		 mg_device_t device);
+
+/**
+ * @brief Inotify file descriptor accessor
+ *
+ * the descriptor becomes readable when nodes appear in the watched
+ * directory; it can be added to the capture loop's select.
+ *
+ * @param hotplug  object handle
+ *
+ * @return file descriptor, or -1 on failure
+ */
+int
+mg_hotplug_get_fd(mg_hotplug_t hotplug);
+
+/**
+ * @brief Handle the pending directory events
+ *
+ * does not block.  nodes that match a rule, and are not known yet, are
+ * handed to the worker thread.  a node matched by bus information only
+ * is handed over too, as the bus information is only known once the
+ * node is opened.
+ *
+ * @param hotplug  object handle
+ * @param known  returns \c true for device numbers already in use
+ * @param arg  argument passed to \a known
+ *
+ * @return number of nodes handed to the worker thread, or -1 on
+ * failure
+ */
+int
+mg_hotplug_poll(mg_hotplug_t hotplug,
+		bool (*known)(void *arg, dev_t devno),
+		void *arg);
+
+/**
+ * @brief Take an initialised device
+ *
+ * the device is open and initialised, but not streaming.
+ *
+ * @param hotplug  object handle
+ *
+ * @return device object handle, owned by the caller, or 0 if no device
+ * is ready
+ */
+mg_device_t
+mg_hotplug_take(mg_hotplug_t hotplug);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_HOTPLUG_H */
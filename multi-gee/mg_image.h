@@ -0,0 +1,93 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee image geometry declaration
+ */
+#ifndef ITL_MULTI_GEE_MG_IMAGE_H
+#define ITL_MULTI_GEE_MG_IMAGE_H
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint32_t */
+
+/**
+ * @brief Maximum number of memory planes per image
+ *
+ * enough for the three-plane YUV formats of multi-planar drivers.
+ */
+#define MG_MAX_PLANES 3
+
+/**
+ * @brief Point in pixel coordinates
+ *
+ * pixel centres are on whole numbers.
+ */
+struct mg_point
+{
+	float x; /**< Column */
+	float y; /**< Line */
+};
+
+/**
+ * @brief Rectangle in full frame pixel coordinates
+ *
+ * a rectangle with zero width stands for the full frame.
+ */
+struct mg_rect
+{
+	int32_t left; /**< Left edge */
+	int32_t top; /**< Top edge */
+	uint32_t width; /**< Width in pixels */
+	uint32_t height; /**< Height in lines */
+};
+
+/**
+ * @brief Maximum number of search windows per device
+ *
+ * enough for a box around every marker of a full body set.
+ */
+#define MG_MAX_WINDOWS 64
+
+/**
+ * @brief View on image data
+ *
+ * the data is not owned by the view.
+ */
+struct mg_image
+{
+	void *data; /**< First byte of the top left pixel */
+	uint32_t width; /**< Width in pixels */
+	uint32_t height; /**< Height in lines */
+	uint32_t stride; /**< Distance between lines in bytes */
+};
+
+/**
+ * @brief Memory plane of a captured image
+ *
+ * single-planar formats have one plane holding the whole image.  the
+ * data is not owned by the plane.
+ */
+struct mg_plane
+{
+	void *data; /**< First byte of the plane */
+	size_t length; /**< Size of the plane in bytes */
+	uint32_t stride; /**< Distance between lines in bytes */
+	int dmabuf; /**< Exported DMABUF file descriptor, or -1 */
+};
+
+#endif /* ITL_MULTI_GEE_MG_IMAGE_H */
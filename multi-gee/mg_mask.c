@@ -0,0 +1,980 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee binary mask definition
+ */
+#include <string.h> /* memcpy, memset */
+
+#include "mg_mask.h" /* class implemented */
+#include "mg_threshold.h"
+
+#ifdef MG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Largest image side spans can address
+ */
+#define MAX_SIDE 65535
+
+/**
+ * @brief Erode or dilate the mask in place
+ *
+ * each line is first merged with the lines above and below, then with
+ * its left and right neighbours.  the original of the line above is
+ * kept in the scratch space, as the line itself is overwritten.
+ *
+ * @param mask  object handle
+ * @param erode  erode rather than dilate?
+ * @param simd  kernel to use
+ */
+static
+void
+morph(mg_mask_t mask,
+      bool erode,
+      enum mg_simd simd);
+
+/**
+ * @brief Binary mask object structure
+ */
+CLASS(mg_mask, mg_mask_t)
+{
+	uint32_t width; /**< Width in pixels */
+	uint32_t height; /**< Height in lines */
+	uint32_t words; /**< Words per line */
+	uint64_t *bits; /**< Lines, followed by scratch space */
+	size_t capacity; /**< Words allocated */
+};
+
+/**
+ * @brief Merge three lines
+ *
+ * @param up  line above
+ * @param line  the line
+ * @param down  line below
+ * @param dst  merged line
+ * @param words  number of words
+ * @param erode  and rather than or?
+ */
+typedef void (*merge_fn)(const uint64_t *up,
+			 const uint64_t *line,
+			 const uint64_t *down,
+			 uint64_t *dst,
+			 uint32_t words,
+			 bool erode);
+
+/**
+ * @brief Merge every pixel of a line with its left and right neighbour
+ *
+ * the words before and after the line are read as well.
+ *
+ * @param src  line
+ * @param dst  merged line
+ * @param words  number of words
+ * @param erode  and rather than or?
+ */
+typedef void (*spread_fn)(const uint64_t *src,
+			  uint64_t *dst,
+			  uint32_t words,
+			  bool erode);
+
+/**
+ * @brief Merge a mask into another
+ *
+ * @param dst  mask merged into
+ * @param src  other mask
+ * @param words  number of words
+ * @param op  how the masks are merged
+ */
+typedef void (*combine_fn)(uint64_t *dst,
+			   const uint64_t *src,
+			   size_t words,
+			   enum mg_mask_op op);
+
+static
+void
+merge_scalar(const uint64_t *up,
+	     const uint64_t *line,
+	     const uint64_t *down,
+	     uint64_t *dst,
+	     uint32_t words,
+	     bool erode)
+{
+	for (uint32_t i = 0; i < words; i++) {
+		dst[i] = erode ? up[i] & line[i] & down[i]
+			: up[i] | line[i] | down[i];
+	}
+}
+
+static
+void
+spread_scalar(const uint64_t *src,
+	      uint64_t *dst,
+	      uint32_t words,
+	      bool erode)
+{
+	const uint64_t *before = src - 1;
+	const uint64_t *after = src + 1;
+	for (uint32_t i = 0; i < words; i++) {
+		uint64_t v = src[i];
+		uint64_t l = v << 1 | before[i] >> 63;
+		uint64_t r = v >> 1 | after[i] << 63;
+		dst[i] = erode ? v & l & r : v | l | r;
+	}
+}
+
+static
+void
+combine_scalar(uint64_t *dst,
+	       const uint64_t *src,
+	       size_t words,
+	       enum mg_mask_op op)
+{
+	for (size_t i = 0; i < words; i++) {
+		switch (op) {
+		case MG_MASK_AND:
+			dst[i] &= src[i];
+			break;
+		case MG_MASK_OR:
+			dst[i] |= src[i];
+			break;
+		case MG_MASK_AND_NOT:
+			dst[i] &= ~src[i];
+			break;
+		}
+	}
+}
+
+#ifdef MG_SIMD_X86
+
+MG_TARGET_SSE2
+static
+void
+merge_sse2(const uint64_t *up,
+	   const uint64_t *line,
+	   const uint64_t *down,
+	   uint64_t *dst,
+	   uint32_t words,
+	   bool erode)
+{
+	uint32_t i = 0;
+	for (; i + 2 <= words; i += 2) {
+		__m128i u = _mm_loadu_si128((const __m128i *) (up + i));
+		__m128i l = _mm_loadu_si128((const __m128i *) (line + i));
+		__m128i d = _mm_loadu_si128((const __m128i *) (down + i));
+		__m128i m = erode
+			? _mm_and_si128(_mm_and_si128(u, l), d)
+			: _mm_or_si128(_mm_or_si128(u, l), d);
+		_mm_storeu_si128((__m128i *) (dst + i), m);
+	}
+	if (i < words) {
+		merge_scalar(up + i, line + i, down + i, dst + i, words - i,
+			     erode);
+	}
+}
+
+MG_TARGET_SSE2
+static
+void
+spread_sse2(const uint64_t *src,
+	    uint64_t *dst,
+	    uint32_t words,
+	    bool erode)
+{
+	uint32_t i = 0;
+	for (; i + 2 <= words; i += 2) {
+		__m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+		__m128i b = _mm_loadu_si128((const __m128i *) (src + i - 1));
+		__m128i a = _mm_loadu_si128((const __m128i *) (src + i + 1));
+		/* the bits that cross into the next word come from b and a */
+		__m128i l = _mm_or_si128(_mm_slli_epi64(v, 1),
+					 _mm_srli_epi64(b, 63));
+		__m128i r = _mm_or_si128(_mm_srli_epi64(v, 1),
+					 _mm_slli_epi64(a, 63));
+		__m128i m = erode
+			? _mm_and_si128(_mm_and_si128(v, l), r)
+			: _mm_or_si128(_mm_or_si128(v, l), r);
+		_mm_storeu_si128((__m128i *) (dst + i), m);
+	}
+	if (i < words) {
+		spread_scalar(src + i, dst + i, words - i, erode);
+	}
+}
+
+MG_TARGET_SSE2
+static
+void
+combine_sse2(uint64_t *dst,
+	     const uint64_t *src,
+	     size_t words,
+	     enum mg_mask_op op)
+{
+	size_t i = 0;
+	for (; i + 2 <= words; i += 2) {
+		__m128i d = _mm_loadu_si128((const __m128i *) (dst + i));
+		__m128i s = _mm_loadu_si128((const __m128i *) (src + i));
+		switch (op) {
+		case MG_MASK_AND:
+			d = _mm_and_si128(d, s);
+			break;
+		case MG_MASK_OR:
+			d = _mm_or_si128(d, s);
+			break;
+		case MG_MASK_AND_NOT:
+			d = _mm_andnot_si128(s, d);
+			break;
+		}
+		_mm_storeu_si128((__m128i *) (dst + i), d);
+	}
+	if (i < words) {
+		combine_scalar(dst + i, src + i, words - i, op);
+	}
+}
+
+MG_TARGET_AVX2
+static
+void
+merge_avx2(const uint64_t *up,
+	   const uint64_t *line,
+	   const uint64_t *down,
+	   uint64_t *dst,
+	   uint32_t words,
+	   bool erode)
+{
+	uint32_t i = 0;
+	for (; i + 4 <= words; i += 4) {
+		__m256i u = _mm256_loadu_si256((const __m256i *) (up + i));
+		__m256i l = _mm256_loadu_si256((const __m256i *) (line + i));
+		__m256i d = _mm256_loadu_si256((const __m256i *) (down + i));
+		__m256i m = erode
+			? _mm256_and_si256(_mm256_and_si256(u, l), d)
+			: _mm256_or_si256(_mm256_or_si256(u, l), d);
+		_mm256_storeu_si256((__m256i *) (dst + i), m);
+	}
+	if (i < words) {
+		merge_sse2(up + i, line + i, down + i, dst + i, words - i,
+			   erode);
+	}
+}
+
+MG_TARGET_AVX2
+static
+void
+spread_avx2(const uint64_t *src,
+	    uint64_t *dst,
+	    uint32_t words,
+	    bool erode)
+{
+	uint32_t i = 0;
+	for (; i + 4 <= words; i += 4) {
+		__m256i v = _mm256_loadu_si256((const __m256i *) (src + i));
+		__m256i b = _mm256_loadu_si256((const __m256i *) (src + i - 1));
+		__m256i a = _mm256_loadu_si256((const __m256i *) (src + i + 1));
+		__m256i l = _mm256_or_si256(_mm256_slli_epi64(v, 1),
+					    _mm256_srli_epi64(b, 63));
+		__m256i r = _mm256_or_si256(_mm256_srli_epi64(v, 1),
+					    _mm256_slli_epi64(a, 63));
+		__m256i m = erode
+			? _mm256_and_si256(_mm256_and_si256(v, l), r)
+			: _mm256_or_si256(_mm256_or_si256(v, l), r);
+		_mm256_storeu_si256((__m256i *) (dst + i), m);
+	}
+	if (i < words) {
+		spread_sse2(src + i, dst + i, words - i, erode);
+	}
+}
+
+MG_TARGET_AVX2
+static
+void
+combine_avx2(uint64_t *dst,
+	     const uint64_t *src,
+	     size_t words,
+	     enum mg_mask_op op)
+{
+	size_t i = 0;
+	for (; i + 4 <= words; i += 4) {
+		__m256i d = _mm256_loadu_si256((const __m256i *) (dst + i));
+		__m256i s = _mm256_loadu_si256((const __m256i *) (src + i));
+		switch (op) {
+		case MG_MASK_AND:
+			d = _mm256_and_si256(d, s);
+			break;
+		case MG_MASK_OR:
+			d = _mm256_or_si256(d, s);
+			break;
+		case MG_MASK_AND_NOT:
+			d = _mm256_andnot_si256(s, d);
+			break;
+		}
+		_mm256_storeu_si256((__m256i *) (dst + i), d);
+	}
+	if (i < words) {
+		combine_sse2(dst + i, src + i, words - i, op);
+	}
+}
+
+/**
+ * @brief Line merge kernel per instruction set level
+ */
+static const merge_fn merge_line[] = {
+	merge_scalar,
+	merge_sse2,
+	merge_avx2
+};
+
+/**
+ * @brief Neighbour merge kernel per instruction set level
+ */
+static const spread_fn spread_line[] = {
+	spread_scalar,
+	spread_sse2,
+	spread_avx2
+};
+
+/**
+ * @brief Mask merge kernel per instruction set level
+ */
+static const combine_fn combine_words[] = {
+	combine_scalar,
+	combine_sse2,
+	combine_avx2
+};
+
+#else /* MG_SIMD_X86 */
+
+static const merge_fn merge_line[] = {
+	merge_scalar,
+	merge_scalar,
+	merge_scalar
+};
+
+static const spread_fn spread_line[] = {
+	spread_scalar,
+	spread_scalar,
+	spread_scalar
+};
+
+static const combine_fn combine_words[] = {
+	combine_scalar,
+	combine_scalar,
+	combine_scalar
+};
+
+#endif /* MG_SIMD_X86 */
+
+mg_mask_t
+mg_mask_create(uint32_t width,
+	       uint32_t height)
+{
+	mg_mask_t mg_mask;
+	NEWOBJ(mg_mask);
+
+	mg_mask->width = 0;
+	mg_mask->height = 0;
+	mg_mask->words = 0;
+	mg_mask->bits = 0;
+	mg_mask->capacity = 0;
+
+	if (!mg_mask_set_size(mg_mask, width, height)) {
+		mg_mask = mg_mask_destroy(mg_mask);
+	}
+
+	return mg_mask;
+}
+
+mg_mask_t
+mg_mask_destroy(mg_mask_t mg_mask)
+{
+	VERIFYZ(mg_mask) {
+		FREEOBJ(mg_mask->bits);
+
+		FREEOBJ(mg_mask);
+	}
+
+	return 0;
+}
+
+mg_mask_t
+mg_mask_clear(mg_mask_t mg_mask)
+{
+	mg_mask_t p = 0;
+
+	VERIFY(mg_mask) {
+		memset(mg_mask->bits, 0, (size_t) mg_mask->words
+		       * mg_mask->height * sizeof(*mg_mask->bits));
+		p = mg_mask;
+	}
+
+	return p;
+}
+
+mg_mask_t
+mg_mask_close(mg_mask_t mg_mask,
+	      enum mg_simd simd)
+{
+	return mg_mask_erode(mg_mask_dilate(mg_mask, simd), simd);
+}
+
+mg_mask_t
+mg_mask_combine(mg_mask_t mg_mask,
+		mg_mask_t other,
+		enum mg_mask_op op,
+		enum mg_simd simd)
+{
+	mg_mask_t p = 0;
+
+	VERIFY(mg_mask) {
+		VERIFY(other) {
+			if (other->width != mg_mask->width
+			    || other->height != mg_mask->height) {
+				return 0;
+			}
+
+			if (simd > mg_simd_detect()) {
+				simd = mg_simd_detect();
+			}
+
+			/* the lines follow each other, as do the clear bits */
+			combine_words[simd](mg_mask->bits, other->bits,
+					    (size_t) mg_mask->words
+					    * mg_mask->height,
+					    op);
+			p = mg_mask;
+		}
+	}
+
+	return p;
+}
+
+mg_mask_t
+mg_mask_dilate(mg_mask_t mg_mask,
+	       enum mg_simd simd)
+{
+	mg_mask_t p = 0;
+
+	VERIFY(mg_mask) {
+		morph(mg_mask, false, simd);
+		p = mg_mask;
+	}
+
+	return p;
+}
+
+mg_mask_t
+mg_mask_erode(mg_mask_t mg_mask,
+	      enum mg_simd simd)
+{
+	mg_mask_t p = 0;
+
+	VERIFY(mg_mask) {
+		morph(mg_mask, true, simd);
+		p = mg_mask;
+	}
+
+	return p;
+}
+
+mg_mask_t
+mg_mask_fill(mg_mask_t mg_mask,
+	     const struct mg_rect *rect,
+	     bool value)
+{
+	mg_mask_t p = 0;
+
+	VERIFY(mg_mask) {
+		int64_t left = (rect->left < 0) ? 0 : rect->left;
+		int64_t top = (rect->top < 0) ? 0 : rect->top;
+		int64_t right = (int64_t) rect->left + rect->width;
+		int64_t bottom = (int64_t) rect->top + rect->height;
+		if (right > mg_mask->width) {
+			right = mg_mask->width;
+		}
+		if (bottom > mg_mask->height) {
+			bottom = mg_mask->height;
+		}
+
+		for (int64_t y = top; y < bottom; y++) {
+			uint64_t *line = mg_mask->bits
+				+ (size_t) y * mg_mask->words;
+			for (int64_t x = left; x < right; ) {
+				/* a word, or what is left of it, at a time */
+				unsigned int bit = x % 64;
+				unsigned int n = (right - x < 64 - bit)
+					? right - x : 64 - bit;
+				uint64_t bits = (64 == n)
+					? ~(uint64_t) 0
+					: (((uint64_t) 1 << n) - 1) << bit;
+				if (value) {
+					line[x / 64] |= bits;
+				} else {
+					line[x / 64] &= ~bits;
+				}
+				x += n;
+			}
+		}
+		p = mg_mask;
+	}
+
+	return p;
+}
+
+bool
+mg_mask_get(mg_mask_t mg_mask,
+	    uint32_t x,
+	    uint32_t y)
+{
+	bool set = false;
+
+	VERIFY(mg_mask) {
+		if (x < mg_mask->width && y < mg_mask->height) {
+			uint64_t word = mg_mask->bits[(size_t) y * mg_mask->words
+						      + x / 64];
+			set = word >> (x % 64) & 1;
+		}
+	}
+
+	return set;
+}
+
+uint64_t
+mg_mask_get_count(mg_mask_t mg_mask)
+{
+	uint64_t count = 0;
+
+	VERIFY(mg_mask) {
+		size_t n = (size_t) mg_mask->words * mg_mask->height;
+		for (size_t i = 0; i < n; i++) {
+			count += __builtin_popcountll(mg_mask->bits[i]);
+		}
+	}
+
+	return count;
+}
+
+uint32_t
+mg_mask_get_height(mg_mask_t mg_mask)
+{
+	uint32_t height = 0;
+
+	VERIFY(mg_mask) {
+		height = mg_mask->height;
+	}
+
+	return height;
+}
+
+uint64_t *
+mg_mask_get_line(mg_mask_t mg_mask,
+		 uint32_t y)
+{
+	uint64_t *line = 0;
+
+	VERIFY(mg_mask) {
+		if (y < mg_mask->height) {
+			line = mg_mask->bits + (size_t) y * mg_mask->words;
+		}
+	}
+
+	return line;
+}
+
+unsigned int
+mg_mask_get_spans(mg_mask_t mg_mask,
+		  struct mg_span *span,
+		  unsigned int max)
+{
+	unsigned int n = 0;
+
+	VERIFY(mg_mask) {
+		uint32_t width = (mg_mask->width < MAX_SIDE)
+			? mg_mask->width : MAX_SIDE;
+		uint32_t height = (mg_mask->height < MAX_SIDE)
+			? mg_mask->height : MAX_SIDE;
+		uint32_t words = (width + 63) / 64;
+
+		for (uint32_t y = 0; y < height; y++) {
+			const uint64_t *line = mg_mask->bits
+				+ (size_t) y * mg_mask->words;
+			bool open = false;
+			uint32_t start = 0;
+			for (uint32_t k = 0; k < words; k++) {
+				uint64_t word = line[k];
+				if (k == words - 1 && width % 64) {
+					word &= ((uint64_t) 1 << width % 64) - 1;
+				}
+
+				/* whole words of background or foreground */
+				if (open ? word == ~(uint64_t) 0 : !word) {
+					continue;
+				}
+
+				unsigned int i = 0;
+				for (;;) {
+					uint64_t rest = (open ? ~word : word) >> i;
+					if (!rest) {
+						break;
+					}
+					i += __builtin_ctzll(rest);
+					uint32_t x = 64 * k + i;
+					if (open) {
+						if (n < max) {
+							span[n].y = y;
+							span[n].x = start;
+							span[n].length = x - start;
+						}
+						n++;
+					} else {
+						start = x;
+					}
+					open = !open;
+				}
+			}
+			if (open) {
+				if (n < max) {
+					span[n].y = y;
+					span[n].x = start;
+					span[n].length = width - start;
+				}
+				n++;
+			}
+		}
+	}
+
+	return n;
+}
+
+uint32_t
+mg_mask_get_width(mg_mask_t mg_mask)
+{
+	uint32_t width = 0;
+
+	VERIFY(mg_mask) {
+		width = mg_mask->width;
+	}
+
+	return width;
+}
+
+uint32_t
+mg_mask_get_words(mg_mask_t mg_mask)
+{
+	uint32_t words = 0;
+
+	VERIFY(mg_mask) {
+		words = mg_mask->words;
+	}
+
+	return words;
+}
+
+mg_mask_t
+mg_mask_open(mg_mask_t mg_mask,
+	     enum mg_simd simd)
+{
+	return mg_mask_dilate(mg_mask_erode(mg_mask, simd), simd);
+}
+
+mg_mask_t
+mg_mask_set_size(mg_mask_t mg_mask,
+		 uint32_t width,
+		 uint32_t height)
+{
+	mg_mask_t p = 0;
+
+	VERIFY(mg_mask) {
+		uint32_t words = (width + 63) / 64;
+
+		/* two lines of originals and a line with a word either side */
+		size_t n = (size_t) words * height + 3 * (size_t) words + 2;
+		if (n > mg_mask->capacity) {
+			uint64_t *bits = MALLOC(n * sizeof(*bits));
+			if (!bits) {
+				return 0;
+			}
+			FREEOBJ(mg_mask->bits);
+			mg_mask->bits = bits;
+			mg_mask->capacity = n;
+		}
+
+		mg_mask->width = width;
+		mg_mask->height = height;
+		mg_mask->words = words;
+		memset(mg_mask->bits, 0, n * sizeof(*mg_mask->bits));
+		p = mg_mask;
+	}
+
+	return p;
+}
+
+void
+morph(mg_mask_t mask,
+      bool erode,
+      enum mg_simd simd)
+{
+	uint32_t words = mask->words;
+	uint32_t height = mask->height;
+	if (!words || !height) {
+		return;
+	}
+
+	if (simd > mg_simd_detect()) {
+		simd = mg_simd_detect();
+	}
+
+	size_t size = words * sizeof(*mask->bits);
+	uint64_t *above = mask->bits + (size_t) words * height;
+	uint64_t *here = above + words;
+	uint64_t *row = here + words + 1;
+	unsigned int rest = mask->width % 64;
+	uint64_t valid = rest ? ((uint64_t) 1 << rest) - 1 : ~(uint64_t) 0;
+
+	memcpy(here, mask->bits, size);
+	for (uint32_t y = 0; y < height; y++) {
+		uint64_t *line = mask->bits + (size_t) y * words;
+
+		/* the edge lines are their own neighbours */
+		const uint64_t *up = y ? above : here;
+		const uint64_t *down = (y + 1 < height) ? line + words : here;
+		merge_line[simd](up, here, down, row, words, erode);
+
+		/* and so are the edge columns */
+		row[-1] = (row[0] & 1) << 63;
+		if (rest) {
+			row[words - 1] |= (row[words - 1] >> (rest - 1) & 1)
+				<< rest;
+			row[words] = 0;
+		} else {
+			row[words] = row[words - 1] >> 63;
+		}
+		spread_line[simd](row, line, words, erode);
+		line[words - 1] &= valid;
+
+		uint64_t *t = above;
+		above = here;
+		here = t;
+		if (y + 1 < height) {
+			memcpy(here, line + words, size);
+		}
+	}
+}
+
+#ifdef TEST_MULTI_GEE_MG_MASK
+
+#include <stdio.h>
+#include <stdlib.h>
+
+USE_XASSERT
+
+/**
+ * @brief Straightforward erosion or dilation to compare the kernels
+ * against
+ */
+static
+void
+reference(const uint8_t *src,
+	  uint8_t *dst,
+	  uint32_t w,
+	  uint32_t h,
+	  bool erode)
+{
+	for (uint32_t y = 0; y < h; y++) {
+		for (uint32_t x = 0; x < w; x++) {
+			uint8_t v = erode ? 1 : 0;
+			for (int dy = -1; dy <= 1; dy++) {
+				for (int dx = -1; dx <= 1; dx++) {
+					int64_t yy = (int64_t) y + dy;
+					int64_t xx = (int64_t) x + dx;
+					yy = (yy < 0) ? 0 : (yy >= h) ? h - 1 : yy;
+					xx = (xx < 0) ? 0 : (xx >= w) ? w - 1 : xx;
+					uint8_t s = src[yy * w + xx];
+					v = erode ? v & s : v | s;
+				}
+			}
+			dst[y * w + x] = v;
+		}
+	}
+}
+
+static
+bool
+same(mg_mask_t mask,
+     const uint8_t *pixel)
+{
+	uint32_t w = mg_mask_get_width(mask);
+	uint32_t h = mg_mask_get_height(mask);
+	for (uint32_t y = 0; y < h; y++) {
+		for (uint32_t x = 0; x < w; x++) {
+			if (mg_mask_get(mask, x, y) != pixel[y * w + x]) {
+				return false;
+			}
+		}
+
+		/* the bits past the width stay clear */
+		uint64_t *line = mg_mask_get_line(mask, y);
+		uint32_t words = mg_mask_get_words(mask);
+		if (w % 64 && line[words - 1] >> (w % 64)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void
+mg_mask_test()
+{
+	printf("%s: %s\n", __func__, mg_simd_name(mg_simd_detect()));
+
+	mg_mask_t mask = mg_mask_create(80, 7);
+	XASSERT(mask && mg_mask_get_words(mask) == 2) {
+		/* empty */
+	}
+	XASSERT(mg_mask_get_count(mask) == 0) {
+		/* empty */
+	}
+
+	/* rectangles are clipped to the mask */
+	struct mg_rect edge = {75, -1, 20, 2};
+	mg_mask_fill(mask, &edge, true);
+	XASSERT(mg_mask_get_count(mask) == 5 && mg_mask_get(mask, 79, 0)) {
+		/* empty */
+	}
+	mg_mask_clear(mask);
+
+	/* a rectangle across a word edge */
+	struct mg_rect rect = {60, 2, 10, 3};
+	mg_mask_fill(mask, &rect, true);
+	XASSERT(mg_mask_get_count(mask) == 30) {
+		/* empty */
+	}
+	XASSERT(mg_mask_get(mask, 63, 3) && mg_mask_get(mask, 64, 3)) {
+		/* empty */
+	}
+	XASSERT(!mg_mask_get(mask, 59, 3) && !mg_mask_get(mask, 70, 3)) {
+		/* empty */
+	}
+
+	/* a speck goes with opening, the rectangle stays */
+	struct mg_rect speck = {10, 3, 1, 1};
+	mg_mask_fill(mask, &speck, true);
+	mg_mask_open(mask, MG_SIMD_SCALAR);
+	XASSERT(mg_mask_get_count(mask) == 30 && !mg_mask_get(mask, 10, 3)) {
+		/* empty */
+	}
+
+	/* a hole goes with closing */
+	struct mg_rect hole = {65, 3, 1, 1};
+	mg_mask_fill(mask, &hole, false);
+	XASSERT(mg_mask_get_count(mask) == 29) {
+		/* empty */
+	}
+	mg_mask_close(mask, MG_SIMD_SCALAR);
+	XASSERT(mg_mask_get_count(mask) == 30) {
+		/* empty */
+	}
+
+	/* spans, and an exclusion mask */
+	struct mg_span span[8];
+	XASSERT(mg_mask_get_spans(mask, span, 8) == 3) {
+		/* empty */
+	}
+	XASSERT(span[0].y == 2 && span[0].x == 60 && span[0].length == 10) {
+		/* empty */
+	}
+	mg_mask_t exclude = mg_mask_create(80, 7);
+	struct mg_rect damaged = {0, 3, 62, 1};
+	mg_mask_fill(exclude, &damaged, true);
+	XASSERT(mg_mask_combine(mask, exclude, MG_MASK_AND_NOT,
+				MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(mg_mask_get_spans(mask, span, 8) == 3) {
+		/* empty */
+	}
+	XASSERT(span[1].y == 3 && span[1].x == 62 && span[1].length == 8) {
+		/* empty */
+	}
+	XASSERT(mg_mask_combine(mask, exclude, MG_MASK_OR, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(mg_mask_get_count(mask) == 90) {
+		/* empty */
+	}
+	exclude = mg_mask_destroy(exclude);
+
+	exclude = mg_mask_create(64, 7);
+	XASSERT(!mg_mask_combine(mask, exclude, MG_MASK_AND, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	exclude = mg_mask_destroy(exclude);
+	mask = mg_mask_destroy(mask);
+
+	/* vector kernels match the reference */
+	uint32_t widths[] = {1, 63, 64, 65, 128, 200, 257, 768};
+	for (unsigned int i = 0; i < sizeof(widths) / sizeof(*widths); i++) {
+		uint32_t w = widths[i];
+		uint32_t h = 6;
+		uint8_t *pixel = malloc(w * h);
+		uint8_t *ref = malloc(w * h);
+		for (uint32_t j = 0; j < w * h; j++) {
+			pixel[j] = (rand() % 3) ? 1 : 0;
+		}
+
+		for (int erode = 0; erode <= 1; erode++) {
+			reference(pixel, ref, w, h, erode);
+			for (int simd = MG_SIMD_SCALAR;
+			     simd <= (int) mg_simd_detect(); simd++) {
+				mask = mg_mask_create(w, h);
+				for (uint32_t j = 0; j < w * h; j++) {
+					struct mg_rect r = {j % w, j / w, 1, 1};
+					mg_mask_fill(mask, &r, pixel[j]);
+				}
+				if (erode) {
+					mg_mask_erode(mask, simd);
+				} else {
+					mg_mask_dilate(mask, simd);
+				}
+				XASSERT(same(mask, ref)) {
+					/* empty */
+				}
+
+				/* and with itself it stays the same */
+				mg_mask_t copy = mg_mask_create(w, h);
+				mg_mask_combine(copy, mask, MG_MASK_OR, simd);
+				mg_mask_combine(copy, mask, MG_MASK_AND, simd);
+				XASSERT(same(copy, ref)) {
+					/* empty */
+				}
+				copy = mg_mask_destroy(copy);
+				mask = mg_mask_destroy(mask);
+			}
+		}
+		free(ref);
+		free(pixel);
+	}
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_mask_test));
+}
+
+#endif /* TEST_MULTI_GEE_MG_MASK */
@@ -0,0 +1,289 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee binary mask declaration
+ *
+ * A marker mask only needs a bit per pixel.  The mask packs 64 pixels
+ * into a word, pixel x of a line in bit x % 64 of word x / 64, so a PAL
+ * line fits in twelve words and a whole mask in a level 2 cache.
+ * Erosion and dilation over the 3x3 neighbourhood shift and combine
+ * whole words, two or four at a time with SSE2 or AVX2, and so does
+ * masking with an exclusion mask of damaged or reflective areas.  The
+ * bits past the width of a line are kept clear.
+ */
+#ifndef ITL_MULTI_GEE_MG_MASK_H
+#define ITL_MULTI_GEE_MG_MASK_H
+
+#include <stdbool.h> /* bool */
+#include <stdint.h> /* uint64_t */
+
+#include <cclass/classdef.h>
+#include <multi-gee/mg_image.h>
+#include <multi-gee/mg_simd.h>
+
+__BEGIN_DECLS
+
+struct mg_span;
+
+/**
+ * @brief Multi-gee binary mask object handle
+ */
+NEWHANDLE(mg_mask_t);
+
+/**
+ * @brief How mg_mask_combine() merges two masks
+ */
+enum mg_mask_op
+{
+	MG_MASK_AND, /**< keep pixels set in both */
+	MG_MASK_OR, /**< keep pixels set in either */
+	MG_MASK_AND_NOT /**< clear pixels set in the other */
+};
+
+/**
+ * @brief Create binary mask object
+ *
+ * @param width  width in pixels
+ * @param height  height in lines
+ *
+ * @return a newly created mask object handle, with every pixel clear,
+ * or 0 if out of memory
+ */
+mg_mask_t
+mg_mask_create(uint32_t width,
+	       uint32_t height);
+
+/**
+ * @brief Destroy binary mask object
+ *
+ * @param mask  handle of object to be destroyed
+ *
+ * @return 0
+ */
+mg_mask_t
+mg_mask_destroy(mg_mask_t mask);
+
+/**
+ * @brief Clear every pixel
+ *
+ * @param mask  object handle
+ *
+ * @return object handle
+ */
+mg_mask_t
+mg_mask_clear(mg_mask_t mask);
+
+/**
+ * @brief Dilate, then erode
+ *
+ * fills holes and gaps of a pixel between foreground pixels.
+ *
+ * @param mask  object handle
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return object handle
+ */
+mg_mask_t
+mg_mask_close(mg_mask_t mask,
+	      enum mg_simd simd);
+
+/**
+ * @brief Merge another mask into the mask
+ *
+ * @param mask  object handle
+ * @param other  mask of the same size
+ * @param op  how the masks are merged
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return object handle, or 0 if the sizes differ
+ */
+mg_mask_t
+mg_mask_combine(mg_mask_t mask,
+		mg_mask_t other,
+		enum mg_mask_op op,
+		enum mg_simd simd);
+
+/**
+ * @brief Dilate the mask
+ *
+ * a pixel is set if it or any of its eight neighbours is.  the image
+ * edge is extended outwards.
+ *
+ * @param mask  object handle
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return object handle
+ */
+mg_mask_t
+mg_mask_dilate(mg_mask_t mask,
+	       enum mg_simd simd);
+
+/**
+ * @brief Erode the mask
+ *
+ * a pixel stays set if it and all its eight neighbours are.  the image
+ * edge is extended outwards, so the edge itself does not erode.
+ *
+ * @param mask  object handle
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return object handle
+ */
+mg_mask_t
+mg_mask_erode(mg_mask_t mask,
+	      enum mg_simd simd);
+
+/**
+ * @brief Set a rectangle of pixels
+ *
+ * @param mask  object handle
+ * @param rect  rectangle, clipped to the mask
+ * @param value  set or clear the pixels?
+ *
+ * @return object handle
+ */
+mg_mask_t
+mg_mask_fill(mg_mask_t mask,
+	     const struct mg_rect *rect,
+	     bool value);
+
+/**
+ * @brief Pixel accessor
+ *
+ * @param mask  object handle
+ * @param x  column
+ * @param y  line
+ *
+ * @return \c true if the pixel is set, \c false if it is clear or
+ * outside the mask
+ */
+bool
+mg_mask_get(mg_mask_t mask,
+	    uint32_t x,
+	    uint32_t y);
+
+/**
+ * @brief Set pixel count accessor
+ *
+ * @param mask  object handle
+ *
+ * @return the number of pixels set
+ */
+uint64_t
+mg_mask_get_count(mg_mask_t mask);
+
+/**
+ * @brief Height accessor
+ *
+ * @param mask  object handle
+ *
+ * @return height in lines
+ */
+uint32_t
+mg_mask_get_height(mg_mask_t mask);
+
+/**
+ * @brief Line accessor
+ *
+ * a line is mg_mask_get_words() words.  the bits past the width must
+ * be left clear.
+ *
+ * @param mask  object handle
+ * @param y  line
+ *
+ * @return the words of the line, or 0 if there is no such line
+ */
+uint64_t *
+mg_mask_get_line(mg_mask_t mask,
+		 uint32_t y);
+
+/**
+ * @brief Turn the mask into spans
+ *
+ * like mg_threshold(), the spans come in raster order and the number
+ * found is returned even if it does not fit.  the mask may be at most
+ * 65535 pixels wide and high.
+ *
+ * @param mask  object handle
+ * @param span  array to fill in
+ * @param max  number of spans the array holds
+ *
+ * @return the number of spans found, of which at most @a max are
+ * stored
+ */
+unsigned int
+mg_mask_get_spans(mg_mask_t mask,
+		  struct mg_span *span,
+		  unsigned int max);
+
+/**
+ * @brief Width accessor
+ *
+ * @param mask  object handle
+ *
+ * @return width in pixels
+ */
+uint32_t
+mg_mask_get_width(mg_mask_t mask);
+
+/**
+ * @brief Words per line accessor
+ *
+ * @param mask  object handle
+ *
+ * @return number of 64-bit words per line
+ */
+uint32_t
+mg_mask_get_words(mg_mask_t mask);
+
+/**
+ * @brief Erode, then dilate
+ *
+ * takes away specks and lines narrower than three pixels, and leaves
+ * larger blobs as they were.
+ *
+ * @param mask  object handle
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return object handle
+ */
+mg_mask_t
+mg_mask_open(mg_mask_t mask,
+	     enum mg_simd simd);
+
+/**
+ * @brief Set the size
+ *
+ * memory is only allocated when the mask grows.  every pixel is
+ * cleared.
+ *
+ * @param mask  object handle
+ * @param width  width in pixels
+ * @param height  height in lines
+ *
+ * @return object handle, or 0 if out of memory
+ */
+mg_mask_t
+mg_mask_set_size(mg_mask_t mask,
+		 uint32_t width,
+		 uint32_t height);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_MASK_H */
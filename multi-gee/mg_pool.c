@@ -0,0 +1,174 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee per-buffer memory pool definition
+ */
+#include <pthread.h>
+#include <stdlib.h> /* posix_memalign */
+
+#include "mg_pool.h" /* class implemented */
+
+USE_XASSERT
+
+/**
+ * @brief Memory block
+ */
+struct block
+{
+	void *data; /**< MG_POOL_ALIGN aligned memory */
+	size_t size; /**< Size of memory */
+};
+
+/**
+ * @brief Memory pool object structure
+ */
+CLASS(mg_pool, mg_pool_t)
+{
+	pthread_mutex_t lock; /**< Guards the block table */
+	struct block *block; /**< Blocks, MG_POOL_PLANES per buffer */
+	unsigned int number; /**< Number of buffers in table */
+};
+
+mg_pool_t
+mg_pool_create()
+{
+	mg_pool_t mg_pool;
+	NEWOBJ(mg_pool);
+
+	pthread_mutex_init(&mg_pool->lock, 0);
+	mg_pool->block = 0;
+	mg_pool->number = 0;
+
+	return mg_pool;
+}
+
+mg_pool_t
+mg_pool_destroy(mg_pool_t mg_pool)
+{
+	VERIFYZ(mg_pool) {
+		for (unsigned int i = 0; i < mg_pool->number * MG_POOL_PLANES; i++) {
+			free(mg_pool->block[i].data);
+		}
+		FREEOBJ(mg_pool->block);
+		pthread_mutex_destroy(&mg_pool->lock);
+
+		FREEOBJ(mg_pool);
+	}
+
+	return 0;
+}
+
+void *
+mg_pool_get(mg_pool_t mg_pool,
+	    unsigned int index,
+	    enum mg_pool_plane plane,
+	    size_t size)
+{
+	void *p = 0;
+
+	VERIFY(mg_pool) {
+		pthread_mutex_lock(&mg_pool->lock);
+
+		if (index >= mg_pool->number) {
+			unsigned int n = index + 1;
+			struct block *block =
+				MALLOC(n * MG_POOL_PLANES * sizeof(*block));
+			for (unsigned int i = 0; i < n * MG_POOL_PLANES; i++) {
+				if (i < mg_pool->number * MG_POOL_PLANES) {
+					block[i] = mg_pool->block[i];
+				} else {
+					block[i].data = 0;
+					block[i].size = 0;
+				}
+			}
+			FREEOBJ(mg_pool->block);
+			mg_pool->block = block;
+			mg_pool->number = n;
+		}
+
+		struct block *b = &mg_pool->block[index * MG_POOL_PLANES + plane];
+		if (b->size < size) {
+			free(b->data);
+			b->data = 0;
+			b->size = 0;
+			if (0 == posix_memalign(&b->data, MG_POOL_ALIGN, size)) {
+				b->size = size;
+			} else {
+				b->data = 0;
+			}
+		}
+		p = b->data;
+
+		pthread_mutex_unlock(&mg_pool->lock);
+	}
+
+	return p;
+}
+
+#ifdef TEST_MULTI_GEE_MG_POOL
+
+#include <stdint.h>
+#include <stdio.h>
+
+void
+mg_pool()
+{
+	mg_pool_t pool = mg_pool_create();
+
+	/* blocks are aligned and kept per buffer and plane */
+	void *a = mg_pool_get(pool, 0, MG_POOL_GREY, 100);
+	void *b = mg_pool_get(pool, 3, MG_POOL_GREY, 100);
+	XASSERT(a && b && a != b) {
+		/* empty */
+	}
+	XASSERT(0 == (uintptr_t) a % MG_POOL_ALIGN) {
+		/* empty */
+	}
+	XASSERT(mg_pool_get(pool, 0, MG_POOL_GREY, 50) == a) {
+		/* empty */
+	}
+	XASSERT(mg_pool_get(pool, 3, MG_POOL_GREY, 100) == b) {
+		/* empty */
+	}
+
+	/* growing the table keeps the blocks */
+	void *c = mg_pool_get(pool, 7, MG_POOL_GREY, 10);
+	XASSERT(c && mg_pool_get(pool, 0, MG_POOL_GREY, 100) == a) {
+		/* empty */
+	}
+
+	/* a larger block may move */
+	a = mg_pool_get(pool, 0, MG_POOL_GREY, 1 << 20);
+	XASSERT(a && 0 == (uintptr_t) a % MG_POOL_ALIGN) {
+		/* empty */
+	}
+
+	pool = mg_pool_destroy(pool);
+	XASSERT(pool == 0) {
+		/* empty */
+	}
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_pool));
+}
+
+#endif /* TEST_MULTI_GEE_MG_POOL */
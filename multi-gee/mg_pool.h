@@ -0,0 +1,105 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee per-buffer memory pool declaration
+ *
+ * Images derived from a frame, such as the grey image of a colour
+ * frame, live as long as the frame holds its capture buffer.  The pool
+ * keeps one memory block per capture buffer and kind of derived image,
+ * so the blocks are allocated once and reused for every frame captured
+ * into the same buffer.
+ */
+#ifndef ITL_MULTI_GEE_MG_POOL_H
+#define ITL_MULTI_GEE_MG_POOL_H
+
+#include <stddef.h> /* size_t */
+
+#include <cclass/classdef.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Alignment of pool memory, a cache line
+ */
+#define MG_POOL_ALIGN 64
+
+/**
+ * @brief Kinds of derived images
+ */
+enum mg_pool_plane
+{
+	MG_POOL_GREY, /**< grey image converted from colour or Bayer */
+	MG_POOL_TOP, /**< full-height image of the top field */
+	MG_POOL_BOTTOM, /**< full-height image of the bottom field */
+	MG_POOL_LEVEL1, /**< image pyramid, half size */
+	MG_POOL_LEVEL2, /**< image pyramid, quarter size */
+	MG_POOL_LEVEL3, /**< image pyramid, eighth size */
+	MG_POOL_FOREGROUND, /**< grey image less the background */
+	MG_POOL_PLANES /**< number of kinds */
+};
+
+/**
+ * @brief Multi-gee memory pool object handle
+ */
+NEWHANDLE(mg_pool_t);
+
+/**
+ * @brief Create memory pool object
+ *
+ * @return a newly created memory pool object handle
+ */
+mg_pool_t
+mg_pool_create();
+
+/**
+ * @brief Destroy memory pool object
+ *
+ * frees all memory handed out by the pool.
+ *
+ * @param pool  handle of object to be destroyed
+ *
+ * @return 0
+ */
+mg_pool_t
+mg_pool_destroy(mg_pool_t pool);
+
+/**
+ * @brief Memory block of a capture buffer
+ *
+ * the block is allocated on first use, and reallocated when a larger
+ * size is asked for.  the contents do not survive a reallocation.  it
+ * is safe to ask for blocks of different buffers from different
+ * threads.
+ *
+ * @param pool  object handle
+ * @param index  capture buffer index
+ * @param plane  kind of derived image
+ * @param size  size of the block in bytes
+ *
+ * @return MG_POOL_ALIGN aligned memory, or 0 on failure
+ */
+void *
+mg_pool_get(mg_pool_t pool,
+	    unsigned int index,
+	    enum mg_pool_plane plane,
+	    size_t size);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_POOL_H */
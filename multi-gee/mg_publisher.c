@@ -0,0 +1,397 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Shared memory frameset publisher definition
+ */
+#define _GNU_SOURCE /* memfd_create, accept4 */
+
+#include <errno.h>
+#include <fcntl.h> /* F_ADD_SEALS */
+#include <linux/futex.h> /* FUTEX_WAKE */
+#include <string.h>
+#include <sys/mman.h> /* memfd_create, mmap */
+#include <sys/socket.h>
+#include <sys/syscall.h> /* SYS_futex */
+#include <sys/un.h> /* struct sockaddr_un */
+#include <unistd.h>
+
+#include "mg_buffer.h"
+#include "mg_device.h"
+#include "mg_frame.h"
+#include "mg_publisher.h" /* class implemented */
+#include "mg_ring.h"
+
+USE_XASSERT
+
+/**
+ * @brief Find or add a device in the ring's device table
+ *
+ * @param publisher  object handle
+ * @param device  capture device
+ *
+ * @return device table index, or -1 if the table is full
+ */
+static
+int
+ring_device(mg_publisher_t publisher,
+	    mg_device_t device);
+
+/**
+ * @brief Pass the ring file descriptor over a connected socket
+ *
+ * @param publisher  object handle
+ * @param sock  connected socket
+ *
+ * @return \c true on success, \c false on failure
+ */
+static
+bool
+send_ring(mg_publisher_t publisher,
+	  int sock);
+
+/**
+ * @brief Publisher object structure
+ */
+CLASS(mg_publisher, mg_publisher_t)
+{
+	char *path; /**< Socket file name */
+	int sock; /**< Listening socket */
+	int memfd; /**< Ring file descriptor */
+	size_t size; /**< Ring size in bytes */
+	struct mg_ring_header *ring; /**< Ring mapping */
+	log_t log; /**< Log object handle */
+};
+
+mg_publisher_t
+mg_publisher_create(const char *path,
+		    unsigned int num_slots,
+		    size_t image_size,
+		    log_t log)
+{
+	if (!num_slots || !image_size) {
+		lg_log(log, "%s: a ring needs slots and image space", path);
+		return 0;
+	}
+
+	mg_publisher_t mg_publisher;
+	NEWOBJ(mg_publisher);
+
+	STRDUP(mg_publisher->path, path);
+	mg_publisher->sock = -1;
+	mg_publisher->memfd = -1;
+	mg_publisher->ring = MAP_FAILED;
+	mg_publisher->log = log;
+
+	/* keep every slot, and so every image, cache line aligned */
+	size_t slot_size = sizeof(struct mg_ring_slot)
+		+ MG_RING_MAX_DEVICES * image_size;
+	slot_size = (slot_size + 63) & ~(size_t) 63;
+	size_t slot_offset = (sizeof(struct mg_ring_header) + 63)
+		& ~(size_t) 63;
+	mg_publisher->size = slot_offset + num_slots * slot_size;
+
+	mg_publisher->memfd = memfd_create("multi-gee-ring",
+					   MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (-1 == mg_publisher->memfd) {
+		lg_errno(log, "memfd_create");
+		return mg_publisher_destroy(mg_publisher);
+	}
+
+	if (-1 == ftruncate(mg_publisher->memfd, mg_publisher->size)) {
+		lg_errno(log, "ftruncate ring to %zu bytes",
+			 mg_publisher->size);
+		return mg_publisher_destroy(mg_publisher);
+	}
+
+	/* subscribers rely on the ring size not changing under them */
+	if (-1 == fcntl(mg_publisher->memfd, F_ADD_SEALS,
+			F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)) {
+		lg_errno(log, "seal ring");
+	}
+
+	mg_publisher->ring = mmap(NULL,
+				  mg_publisher->size,
+				  PROT_READ | PROT_WRITE,
+				  MAP_SHARED,
+				  mg_publisher->memfd,
+				  0);
+	if (MAP_FAILED == mg_publisher->ring) {
+		lg_errno(log, "mmap ring");
+		return mg_publisher_destroy(mg_publisher);
+	}
+
+	/* the memfd starts out zero filled */
+	struct mg_ring_header *ring = mg_publisher->ring;
+	ring->version = MG_RING_VERSION;
+	ring->num_slots = num_slots;
+	ring->max_devices = MG_RING_MAX_DEVICES;
+	ring->image_size = image_size;
+	ring->slot_size = slot_size;
+	ring->slot_offset = slot_offset;
+	__atomic_store_n(&ring->magic, MG_RING_MAGIC, __ATOMIC_RELEASE);
+
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		lg_log(log, "socket path too long: %s", path);
+		return mg_publisher_destroy(mg_publisher);
+	}
+	strcpy(addr.sun_path, path);
+
+	mg_publisher->sock = socket(AF_UNIX,
+				    SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+				    0);
+	if (-1 == mg_publisher->sock) {
+		lg_errno(log, "socket");
+		return mg_publisher_destroy(mg_publisher);
+	}
+
+	unlink(path);
+	if (-1 == bind(mg_publisher->sock,
+		       (struct sockaddr *) &addr,
+		       sizeof(addr))) {
+		lg_errno(log, "bind %s", path);
+		return mg_publisher_destroy(mg_publisher);
+	}
+
+	if (-1 == listen(mg_publisher->sock, 8)) {
+		lg_errno(log, "listen %s", path);
+		return mg_publisher_destroy(mg_publisher);
+	}
+
+	return mg_publisher;
+}
+
+mg_publisher_t
+mg_publisher_destroy(mg_publisher_t mg_publisher)
+{
+	VERIFYZ(mg_publisher) {
+		if (-1 != mg_publisher->sock) {
+			close(mg_publisher->sock);
+			unlink(mg_publisher->path);
+		}
+		if (MAP_FAILED != mg_publisher->ring) {
+			munmap(mg_publisher->ring, mg_publisher->size);
+		}
+		if (-1 != mg_publisher->memfd) {
+			close(mg_publisher->memfd);
+		}
+
+		FREEOBJ(mg_publisher->path);
+		FREEOBJ(mg_publisher);
+	}
+
+	return 0;
+}
+
+bool
+mg_publisher_publish(mg_publisher_t mg_publisher,
+		     sllist_t frame_list)
+{
+	bool ok = false;
+
+	VERIFY(mg_publisher) {
+		struct mg_ring_header *ring = mg_publisher->ring;
+		uint64_t frameset = ring->published;
+		char *base = (char *) ring + ring->slot_offset
+			+ (frameset % ring->num_slots) * ring->slot_size;
+		struct mg_ring_slot *slot = (struct mg_ring_slot *) base;
+		char *image = base + sizeof(*slot);
+
+		/* open the slot for writing */
+		uint32_t seqlock = slot->seqlock;
+		__atomic_store_n(&slot->seqlock, seqlock + 1,
+				 __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+
+		ok = true;
+		uint32_t n = 0;
+		for (sllist_t f = frame_list; f; f = sllist_next(f)) {
+			mg_frame_t frame = sllist_data(f);
+			mg_device_t dev = mg_frame_get_device(frame);
+
+			int index = ring_device(mg_publisher, dev);
+			if (0 > index) {
+				ok = false;
+				continue;
+			}
+
+			struct mg_ring_frame *rec = &slot->frame[n];
+			struct timeval tv = mg_frame_get_timestamp(frame);
+			struct mg_format format = mg_frame_get_format(frame);
+
+			/* the image, not the whole buffer, which a crop shrinks */
+			size_t bytes = format.sizeimage;
+			size_t length = mg_buffer_get_length(
+				mg_device_get_buffer(dev),
+				mg_frame_get_index(frame));
+			if (bytes > length) {
+				bytes = length;
+			}
+			if (bytes > ring->image_size) {
+				bytes = ring->image_size;
+			}
+
+			rec->device = index;
+			rec->sequence = mg_frame_get_sequence(frame);
+			rec->tv_sec = tv.tv_sec;
+			rec->tv_usec = tv.tv_usec;
+			rec->bytes = bytes;
+			rec->width = format.width;
+			rec->height = format.height;
+			rec->bytesperline = format.bytesperline;
+			rec->pixelformat = format.pixelformat;
+
+			/* statistics worked out in advance cost only the copy */
+			const struct mg_stats *stats = 0;
+			if (mg_config_get_stats(mg_device_get_config(dev))) {
+				stats = mg_frame_get_stats(frame);
+			}
+			if (stats) {
+				rec->stats = *stats;
+			} else {
+				memset(&rec->stats, 0, sizeof(rec->stats));
+			}
+
+			void *src = mg_frame_get_image(frame);
+			if (src) {
+				memcpy(image + n * ring->image_size, src, bytes);
+			} else {
+				rec->bytes = 0;
+			}
+			n++;
+		}
+		slot->num_frames = n;
+		slot->frameset = frameset;
+
+		/* close the slot, then announce it */
+		__atomic_store_n(&slot->seqlock, seqlock + 2,
+				 __ATOMIC_RELEASE);
+		__atomic_store_n(&ring->published, frameset + 1,
+				 __ATOMIC_RELEASE);
+		__atomic_add_fetch(&ring->futex, 1, __ATOMIC_RELEASE);
+		syscall(SYS_futex, &ring->futex, FUTEX_WAKE, INT32_MAX,
+			NULL, NULL, 0);
+
+		if (!ok) {
+			lg_log(mg_publisher->log,
+			       "more than %d devices in frameset",
+			       MG_RING_MAX_DEVICES);
+		}
+	}
+
+	return ok;
+}
+
+int
+mg_publisher_serve(mg_publisher_t mg_publisher)
+{
+	int count = -1;
+
+	VERIFY(mg_publisher) {
+		count = 0;
+		for (;;) {
+			int sock = accept4(mg_publisher->sock, NULL, NULL,
+					   SOCK_CLOEXEC);
+			if (-1 == sock) {
+				if (EINTR == errno) {
+					continue;
+				}
+				if (EAGAIN != errno && EWOULDBLOCK != errno) {
+					lg_errno(mg_publisher->log, "accept");
+					count = -1;
+				}
+				break;
+			}
+
+			if (send_ring(mg_publisher, sock)) {
+				count++;
+			}
+			close(sock);
+		}
+	}
+
+	return count;
+}
+
+int
+ring_device(mg_publisher_t mg_publisher,
+	    mg_device_t dev)
+{
+	struct mg_ring_header *ring = mg_publisher->ring;
+	uint64_t devno = mg_device_get_devno(dev);
+
+	for (uint32_t i = 0; i < ring->num_devices; i++) {
+		if (ring->device[i].devno == devno) {
+			return i;
+		}
+	}
+
+	if (ring->num_devices >= ring->max_devices) {
+		return -1;
+	}
+
+	/* fill in the entry before subscribers can see it */
+	uint32_t i = ring->num_devices;
+	strncpy(ring->device[i].name,
+		mg_device_get_name(dev),
+		MG_RING_NAME_MAX - 1);
+	ring->device[i].devno = devno;
+	__atomic_store_n(&ring->num_devices, i + 1, __ATOMIC_RELEASE);
+
+	return i;
+}
+
+bool
+send_ring(mg_publisher_t mg_publisher,
+	  int sock)
+{
+	uint64_t size = mg_publisher->size;
+	struct iovec iov = {
+		.iov_base = &size,
+		.iov_len = sizeof(size),
+	};
+
+	union {
+		char buf[CMSG_SPACE(sizeof(int))];
+		struct cmsghdr align;
+	} control;
+	memset(&control, 0, sizeof(control));
+
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &mg_publisher->memfd, sizeof(int));
+
+	if (-1 == sendmsg(sock, &msg, MSG_NOSIGNAL)) {
+		lg_errno(mg_publisher->log, "sendmsg ring fd");
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,103 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Shared memory frameset publisher declaration
+ */
+#ifndef ITL_MULTI_GEE_MG_PUBLISHER_H
+#define ITL_MULTI_GEE_MG_PUBLISHER_H
+
+#include <stdbool.h> /* bool */
+
+#include <multi-gee/log.h>
+#include <multi-gee/sllist.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Frameset publisher object handle
+ */
+NEWHANDLE(mg_publisher_t);
+
+/**
+ * @brief Create publisher object
+ *
+ * creates a memfd backed frameset ring and a unix domain socket at the
+ * given path.  subscribers connect to the socket to receive the ring's
+ * file descriptor.  an existing socket file at the path is replaced.
+ *
+ * @param path  unix domain socket path
+ * @param num_slots  number of framesets kept in the ring, at least 1
+ * @param image_size  image bytes reserved per device per frameset, at
+ * least 1
+ * @param log  to log possible errors to
+ *
+ * @return a newly created publisher object handle, or 0 on failure
+ */
+mg_publisher_t
+mg_publisher_create(const char *path,
+		    unsigned int num_slots,
+		    size_t image_size,
+		    log_t log);
+
+/**
+ * @brief Destroy publisher object
+ *
+ * removes the socket file.  subscribers that are attached keep their
+ * mapping of the ring, but no new framesets are published.
+ *
+ * @param publisher  handle of object to be destroyed
+ *
+ * @return 0
+ */
+mg_publisher_t
+mg_publisher_destroy(mg_publisher_t publisher);
+
+/**
+ * @brief Copy a frameset into the ring
+ *
+ * meant to be called from the multi-gee callback function.  the oldest
+ * slot is overwritten; the publisher never waits for subscribers.
+ * images larger than the reserved image size are truncated.
+ *
+ * @param publisher  object handle
+ * @param frame_list  list of in-sync frames
+ *
+ * @return \c true on success, \c false if the frameset holds more
+ * devices than the ring can describe
+ */
+bool
+mg_publisher_publish(mg_publisher_t publisher,
+		     sllist_t frame_list);
+
+/**
+ * @brief Hand the ring to waiting subscribers
+ *
+ * accepts all pending connections on the socket, without blocking, and
+ * passes the ring's file descriptor to each of them.
+ *
+ * @param publisher  object handle
+ *
+ * @return number of subscribers attached by this call, or -1 on failure
+ */
+int
+mg_publisher_serve(mg_publisher_t publisher);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_PUBLISHER_H */
@@ -0,0 +1,122 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Shared memory frameset ring layout
+ *
+ * The ring lives in a single memfd shared between one publisher and
+ * any number of subscribers.  It starts with a header, followed by a
+ * fixed number of slots.  Each slot holds a frameset: a slot header
+ * with one frame record per device, followed by the image data of
+ * every device.
+ *
+ * A slot is guarded by a sequence lock.  The publisher makes the lock
+ * odd before it touches the slot and even again when it is done.  A
+ * subscriber samples the lock before and after it reads a slot, and
+ * discards what it read if the lock was odd or has changed.  The
+ * publisher never waits for subscribers.
+ */
+#ifndef ITL_MULTI_GEE_MG_RING_H
+#define ITL_MULTI_GEE_MG_RING_H
+
+#include <stdint.h> /* uint32_t */
+
+#include <cclass/classdef.h>
+
+#include <multi-gee/mg_stats.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Ring header magic number, "mgRG"
+ */
+#define MG_RING_MAGIC 0x4752676d
+
+/**
+ * @brief Ring layout version
+ */
+#define MG_RING_VERSION 2
+
+/**
+ * @brief Maximum number of devices in a frameset
+ */
+#define MG_RING_MAX_DEVICES 16
+
+/**
+ * @brief Maximum length of a device name, including the terminator
+ */
+#define MG_RING_NAME_MAX 32
+
+/**
+ * @brief Device table entry
+ */
+struct mg_ring_device {
+	char name[MG_RING_NAME_MAX]; /**< Device file name */
+	uint64_t devno; /**< Device number */
+};
+
+/**
+ * @brief Ring header, at offset 0 of the shared memory
+ */
+struct mg_ring_header {
+	uint32_t magic; /**< MG_RING_MAGIC */
+	uint32_t version; /**< MG_RING_VERSION */
+	uint32_t num_slots; /**< Number of slots in the ring */
+	uint32_t max_devices; /**< Device table size */
+	uint64_t image_size; /**< Image bytes reserved per device */
+	uint64_t slot_size; /**< Size of a slot, including images */
+	uint64_t slot_offset; /**< Offset of the first slot */
+	uint32_t num_devices; /**< Used device table entries */
+	uint32_t futex; /**< Bumped on every publish, to wait on */
+	uint64_t published; /**< Number of framesets published */
+	struct mg_ring_device device[MG_RING_MAX_DEVICES]; /**< Devices */
+};
+
+/**
+ * @brief Frame record in a slot
+ */
+struct mg_ring_frame {
+	uint32_t device; /**< Device table index */
+	uint32_t sequence; /**< Frame sequence number */
+	int64_t tv_sec; /**< Time stamp, seconds */
+	int64_t tv_usec; /**< Time stamp, microseconds */
+	uint64_t bytes; /**< Image bytes stored */
+	uint32_t width; /**< Image width in pixels */
+	uint32_t height; /**< Image height in lines */
+	uint32_t bytesperline; /**< Line stride in bytes */
+	uint32_t pixelformat; /**< video4linux2 fourcc code */
+	struct mg_stats stats; /**< Image statistics, no pixels if the
+				 device does not gather them */
+};
+
+/**
+ * @brief Slot header
+ *
+ * the image of frame record i is stored at offset
+ * sizeof(struct mg_ring_slot) + i * image_size from the slot start.
+ */
+struct mg_ring_slot {
+	uint32_t seqlock; /**< Odd while the slot is being written */
+	uint32_t num_frames; /**< Frame records in use */
+	uint64_t frameset; /**< Frameset number held by the slot */
+	struct mg_ring_frame frame[MG_RING_MAX_DEVICES]; /**< Frames */
+};
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_RING_H */
@@ -0,0 +1,68 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee SIMD support definition
+ */
+#include <stdlib.h> /* getenv */
+#include <string.h> /* strcmp */
+
+#include "mg_simd.h" /* declarations implemented */
+
+enum mg_simd
+mg_simd_detect(void)
+{
+	static int level = -1;
+
+	if (0 > level) {
+		enum mg_simd simd = MG_SIMD_SCALAR;
+#ifdef MG_SIMD_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) {
+			simd = MG_SIMD_AVX2;
+		} else if (__builtin_cpu_supports("sse2")) {
+			simd = MG_SIMD_SSE2;
+		}
+#endif
+		const char *cap = getenv("MG_SIMD");
+		if (cap) {
+			for (int i = MG_SIMD_SCALAR; i < (int) simd; i++) {
+				if (!strcmp(cap, mg_simd_name(i))) {
+					simd = i;
+					break;
+				}
+			}
+		}
+		level = simd;
+	}
+
+	return level;
+}
+
+const char *
+mg_simd_name(enum mg_simd simd)
+{
+	switch (simd) {
+	case MG_SIMD_SSE2:
+		return "sse2";
+	case MG_SIMD_AVX2:
+		return "avx2";
+	default:
+		return "scalar";
+	}
+}
@@ -0,0 +1,82 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee SIMD support declaration
+ *
+ * Pixel kernels come in scalar, SSE2 and AVX2 versions.  The vector
+ * versions are compiled with per-function target attributes, so the
+ * library runs on any x86 processor and picks the best version at run
+ * time.
+ */
+#ifndef ITL_MULTI_GEE_MG_SIMD_H
+#define ITL_MULTI_GEE_MG_SIMD_H
+
+#include <cclass/classdef.h>
+
+__BEGIN_DECLS
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief Vector kernels are available
+ */
+#define MG_SIMD_X86 1
+/**
+ * @brief Compile a function for SSE2
+ */
+#define MG_TARGET_SSE2 __attribute__((target("sse2")))
+/**
+ * @brief Compile a function for AVX2
+ */
+#define MG_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+/**
+ * @brief Instruction set level of a kernel
+ */
+enum mg_simd
+{
+	MG_SIMD_SCALAR, /**< plain C */
+	MG_SIMD_SSE2, /**< 16 byte vectors */
+	MG_SIMD_AVX2 /**< 32 byte vectors */
+};
+
+/**
+ * @brief Best instruction set level of this processor
+ *
+ * the level can be capped with the MG_SIMD environment variable, set
+ * to "scalar", "sse2" or "avx2".
+ *
+ * @return instruction set level
+ */
+enum mg_simd
+mg_simd_detect(void);
+
+/**
+ * @brief Instruction set level name
+ *
+ * @param simd  instruction set level
+ *
+ * @return "scalar", "sse2" or "avx2"
+ */
+const char *
+mg_simd_name(enum mg_simd simd);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_SIMD_H */
@@ -0,0 +1,380 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee image statistics definition
+ */
+#include <string.h> /* memset */
+
+#include "mg_stats.h" /* declarations implemented */
+
+#ifdef MG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Count the grey levels of a line
+ *
+ * neighbouring pixels are often the same, so they are counted in four
+ * tables in turn rather than waiting on the increment of one.
+ *
+ * @param line  first pixel
+ * @param width  number of pixels
+ * @param bins  four histograms to add to
+ */
+static
+void
+histogram_line(const uint8_t *line,
+	       uint32_t width,
+	       uint32_t bins[4][256]);
+
+/**
+ * @brief Add up the Laplacian of part of a line
+ *
+ * the pixels left and right of the part are read as well.
+ *
+ * @param up  pixel above the first
+ * @param line  first pixel
+ * @param down  pixel below the first
+ * @param width  number of pixels
+ * @param sum  sum to add the Laplacians to
+ * @param square  sum to add their squares to
+ */
+typedef void (*laplace_fn)(const uint8_t *up,
+			   const uint8_t *line,
+			   const uint8_t *down,
+			   uint32_t width,
+			   int64_t *sum,
+			   uint64_t *square);
+
+static
+void
+laplace_scalar(const uint8_t *up,
+	       const uint8_t *line,
+	       const uint8_t *down,
+	       uint32_t width,
+	       int64_t *sum,
+	       uint64_t *square)
+{
+	const uint8_t *left = line - 1;
+	const uint8_t *right = line + 1;
+	int64_t s = 0;
+	uint64_t q = 0;
+	for (uint32_t i = 0; i < width; i++) {
+		int32_t l = 4 * line[i] - left[i] - right[i] - up[i] - down[i];
+		s += l;
+		q += l * l;
+	}
+	*sum += s;
+	*square += q;
+}
+
+#ifdef MG_SIMD_X86
+
+MG_TARGET_SSE2
+static
+void
+laplace_sse2(const uint8_t *up,
+	     const uint8_t *line,
+	     const uint8_t *down,
+	     uint32_t width,
+	     int64_t *sum,
+	     uint64_t *square)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16(1);
+	__m128i s = zero;
+	__m128i q = zero;
+	uint32_t i = 0;
+	for (; i + 8 <= width; i += 8) {
+#define LOAD(p) _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (p)), zero)
+		__m128i c = LOAD(line + i);
+		__m128i lr = _mm_add_epi16(LOAD(line + i - 1),
+					   LOAD(line + i + 1));
+		__m128i ud = _mm_add_epi16(LOAD(up + i), LOAD(down + i));
+#undef LOAD
+		/* at most 1020 either way, fits 16 bits */
+		__m128i l = _mm_sub_epi16(_mm_slli_epi16(c, 2),
+					  _mm_add_epi16(lr, ud));
+		s = _mm_add_epi32(s, _mm_madd_epi16(l, one));
+
+		/* squares add up past 32 bits on long lines */
+		__m128i l2 = _mm_madd_epi16(l, l);
+		q = _mm_add_epi64(q, _mm_unpacklo_epi32(l2, zero));
+		q = _mm_add_epi64(q, _mm_unpackhi_epi32(l2, zero));
+	}
+
+	int32_t s32[4];
+	uint64_t q64[2];
+	_mm_storeu_si128((__m128i *) s32, s);
+	_mm_storeu_si128((__m128i *) q64, q);
+	*sum += (int64_t) s32[0] + s32[1] + s32[2] + s32[3];
+	*square += q64[0] + q64[1];
+
+	if (i < width) {
+		laplace_scalar(up + i, line + i, down + i, width - i,
+			       sum, square);
+	}
+}
+
+MG_TARGET_AVX2
+static
+void
+laplace_avx2(const uint8_t *up,
+	     const uint8_t *line,
+	     const uint8_t *down,
+	     uint32_t width,
+	     int64_t *sum,
+	     uint64_t *square)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi16(1);
+	__m256i s = zero;
+	__m256i q = zero;
+	uint32_t i = 0;
+	for (; i + 16 <= width; i += 16) {
+#define LOAD(p) _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (p)))
+		__m256i c = LOAD(line + i);
+		__m256i lr = _mm256_add_epi16(LOAD(line + i - 1),
+					      LOAD(line + i + 1));
+		__m256i ud = _mm256_add_epi16(LOAD(up + i), LOAD(down + i));
+#undef LOAD
+		__m256i l = _mm256_sub_epi16(_mm256_slli_epi16(c, 2),
+					     _mm256_add_epi16(lr, ud));
+		s = _mm256_add_epi32(s, _mm256_madd_epi16(l, one));
+
+		/* the order of the squares does not matter for the sum */
+		__m256i l2 = _mm256_madd_epi16(l, l);
+		q = _mm256_add_epi64(q, _mm256_unpacklo_epi32(l2, zero));
+		q = _mm256_add_epi64(q, _mm256_unpackhi_epi32(l2, zero));
+	}
+
+	int32_t s32[8];
+	uint64_t q64[4];
+	_mm256_storeu_si256((__m256i *) s32, s);
+	_mm256_storeu_si256((__m256i *) q64, q);
+	for (unsigned int k = 0; k < 8; k++) {
+		*sum += s32[k];
+	}
+	*square += q64[0] + q64[1] + q64[2] + q64[3];
+
+	if (i < width) {
+		laplace_sse2(up + i, line + i, down + i, width - i,
+			     sum, square);
+	}
+}
+
+/**
+ * @brief Laplacian kernel per instruction set level
+ */
+static const laplace_fn laplace_line[] = {
+	laplace_scalar,
+	laplace_sse2,
+	laplace_avx2
+};
+
+#else /* MG_SIMD_X86 */
+
+static const laplace_fn laplace_line[] = {
+	laplace_scalar,
+	laplace_scalar,
+	laplace_scalar
+};
+
+#endif /* MG_SIMD_X86 */
+
+bool
+mg_stats_compute(const struct mg_image *image,
+		 unsigned int step,
+		 struct mg_stats *stats,
+		 enum mg_simd simd)
+{
+	if (simd > mg_simd_detect()) {
+		simd = mg_simd_detect();
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	if (!image->data || image->width < 3 || image->height < 3) {
+		return false;
+	}
+	if (!step) {
+		step = 1;
+	}
+
+	uint32_t bins[4][256];
+	memset(bins, 0, sizeof(bins));
+	int64_t sum = 0;
+	uint64_t square = 0;
+	uint64_t samples = 0;
+	for (uint32_t y = 1; y < image->height - 1; y += step) {
+		const uint8_t *line = (const uint8_t *) image->data
+			+ (size_t) y * image->stride;
+		histogram_line(line, image->width, bins);
+		laplace_line[simd](line - image->stride + 1,
+				   line + 1,
+				   line + image->stride + 1,
+				   image->width - 2,
+				   &sum, &square);
+		samples += image->width - 2;
+	}
+
+	uint64_t total = 0;
+	for (unsigned int i = 0; i < 256; i++) {
+		uint32_t n = bins[0][i] + bins[1][i] + bins[2][i] + bins[3][i];
+		stats->histogram[i] = n;
+		stats->pixels += n;
+		total += (uint64_t) n * i;
+	}
+	stats->saturated = stats->histogram[255];
+	stats->mean = (double) total / stats->pixels;
+
+	double mean = (double) sum / samples;
+	stats->focus = (double) square / samples - mean * mean;
+
+	return true;
+}
+
+void
+histogram_line(const uint8_t *line,
+	       uint32_t width,
+	       uint32_t bins[4][256])
+{
+	uint32_t i = 0;
+	for (; i + 4 <= width; i += 4) {
+		bins[0][line[i]]++;
+		bins[1][line[i + 1]]++;
+		bins[2][line[i + 2]]++;
+		bins[3][line[i + 3]]++;
+	}
+	for (; i < width; i++) {
+		bins[0][line[i]]++;
+	}
+}
+
+#ifdef TEST_MULTI_GEE_MG_STATS
+
+#include <stdio.h>
+#include <stdlib.h>
+
+USE_XASSERT
+
+void
+mg_stats_test()
+{
+	printf("%s: %s\n", __func__, mg_simd_name(mg_simd_detect()));
+
+	struct mg_stats stats;
+
+	/* too small for a Laplacian */
+	uint8_t small[2 * 5] = {0};
+	struct mg_image tiny = {small, 2, 5, 2};
+	XASSERT(!mg_stats_compute(&tiny, 1, &stats, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(0 == stats.pixels) {
+		/* empty */
+	}
+
+	/* flat grey: no edges, one bin */
+	uint8_t flat[10 * 6];
+	memset(flat, 90, sizeof(flat));
+	struct mg_image image = {flat, 10, 6, 10};
+	XASSERT(mg_stats_compute(&image, 1, &stats, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(40 == stats.pixels && 40 == stats.histogram[90]) {
+		/* empty */
+	}
+	XASSERT(90 == stats.mean && 0 == stats.saturated && 0 == stats.focus) {
+		/* empty */
+	}
+
+	/* every other line, and a burnt out corner */
+	flat[2 * 10 + 9] = 255;
+	flat[3 * 10 + 9] = 255;
+	XASSERT(mg_stats_compute(&image, 2, &stats, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(20 == stats.pixels && 1 == stats.saturated) {
+		/* empty */
+	}
+
+	/* a checkerboard is as sharp as it gets */
+	for (unsigned int i = 0; i < sizeof(flat); i++) {
+		flat[i] = ((i % 10 + i / 10) & 1) ? 255 : 0;
+	}
+	XASSERT(mg_stats_compute(&image, 1, &stats, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(20 == stats.saturated && 127.5 == stats.mean) {
+		/* empty */
+	}
+	XASSERT(1040400 == stats.focus) {
+		/* empty */
+	}
+
+	/* vector kernels match the scalar one, and blur lowers focus */
+	uint32_t widths[] = {3, 10, 17, 18, 34, 100, 768};
+	for (unsigned int i = 0; i < sizeof(widths) / sizeof(*widths); i++) {
+		uint32_t w = widths[i];
+		uint32_t h = 7;
+		struct mg_image src = {malloc(w * h), w, h, w};
+		struct mg_image blur = {malloc(w * h), w, h, w};
+		uint8_t *p = src.data;
+		uint8_t *b = blur.data;
+		for (uint32_t j = 0; j < w * h; j++) {
+			p[j] = rand();
+		}
+		for (uint32_t j = 0; j < w * h; j++) {
+			b[j] = (p[j] + p[(j + 1) % (w * h)]
+				+ p[(j + w) % (w * h)]
+				+ p[(j + w + 1) % (w * h)]) / 4;
+		}
+
+		struct mg_stats ref;
+		mg_stats_compute(&src, 1, &ref, MG_SIMD_SCALAR);
+		for (int simd = MG_SIMD_SCALAR; simd <= (int) mg_simd_detect();
+		     simd++) {
+			XASSERT(mg_stats_compute(&src, 1, &stats, simd)) {
+				/* empty */
+			}
+			XASSERT(0 == memcmp(&ref, &stats, sizeof(ref))) {
+				/* empty */
+			}
+		}
+		XASSERT(w * (h - 2) == ref.pixels) {
+			/* empty */
+		}
+
+		mg_stats_compute(&blur, 1, &stats, mg_simd_detect());
+		XASSERT(stats.focus < ref.focus / 2) {
+			/* empty */
+		}
+
+		free(blur.data);
+		free(src.data);
+	}
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_stats_test));
+}
+
+#endif /* TEST_MULTI_GEE_MG_STATS */
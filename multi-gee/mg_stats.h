@@ -0,0 +1,76 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee image statistics declaration
+ *
+ * Exposure control and camera health checks look at a few numbers per
+ * frame rather than at the image: how the grey levels are spread, how
+ * bright the frame is on average, how much of it is burnt out, and
+ * whether it is in focus.  These change little from one line to the
+ * next, so only every so many lines are looked at.  Focus is measured
+ * as the variance of the Laplacian, which is high for sharp edges and
+ * drops as the image blurs; it is only comparable between frames of
+ * the same scene.
+ */
+#ifndef ITL_MULTI_GEE_MG_STATS_H
+#define ITL_MULTI_GEE_MG_STATS_H
+
+#include <stdbool.h> /* bool */
+#include <stdint.h> /* uint32_t */
+
+#include <multi-gee/mg_image.h>
+#include <multi-gee/mg_simd.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Statistics of an 8-bit image
+ */
+struct mg_stats
+{
+	uint32_t histogram[256]; /**< Pixels per grey level */
+	uint32_t pixels; /**< Pixels counted, 0 if none */
+	uint32_t saturated; /**< Pixels at 255 */
+	float mean; /**< Mean grey level */
+	float focus; /**< Variance of the Laplacian */
+};
+
+/**
+ * @brief Work out the statistics of an image
+ *
+ * every step-th line is looked at, starting with the second, and the
+ * Laplacian 4 c - l - r - u - d of every pixel on those lines that has
+ * four neighbours.
+ *
+ * @param image  8-bit image, at least 3 pixels wide and high
+ * @param step  look at every how many lines, at least 1
+ * @param [out]stats  statistics
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return \c true on success, \c false if the image is too small
+ */
+bool
+mg_stats_compute(const struct mg_image *image,
+		 unsigned int step,
+		 struct mg_stats *stats,
+		 enum mg_simd simd);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_STATS_H */
@@ -0,0 +1,507 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Shared memory frameset subscriber definition
+ */
+#define _GNU_SOURCE /* MSG_CMSG_CLOEXEC */
+
+#include <errno.h>
+#include <linux/futex.h> /* FUTEX_WAIT */
+#include <string.h>
+#include <sys/mman.h> /* mmap */
+#include <sys/socket.h>
+#include <sys/stat.h> /* fstat */
+#include <sys/syscall.h> /* SYS_futex */
+#include <sys/un.h> /* struct sockaddr_un */
+#include <time.h> /* clock_gettime */
+#include <unistd.h>
+
+#include "mg_subscriber.h" /* class implemented */
+
+USE_XASSERT
+
+/**
+ * @brief Receive the ring file descriptor from the publisher
+ *
+ * @param sock  connected socket
+ * @param log  to log possible errors to
+ *
+ * @return ring file descriptor, or -1 on failure
+ */
+static
+int
+receive_ring(int sock,
+	     log_t log);
+
+/**
+ * @brief Subscriber object structure
+ */
+CLASS(mg_subscriber, mg_subscriber_t)
+{
+	size_t size; /**< Ring size in bytes */
+	struct mg_ring_header *ring; /**< Read-only ring mapping */
+	log_t log; /**< Log object handle */
+};
+
+mg_subscriber_t
+mg_subscriber_create(const char *path,
+		     log_t log)
+{
+	mg_subscriber_t mg_subscriber;
+	NEWOBJ(mg_subscriber);
+
+	mg_subscriber->ring = MAP_FAILED;
+	mg_subscriber->log = log;
+
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		lg_log(log, "socket path too long: %s", path);
+		return mg_subscriber_destroy(mg_subscriber);
+	}
+	strcpy(addr.sun_path, path);
+
+	int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (-1 == sock) {
+		lg_errno(log, "socket");
+		return mg_subscriber_destroy(mg_subscriber);
+	}
+
+	int fd = -1;
+	if (-1 == connect(sock, (struct sockaddr *) &addr, sizeof(addr))) {
+		lg_errno(log, "connect %s", path);
+	} else {
+		fd = receive_ring(sock, log);
+	}
+	close(sock);
+
+	if (-1 == fd) {
+		return mg_subscriber_destroy(mg_subscriber);
+	}
+
+	struct stat st;
+	if (-1 == fstat(fd, &st)) {
+		lg_errno(log, "fstat ring");
+		close(fd);
+		return mg_subscriber_destroy(mg_subscriber);
+	}
+	mg_subscriber->size = st.st_size;
+
+	if (mg_subscriber->size >= sizeof(struct mg_ring_header)) {
+		mg_subscriber->ring = mmap(NULL,
+					   mg_subscriber->size,
+					   PROT_READ,
+					   MAP_SHARED,
+					   fd,
+					   0);
+		if (MAP_FAILED == mg_subscriber->ring) {
+			lg_errno(log, "mmap ring");
+		}
+	}
+	close(fd);
+
+	if (MAP_FAILED == mg_subscriber->ring) {
+		return mg_subscriber_destroy(mg_subscriber);
+	}
+
+	struct mg_ring_header *ring = mg_subscriber->ring;
+	if (MG_RING_MAGIC != __atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE)
+	    || MG_RING_VERSION != ring->version
+	    || !ring->num_slots
+	    || ring->slot_offset
+	    + ring->num_slots * ring->slot_size > mg_subscriber->size) {
+		lg_log(log, "%s: not a multi-gee frameset ring", path);
+		return mg_subscriber_destroy(mg_subscriber);
+	}
+
+	return mg_subscriber;
+}
+
+mg_subscriber_t
+mg_subscriber_destroy(mg_subscriber_t mg_subscriber)
+{
+	VERIFYZ(mg_subscriber) {
+		if (MAP_FAILED != mg_subscriber->ring) {
+			munmap(mg_subscriber->ring, mg_subscriber->size);
+		}
+
+		FREEOBJ(mg_subscriber);
+	}
+
+	return 0;
+}
+
+const struct mg_ring_slot *
+mg_subscriber_begin(mg_subscriber_t mg_subscriber,
+		    uint64_t frameset,
+		    uint32_t *seqlock)
+{
+	const struct mg_ring_slot *p = 0;
+
+	VERIFY(mg_subscriber) {
+		struct mg_ring_header *ring = mg_subscriber->ring;
+		const char *base = (const char *) ring + ring->slot_offset
+			+ (frameset % ring->num_slots) * ring->slot_size;
+		const struct mg_ring_slot *slot =
+			(const struct mg_ring_slot *) base;
+
+		uint32_t lock = __atomic_load_n(&slot->seqlock,
+						__ATOMIC_ACQUIRE);
+		if (!(lock & 1)
+		    && slot->frameset == frameset
+		    && frameset < __atomic_load_n(&ring->published,
+						  __ATOMIC_ACQUIRE)) {
+			*seqlock = lock;
+			p = slot;
+		}
+	}
+
+	return p;
+}
+
+bool
+mg_subscriber_end(mg_subscriber_t mg_subscriber,
+		  const struct mg_ring_slot *slot,
+		  uint32_t seqlock)
+{
+	bool ok = false;
+
+	VERIFY(mg_subscriber) {
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		ok = (seqlock == __atomic_load_n(&slot->seqlock,
+						 __ATOMIC_RELAXED));
+	}
+
+	return ok;
+}
+
+const char *
+mg_subscriber_get_device_name(mg_subscriber_t mg_subscriber,
+			      uint32_t device)
+{
+	const char *name = 0;
+
+	VERIFY(mg_subscriber) {
+		struct mg_ring_header *ring = mg_subscriber->ring;
+		if (device < __atomic_load_n(&ring->num_devices,
+					     __ATOMIC_ACQUIRE)) {
+			name = ring->device[device].name;
+		}
+	}
+
+	return name;
+}
+
+const void *
+mg_subscriber_get_image(mg_subscriber_t mg_subscriber,
+			const struct mg_ring_slot *slot,
+			unsigned int index)
+{
+	const void *image = 0;
+
+	VERIFY(mg_subscriber) {
+		if (index < MG_RING_MAX_DEVICES) {
+			image = (const char *) slot + sizeof(*slot)
+				+ index * mg_subscriber->ring->image_size;
+		}
+	}
+
+	return image;
+}
+
+uint64_t
+mg_subscriber_get_published(mg_subscriber_t mg_subscriber)
+{
+	uint64_t published = 0;
+
+	VERIFY(mg_subscriber) {
+		published = __atomic_load_n(&mg_subscriber->ring->published,
+					    __ATOMIC_ACQUIRE);
+	}
+
+	return published;
+}
+
+bool
+mg_subscriber_wait(mg_subscriber_t mg_subscriber,
+		   uint64_t published,
+		   struct timeval timeout)
+{
+	bool ok = false;
+
+	VERIFY(mg_subscriber) {
+		struct mg_ring_header *ring = mg_subscriber->ring;
+
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		struct timespec end = now;
+		end.tv_sec += timeout.tv_sec;
+		end.tv_nsec += timeout.tv_usec * 1000;
+		if (end.tv_nsec >= 1000000000) {
+			end.tv_sec++;
+			end.tv_nsec -= 1000000000;
+		}
+
+		for (;;) {
+			uint32_t futex = __atomic_load_n(&ring->futex,
+							 __ATOMIC_ACQUIRE);
+			if (__atomic_load_n(&ring->published,
+					    __ATOMIC_ACQUIRE) > published) {
+				ok = true;
+				break;
+			}
+
+			struct timespec left;
+			left.tv_sec = end.tv_sec - now.tv_sec;
+			left.tv_nsec = end.tv_nsec - now.tv_nsec;
+			if (left.tv_nsec < 0) {
+				left.tv_sec--;
+				left.tv_nsec += 1000000000;
+			}
+			if (left.tv_sec < 0) {
+				break;
+			}
+
+			/* the ring is mapped read-only, so no private futex */
+			if (-1 == syscall(SYS_futex, &ring->futex, FUTEX_WAIT,
+					  futex, &left, NULL, 0)
+			    && ETIMEDOUT == errno) {
+				break;
+			}
+			clock_gettime(CLOCK_MONOTONIC, &now);
+		}
+	}
+
+	return ok;
+}
+
+int
+receive_ring(int sock,
+	     log_t log)
+{
+	uint64_t size;
+	struct iovec iov = {
+		.iov_base = &size,
+		.iov_len = sizeof(size),
+	};
+
+	union {
+		char buf[CMSG_SPACE(sizeof(int))];
+		struct cmsghdr align;
+	} control;
+
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	ssize_t ret;
+	do
+		ret = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+	while (-1 == ret && EINTR == errno);
+
+	if (-1 == ret) {
+		lg_errno(log, "recvmsg ring fd");
+		return -1;
+	}
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	if (!cmsg
+	    || SOL_SOCKET != cmsg->cmsg_level
+	    || SCM_RIGHTS != cmsg->cmsg_type) {
+		lg_log(log, "publisher did not pass a ring");
+		return -1;
+	}
+
+	int fd;
+	memcpy(&fd, CMSG_DATA(cmsg), sizeof(fd));
+
+	return fd;
+}
+
+#ifdef TEST_MULTI_GEE_MG_SUBSCRIBER
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/wait.h>
+
+#include <asm/types.h> /* needed for videodev2.h */
+#include <linux/videodev2.h> /* struct v4l2_buffer */
+
+#include "mg_frame.h"
+#include "mg_publisher.h"
+
+#define FRAMESETS 5
+
+/* socket the publisher listens on, shared with the forked subscriber */
+static char path[64];
+
+static
+void
+subscribe()
+{
+	log_t log = lg_create("mg_subscriber", "stderr");
+	mg_subscriber_t sub = mg_subscriber_create(path, log);
+	XASSERT(sub) {
+		/* empty */
+	}
+
+	struct timeval timeout = {5, 0};
+	uint64_t seen = 0;
+	while (seen < FRAMESETS) {
+		XASSERT(mg_subscriber_wait(sub, seen, timeout)) {
+			/* empty */
+		}
+		seen = mg_subscriber_get_published(sub);
+	}
+
+	/* the ring holds the last two framesets */
+	uint32_t lock;
+	XASSERT(mg_subscriber_begin(sub, FRAMESETS - 3, &lock) == 0) {
+		/* empty */
+	}
+	XASSERT(mg_subscriber_begin(sub, FRAMESETS, &lock) == 0) {
+		/* empty */
+	}
+
+	const struct mg_ring_slot *slot =
+		mg_subscriber_begin(sub, FRAMESETS - 1, &lock);
+	XASSERT(slot) {
+		/* empty */
+	}
+	XASSERT(slot->num_frames == 1) {
+		/* empty */
+	}
+	XASSERT(slot->frame[0].sequence == FRAMESETS - 1) {
+		/* empty */
+	}
+	XASSERT(slot->frame[0].bytes == 12) {
+		/* empty */
+	}
+	XASSERT(slot->frame[0].width == 4 && slot->frame[0].height == 3) {
+		/* empty */
+	}
+	XASSERT(slot->frame[0].bytesperline == 4) {
+		/* empty */
+	}
+	XASSERT(slot->frame[0].pixelformat == V4L2_PIX_FMT_GREY) {
+		/* empty */
+	}
+	XASSERT(slot->frame[0].stats.pixels == 4) {
+		/* empty */
+	}
+	XASSERT(slot->frame[0].stats.histogram[0] == 4) {
+		/* empty */
+	}
+	XASSERT(0 == strcmp(mg_subscriber_get_device_name(
+				    sub, slot->frame[0].device),
+			    "/dev/null")) {
+		/* empty */
+	}
+	XASSERT(0 == memcmp(mg_subscriber_get_image(sub, slot, 0),
+			    "mg-4", 4)) {
+		/* empty */
+	}
+	XASSERT(mg_subscriber_end(sub, slot, lock)) {
+		/* empty */
+	}
+
+	sub = mg_subscriber_destroy(sub);
+	log = lg_destroy(log);
+}
+
+void
+mg_subscriber()
+{
+	snprintf(path, sizeof(path), "/tmp/mg_subscriber.%d", getpid());
+
+	log_t log = lg_create("mg_publisher", "stderr");
+
+	/* a ring without slots or image space is refused */
+	XASSERT(!mg_publisher_create(path, 0, 16, log)) {
+		/* empty */
+	}
+	XASSERT(!mg_publisher_create(path, 2, 0, log)) {
+		/* empty */
+	}
+
+	mg_publisher_t pub = mg_publisher_create(path, 2, 16, log);
+	XASSERT(pub) {
+		/* empty */
+	}
+
+	pid_t pid = fork();
+	if (0 == pid) {
+		/* the parent sees the subscriber's assertions fail */
+		_exit(cclass_assert_test(subscribe));
+	}
+
+	while (0 == mg_publisher_serve(pub)) {
+		usleep(1000);
+	}
+
+	/* a 4x3 grey image, with statistics of its middle line, in a
+	   buffer larger than the image */
+	char image[16] = "mg-_";
+	mg_device_t dev = mg_device_create("/dev/null", 1, log, 0);
+	mg_buffer_t buf = mg_device_get_buffer(dev);
+	mg_buffer_alloc(buf, 1);
+	mg_buffer_set(buf, 0, image, sizeof(image));
+	struct mg_format grey = {4, 3, 4, 12,
+				 V4L2_PIX_FMT_GREY, V4L2_FIELD_NONE,
+				 1, {{4, 12}}};
+	mg_device_set_format(dev, grey);
+	mg_config_set_stats(mg_device_get_config(dev), 1);
+
+	for (int i = 0; i < FRAMESETS; i++) {
+		struct v4l2_buffer v4l2_buf;
+		memset(&v4l2_buf, 0, sizeof(v4l2_buf));
+		v4l2_buf.sequence = i;
+		image[3] = '0' + i;
+
+		mg_frame_t frame = mg_frame_create(dev, &v4l2_buf);
+		sllist_t list = sllist_insert_data(0, frame);
+		XASSERT(mg_publisher_publish(pub, list)) {
+			/* empty */
+		}
+		list = sllist_empty(list);
+		mg_frame_destroy(frame);
+	}
+
+	int status;
+	waitpid(pid, &status, 0);
+	XASSERT(WIFEXITED(status) && EXIT_SUCCESS == WEXITSTATUS(status)) {
+		/* empty */
+	}
+
+	dev = mg_device_destroy(dev);
+	pub = mg_publisher_destroy(pub);
+	log = lg_destroy(log);
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_subscriber));
+}
+
+#endif /* TEST_MULTI_GEE_MG_SUBSCRIBER */
@@ -0,0 +1,167 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Shared memory frameset subscriber declaration
+ *
+ * A subscriber reads framesets in place, from the ring published by
+ * another process.  Reading a frameset is bracketed by
+ * mg_subscriber_begin() and mg_subscriber_end():
+ *
+ * @code
+ * uint32_t lock;
+ * const struct mg_ring_slot *slot = mg_subscriber_begin(sub, n, &lock);
+ * if (slot) {
+ *     for (unsigned int i = 0; i < slot->num_frames; i++) {
+ *         const void *image = mg_subscriber_get_image(sub, slot, i);
+ *         // process image
+ *     }
+ *     if (!mg_subscriber_end(sub, slot, lock)) {
+ *         // the publisher overwrote the slot, discard the results
+ *     }
+ * }
+ * @endcode
+ */
+#ifndef ITL_MULTI_GEE_MG_SUBSCRIBER_H
+#define ITL_MULTI_GEE_MG_SUBSCRIBER_H
+
+#include <stdbool.h> /* bool */
+#include <stdint.h> /* uint64_t */
+#include <sys/time.h> /* struct timeval */
+
+#include <multi-gee/log.h>
+#include <multi-gee/mg_ring.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Frameset subscriber object handle
+ */
+NEWHANDLE(mg_subscriber_t);
+
+/**
+ * @brief Create subscriber object
+ *
+ * connects to a publisher's socket and maps its ring read-only.
+ *
+ * @param path  unix domain socket path of the publisher
+ * @param log  to log possible errors to
+ *
+ * @return a newly created subscriber object handle, or 0 on failure
+ */
+mg_subscriber_t
+mg_subscriber_create(const char *path,
+		     log_t log);
+
+/**
+ * @brief Destroy subscriber object
+ *
+ * @param subscriber  handle of object to be destroyed
+ *
+ * @return 0
+ */
+mg_subscriber_t
+mg_subscriber_destroy(mg_subscriber_t subscriber);
+
+/**
+ * @brief Start reading a frameset
+ *
+ * @param subscriber  object handle
+ * @param frameset  frameset number
+ * @param [out]seqlock  lock value to pass to mg_subscriber_end()
+ *
+ * @return the slot holding the frameset, or 0 if the frameset is not
+ * published yet, is being written or has been overwritten
+ */
+const struct mg_ring_slot *
+mg_subscriber_begin(mg_subscriber_t subscriber,
+		    uint64_t frameset,
+		    uint32_t *seqlock);
+
+/**
+ * @brief Finish reading a frameset
+ *
+ * @param subscriber  object handle
+ * @param slot  slot returned by mg_subscriber_begin()
+ * @param seqlock  lock value returned by mg_subscriber_begin()
+ *
+ * @return \c true if the slot was not touched by the publisher while
+ * it was read, else \c false
+ */
+bool
+mg_subscriber_end(mg_subscriber_t subscriber,
+		  const struct mg_ring_slot *slot,
+		  uint32_t seqlock);
+
+/**
+ * @brief Device name accessor
+ *
+ * @param subscriber  object handle
+ * @param device  device table index, from a frame record
+ *
+ * @return device file name, or 0 if the index is not valid
+ */
+const char *
+mg_subscriber_get_device_name(mg_subscriber_t subscriber,
+			      uint32_t device);
+
+/**
+ * @brief Image data accessor
+ *
+ * @param subscriber  object handle
+ * @param slot  slot returned by mg_subscriber_begin()
+ * @param index  frame record index in the slot
+ *
+ * @return a pointer to the image data in the shared ring
+ */
+const void *
+mg_subscriber_get_image(mg_subscriber_t subscriber,
+			const struct mg_ring_slot *slot,
+			unsigned int index);
+
+/**
+ * @brief Published framesets accessor
+ *
+ * @param subscriber  object handle
+ *
+ * @return the number of framesets published so far.  the latest
+ * frameset has number one less than this.
+ */
+uint64_t
+mg_subscriber_get_published(mg_subscriber_t subscriber);
+
+/**
+ * @brief Wait for the publisher
+ *
+ * blocks until more than the given number of framesets have been
+ * published, or until the timeout expires.
+ *
+ * @param subscriber  object handle
+ * @param published  number of framesets already seen
+ * @param timeout  maximum time to wait
+ *
+ * @return \c true if a new frameset is available, \c false on timeout
+ */
+bool
+mg_subscriber_wait(mg_subscriber_t subscriber,
+		   uint64_t published,
+		   struct timeval timeout);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_SUBSCRIBER_H */
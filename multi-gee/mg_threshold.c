@@ -0,0 +1,693 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee threshold definition
+ */
+#include <stdbool.h> /* bool */
+#include <stdlib.h> /* qsort */
+
+#include "mg_threshold.h" /* declarations implemented */
+
+#ifdef MG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Largest image side spans can address
+ */
+#define MAX_SIDE 65535
+
+/**
+ * @brief Span collector
+ */
+struct sink
+{
+	struct mg_span *span; /**< Array to fill in */
+	unsigned int max; /**< Number of spans the array holds */
+	unsigned int n; /**< Number of spans found */
+	uint32_t y; /**< Current line */
+	uint32_t start; /**< First pixel of the open run */
+	bool open; /**< Run open? */
+	uint32_t last_y; /**< Line of the last span */
+	uint32_t last_end; /**< Pixel after the last span */
+};
+
+/**
+ * @brief Window clipped to the image
+ */
+struct window
+{
+	uint32_t left; /**< First column */
+	uint32_t top; /**< First line */
+	uint32_t right; /**< Column after the last */
+	uint32_t bottom; /**< Line after the last */
+};
+
+/**
+ * @brief Threshold part of a line
+ *
+ * the vector kernels read whole vectors past the last pixel while they
+ * stay inside the image line, and ignore what they read there.
+ *
+ * @param line  first pixel to look at
+ * @param width  number of pixels
+ * @param readable  number of pixels that may be read, at least @a width
+ * @param x  column of the first pixel
+ * @param level  lowest foreground value
+ * @param sink  span collector
+ */
+typedef void (*row_fn)(const uint8_t *line,
+		       uint32_t width,
+		       uint32_t readable,
+		       uint32_t x,
+		       uint8_t level,
+		       struct sink *sink);
+
+/**
+ * @brief Threshold a line into mask words
+ *
+ * @param line  first pixel
+ * @param width  number of pixels
+ * @param level  lowest foreground value
+ * @param word  mask words, bit i of word k for pixel 64 k + i
+ */
+typedef void (*pack_fn)(const uint8_t *line,
+			uint32_t width,
+			uint8_t level,
+			uint64_t *word);
+
+/**
+ * @brief Add a span, joining it to the last one if they meet
+ *
+ * @param sink  span collector
+ * @param x  first pixel of the span
+ * @param end  pixel after the span
+ */
+static inline
+void
+put_span(struct sink *sink,
+	 uint32_t x,
+	 uint32_t end)
+{
+	if (sink->n && sink->last_y == sink->y && sink->last_end == x) {
+		if (sink->n <= sink->max) {
+			sink->span[sink->n - 1].length += end - x;
+		}
+	} else {
+		if (sink->n < sink->max) {
+			struct mg_span *s = &sink->span[sink->n];
+			s->y = sink->y;
+			s->x = x;
+			s->length = end - x;
+		}
+		sink->n++;
+	}
+	sink->last_y = sink->y;
+	sink->last_end = end;
+}
+
+/**
+ * @brief Mask of the low bits
+ *
+ * @param bits  number of bits, at most 32
+ *
+ * @return mask with the low @a bits bits set
+ */
+static inline
+uint32_t
+mask_bits(unsigned int bits)
+{
+	return (32 == bits) ? 0xffffffffu : (1u << bits) - 1;
+}
+
+/**
+ * @brief Turn a foreground mask into spans
+ *
+ * bit i of the mask is set if pixel x + i is foreground.  a run still
+ * open after the last bit is left open for the next mask.
+ *
+ * @param sink  span collector
+ * @param mask  foreground mask
+ * @param bits  number of pixels in the mask, at most 32
+ * @param x  column of bit 0
+ */
+static inline
+void
+scan_mask(struct sink *sink,
+	  uint32_t mask,
+	  unsigned int bits,
+	  uint32_t x)
+{
+	uint32_t all = mask_bits(bits);
+
+	/* background and the inside of markers are the common cases */
+	if (sink->open ? mask == all : !mask) {
+		return;
+	}
+
+	unsigned int i = 0;
+	while (i < bits) {
+		uint32_t rest = all & (0xffffffffu << i);
+		if (sink->open) {
+			uint32_t background = ~mask & rest;
+			if (!background) {
+				return;
+			}
+			i = __builtin_ctz(background);
+			put_span(sink, sink->start, x + i);
+			sink->open = false;
+		} else {
+			uint32_t foreground = mask & rest;
+			if (!foreground) {
+				return;
+			}
+			i = __builtin_ctz(foreground);
+			sink->start = x + i;
+			sink->open = true;
+		}
+	}
+}
+
+/**
+ * @brief Foreground mask of up to 32 pixels
+ *
+ * @param line  first pixel
+ * @param bits  number of pixels
+ * @param level  lowest foreground value
+ *
+ * @return bit i set if pixel i is foreground
+ */
+static inline
+uint32_t
+mask_scalar(const uint8_t *line,
+	    unsigned int bits,
+	    uint8_t level)
+{
+	uint32_t mask = 0;
+	for (unsigned int i = 0; i < bits; i++) {
+		mask |= (uint32_t) (line[i] >= level) << i;
+	}
+
+	return mask;
+}
+
+static
+void
+row_scalar(const uint8_t *line,
+	   uint32_t width,
+	   uint32_t readable,
+	   uint32_t x,
+	   uint8_t level,
+	   struct sink *sink)
+{
+	(void) readable;
+
+	for (uint32_t i = 0; i < width; i += 32) {
+		unsigned int bits = (width - i < 32) ? width - i : 32;
+		scan_mask(sink, mask_scalar(line + i, bits, level), bits, x + i);
+	}
+}
+
+static
+void
+pack_scalar(const uint8_t *line,
+	    uint32_t width,
+	    uint8_t level,
+	    uint64_t *word)
+{
+	for (uint32_t i = 0; i < width; i += 64) {
+		unsigned int lo = (width - i < 32) ? width - i : 32;
+		unsigned int hi = (width - i > 32) ? width - i - 32 : 0;
+		if (hi > 32) {
+			hi = 32;
+		}
+		uint64_t w = mask_scalar(line + i, lo, level);
+		if (hi) {
+			w |= (uint64_t) mask_scalar(line + i + 32, hi, level) << 32;
+		}
+		word[i / 64] = w;
+	}
+}
+
+#ifdef MG_SIMD_X86
+
+MG_TARGET_SSE2
+static
+void
+row_sse2(const uint8_t *line,
+	 uint32_t width,
+	 uint32_t readable,
+	 uint32_t x,
+	 uint8_t level,
+	 struct sink *sink)
+{
+	__m128i l = _mm_set1_epi8(level);
+	uint32_t i = 0;
+	for (; i < width && i + 32 <= readable; i += 32) {
+		__m128i a = _mm_loadu_si128((const __m128i *) (line + i));
+		__m128i b = _mm_loadu_si128((const __m128i *) (line + i + 16));
+		/* unsigned a >= l if max(a, l) == a */
+		uint32_t lo = _mm_movemask_epi8(
+			_mm_cmpeq_epi8(_mm_max_epu8(a, l), a));
+		uint32_t hi = _mm_movemask_epi8(
+			_mm_cmpeq_epi8(_mm_max_epu8(b, l), b));
+		unsigned int bits = (width - i < 32) ? width - i : 32;
+		scan_mask(sink, (lo | hi << 16) & mask_bits(bits), bits, x + i);
+	}
+	if (i < width) {
+		row_scalar(line + i, width - i, width - i, x + i, level, sink);
+	}
+}
+
+MG_TARGET_AVX2
+static
+void
+row_avx2(const uint8_t *line,
+	 uint32_t width,
+	 uint32_t readable,
+	 uint32_t x,
+	 uint8_t level,
+	 struct sink *sink)
+{
+	__m256i l = _mm256_set1_epi8(level);
+	uint32_t i = 0;
+	for (; i < width && i + 32 <= readable; i += 32) {
+		__m256i a = _mm256_loadu_si256((const __m256i *) (line + i));
+		uint32_t mask = _mm256_movemask_epi8(
+			_mm256_cmpeq_epi8(_mm256_max_epu8(a, l), a));
+		unsigned int bits = (width - i < 32) ? width - i : 32;
+		scan_mask(sink, mask & mask_bits(bits), bits, x + i);
+	}
+	if (i < width) {
+		row_sse2(line + i, width - i, readable - i, x + i, level, sink);
+	}
+}
+
+MG_TARGET_SSE2
+static
+void
+pack_sse2(const uint8_t *line,
+	  uint32_t width,
+	  uint8_t level,
+	  uint64_t *word)
+{
+	__m128i l = _mm_set1_epi8(level);
+	uint32_t i = 0;
+	for (; i + 64 <= width; i += 64) {
+		uint64_t w = 0;
+		for (unsigned int j = 0; j < 64; j += 16) {
+			__m128i a = _mm_loadu_si128((const __m128i *)
+						    (line + i + j));
+			uint64_t m = _mm_movemask_epi8(
+				_mm_cmpeq_epi8(_mm_max_epu8(a, l), a));
+			w |= m << j;
+		}
+		word[i / 64] = w;
+	}
+	if (i < width) {
+		pack_scalar(line + i, width - i, level, word + i / 64);
+	}
+}
+
+MG_TARGET_AVX2
+static
+void
+pack_avx2(const uint8_t *line,
+	  uint32_t width,
+	  uint8_t level,
+	  uint64_t *word)
+{
+	__m256i l = _mm256_set1_epi8(level);
+	uint32_t i = 0;
+	for (; i + 64 <= width; i += 64) {
+		__m256i a = _mm256_loadu_si256((const __m256i *) (line + i));
+		__m256i b = _mm256_loadu_si256((const __m256i *)
+					       (line + i + 32));
+		uint32_t lo = _mm256_movemask_epi8(
+			_mm256_cmpeq_epi8(_mm256_max_epu8(a, l), a));
+		uint32_t hi = _mm256_movemask_epi8(
+			_mm256_cmpeq_epi8(_mm256_max_epu8(b, l), b));
+		word[i / 64] = lo | (uint64_t) hi << 32;
+	}
+	if (i < width) {
+		pack_sse2(line + i, width - i, level, word + i / 64);
+	}
+}
+
+/**
+ * @brief Row kernel per instruction set level
+ */
+static const row_fn threshold_row[] = {
+	row_scalar,
+	row_sse2,
+	row_avx2
+};
+
+/**
+ * @brief Mask kernel per instruction set level
+ */
+static const pack_fn threshold_pack[] = {
+	pack_scalar,
+	pack_sse2,
+	pack_avx2
+};
+
+#else /* MG_SIMD_X86 */
+
+static const row_fn threshold_row[] = {
+	row_scalar,
+	row_scalar,
+	row_scalar
+};
+
+static const pack_fn threshold_pack[] = {
+	pack_scalar,
+	pack_scalar,
+	pack_scalar
+};
+
+#endif /* MG_SIMD_X86 */
+
+/**
+ * @brief Order windows by their left edge
+ */
+static
+int
+by_left(const void *a,
+	const void *b)
+{
+	const struct window *wa = a;
+	const struct window *wb = b;
+
+	return (wa->left > wb->left) - (wa->left < wb->left);
+}
+
+unsigned int
+mg_threshold(const struct mg_image *image,
+	     uint8_t level,
+	     struct mg_span *span,
+	     unsigned int max,
+	     enum mg_simd simd)
+{
+	struct mg_rect all = {0, 0, image->width, image->height};
+
+	return mg_threshold_windows(image, &all, 1, level, span, max, simd);
+}
+
+bool
+mg_threshold_mask(const struct mg_image *image,
+		  uint8_t level,
+		  mg_mask_t mask,
+		  enum mg_simd simd)
+{
+	if (simd > mg_simd_detect()) {
+		simd = mg_simd_detect();
+	}
+
+	if (!image->data
+	    || !mg_mask_set_size(mask, image->width, image->height)) {
+		return false;
+	}
+
+	for (uint32_t y = 0; y < image->height; y++) {
+		const uint8_t *line = (const uint8_t *) image->data
+			+ (size_t) y * image->stride;
+		threshold_pack[simd](line, image->width, level,
+				     mg_mask_get_line(mask, y));
+	}
+
+	return true;
+}
+
+unsigned int
+mg_threshold_windows(const struct mg_image *image,
+		     const struct mg_rect *window,
+		     unsigned int num_windows,
+		     uint8_t level,
+		     struct mg_span *span,
+		     unsigned int max,
+		     enum mg_simd simd)
+{
+	if (simd > mg_simd_detect()) {
+		simd = mg_simd_detect();
+	}
+
+	struct sink sink = {span, max, 0, 0, 0, false, 0, 0};
+	if (!num_windows || !image->data) {
+		return 0;
+	}
+
+	int64_t width = (image->width < MAX_SIDE) ? image->width : MAX_SIDE;
+	int64_t height = (image->height < MAX_SIDE) ? image->height : MAX_SIDE;
+
+	/* clip, and drop windows that end up empty */
+	struct window clip[num_windows];
+	unsigned int n = 0;
+	uint32_t top = height;
+	uint32_t bottom = 0;
+	for (unsigned int i = 0; i < num_windows; i++) {
+		const struct mg_rect *r = &window[i];
+		int64_t left = (r->left < 0) ? 0 : r->left;
+		int64_t right = (int64_t) r->left + r->width;
+		int64_t t = (r->top < 0) ? 0 : r->top;
+		int64_t b = (int64_t) r->top + r->height;
+		if (right > width) {
+			right = width;
+		}
+		if (b > height) {
+			b = height;
+		}
+		if (left >= right || t >= b) {
+			continue;
+		}
+
+		clip[n].left = left;
+		clip[n].top = t;
+		clip[n].right = right;
+		clip[n].bottom = b;
+		if (clip[n].top < top) {
+			top = clip[n].top;
+		}
+		if (clip[n].bottom > bottom) {
+			bottom = clip[n].bottom;
+		}
+		n++;
+	}
+	qsort(clip, n, sizeof(*clip), by_left);
+
+	for (uint32_t y = top; y < bottom; y++) {
+		const uint8_t *line = (const uint8_t *) image->data
+			+ (size_t) y * image->stride;
+		uint32_t done = 0;
+
+		sink.y = y;
+		for (unsigned int i = 0; i < n; i++) {
+			const struct window *w = &clip[i];
+			if (y < w->top || y >= w->bottom || w->right <= done) {
+				continue;
+			}
+
+			/* overlapping windows are looked at once */
+			uint32_t left = (w->left > done) ? w->left : done;
+			threshold_row[simd](line + left, w->right - left,
+					    image->width - left, left, level,
+					    &sink);
+			if (sink.open) {
+				put_span(&sink, sink.start, w->right);
+				sink.open = false;
+			}
+			done = w->right;
+		}
+	}
+
+	return sink.n;
+}
+
+#ifdef TEST_MULTI_GEE_MG_THRESHOLD
+
+#include <stdio.h>
+#include <string.h>
+
+USE_XASSERT
+
+/**
+ * @brief Straightforward threshold to compare the kernels against
+ */
+static
+unsigned int
+reference(const struct mg_image *image,
+	  uint8_t level,
+	  struct mg_span *span)
+{
+	unsigned int n = 0;
+	for (uint32_t y = 0; y < image->height; y++) {
+		const uint8_t *line = (const uint8_t *) image->data
+			+ (size_t) y * image->stride;
+		for (uint32_t x = 0; x < image->width; x++) {
+			if (line[x] < level) {
+				continue;
+			}
+			uint32_t end = x;
+			while (end < image->width && line[end] >= level) {
+				end++;
+			}
+			span[n].y = y;
+			span[n].x = x;
+			span[n].length = end - x;
+			n++;
+			x = end;
+		}
+	}
+
+	return n;
+}
+
+static
+bool
+same(const struct mg_span *a,
+     const struct mg_span *b,
+     unsigned int n)
+{
+	for (unsigned int i = 0; i < n; i++) {
+		if (a[i].y != b[i].y || a[i].x != b[i].x
+		    || a[i].length != b[i].length) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void
+mg_threshold_test()
+{
+	printf("%s: %s\n", __func__, mg_simd_name(mg_simd_detect()));
+
+	/* two markers on a 40x3 image */
+	uint8_t pixel[40 * 3];
+	memset(pixel, 10, sizeof(pixel));
+	memset(pixel + 3, 200, 4);
+	memset(pixel + 40 + 2, 200, 6);
+	memset(pixel + 40 + 30, 255, 10);
+	struct mg_image image = {pixel, 40, 3, 40};
+
+	struct mg_span span[64];
+	XASSERT(3 == mg_threshold(&image, 128, span, 64, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(span[0].y == 0 && span[0].x == 3 && span[0].length == 4) {
+		/* empty */
+	}
+	XASSERT(span[2].y == 1 && span[2].x == 30 && span[2].length == 10) {
+		/* empty */
+	}
+
+	/* the count is returned even if the spans do not fit */
+	memset(span, 0, sizeof(span));
+	XASSERT(3 == mg_threshold(&image, 128, span, 1, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(span[0].length == 4 && span[1].length == 0) {
+		/* empty */
+	}
+
+	/* overlapping and adjacent windows give whole spans */
+	struct mg_rect window[] = {
+		{32, 1, 8, 2}, {-5, -5, 9, 7}, {4, 1, 2, 1}, {28, 0, 6, 2}
+	};
+	XASSERT(3 == mg_threshold_windows(&image, window, 4, 128,
+					  span, 64, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(span[0].y == 0 && span[0].x == 3 && span[0].length == 1) {
+		/* empty */
+	}
+	XASSERT(span[1].y == 1 && span[1].x == 2 && span[1].length == 4) {
+		/* empty */
+	}
+	XASSERT(span[2].y == 1 && span[2].x == 30 && span[2].length == 10) {
+		/* empty */
+	}
+
+	/* vector kernels match the reference */
+	mg_mask_t mask = mg_mask_create(0, 0);
+	uint32_t widths[] = {1, 15, 31, 32, 33, 64, 100, 771};
+	for (unsigned int i = 0; i < sizeof(widths) / sizeof(*widths); i++) {
+		uint32_t w = widths[i];
+		uint32_t h = 5;
+		struct mg_image src = {malloc(w * h), w, h, w};
+		for (uint32_t j = 0; j < w * h; j++) {
+			/* runs of random length */
+			((uint8_t *) src.data)[j] = (rand() % 7) ? 0 : 255;
+			if (j && rand() % 4) {
+				((uint8_t *) src.data)[j] =
+					((uint8_t *) src.data)[j - 1];
+			}
+		}
+
+		struct mg_span *ref = malloc(w * h * sizeof(*ref));
+		struct mg_span *vec = malloc(w * h * sizeof(*vec));
+		unsigned int n = reference(&src, 100, ref);
+		for (int simd = MG_SIMD_SCALAR; simd <= (int) mg_simd_detect();
+		     simd++) {
+			XASSERT(n == mg_threshold(&src, 100, vec, w * h, simd)) {
+				/* empty */
+			}
+			XASSERT(same(ref, vec, n)) {
+				/* empty */
+			}
+
+			/* windows tiling the image give the same spans */
+			struct mg_rect tile[] = {
+				{0, 0, w / 3, h}, {w / 3, 0, w - w / 3, 2},
+				{w / 3, 2, w - w / 3, h - 2}
+			};
+			XASSERT(n == mg_threshold_windows(&src, tile, 3, 100,
+							  vec, w * h, simd)) {
+				/* empty */
+			}
+			XASSERT(same(ref, vec, n)) {
+				/* empty */
+			}
+
+			/* and so does the mask */
+			XASSERT(mg_threshold_mask(&src, 100, mask, simd)) {
+				/* empty */
+			}
+			XASSERT(n == mg_mask_get_spans(mask, vec, w * h)) {
+				/* empty */
+			}
+			XASSERT(same(ref, vec, n)) {
+				/* empty */
+			}
+		}
+		free(vec);
+		free(ref);
+		free(src.data);
+	}
+	mask = mg_mask_destroy(mask);
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_threshold_test));
+}
+
+#endif /* TEST_MULTI_GEE_MG_THRESHOLD */
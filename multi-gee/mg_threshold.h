@@ -0,0 +1,129 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee threshold declaration
+ *
+ * Markers show up as bright spots on a dark background.  The threshold
+ * kernels compare every pixel of an 8-bit image against a level and
+ * hand back the foreground as run-length encoded spans, a few per
+ * marker line, instead of a mask of the whole image.  The comparison is
+ * done 16 or 32 pixels at a time, and background stretches cost little
+ * more than the load.
+ */
+#ifndef ITL_MULTI_GEE_MG_THRESHOLD_H
+#define ITL_MULTI_GEE_MG_THRESHOLD_H
+
+#include <stdbool.h> /* bool */
+#include <stdint.h> /* uint8_t */
+
+#include <multi-gee/mg_image.h>
+#include <multi-gee/mg_mask.h>
+#include <multi-gee/mg_simd.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Run of foreground pixels on one line
+ *
+ * coordinates are relative to the thresholded image, which may be at
+ * most 65535 pixels wide and high.
+ */
+struct mg_span
+{
+	uint16_t y; /**< Line */
+	uint16_t x; /**< First foreground pixel */
+	uint16_t length; /**< Number of foreground pixels */
+};
+
+/**
+ * @brief Threshold an image into spans
+ *
+ * pixels at or above the level are foreground.  the spans come in
+ * raster order.  like snprintf(), the number of spans found is
+ * returned even if it does not fit, so a caller can grow the array and
+ * try again.
+ *
+ * @param image  8-bit image, such as mg_frame_get_grey() returns
+ * @param level  lowest foreground value
+ * @param span  array to fill in
+ * @param max  number of spans the array holds
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return the number of spans found, of which at most @a max are
+ * stored
+ */
+unsigned int
+mg_threshold(const struct mg_image *image,
+	     uint8_t level,
+	     struct mg_span *span,
+	     unsigned int max,
+	     enum mg_simd simd);
+
+/**
+ * @brief Threshold an image into a binary mask
+ *
+ * pixels at or above the level are set.  the mask takes the size of
+ * the image.
+ *
+ * @param image  8-bit image
+ * @param level  lowest foreground value
+ * @param mask  mask to fill in
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return \c true on success, \c false if the image has no data or the
+ * mask cannot grow
+ */
+bool
+mg_threshold_mask(const struct mg_image *image,
+		  uint8_t level,
+		  mg_mask_t mask,
+		  enum mg_simd simd);
+
+/**
+ * @brief Threshold search windows of an image into spans
+ *
+ * as mg_threshold(), but only pixels inside the windows are looked at.
+ * windows are clipped to the image and may overlap; every pixel is
+ * looked at once and spans that meet across window edges are joined,
+ * so the spans are the same as those of the image masked to the union
+ * of the windows, in raster order.
+ *
+ * @param image  8-bit image
+ * @param window  search windows, in image coordinates
+ * @param num_windows  number of search windows
+ * @param level  lowest foreground value
+ * @param span  array to fill in
+ * @param max  number of spans the array holds
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return the number of spans found, of which at most @a max are
+ * stored
+ */
+unsigned int
+mg_threshold_windows(const struct mg_image *image,
+		     const struct mg_rect *window,
+		     unsigned int num_windows,
+		     uint8_t level,
+		     struct mg_span *span,
+		     unsigned int max,
+		     enum mg_simd simd);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_THRESHOLD_H */
@@ -0,0 +1,1395 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee triangulation definition
+ */
+#include <math.h> /* sqrt */
+#include <stdbool.h> /* bool */
+#include <stdlib.h> /* realloc */
+#include <string.h> /* memset */
+
+#include "mg_triangulate.h" /* class implemented */
+
+#ifdef MG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+USE_XASSERT
+
+/**
+ * @brief Most points of one view that can be matched
+ */
+#define MAX_POINTS 65535
+
+/**
+ * @brief Camera calibration slot
+ */
+struct slot
+{
+	bool set; /**< Calibrated? */
+	struct mg_camera camera; /**< Calibration */
+};
+
+/**
+ * @brief Camera pose in normalised image coordinates
+ */
+struct pose
+{
+	double r[9]; /**< World to camera rotation */
+	double t[3]; /**< World to camera translation */
+	double fx; /**< Focal length in column pixels */
+	double fy; /**< Focal length in line pixels */
+	double cx; /**< Principal point column */
+	double cy; /**< Principal point line */
+	double width; /**< Image width */
+	double height; /**< Image height */
+};
+
+/**
+ * @brief Points of a view binned in a grid
+ *
+ * the points of cell c are index[start[c]] up to index[start[c + 1]].
+ */
+struct grid
+{
+	const struct mg_point *point; /**< Points */
+	unsigned int num_points; /**< Number of points */
+	double cell; /**< Cell side in pixels */
+	uint32_t cols; /**< Columns of cells */
+	uint32_t rows; /**< Rows of cells */
+	uint32_t *start; /**< First entry of index per cell, and one more */
+	unsigned int start_capacity; /**< Cells start holds */
+	uint16_t *index; /**< Points, cell by cell */
+	uint8_t *used; /**< Point used for a marker? */
+	unsigned int point_capacity; /**< Points index and used hold */
+};
+
+/**
+ * @brief Points of a marker, before solving
+ */
+struct match
+{
+	uint16_t views; /**< Bit per view the marker is seen in */
+	uint16_t point[MG_TRIANGULATE_MAX_VIEWS]; /**< Point per view */
+};
+
+/**
+ * @brief Markers to solve, one array per quantity
+ *
+ * w[v][i] is 1 if marker i is seen in view v, with normalised image
+ * coordinates nx[v][i] and ny[v][i], and 0 otherwise.
+ */
+struct batch
+{
+	double *nx[MG_TRIANGULATE_MAX_VIEWS]; /**< Normalised columns */
+	double *ny[MG_TRIANGULATE_MAX_VIEWS]; /**< Normalised lines */
+	double *w[MG_TRIANGULATE_MAX_VIEWS]; /**< Weights */
+	double *x; /**< Solved world x */
+	double *y; /**< Solved world y */
+	double *z; /**< Solved world z */
+	double *error; /**< Root mean square reprojection error */
+};
+
+/**
+ * @brief Triangulator object structure
+ */
+CLASS(mg_triangulate, mg_triangulate_t)
+{
+	struct slot *slot; /**< Calibration per device identifier */
+	unsigned int num_slots; /**< Number of slots */
+	double tolerance; /**< Pixels a point may be off */
+	unsigned int min_views; /**< Fewest views of a marker */
+	struct grid grid[MG_TRIANGULATE_MAX_VIEWS]; /**< Binned points */
+	struct match *match; /**< Matched markers */
+	unsigned int match_capacity; /**< Markers match holds */
+	double *batch; /**< Storage of the batch arrays */
+	unsigned int batch_capacity; /**< Markers the batch holds */
+};
+
+/**
+ * @brief Bin the points of a view
+ *
+ * @param grid  grid to fill in
+ * @param pose  camera of the view
+ * @param view  points of the view
+ * @param cell  cell side in pixels
+ *
+ * @return
+ * - @c false on failure to allocate memory, else
+ * - @c true
+ */
+static
+bool
+bin(struct grid *grid,
+    const struct pose *pose,
+    const struct mg_view *view,
+    double cell);
+
+/**
+ * @brief Cell column or row of a coordinate
+ *
+ * @param v  coordinate in pixels
+ * @param cell  cell side in pixels
+ * @param n  number of cells
+ *
+ * @return the cell, clamped to the grid
+ */
+static
+uint32_t
+cell_of(double v,
+	double cell,
+	uint32_t n);
+
+/**
+ * @brief Try a pair of points as a marker
+ *
+ * solves the marker from the pair, and looks for points where it
+ * projects in the other views.
+ *
+ * @param pose  camera per view
+ * @param grid  points per view
+ * @param num_views  number of views
+ * @param a  first view
+ * @param i  point of the first view
+ * @param b  second view
+ * @param j  point of the second view
+ * @param tolerance  pixels a point may be off
+ * @param [out]match  points of the marker
+ * @param [out]error  sum of the squared errors in pixels
+ *
+ * @return number of views the marker is seen in, 0 if the pair does
+ * not fit or the marker is behind a camera
+ */
+static
+unsigned int
+extend(const struct pose *pose,
+       const struct grid *grid,
+       unsigned int num_views,
+       unsigned int a,
+       unsigned int i,
+       unsigned int b,
+       unsigned int j,
+       double tolerance,
+       struct match *match,
+       double *error);
+
+/**
+ * @brief Unused point nearest to a position
+ *
+ * @param grid  points of a view
+ * @param x  column
+ * @param y  line
+ * @param tolerance  greatest distance in pixels
+ * @param [out]d2  squared distance of the point
+ *
+ * @return the point, or -1 if there is none within the tolerance
+ */
+static
+int
+nearest(const struct grid *grid,
+	double x,
+	double y,
+	double tolerance,
+	double *d2);
+
+/**
+ * @brief Project a world point into a view
+ *
+ * @param pose  camera
+ * @param p  world point
+ * @param [out]x  column
+ * @param [out]y  line
+ *
+ * @return
+ * - @c false if the point is not in front of the camera, else
+ * - @c true
+ */
+static
+bool
+project(const struct pose *pose,
+	const double p[3],
+	double *x,
+	double *y);
+
+/**
+ * @brief Make room for some markers
+ *
+ * @param p  array to grow
+ * @param capacity  number of elements the array holds
+ * @param n  number of elements needed
+ * @param size  element size
+ *
+ * @return
+ * - @c false on failure to allocate memory, else
+ * - @c true
+ */
+static
+bool
+reserve(void **p,
+	unsigned int *capacity,
+	unsigned int n,
+	size_t size);
+
+/**
+ * @brief Solve markers by linear least squares
+ *
+ * every view adds two linear equations in the world point, from its
+ * projection; the 3x3 normal equations are solved by Cramer's rule.
+ *
+ * @param pose  camera per view
+ * @param num_views  number of views
+ * @param batch  markers
+ * @param first  first marker
+ * @param n  number of markers
+ */
+typedef void (*solve_fn)(const struct pose *pose,
+			 unsigned int num_views,
+			 const struct batch *batch,
+			 unsigned int first,
+			 unsigned int n);
+
+static
+void
+solve_scalar(const struct pose *pose,
+	     unsigned int num_views,
+	     const struct batch *batch,
+	     unsigned int first,
+	     unsigned int n)
+{
+	for (unsigned int i = first; i < first + n; i++) {
+		double m00 = 0, m01 = 0, m02 = 0, m11 = 0, m12 = 0, m22 = 0;
+		double v0 = 0, v1 = 0, v2 = 0;
+		for (unsigned int v = 0; v < num_views; v++) {
+			const double *r = pose[v].r;
+			const double *t = pose[v].t;
+			double w = batch->w[v][i];
+			for (int k = 0; k < 2; k++) {
+				double u = k ? batch->ny[v][i] : batch->nx[v][i];
+				const double *rk = r + 3 * k;
+				double a0 = u * r[6] - rk[0];
+				double a1 = u * r[7] - rk[1];
+				double a2 = u * r[8] - rk[2];
+				double c = t[k] - u * t[2];
+				m00 += w * a0 * a0;
+				m01 += w * a0 * a1;
+				m02 += w * a0 * a2;
+				m11 += w * a1 * a1;
+				m12 += w * a1 * a2;
+				m22 += w * a2 * a2;
+				v0 += w * a0 * c;
+				v1 += w * a1 * c;
+				v2 += w * a2 * c;
+			}
+		}
+
+		double c00 = m11 * m22 - m12 * m12;
+		double c01 = m02 * m12 - m01 * m22;
+		double c02 = m01 * m12 - m02 * m11;
+		double c11 = m00 * m22 - m02 * m02;
+		double c12 = m01 * m02 - m00 * m12;
+		double c22 = m00 * m11 - m01 * m01;
+		double det = m00 * c00 + m01 * c01 + m02 * c02;
+		double x = (c00 * v0 + c01 * v1 + c02 * v2) / det;
+		double y = (c01 * v0 + c11 * v1 + c12 * v2) / det;
+		double z = (c02 * v0 + c12 * v1 + c22 * v2) / det;
+
+		double e = 0;
+		double count = 0;
+		for (unsigned int v = 0; v < num_views; v++) {
+			const double *r = pose[v].r;
+			const double *t = pose[v].t;
+			double w = batch->w[v][i];
+			double zc = r[6] * x + r[7] * y + r[8] * z + t[2];
+			double dx = ((r[0] * x + r[1] * y + r[2] * z + t[0]) / zc
+				     - batch->nx[v][i]) * pose[v].fx;
+			double dy = ((r[3] * x + r[4] * y + r[5] * z + t[1]) / zc
+				     - batch->ny[v][i]) * pose[v].fy;
+			e += w * (dx * dx + dy * dy);
+			count += w;
+		}
+
+		batch->x[i] = x;
+		batch->y[i] = y;
+		batch->z[i] = z;
+		batch->error[i] = sqrt(e / count);
+	}
+}
+
+#ifdef MG_SIMD_X86
+
+MG_TARGET_SSE2
+static
+void
+solve_sse2(const struct pose *pose,
+	   unsigned int num_views,
+	   const struct batch *batch,
+	   unsigned int first,
+	   unsigned int n)
+{
+	unsigned int i = first;
+	for (; i + 2 <= first + n; i += 2) {
+		__m128d m00 = _mm_setzero_pd(), m01 = m00, m02 = m00;
+		__m128d m11 = m00, m12 = m00, m22 = m00;
+		__m128d v0 = m00, v1 = m00, v2 = m00;
+		for (unsigned int v = 0; v < num_views; v++) {
+			const double *r = pose[v].r;
+			const double *t = pose[v].t;
+			__m128d w = _mm_loadu_pd(batch->w[v] + i);
+			for (int k = 0; k < 2; k++) {
+				__m128d u = _mm_loadu_pd(
+					(k ? batch->ny[v] : batch->nx[v]) + i);
+				const double *rk = r + 3 * k;
+				__m128d a0 = _mm_sub_pd(
+					_mm_mul_pd(u, _mm_set1_pd(r[6])),
+					_mm_set1_pd(rk[0]));
+				__m128d a1 = _mm_sub_pd(
+					_mm_mul_pd(u, _mm_set1_pd(r[7])),
+					_mm_set1_pd(rk[1]));
+				__m128d a2 = _mm_sub_pd(
+					_mm_mul_pd(u, _mm_set1_pd(r[8])),
+					_mm_set1_pd(rk[2]));
+				__m128d c = _mm_sub_pd(
+					_mm_set1_pd(t[k]),
+					_mm_mul_pd(u, _mm_set1_pd(t[2])));
+				__m128d w0 = _mm_mul_pd(w, a0);
+				__m128d w1 = _mm_mul_pd(w, a1);
+				__m128d w2 = _mm_mul_pd(w, a2);
+				m00 = _mm_add_pd(m00, _mm_mul_pd(w0, a0));
+				m01 = _mm_add_pd(m01, _mm_mul_pd(w0, a1));
+				m02 = _mm_add_pd(m02, _mm_mul_pd(w0, a2));
+				m11 = _mm_add_pd(m11, _mm_mul_pd(w1, a1));
+				m12 = _mm_add_pd(m12, _mm_mul_pd(w1, a2));
+				m22 = _mm_add_pd(m22, _mm_mul_pd(w2, a2));
+				v0 = _mm_add_pd(v0, _mm_mul_pd(w0, c));
+				v1 = _mm_add_pd(v1, _mm_mul_pd(w1, c));
+				v2 = _mm_add_pd(v2, _mm_mul_pd(w2, c));
+			}
+		}
+
+		__m128d c00 = _mm_sub_pd(_mm_mul_pd(m11, m22),
+					 _mm_mul_pd(m12, m12));
+		__m128d c01 = _mm_sub_pd(_mm_mul_pd(m02, m12),
+					 _mm_mul_pd(m01, m22));
+		__m128d c02 = _mm_sub_pd(_mm_mul_pd(m01, m12),
+					 _mm_mul_pd(m02, m11));
+		__m128d c11 = _mm_sub_pd(_mm_mul_pd(m00, m22),
+					 _mm_mul_pd(m02, m02));
+		__m128d c12 = _mm_sub_pd(_mm_mul_pd(m01, m02),
+					 _mm_mul_pd(m00, m12));
+		__m128d c22 = _mm_sub_pd(_mm_mul_pd(m00, m11),
+					 _mm_mul_pd(m01, m01));
+		__m128d det = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m00, c00),
+						    _mm_mul_pd(m01, c01)),
+					 _mm_mul_pd(m02, c02));
+		__m128d x = _mm_div_pd(
+			_mm_add_pd(_mm_add_pd(_mm_mul_pd(c00, v0),
+					      _mm_mul_pd(c01, v1)),
+				   _mm_mul_pd(c02, v2)), det);
+		__m128d y = _mm_div_pd(
+			_mm_add_pd(_mm_add_pd(_mm_mul_pd(c01, v0),
+					      _mm_mul_pd(c11, v1)),
+				   _mm_mul_pd(c12, v2)), det);
+		__m128d z = _mm_div_pd(
+			_mm_add_pd(_mm_add_pd(_mm_mul_pd(c02, v0),
+					      _mm_mul_pd(c12, v1)),
+				   _mm_mul_pd(c22, v2)), det);
+
+		__m128d e = _mm_setzero_pd();
+		__m128d count = _mm_setzero_pd();
+		for (unsigned int v = 0; v < num_views; v++) {
+			const double *r = pose[v].r;
+			const double *t = pose[v].t;
+			__m128d p[3];
+			for (int k = 0; k < 3; k++) {
+				p[k] = _mm_add_pd(
+					_mm_add_pd(
+						_mm_mul_pd(_mm_set1_pd(r[3 * k]), x),
+						_mm_mul_pd(_mm_set1_pd(r[3 * k + 1]),
+							   y)),
+					_mm_add_pd(
+						_mm_mul_pd(_mm_set1_pd(r[3 * k + 2]),
+							   z),
+						_mm_set1_pd(t[k])));
+			}
+			__m128d w = _mm_loadu_pd(batch->w[v] + i);
+			__m128d dx = _mm_mul_pd(
+				_mm_sub_pd(_mm_div_pd(p[0], p[2]),
+					   _mm_loadu_pd(batch->nx[v] + i)),
+				_mm_set1_pd(pose[v].fx));
+			__m128d dy = _mm_mul_pd(
+				_mm_sub_pd(_mm_div_pd(p[1], p[2]),
+					   _mm_loadu_pd(batch->ny[v] + i)),
+				_mm_set1_pd(pose[v].fy));
+			e = _mm_add_pd(e, _mm_mul_pd(
+					       w, _mm_add_pd(_mm_mul_pd(dx, dx),
+							     _mm_mul_pd(dy, dy))));
+			count = _mm_add_pd(count, w);
+		}
+
+		_mm_storeu_pd(batch->x + i, x);
+		_mm_storeu_pd(batch->y + i, y);
+		_mm_storeu_pd(batch->z + i, z);
+		_mm_storeu_pd(batch->error + i, _mm_sqrt_pd(_mm_div_pd(e, count)));
+	}
+	if (i < first + n) {
+		solve_scalar(pose, num_views, batch, i, first + n - i);
+	}
+}
+
+MG_TARGET_AVX2
+static
+void
+solve_avx2(const struct pose *pose,
+	   unsigned int num_views,
+	   const struct batch *batch,
+	   unsigned int first,
+	   unsigned int n)
+{
+	unsigned int i = first;
+	for (; i + 4 <= first + n; i += 4) {
+		__m256d m00 = _mm256_setzero_pd(), m01 = m00, m02 = m00;
+		__m256d m11 = m00, m12 = m00, m22 = m00;
+		__m256d v0 = m00, v1 = m00, v2 = m00;
+		for (unsigned int v = 0; v < num_views; v++) {
+			const double *r = pose[v].r;
+			const double *t = pose[v].t;
+			__m256d w = _mm256_loadu_pd(batch->w[v] + i);
+			for (int k = 0; k < 2; k++) {
+				__m256d u = _mm256_loadu_pd(
+					(k ? batch->ny[v] : batch->nx[v]) + i);
+				const double *rk = r + 3 * k;
+				__m256d a0 = _mm256_sub_pd(
+					_mm256_mul_pd(u, _mm256_set1_pd(r[6])),
+					_mm256_set1_pd(rk[0]));
+				__m256d a1 = _mm256_sub_pd(
+					_mm256_mul_pd(u, _mm256_set1_pd(r[7])),
+					_mm256_set1_pd(rk[1]));
+				__m256d a2 = _mm256_sub_pd(
+					_mm256_mul_pd(u, _mm256_set1_pd(r[8])),
+					_mm256_set1_pd(rk[2]));
+				__m256d c = _mm256_sub_pd(
+					_mm256_set1_pd(t[k]),
+					_mm256_mul_pd(u, _mm256_set1_pd(t[2])));
+				__m256d w0 = _mm256_mul_pd(w, a0);
+				__m256d w1 = _mm256_mul_pd(w, a1);
+				__m256d w2 = _mm256_mul_pd(w, a2);
+				m00 = _mm256_add_pd(m00, _mm256_mul_pd(w0, a0));
+				m01 = _mm256_add_pd(m01, _mm256_mul_pd(w0, a1));
+				m02 = _mm256_add_pd(m02, _mm256_mul_pd(w0, a2));
+				m11 = _mm256_add_pd(m11, _mm256_mul_pd(w1, a1));
+				m12 = _mm256_add_pd(m12, _mm256_mul_pd(w1, a2));
+				m22 = _mm256_add_pd(m22, _mm256_mul_pd(w2, a2));
+				v0 = _mm256_add_pd(v0, _mm256_mul_pd(w0, c));
+				v1 = _mm256_add_pd(v1, _mm256_mul_pd(w1, c));
+				v2 = _mm256_add_pd(v2, _mm256_mul_pd(w2, c));
+			}
+		}
+
+		__m256d c00 = _mm256_sub_pd(_mm256_mul_pd(m11, m22),
+					    _mm256_mul_pd(m12, m12));
+		__m256d c01 = _mm256_sub_pd(_mm256_mul_pd(m02, m12),
+					    _mm256_mul_pd(m01, m22));
+		__m256d c02 = _mm256_sub_pd(_mm256_mul_pd(m01, m12),
+					    _mm256_mul_pd(m02, m11));
+		__m256d c11 = _mm256_sub_pd(_mm256_mul_pd(m00, m22),
+					    _mm256_mul_pd(m02, m02));
+		__m256d c12 = _mm256_sub_pd(_mm256_mul_pd(m01, m02),
+					    _mm256_mul_pd(m00, m12));
+		__m256d c22 = _mm256_sub_pd(_mm256_mul_pd(m00, m11),
+					    _mm256_mul_pd(m01, m01));
+		__m256d det = _mm256_add_pd(
+			_mm256_add_pd(_mm256_mul_pd(m00, c00),
+				      _mm256_mul_pd(m01, c01)),
+			_mm256_mul_pd(m02, c02));
+		__m256d x = _mm256_div_pd(
+			_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(c00, v0),
+						    _mm256_mul_pd(c01, v1)),
+				      _mm256_mul_pd(c02, v2)), det);
+		__m256d y = _mm256_div_pd(
+			_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(c01, v0),
+						    _mm256_mul_pd(c11, v1)),
+				      _mm256_mul_pd(c12, v2)), det);
+		__m256d z = _mm256_div_pd(
+			_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(c02, v0),
+						    _mm256_mul_pd(c12, v1)),
+				      _mm256_mul_pd(c22, v2)), det);
+
+		__m256d e = _mm256_setzero_pd();
+		__m256d count = _mm256_setzero_pd();
+		for (unsigned int v = 0; v < num_views; v++) {
+			const double *r = pose[v].r;
+			const double *t = pose[v].t;
+			__m256d p[3];
+			for (int k = 0; k < 3; k++) {
+				p[k] = _mm256_add_pd(
+					_mm256_add_pd(
+						_mm256_mul_pd(
+							_mm256_set1_pd(r[3 * k]), x),
+						_mm256_mul_pd(
+							_mm256_set1_pd(r[3 * k + 1]),
+							y)),
+					_mm256_add_pd(
+						_mm256_mul_pd(
+							_mm256_set1_pd(r[3 * k + 2]),
+							z),
+						_mm256_set1_pd(t[k])));
+			}
+			__m256d w = _mm256_loadu_pd(batch->w[v] + i);
+			__m256d dx = _mm256_mul_pd(
+				_mm256_sub_pd(_mm256_div_pd(p[0], p[2]),
+					      _mm256_loadu_pd(batch->nx[v] + i)),
+				_mm256_set1_pd(pose[v].fx));
+			__m256d dy = _mm256_mul_pd(
+				_mm256_sub_pd(_mm256_div_pd(p[1], p[2]),
+					      _mm256_loadu_pd(batch->ny[v] + i)),
+				_mm256_set1_pd(pose[v].fy));
+			e = _mm256_add_pd(e, _mm256_mul_pd(
+					       w,
+					       _mm256_add_pd(_mm256_mul_pd(dx, dx),
+							     _mm256_mul_pd(dy, dy))));
+			count = _mm256_add_pd(count, w);
+		}
+
+		_mm256_storeu_pd(batch->x + i, x);
+		_mm256_storeu_pd(batch->y + i, y);
+		_mm256_storeu_pd(batch->z + i, z);
+		_mm256_storeu_pd(batch->error + i,
+				 _mm256_sqrt_pd(_mm256_div_pd(e, count)));
+	}
+	if (i < first + n) {
+		solve_sse2(pose, num_views, batch, i, first + n - i);
+	}
+}
+
+/**
+ * @brief Solve kernel per instruction set level
+ */
+static const solve_fn solve[] = {
+	solve_scalar,
+	solve_sse2,
+	solve_avx2
+};
+
+#else /* MG_SIMD_X86 */
+
+static const solve_fn solve[] = {
+	solve_scalar,
+	solve_scalar,
+	solve_scalar
+};
+
+#endif /* MG_SIMD_X86 */
+
+mg_triangulate_t
+mg_triangulate_create()
+{
+	mg_triangulate_t mg_triangulate;
+	NEWOBJ(mg_triangulate);
+
+	mg_triangulate->slot = 0;
+	mg_triangulate->num_slots = 0;
+	mg_triangulate->tolerance = 2;
+	mg_triangulate->min_views = 2;
+	for (unsigned int v = 0; v < MG_TRIANGULATE_MAX_VIEWS; v++) {
+		struct grid *grid = &mg_triangulate->grid[v];
+		grid->point = 0;
+		grid->num_points = 0;
+		grid->cell = 0;
+		grid->cols = 0;
+		grid->rows = 0;
+		grid->start = 0;
+		grid->start_capacity = 0;
+		grid->index = 0;
+		grid->used = 0;
+		grid->point_capacity = 0;
+	}
+	mg_triangulate->match = 0;
+	mg_triangulate->match_capacity = 0;
+	mg_triangulate->batch = 0;
+	mg_triangulate->batch_capacity = 0;
+
+	return mg_triangulate;
+}
+
+mg_triangulate_t
+mg_triangulate_destroy(mg_triangulate_t mg_triangulate)
+{
+	VERIFYZ(mg_triangulate) {
+		for (unsigned int v = 0; v < MG_TRIANGULATE_MAX_VIEWS; v++) {
+			FREEOBJ(mg_triangulate->grid[v].start);
+			FREEOBJ(mg_triangulate->grid[v].index);
+			FREEOBJ(mg_triangulate->grid[v].used);
+		}
+		FREEOBJ(mg_triangulate->slot);
+		FREEOBJ(mg_triangulate->match);
+		FREEOBJ(mg_triangulate->batch);
+
+		FREEOBJ(mg_triangulate);
+	}
+
+	return 0;
+}
+
+unsigned int
+mg_triangulate(mg_triangulate_t mg_triangulate,
+	       const struct mg_view *view,
+	       unsigned int num_views,
+	       struct mg_marker *marker,
+	       unsigned int max,
+	       enum mg_simd simd)
+{
+	unsigned int count = 0;
+
+	VERIFY(mg_triangulate) {
+		if (!view || num_views > MG_TRIANGULATE_MAX_VIEWS) {
+			return 0;
+		}
+
+		if (simd > mg_simd_detect()) {
+			simd = mg_simd_detect();
+		}
+
+		/* cells of twice the tolerance keep a search within the
+		 * neighbouring cells */
+		double tolerance = mg_triangulate->tolerance;
+		double cell = (4 * tolerance > 16) ? 4 * tolerance : 16;
+		struct pose pose[MG_TRIANGULATE_MAX_VIEWS];
+		struct grid *grid = mg_triangulate->grid;
+		for (unsigned int v = 0; v < num_views; v++) {
+			int d = view[v].device;
+			if (d < 0 || (unsigned int) d >= mg_triangulate->num_slots
+			    || !mg_triangulate->slot[d].set) {
+				return 0;
+			}
+			const struct mg_camera *c = &mg_triangulate->slot[d].camera;
+			memcpy(pose[v].r, c->r, sizeof(pose[v].r));
+			memcpy(pose[v].t, c->t, sizeof(pose[v].t));
+			pose[v].fx = c->lens.fx;
+			pose[v].fy = c->lens.fy;
+			pose[v].cx = c->lens.cx;
+			pose[v].cy = c->lens.cy;
+			pose[v].width = c->width;
+			pose[v].height = c->height;
+			if (!bin(&grid[v], &pose[v], &view[v], cell)) {
+				return 0;
+			}
+		}
+
+		/* epipolar line in view b of a point in view a, as
+		 * essential matrices [t]x R from a to b */
+		double essential[MG_TRIANGULATE_MAX_VIEWS]
+			[MG_TRIANGULATE_MAX_VIEWS][9];
+		for (unsigned int a = 0; a < num_views; a++) {
+			for (unsigned int b = a + 1; b < num_views; b++) {
+				const double *ra = pose[a].r;
+				const double *rb = pose[b].r;
+				double r[9];
+				for (int k = 0; k < 3; k++) {
+					for (int l = 0; l < 3; l++) {
+						r[3 * k + l] = rb[3 * k] * ra[3 * l]
+							+ rb[3 * k + 1] * ra[3 * l + 1]
+							+ rb[3 * k + 2] * ra[3 * l + 2];
+					}
+				}
+				double t[3];
+				for (int k = 0; k < 3; k++) {
+					t[k] = pose[b].t[k]
+						- (r[3 * k] * pose[a].t[0]
+						   + r[3 * k + 1] * pose[a].t[1]
+						   + r[3 * k + 2] * pose[a].t[2]);
+				}
+				double *e = essential[a][b];
+				for (int l = 0; l < 3; l++) {
+					e[l] = t[1] * r[6 + l] - t[2] * r[3 + l];
+					e[3 + l] = t[2] * r[l] - t[0] * r[6 + l];
+					e[6 + l] = t[0] * r[3 + l] - t[1] * r[l];
+				}
+			}
+		}
+
+		unsigned int num_matches = 0;
+		for (unsigned int a = 0; a < num_views; a++) {
+			const struct grid *ga = &grid[a];
+			for (unsigned int i = 0; i < ga->num_points; i++) {
+				const struct mg_point *pa = &ga->point[i];
+				if (ga->used[i] || isnan(pa->x) || isnan(pa->y)) {
+					continue;
+				}
+				double qa[3] = {(pa->x - pose[a].cx) / pose[a].fx,
+						(pa->y - pose[a].cy) / pose[a].fy,
+						1};
+
+				struct match best;
+				unsigned int best_views = 0;
+				double best_error = 0;
+				for (unsigned int b = a + 1; b < num_views; b++) {
+					const struct grid *gb = &grid[b];
+					const struct pose *pb = &pose[b];
+					const double *e = essential[a][b];
+					double l[3];
+					for (int k = 0; k < 3; k++) {
+						l[k] = e[3 * k] * qa[0]
+							+ e[3 * k + 1] * qa[1]
+							+ e[3 * k + 2];
+					}
+
+					/* the line in pixels of b, of unit
+					 * normal */
+					double la = l[0] / pb->fx;
+					double lb = l[1] / pb->fy;
+					double lc = l[2] - la * pb->cx - lb * pb->cy;
+					double norm = sqrt(la * la + lb * lb);
+					if (!(norm > 0)) {
+						continue;
+					}
+					la /= norm;
+					lb /= norm;
+					lc /= norm;
+
+					/* walk the cells along the line, by
+					 * column if it is flat, else by row */
+					bool flat = fabs(lb) >= fabs(la);
+					uint32_t steps = flat ? gb->cols : gb->rows;
+					for (uint32_t s = 0; s < steps; s++) {
+						double lo = s * gb->cell;
+						double hi = lo + gb->cell;
+						double p0, p1;
+						if (flat) {
+							p0 = -(la * lo + lc) / lb;
+							p1 = -(la * hi + lc) / lb;
+						} else {
+							p0 = -(lb * lo + lc) / la;
+							p1 = -(lb * hi + lc) / la;
+						}
+						double band = tolerance
+							/ (flat ? fabs(lb) : fabs(la));
+						double from = ((p0 < p1) ? p0 : p1) - band;
+						double to = ((p0 < p1) ? p1 : p0) + band;
+						uint32_t across = flat ? gb->rows : gb->cols;
+						if (to < 0 || from >= across * gb->cell) {
+							continue;
+						}
+						uint32_t c0 = cell_of(from, gb->cell, across);
+						uint32_t c1 = cell_of(to, gb->cell, across);
+						for (uint32_t c = c0; c <= c1; c++) {
+							uint32_t k = flat
+								? c * gb->cols + s
+								: s * gb->cols + c;
+							for (uint32_t q = gb->start[k];
+							     q < gb->start[k + 1];
+							     q++) {
+								unsigned int j = gb->index[q];
+								const struct mg_point *p =
+									&gb->point[j];
+								if (gb->used[j]
+								    || fabs(la * p->x
+									    + lb * p->y
+									    + lc)
+								    > tolerance) {
+									continue;
+								}
+
+								struct match m;
+								double error;
+								unsigned int n = extend(
+									pose, grid,
+									num_views,
+									a, i, b, j,
+									tolerance,
+									&m, &error);
+								if (n > best_views
+								    || (n
+									&& n == best_views
+									&& error
+									< best_error)) {
+									best = m;
+									best_views = n;
+									best_error = error;
+								}
+							}
+						}
+					}
+				}
+
+				if (best_views < mg_triangulate->min_views) {
+					continue;
+				}
+				if (!reserve((void **) &mg_triangulate->match,
+					     &mg_triangulate->match_capacity,
+					     num_matches + 1,
+					     sizeof(*mg_triangulate->match))) {
+					return 0;
+				}
+				mg_triangulate->match[num_matches++] = best;
+				for (unsigned int v = 0; v < num_views; v++) {
+					if (best.views & (1u << v)) {
+						grid[v].used[best.point[v]] = 1;
+					}
+				}
+			}
+		}
+
+		/* solve the markers that fit, all at once */
+		unsigned int n = (num_matches < max) ? num_matches : max;
+		if (n > mg_triangulate->batch_capacity) {
+			size_t size = (3 * MG_TRIANGULATE_MAX_VIEWS + 4)
+				* (size_t) n * sizeof(double);
+			double *p = realloc(mg_triangulate->batch, size);
+			if (!p) {
+				return 0;
+			}
+			mg_triangulate->batch = p;
+			mg_triangulate->batch_capacity = n;
+		}
+		struct batch batch;
+		double *p = mg_triangulate->batch;
+		for (unsigned int v = 0; v < num_views; v++) {
+			batch.nx[v] = p;
+			batch.ny[v] = p + n;
+			batch.w[v] = p + 2 * n;
+			p += 3 * n;
+		}
+		batch.x = p;
+		batch.y = p + n;
+		batch.z = p + 2 * n;
+		batch.error = p + 3 * n;
+
+		for (unsigned int i = 0; i < n; i++) {
+			const struct match *m = &mg_triangulate->match[i];
+			for (unsigned int v = 0; v < num_views; v++) {
+				if (m->views & (1u << v)) {
+					const struct mg_point *q =
+						&grid[v].point[m->point[v]];
+					batch.nx[v][i] = (q->x - pose[v].cx)
+						/ pose[v].fx;
+					batch.ny[v][i] = (q->y - pose[v].cy)
+						/ pose[v].fy;
+					batch.w[v][i] = 1;
+				} else {
+					batch.nx[v][i] = 0;
+					batch.ny[v][i] = 0;
+					batch.w[v][i] = 0;
+				}
+			}
+		}
+		solve[simd](pose, num_views, &batch, 0, n);
+
+		for (unsigned int i = 0; i < n; i++) {
+			const struct match *m = &mg_triangulate->match[i];
+			marker[i].x = batch.x[i];
+			marker[i].y = batch.y[i];
+			marker[i].z = batch.z[i];
+			marker[i].error = batch.error[i];
+			marker[i].views = m->views;
+			memcpy(marker[i].point, m->point, sizeof(m->point));
+		}
+
+		count = num_matches;
+	}
+
+	return count;
+}
+
+mg_triangulate_t
+mg_triangulate_set_camera(mg_triangulate_t mg_triangulate,
+			  int device,
+			  const struct mg_camera *camera)
+{
+	mg_triangulate_t p = 0;
+
+	VERIFY(mg_triangulate) {
+		if (device < 0
+		    || (camera && !(camera->lens.fx > 0 && camera->lens.fy > 0
+				    && camera->width && camera->height))) {
+			return 0;
+		}
+
+		unsigned int n = mg_triangulate->num_slots;
+		if ((unsigned int) device >= n) {
+			if (!camera) {
+				return mg_triangulate;
+			}
+			unsigned int capacity = n;
+			if (!reserve((void **) &mg_triangulate->slot, &capacity,
+				     device + 1, sizeof(*mg_triangulate->slot))) {
+				return 0;
+			}
+			memset(mg_triangulate->slot + n, 0,
+			       (device + 1 - n) * sizeof(*mg_triangulate->slot));
+			mg_triangulate->num_slots = device + 1;
+		}
+
+		struct slot *slot = &mg_triangulate->slot[device];
+		slot->set = camera;
+		if (camera) {
+			slot->camera = *camera;
+		}
+		p = mg_triangulate;
+	}
+
+	return p;
+}
+
+mg_triangulate_t
+mg_triangulate_set_min_views(mg_triangulate_t mg_triangulate,
+			     unsigned int min_views)
+{
+	mg_triangulate_t p = 0;
+
+	VERIFY(mg_triangulate) {
+		if (2 <= min_views && min_views <= MG_TRIANGULATE_MAX_VIEWS) {
+			mg_triangulate->min_views = min_views;
+			p = mg_triangulate;
+		}
+	}
+
+	return p;
+}
+
+mg_triangulate_t
+mg_triangulate_set_tolerance(mg_triangulate_t mg_triangulate,
+			     double pixels)
+{
+	mg_triangulate_t p = 0;
+
+	VERIFY(mg_triangulate) {
+		if (pixels > 0) {
+			mg_triangulate->tolerance = pixels;
+			p = mg_triangulate;
+		}
+	}
+
+	return p;
+}
+
+bool
+bin(struct grid *grid,
+    const struct pose *pose,
+    const struct mg_view *view,
+    double cell)
+{
+	unsigned int n = (view->num_points < MAX_POINTS)
+		? view->num_points : MAX_POINTS;
+	grid->point = view->point;
+	grid->num_points = n;
+	grid->cell = cell;
+	grid->cols = ceil(pose->width / cell);
+	grid->rows = ceil(pose->height / cell);
+
+	unsigned int cells = grid->cols * grid->rows;
+	unsigned int capacity = grid->point_capacity;
+	if (!reserve((void **) &grid->start, &grid->start_capacity, cells + 1,
+		     sizeof(*grid->start))
+	    || !reserve((void **) &grid->index, &capacity, n,
+			sizeof(*grid->index))
+	    || !reserve((void **) &grid->used, &grid->point_capacity, n,
+			sizeof(*grid->used))) {
+		return false;
+	}
+
+	/* counting sort of the points by cell */
+	memset(grid->start, 0, (cells + 1) * sizeof(*grid->start));
+	memset(grid->used, 0, n * sizeof(*grid->used));
+	for (unsigned int i = 0; i < n; i++) {
+		const struct mg_point *p = &view->point[i];
+		if (isnan(p->x) || isnan(p->y)) {
+			continue;
+		}
+		uint32_t k = cell_of(p->y, cell, grid->rows) * grid->cols
+			+ cell_of(p->x, cell, grid->cols);
+		grid->start[k + 1]++;
+	}
+	for (unsigned int k = 0; k < cells; k++) {
+		grid->start[k + 1] += grid->start[k];
+	}
+	for (unsigned int i = 0; i < n; i++) {
+		const struct mg_point *p = &view->point[i];
+		if (isnan(p->x) || isnan(p->y)) {
+			continue;
+		}
+		uint32_t k = cell_of(p->y, cell, grid->rows) * grid->cols
+			+ cell_of(p->x, cell, grid->cols);
+		grid->index[grid->start[k]++] = i;
+	}
+
+	/* the fill moved every start one cell on */
+	memmove(grid->start + 1, grid->start, cells * sizeof(*grid->start));
+	grid->start[0] = 0;
+
+	return true;
+}
+
+uint32_t
+cell_of(double v,
+	double cell,
+	uint32_t n)
+{
+	if (!(v > 0)) {
+		return 0;
+	}
+
+	double c = v / cell;
+
+	return (c >= n) ? n - 1 : (uint32_t) c;
+}
+
+unsigned int
+extend(const struct pose *pose,
+       const struct grid *grid,
+       unsigned int num_views,
+       unsigned int a,
+       unsigned int i,
+       unsigned int b,
+       unsigned int j,
+       double tolerance,
+       struct match *match,
+       double *error)
+{
+	/* the pair on its own, as a batch of one */
+	double nx[2];
+	double ny[2];
+	double w[2] = {1, 1};
+	double x, y, z, e;
+	const struct mg_point *p[2] = {&grid[a].point[i], &grid[b].point[j]};
+	struct pose pair[2] = {pose[a], pose[b]};
+	for (int k = 0; k < 2; k++) {
+		nx[k] = (p[k]->x - pair[k].cx) / pair[k].fx;
+		ny[k] = (p[k]->y - pair[k].cy) / pair[k].fy;
+	}
+	struct batch batch = {
+		{&nx[0], &nx[1]}, {&ny[0], &ny[1]}, {&w[0], &w[1]},
+		&x, &y, &z, &e
+	};
+	solve_scalar(pair, 2, &batch, 0, 1);
+
+	double world[3] = {x, y, z};
+	double u;
+	double v;
+	if (!(e <= tolerance)
+	    || !project(&pose[a], world, &u, &v)
+	    || !project(&pose[b], world, &u, &v)) {
+		return 0;
+	}
+
+	memset(match, 0, sizeof(*match));
+	match->views = 1u << a | 1u << b;
+	match->point[a] = i;
+	match->point[b] = j;
+	*error = 2 * e * e;
+	unsigned int n = 2;
+	for (unsigned int c = 0; c < num_views; c++) {
+		if (c == a || c == b
+		    || !project(&pose[c], world, &u, &v)) {
+			continue;
+		}
+		double d2;
+		int k = nearest(&grid[c], u, v, tolerance, &d2);
+		if (k >= 0) {
+			match->views |= 1u << c;
+			match->point[c] = k;
+			*error += d2;
+			n++;
+		}
+	}
+
+	return n;
+}
+
+int
+nearest(const struct grid *grid,
+	double x,
+	double y,
+	double tolerance,
+	double *d2)
+{
+	int best = -1;
+	double best_d2 = tolerance * tolerance;
+
+	if (x < -tolerance || y < -tolerance
+	    || x > grid->cols * grid->cell + tolerance
+	    || y > grid->rows * grid->cell + tolerance) {
+		return -1;
+	}
+
+	uint32_t c0 = cell_of(x - tolerance, grid->cell, grid->cols);
+	uint32_t c1 = cell_of(x + tolerance, grid->cell, grid->cols);
+	uint32_t r0 = cell_of(y - tolerance, grid->cell, grid->rows);
+	uint32_t r1 = cell_of(y + tolerance, grid->cell, grid->rows);
+	for (uint32_t r = r0; r <= r1; r++) {
+		for (uint32_t c = c0; c <= c1; c++) {
+			uint32_t k = r * grid->cols + c;
+			for (uint32_t q = grid->start[k];
+			     q < grid->start[k + 1];
+			     q++) {
+				unsigned int i = grid->index[q];
+				double dx = grid->point[i].x - x;
+				double dy = grid->point[i].y - y;
+				double d = dx * dx + dy * dy;
+				if (!grid->used[i] && d <= best_d2) {
+					best = i;
+					best_d2 = d;
+				}
+			}
+		}
+	}
+
+	*d2 = best_d2;
+
+	return best;
+}
+
+bool
+project(const struct pose *pose,
+	const double p[3],
+	double *x,
+	double *y)
+{
+	const double *r = pose->r;
+	const double *t = pose->t;
+	double zc = r[6] * p[0] + r[7] * p[1] + r[8] * p[2] + t[2];
+	if (!(zc > 0)) {
+		return false;
+	}
+
+	*x = (r[0] * p[0] + r[1] * p[1] + r[2] * p[2] + t[0]) / zc
+		* pose->fx + pose->cx;
+	*y = (r[3] * p[0] + r[4] * p[1] + r[5] * p[2] + t[1]) / zc
+		* pose->fy + pose->cy;
+
+	return true;
+}
+
+bool
+reserve(void **p,
+	unsigned int *capacity,
+	unsigned int n,
+	size_t size)
+{
+	if (n <= *capacity) {
+		return true;
+	}
+
+	/* grow by half again, for lists that grow frame by frame */
+	unsigned int c = n + n / 2;
+	void *q = realloc(*p, c * size);
+	if (!q) {
+		return false;
+	}
+	*p = q;
+	*capacity = c;
+
+	return true;
+}
+
+#ifdef TEST_MULTI_GEE_MG_TRIANGULATE
+
+/**
+ * @brief Camera on a ring around the origin, looking at it
+ */
+static
+void
+ring_camera(struct mg_camera *camera,
+	    double angle,
+	    double height)
+{
+	double c[3] = {3000 * cos(angle), 3000 * sin(angle), height};
+	double d = sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+	double z[3] = {-c[0] / d, -c[1] / d, -c[2] / d};
+	double x[3] = {z[1], -z[0], 0};
+	double n = sqrt(x[0] * x[0] + x[1] * x[1]);
+	x[0] /= n;
+	x[1] /= n;
+	double y[3] = {z[1] * x[2] - z[2] * x[1],
+		       z[2] * x[0] - z[0] * x[2],
+		       z[0] * x[1] - z[1] * x[0]};
+
+	struct mg_lens lens = {800, 800, 384, 288, 0, 0, 0, 0, 0};
+	camera->lens = lens;
+	for (int k = 0; k < 3; k++) {
+		camera->r[k] = x[k];
+		camera->r[3 + k] = y[k];
+		camera->r[6 + k] = z[k];
+	}
+	for (int k = 0; k < 3; k++) {
+		camera->t[k] = -(camera->r[3 * k] * c[0]
+				 + camera->r[3 * k + 1] * c[1]
+				 + camera->r[3 * k + 2] * c[2]);
+	}
+	camera->width = 768;
+	camera->height = 576;
+}
+
+static
+double
+noise()
+{
+	return (rand() % 1000 / 1000.0 - 0.5) * 0.4;
+}
+
+void
+mg_triangulate_test()
+{
+	enum { CAMERAS = 5, MARKERS = 40 };
+	mg_triangulate_t tri = mg_triangulate_create();
+	struct mg_camera camera[CAMERAS];
+	struct pose pose[CAMERAS];
+	for (int c = 0; c < CAMERAS; c++) {
+		ring_camera(&camera[c], c * 2 * M_PI / CAMERAS,
+			    (c & 1) ? 800 : 1500);
+		XASSERT(tri == mg_triangulate_set_camera(tri, 10 + c,
+							  &camera[c])) {
+			/* empty */
+		}
+		memcpy(pose[c].r, camera[c].r, sizeof(pose[c].r));
+		memcpy(pose[c].t, camera[c].t, sizeof(pose[c].t));
+		pose[c].fx = pose[c].fy = 800;
+		pose[c].cx = 384;
+		pose[c].cy = 288;
+	}
+	XASSERT(!mg_triangulate_set_camera(tri, -1, &camera[0])) {
+		/* empty */
+	}
+	XASSERT(!mg_triangulate_set_min_views(tri, 1)
+		&& !mg_triangulate_set_tolerance(tri, 0)) {
+		/* empty */
+	}
+
+	/* markers in a cube in the middle, every one seen by three or
+	 * more cameras, listed in a different order by every camera */
+	double world[MARKERS][3];
+	struct mg_point point[CAMERAS][MARKERS + 2];
+	int which[CAMERAS][MARKERS + 2];
+	unsigned int num_points[CAMERAS] = {0};
+	for (int m = 0; m < MARKERS; m++) {
+		for (int k = 0; k < 3; k++) {
+			world[m][k] = rand() % 1000 - 500;
+		}
+		int hidden = (m % 3) ? m % CAMERAS : -1;
+		int hidden2 = (m % 7) ? -1 : (m + 2) % CAMERAS;
+		for (int c = 0; c < CAMERAS; c++) {
+			double x;
+			double y;
+			if (c == hidden || c == hidden2
+			    || !project(&pose[c], world[m], &x, &y)) {
+				continue;
+			}
+			unsigned int n = num_points[c]++;
+			unsigned int at = n ? rand() % (n + 1) : 0;
+			point[c][n] = point[c][at];
+			which[c][n] = which[c][at];
+			point[c][at].x = x + noise();
+			point[c][at].y = y + noise();
+			which[c][at] = m;
+		}
+	}
+	/* a reflection and a point outside the image */
+	point[4][num_points[4]].x = 100;
+	point[4][num_points[4]].y = 100;
+	which[4][num_points[4]++] = -1;
+	point[2][num_points[2]].x = NAN;
+	point[2][num_points[2]].y = NAN;
+	which[2][num_points[2]++] = -1;
+
+	struct mg_view view[CAMERAS];
+	for (int c = 0; c < CAMERAS; c++) {
+		view[c].device = 10 + c;
+		view[c].point = point[c];
+		view[c].num_points = num_points[c];
+	}
+
+	struct mg_marker marker[MARKERS + 2];
+	XASSERT(MARKERS == mg_triangulate(tri, view, CAMERAS, marker,
+					  MARKERS + 2, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	bool found[MARKERS] = {false};
+	for (int i = 0; i < MARKERS; i++) {
+		const struct mg_marker *k = &marker[i];
+		int m = -1;
+		for (int c = 0; c < CAMERAS; c++) {
+			if (k->views & (1u << c)) {
+				int w = which[c][k->point[c]];
+				XASSERT(w >= 0 && (m < 0 || m == w)) {
+					/* empty */
+				}
+				m = w;
+			}
+		}
+		XASSERT(m >= 0 && !found[m] && k->error < 0.5) {
+			/* empty */
+		}
+		found[m] = true;
+		double dx = k->x - world[m][0];
+		double dy = k->y - world[m][1];
+		double dz = k->z - world[m][2];
+		XASSERT(sqrt(dx * dx + dy * dy + dz * dz) < 2) {
+			/* empty */
+		}
+	}
+
+	/* every kernel solves alike */
+	for (int simd = MG_SIMD_SSE2; simd <= (int) mg_simd_detect();
+	     simd++) {
+		struct mg_marker other[MARKERS];
+		XASSERT(MARKERS == mg_triangulate(tri, view, CAMERAS, other,
+						  MARKERS, simd)) {
+			/* empty */
+		}
+		for (int i = 0; i < MARKERS; i++) {
+			XASSERT(fabs(other[i].x - marker[i].x) < 1e-6
+				&& fabs(other[i].y - marker[i].y) < 1e-6
+				&& fabs(other[i].z - marker[i].z) < 1e-6
+				&& fabs(other[i].error - marker[i].error) < 1e-4
+				&& other[i].views == marker[i].views) {
+				/* empty */
+			}
+		}
+	}
+
+	/* asking for more cameras drops the markers seen by fewer */
+	unsigned int all = 0;
+	for (int i = 0; i < MARKERS; i++) {
+		all += __builtin_popcount(marker[i].views) >= 4;
+	}
+	tri = mg_triangulate_set_min_views(tri, 4);
+	XASSERT(all == mg_triangulate(tri, view, CAMERAS, marker, 0,
+				      MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+
+	/* views of unknown cameras are refused */
+	tri = mg_triangulate_set_camera(tri, 12, 0);
+	XASSERT(0 == mg_triangulate(tri, view, CAMERAS, marker, MARKERS,
+				    MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+
+	tri = mg_triangulate_destroy(tri);
+	XASSERT(tri == 0) {
+		/* empty */
+	}
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_triangulate_test));
+}
+
+#endif /* TEST_MULTI_GEE_MG_TRIANGULATE */
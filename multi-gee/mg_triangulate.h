@@ -0,0 +1,194 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee triangulation declaration
+ *
+ * The triangulator knows where every camera is, by device identifier,
+ * and turns the corrected marker points of the cameras of a frameset
+ * into 3D markers.  Points are matched between cameras along epipolar
+ * lines, with the points of every camera binned in a grid so only
+ * those near a line or a projection are looked at.  Matched points are
+ * solved by linear least squares, several markers per vector.
+ */
+#ifndef ITL_MULTI_GEE_MG_TRIANGULATE_H
+#define ITL_MULTI_GEE_MG_TRIANGULATE_H
+
+#include <stdint.h> /* uint16_t */
+
+#include <cclass/classdef.h>
+#include <multi-gee/mg_image.h>
+#include <multi-gee/mg_simd.h>
+#include <multi-gee/mg_undistort.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Maximum number of cameras a marker is seen from
+ */
+#define MG_TRIANGULATE_MAX_VIEWS 16
+
+/**
+ * @brief Multi-gee triangulator object handle
+ */
+NEWHANDLE(mg_triangulate_t);
+
+/**
+ * @brief Calibrated camera
+ *
+ * a world point X is at R X + t in camera coordinates, with the camera
+ * looking along its positive z axis.
+ */
+struct mg_camera
+{
+	struct mg_lens lens; /**< Lens, of which only the focal lengths and
+			       principal point are used, since points are
+			       corrected for distortion */
+	double r[9]; /**< World to camera rotation, row by row */
+	double t[3]; /**< World to camera translation */
+	uint32_t width; /**< Image width */
+	uint32_t height; /**< Image height */
+};
+
+/**
+ * @brief Marker points of one camera
+ */
+struct mg_view
+{
+	int device; /**< Device identifier of the camera */
+	const struct mg_point *point; /**< Corrected points, see
+					mg_undistort_points(); NAN points
+					are skipped */
+	unsigned int num_points; /**< Number of points */
+};
+
+/**
+ * @brief Triangulated marker
+ */
+struct mg_marker
+{
+	double x; /**< World x */
+	double y; /**< World y */
+	double z; /**< World z */
+	float error; /**< Root mean square reprojection error in pixels */
+	uint16_t views; /**< Bit i is set if the marker was seen in view i */
+	uint16_t point[MG_TRIANGULATE_MAX_VIEWS]; /**< Index of the point in
+						    every view it was seen
+						    in */
+};
+
+/**
+ * @brief Create triangulator object
+ *
+ * markers must be seen by two cameras, within 2 pixels of where they
+ * project, by default.
+ *
+ * @return a newly created triangulator object handle
+ */
+mg_triangulate_t
+mg_triangulate_create();
+
+/**
+ * @brief Destroy triangulator object
+ *
+ * @param triangulate  object handle
+ *
+ * @return 0
+ */
+mg_triangulate_t
+mg_triangulate_destroy(mg_triangulate_t triangulate);
+
+/**
+ * @brief Triangulate the markers of a frameset
+ *
+ * every point is used for at most one marker.  a marker is found from
+ * the first camera pair that sees it, by looking for its points near
+ * the epipolar line of the first in the second, and then where the
+ * pair puts it in the other cameras.  of the candidates, the one seen
+ * by most cameras, with the smallest error, is taken.  like snprintf(),
+ * the number of markers found is returned even if they do not fit.
+ *
+ * @param triangulate  object handle
+ * @param view  points per camera, of cameras set with
+ * mg_triangulate_set_camera()
+ * @param num_views  number of views, at most MG_TRIANGULATE_MAX_VIEWS
+ * @param marker  array to fill in
+ * @param max  number of markers the array holds
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return the number of markers found, of which at most @a max are
+ * stored
+ */
+unsigned int
+mg_triangulate(mg_triangulate_t triangulate,
+	       const struct mg_view *view,
+	       unsigned int num_views,
+	       struct mg_marker *marker,
+	       unsigned int max,
+	       enum mg_simd simd);
+
+/**
+ * @brief Calibrate a camera
+ *
+ * @param triangulate  object handle
+ * @param device  device identifier
+ * @param camera  camera calibration, or 0 to forget the camera
+ *
+ * @return
+ * - 0 on failure, else
+ * - object handle
+ */
+mg_triangulate_t
+mg_triangulate_set_camera(mg_triangulate_t triangulate,
+			  int device,
+			  const struct mg_camera *camera);
+
+/**
+ * @brief Set the fewest cameras a marker must be seen from
+ *
+ * @param triangulate  object handle
+ * @param min_views  number of cameras, from 2 to
+ * MG_TRIANGULATE_MAX_VIEWS
+ *
+ * @return
+ * - 0 on failure, else
+ * - object handle
+ */
+mg_triangulate_t
+mg_triangulate_set_min_views(mg_triangulate_t triangulate,
+			     unsigned int min_views);
+
+/**
+ * @brief Set how far a point may be from where a marker projects
+ *
+ * also the distance a point may be from an epipolar line.
+ *
+ * @param triangulate  object handle
+ * @param pixels  tolerance, greater than 0
+ *
+ * @return
+ * - 0 on failure, else
+ * - object handle
+ */
+mg_triangulate_t
+mg_triangulate_set_tolerance(mg_triangulate_t triangulate,
+			     double pixels);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_TRIANGULATE_H */
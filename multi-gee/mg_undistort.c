@@ -0,0 +1,805 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee lens distortion correction definition
+ */
+#include <math.h> /* lround */
+#include <stdio.h> /* fopen */
+#include <string.h> /* memcmp */
+
+#include "mg_undistort.h" /* class implemented */
+
+#ifdef MG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+USE_XASSERT
+
+/**
+ * @brief Steps taken to invert the lens model
+ *
+ * plenty for the distortion of real lenses, and only taken once per
+ * pixel when the map is made.
+ */
+#define INVERT_STEPS 20
+
+/**
+ * @brief Source of a corrected pixel outside the captured image
+ */
+#define OUTSIDE UINT32_MAX
+
+/**
+ * @brief Cache file tag, with the layout version at the end
+ */
+#define CACHE_MAGIC "MGLUT001"
+
+/**
+ * @brief Cache file header, followed by the maps
+ */
+struct cache_header
+{
+	char magic[8]; /**< CACHE_MAGIC */
+	uint32_t width; /**< Captured image width */
+	uint32_t height; /**< Captured image height */
+	struct mg_lens lens; /**< Lens the maps were made for */
+};
+
+/**
+ * @brief Distortion corrector object structure
+ */
+CLASS(mg_undistort, mg_undistort_t)
+{
+	struct mg_lens lens; /**< Lens model */
+	uint32_t width; /**< Captured image width */
+	uint32_t height; /**< Captured image height */
+	float *px; /**< Corrected column per captured pixel */
+	float *py; /**< Corrected line per captured pixel */
+	uint32_t *xy; /**< Top left source pixel per corrected pixel,
+			column in the low half, or OUTSIDE */
+	uint32_t *frac; /**< Source position right of and below that pixel,
+			  in 1/256 pixel, column in the low half */
+};
+
+/**
+ * @brief Create an object without maps
+ *
+ * @param lens  lens model
+ * @param width  captured image width
+ * @param height  captured image height
+ *
+ * @return object handle, or 0 on failure
+ */
+static
+mg_undistort_t
+create(const struct mg_lens *lens,
+       uint32_t width,
+       uint32_t height);
+
+/**
+ * @brief Apply the lens model to an ideal image plane point
+ *
+ * @param lens  lens model
+ * @param x  ideal column, at unit distance
+ * @param y  ideal line, at unit distance
+ * @param xd  distorted column to fill in
+ * @param yd  distorted line to fill in
+ */
+static
+void
+distort(const struct mg_lens *lens,
+	double x,
+	double y,
+	double *xd,
+	double *yd);
+
+/**
+ * @brief Read the maps from a cache file
+ *
+ * @param undistort  object handle
+ * @param path  cache file
+ *
+ * @return
+ * - @c false if the file is missing or for another lens or size, else
+ * - @c true
+ */
+static
+bool
+load(mg_undistort_t undistort,
+     const char *path);
+
+/**
+ * @brief Work out the corrected position of every captured pixel
+ *
+ * @param undistort  object handle
+ */
+static
+void
+make_points(mg_undistort_t undistort);
+
+/**
+ * @brief Work out the source of every corrected pixel
+ *
+ * @param undistort  object handle
+ */
+static
+void
+make_remap(mg_undistort_t undistort);
+
+/**
+ * @brief Correct part of an image line
+ *
+ * @param xy  source pixels
+ * @param frac  source fractions
+ * @param n  number of pixels
+ * @param src  first captured pixel
+ * @param stride  captured line stride
+ * @param last  line of the top left pixel of the bottom-most source
+ * squares
+ * @param dst  first corrected pixel to fill in
+ */
+typedef void (*remap_fn)(const uint32_t *xy,
+			 const uint32_t *frac,
+			 uint32_t n,
+			 const uint8_t *src,
+			 uint32_t stride,
+			 uint32_t last,
+			 uint8_t *dst);
+
+static
+void
+remap_scalar(const uint32_t *xy,
+	     const uint32_t *frac,
+	     uint32_t n,
+	     const uint8_t *src,
+	     uint32_t stride,
+	     uint32_t last,
+	     uint8_t *dst)
+{
+	(void) last;
+
+	for (uint32_t i = 0; i < n; i++) {
+		if (OUTSIDE == xy[i]) {
+			dst[i] = 0;
+			continue;
+		}
+
+		const uint8_t *p = src + (size_t) (xy[i] >> 16) * stride
+			+ (xy[i] & 0xffff);
+		uint32_t fx = frac[i] & 0xffff;
+		uint32_t fy = frac[i] >> 16;
+		uint32_t top = p[0] * (256 - fx) + p[1] * fx;
+		uint32_t bottom = p[stride] * (256 - fx) + p[stride + 1] * fx;
+		dst[i] = (top * (256 - fy) + bottom * fy + 32768) >> 16;
+	}
+}
+
+#ifdef MG_SIMD_X86
+
+MG_TARGET_AVX2
+static
+void
+remap_avx2(const uint32_t *xy,
+	   const uint32_t *frac,
+	   uint32_t n,
+	   const uint8_t *src,
+	   uint32_t stride,
+	   uint32_t last,
+	   uint8_t *dst)
+{
+	const __m256i low = _mm256_set1_epi32(0xffff);
+	const __m256i byte = _mm256_set1_epi32(0xff);
+	const __m256i one = _mm256_set1_epi32(256);
+	const __m256i half = _mm256_set1_epi32(32768);
+	const __m256i four = _mm256_set1_epi32(4);
+	const __m256i vstride = _mm256_set1_epi32(stride);
+	const __m256i vlast = _mm256_set1_epi32(last);
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	uint32_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i s = _mm256_loadu_si256((const __m256i *) (xy + i));
+		__m256i outside = _mm256_cmpeq_epi32(s, _mm256_set1_epi32(-1));
+		s = _mm256_andnot_si256(outside, s);
+		__m256i x = _mm256_and_si256(s, low);
+		__m256i y = _mm256_srli_epi32(s, 16);
+
+		/* the gathers read 4 bytes, which must not run off the
+		 * bottom line */
+		__m256i over = _mm256_and_si256(
+			_mm256_cmpeq_epi32(y, vlast),
+			_mm256_cmpgt_epi32(_mm256_add_epi32(x, four),
+					   vstride));
+		if (!_mm256_testz_si256(over, over)) {
+			remap_scalar(xy + i, frac + i, 8, src, stride, last,
+				     dst + i);
+			continue;
+		}
+
+		__m256i offset = _mm256_add_epi32(
+			_mm256_mullo_epi32(y, vstride), x);
+		__m256i g0 = _mm256_i32gather_epi32((const int *) src,
+						    offset, 1);
+		__m256i g1 = _mm256_i32gather_epi32((const int *) (src + stride),
+						    offset, 1);
+
+		__m256i f = _mm256_loadu_si256((const __m256i *) (frac + i));
+		__m256i fx = _mm256_and_si256(f, low);
+		__m256i fy = _mm256_srli_epi32(f, 16);
+		__m256i gx = _mm256_sub_epi32(one, fx);
+		__m256i gy = _mm256_sub_epi32(one, fy);
+
+		__m256i top = _mm256_add_epi32(
+			_mm256_mullo_epi32(_mm256_and_si256(g0, byte), gx),
+			_mm256_mullo_epi32(
+				_mm256_and_si256(_mm256_srli_epi32(g0, 8), byte),
+				fx));
+		__m256i bottom = _mm256_add_epi32(
+			_mm256_mullo_epi32(_mm256_and_si256(g1, byte), gx),
+			_mm256_mullo_epi32(
+				_mm256_and_si256(_mm256_srli_epi32(g1, 8), byte),
+				fx));
+		__m256i v = _mm256_srli_epi32(
+			_mm256_add_epi32(
+				_mm256_add_epi32(_mm256_mullo_epi32(top, gy),
+						 _mm256_mullo_epi32(bottom, fy)),
+				half),
+			16);
+		v = _mm256_andnot_si256(outside, v);
+
+		/* 8 words to 8 bytes, the packs work per 128-bit lane */
+		v = _mm256_packus_epi32(v, v);
+		v = _mm256_packus_epi16(v, v);
+		v = _mm256_permutevar8x32_epi32(v, order);
+		_mm_storel_epi64((__m128i *) (dst + i),
+				 _mm256_castsi256_si128(v));
+	}
+	if (i < n) {
+		remap_scalar(xy + i, frac + i, n - i, src, stride, last,
+			     dst + i);
+	}
+}
+
+/**
+ * @brief Remap kernel per instruction set level
+ */
+static const remap_fn remap_line[] = {
+	remap_scalar,
+	remap_scalar,
+	remap_avx2
+};
+
+#else /* MG_SIMD_X86 */
+
+static const remap_fn remap_line[] = {
+	remap_scalar,
+	remap_scalar,
+	remap_scalar
+};
+
+#endif /* MG_SIMD_X86 */
+
+mg_undistort_t
+mg_undistort_create(const struct mg_lens *lens,
+		    uint32_t width,
+		    uint32_t height)
+{
+	mg_undistort_t mg_undistort = create(lens, width, height);
+
+	if (mg_undistort) {
+		make_points(mg_undistort);
+		make_remap(mg_undistort);
+	}
+
+	return mg_undistort;
+}
+
+mg_undistort_t
+mg_undistort_create_cached(const struct mg_lens *lens,
+			   uint32_t width,
+			   uint32_t height,
+			   const char *path)
+{
+	mg_undistort_t mg_undistort = create(lens, width, height);
+
+	if (mg_undistort && !load(mg_undistort, path)) {
+		make_points(mg_undistort);
+		make_remap(mg_undistort);
+		mg_undistort_save(mg_undistort, path);
+	}
+
+	return mg_undistort;
+}
+
+mg_undistort_t
+mg_undistort_destroy(mg_undistort_t mg_undistort)
+{
+	VERIFYZ(mg_undistort) {
+		FREEOBJ(mg_undistort->px);
+		FREEOBJ(mg_undistort->py);
+		FREEOBJ(mg_undistort->xy);
+		FREEOBJ(mg_undistort->frac);
+
+		FREEOBJ(mg_undistort);
+	}
+
+	return 0;
+}
+
+const struct mg_lens *
+mg_undistort_get_lens(mg_undistort_t mg_undistort)
+{
+	const struct mg_lens *lens = 0;
+
+	VERIFY(mg_undistort) {
+		lens = &mg_undistort->lens;
+	}
+
+	return lens;
+}
+
+bool
+mg_undistort_image(mg_undistort_t mg_undistort,
+		   const struct mg_image *src,
+		   struct mg_image *dst,
+		   enum mg_simd simd)
+{
+	bool ok = false;
+
+	VERIFY(mg_undistort) {
+		uint32_t w = mg_undistort->width;
+		uint32_t h = mg_undistort->height;
+		if (!src || !dst || !src->data || !dst->data
+		    || src->width != w || src->height != h || src->stride < w
+		    || dst->width != w || dst->height != h || dst->stride < w) {
+			return false;
+		}
+
+		if (simd > mg_simd_detect()) {
+			simd = mg_simd_detect();
+		}
+
+		for (uint32_t y = 0; y < h; y++) {
+			size_t i = (size_t) y * w;
+			remap_line[simd](mg_undistort->xy + i,
+					 mg_undistort->frac + i,
+					 w,
+					 src->data,
+					 src->stride,
+					 h - 2,
+					 (uint8_t *) dst->data
+					 + (size_t) y * dst->stride);
+		}
+		ok = true;
+	}
+
+	return ok;
+}
+
+unsigned int
+mg_undistort_points(mg_undistort_t mg_undistort,
+		    const struct mg_point *in,
+		    struct mg_point *out,
+		    unsigned int n)
+{
+	unsigned int inside = 0;
+
+	VERIFY(mg_undistort) {
+		uint32_t w = mg_undistort->width;
+		uint32_t h = mg_undistort->height;
+		const float *px = mg_undistort->px;
+		const float *py = mg_undistort->py;
+		for (unsigned int i = 0; i < n; i++) {
+			float x = in[i].x;
+			float y = in[i].y;
+
+			/* also false for NAN */
+			if (!(x >= 0 && x <= w - 1 && y >= 0 && y <= h - 1)) {
+				out[i].x = NAN;
+				out[i].y = NAN;
+				continue;
+			}
+
+			uint32_t x0 = x;
+			uint32_t y0 = y;
+			if (x0 > w - 2) {
+				x0 = w - 2;
+			}
+			if (y0 > h - 2) {
+				y0 = h - 2;
+			}
+			float tx = x - x0;
+			float ty = y - y0;
+			size_t k = (size_t) y0 * w + x0;
+
+			/* bilinear in the corrected positions of the four
+			 * captured pixels around the point */
+			float top = px[k] + (px[k + 1] - px[k]) * tx;
+			float bottom = px[k + w] + (px[k + w + 1] - px[k + w]) * tx;
+			out[i].x = top + (bottom - top) * ty;
+			top = py[k] + (py[k + 1] - py[k]) * tx;
+			bottom = py[k + w] + (py[k + w + 1] - py[k + w]) * tx;
+			out[i].y = top + (bottom - top) * ty;
+			inside++;
+		}
+	}
+
+	return inside;
+}
+
+bool
+mg_undistort_save(mg_undistort_t mg_undistort,
+		  const char *path)
+{
+	bool ok = false;
+
+	VERIFY(mg_undistort) {
+		/* write aside and rename, so readers never see half a file */
+		char tmp[path ? strlen(path) + 5 : 1];
+		FILE *file = 0;
+		if (path) {
+			snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+			file = fopen(tmp, "wb");
+		}
+
+		if (file) {
+			struct cache_header header;
+			memset(&header, 0, sizeof(header));
+			memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+			header.width = mg_undistort->width;
+			header.height = mg_undistort->height;
+			header.lens = mg_undistort->lens;
+
+			size_t n = (size_t) mg_undistort->width
+				* mg_undistort->height;
+			ok = 1 == fwrite(&header, sizeof(header), 1, file)
+				&& n == fwrite(mg_undistort->px,
+					       sizeof(float), n, file)
+				&& n == fwrite(mg_undistort->py,
+					       sizeof(float), n, file)
+				&& n == fwrite(mg_undistort->xy,
+					       sizeof(uint32_t), n, file)
+				&& n == fwrite(mg_undistort->frac,
+					       sizeof(uint32_t), n, file);
+			ok = (0 == fclose(file)) && ok;
+			ok = ok && 0 == rename(tmp, path);
+			if (!ok) {
+				remove(tmp);
+			}
+		}
+	}
+
+	return ok;
+}
+
+mg_undistort_t
+create(const struct mg_lens *lens,
+       uint32_t width,
+       uint32_t height)
+{
+	if (!lens || width < 2 || height < 2 || width > 65535 || height > 65535
+	    || !(lens->fx > 0) || !(lens->fy > 0)) {
+		return 0;
+	}
+
+	mg_undistort_t mg_undistort;
+	NEWOBJ(mg_undistort);
+
+	size_t n = (size_t) width * height;
+	mg_undistort->lens = *lens;
+	mg_undistort->width = width;
+	mg_undistort->height = height;
+	mg_undistort->px = MALLOC(n * sizeof(*mg_undistort->px));
+	mg_undistort->py = MALLOC(n * sizeof(*mg_undistort->py));
+	mg_undistort->xy = MALLOC(n * sizeof(*mg_undistort->xy));
+	mg_undistort->frac = MALLOC(n * sizeof(*mg_undistort->frac));
+	if (!mg_undistort->px || !mg_undistort->py || !mg_undistort->xy
+	    || !mg_undistort->frac) {
+		return mg_undistort_destroy(mg_undistort);
+	}
+
+	return mg_undistort;
+}
+
+void
+distort(const struct mg_lens *lens,
+	double x,
+	double y,
+	double *xd,
+	double *yd)
+{
+	double r2 = x * x + y * y;
+	double radial = 1 + r2 * (lens->k1 + r2 * (lens->k2 + r2 * lens->k3));
+	*xd = x * radial + 2 * lens->p1 * x * y
+		+ lens->p2 * (r2 + 2 * x * x);
+	*yd = y * radial + lens->p1 * (r2 + 2 * y * y)
+		+ 2 * lens->p2 * x * y;
+}
+
+bool
+load(mg_undistort_t mg_undistort,
+     const char *path)
+{
+	if (!path) {
+		return false;
+	}
+
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		return false;
+	}
+
+	struct cache_header header;
+	size_t n = (size_t) mg_undistort->width * mg_undistort->height;
+	bool ok = 1 == fread(&header, sizeof(header), 1, file)
+		&& 0 == memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic))
+		&& header.width == mg_undistort->width
+		&& header.height == mg_undistort->height
+		&& 0 == memcmp(&header.lens, &mg_undistort->lens,
+			       sizeof(header.lens))
+		&& n == fread(mg_undistort->px, sizeof(float), n, file)
+		&& n == fread(mg_undistort->py, sizeof(float), n, file)
+		&& n == fread(mg_undistort->xy, sizeof(uint32_t), n, file)
+		&& n == fread(mg_undistort->frac, sizeof(uint32_t), n, file)
+		&& EOF == fgetc(file);
+	fclose(file);
+
+	return ok;
+}
+
+void
+make_points(mg_undistort_t mg_undistort)
+{
+	const struct mg_lens *lens = &mg_undistort->lens;
+	uint32_t w = mg_undistort->width;
+	uint32_t h = mg_undistort->height;
+
+	for (uint32_t v = 0; v < h; v++) {
+		for (uint32_t u = 0; u < w; u++) {
+			double xd = (u - lens->cx) / lens->fx;
+			double yd = (v - lens->cy) / lens->fy;
+
+			/* fixed point iteration, starting at the distorted
+			 * point */
+			double x = xd;
+			double y = yd;
+			for (int i = 0; i < INVERT_STEPS; i++) {
+				double dx;
+				double dy;
+				distort(lens, x, y, &dx, &dy);
+				x += xd - dx;
+				y += yd - dy;
+			}
+
+			size_t k = (size_t) v * w + u;
+			mg_undistort->px[k] = x * lens->fx + lens->cx;
+			mg_undistort->py[k] = y * lens->fy + lens->cy;
+		}
+	}
+}
+
+void
+make_remap(mg_undistort_t mg_undistort)
+{
+	const struct mg_lens *lens = &mg_undistort->lens;
+	uint32_t w = mg_undistort->width;
+	uint32_t h = mg_undistort->height;
+	long max_x = (long) (w - 1) * 256;
+	long max_y = (long) (h - 1) * 256;
+
+	for (uint32_t v = 0; v < h; v++) {
+		for (uint32_t u = 0; u < w; u++) {
+			double xd;
+			double yd;
+			distort(lens,
+				(u - lens->cx) / lens->fx,
+				(v - lens->cy) / lens->fy,
+				&xd, &yd);
+			double sx = (xd * lens->fx + lens->cx) * 256;
+			double sy = (yd * lens->fy + lens->cy) * 256;
+
+			size_t k = (size_t) v * w + u;
+			if (!(sx >= 0 && sx <= max_x && sy >= 0 && sy <= max_y)) {
+				mg_undistort->xy[k] = OUTSIDE;
+				mg_undistort->frac[k] = 0;
+				continue;
+			}
+
+			/* the last column and line are reached from the
+			 * pixel before them */
+			long fx = lround(sx);
+			long fy = lround(sy);
+			uint32_t x = fx >> 8;
+			uint32_t y = fy >> 8;
+			fx &= 255;
+			fy &= 255;
+			if (x == w - 1) {
+				x--;
+				fx = 256;
+			}
+			if (y == h - 1) {
+				y--;
+				fy = 256;
+			}
+			mg_undistort->xy[k] = x | y << 16;
+			mg_undistort->frac[k] = fx | fy << 16;
+		}
+	}
+}
+
+#ifdef TEST_MULTI_GEE_MG_UNDISTORT
+
+#include <stdlib.h>
+#include <unistd.h>
+
+void
+mg_undistort_test()
+{
+	enum { W = 101, H = 67 };
+	struct mg_lens identity = {80, 80, 50, 33, 0, 0, 0, 0, 0};
+	struct mg_lens pincushion = {80, 82, 49.5, 34, 0.25, 0.08, -0.01,
+				     0.002, -0.001};
+
+	XASSERT(!mg_undistort_create(&identity, 1, H)) {
+		/* empty */
+	}
+
+	/* without distortion nothing moves */
+	mg_undistort_t u = mg_undistort_create(&identity, W, H);
+	struct mg_point p[4] = {{0, 0}, {12.25, 40.5}, {100, 66}, {-1, 3}};
+	XASSERT(3 == mg_undistort_points(u, p, p, 4)) {
+		/* empty */
+	}
+	XASSERT(fabsf(p[1].x - 12.25f) < 1e-4 && fabsf(p[1].y - 40.5f) < 1e-4
+		&& fabsf(p[2].x - 100) < 1e-4 && isnan(p[3].x)) {
+		/* empty */
+	}
+
+	static uint8_t src[W * H];
+	static uint8_t ref[W * H];
+	static uint8_t dst[W * H];
+	for (unsigned int i = 0; i < W * H; i++) {
+		src[i] = rand();
+	}
+	struct mg_image si = {src, W, H, W};
+	struct mg_image ri = {ref, W, H, W};
+	struct mg_image di = {dst, W, H, W};
+	for (int simd = MG_SIMD_SCALAR; simd <= (int) mg_simd_detect();
+	     simd++) {
+		memset(dst, 1, sizeof(dst));
+		XASSERT(mg_undistort_image(u, &si, &di, simd)) {
+			/* empty */
+		}
+		XASSERT(0 == memcmp(src, dst, sizeof(dst))) {
+			/* empty */
+		}
+	}
+	struct mg_image small = {dst, W - 1, H, W};
+	XASSERT(!mg_undistort_image(u, &si, &small, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	u = mg_undistort_destroy(u);
+
+	/* a distorted point goes back to where the lens model took it */
+	u = mg_undistort_create(&pincushion, W, H);
+	for (int i = 0; i < 50; i++) {
+		double x = (rand() % 1000 / 1000.0 - 0.5) * 1.0;
+		double y = (rand() % 1000 / 1000.0 - 0.5) * 0.7;
+		double xd;
+		double yd;
+		distort(&pincushion, x, y, &xd, &yd);
+		struct mg_point q = {xd * pincushion.fx + pincushion.cx,
+				     yd * pincushion.fy + pincushion.cy};
+		if (1 == mg_undistort_points(u, &q, &q, 1)) {
+			XASSERT(fabs(q.x - (x * pincushion.fx + pincushion.cx)) < 0.02
+				&& fabs(q.y - (y * pincushion.fy + pincushion.cy))
+				< 0.02) {
+				/* empty */
+			}
+		}
+	}
+
+	/* every kernel resamples alike, corners fall outside */
+	XASSERT(mg_undistort_image(u, &si, &ri, MG_SIMD_SCALAR)) {
+		/* empty */
+	}
+	XASSERT(0 == ref[0] && 0 == ref[W * H - 1]) {
+		/* empty */
+	}
+	for (int simd = MG_SIMD_SSE2; simd <= (int) mg_simd_detect();
+	     simd++) {
+		memset(dst, 1, sizeof(dst));
+		mg_undistort_image(u, &si, &di, simd);
+		XASSERT(0 == memcmp(ref, dst, sizeof(dst))) {
+			/* empty */
+		}
+	}
+
+	/* a corrected pixel interpolates its source */
+	uint32_t k = 20 * W + 30;
+	double xd;
+	double yd;
+	distort(&pincushion, (30 - pincushion.cx) / pincushion.fx,
+		(20 - pincushion.cy) / pincushion.fy, &xd, &yd);
+	double sx = xd * pincushion.fx + pincushion.cx;
+	double sy = yd * pincushion.fy + pincushion.cy;
+	int x0 = sx;
+	int y0 = sy;
+	double tx = sx - x0;
+	double ty = sy - y0;
+	const uint8_t *s = src + y0 * W + x0;
+	double want = (s[0] * (1 - tx) + s[1] * tx) * (1 - ty)
+		+ (s[W] * (1 - tx) + s[W + 1] * tx) * ty;
+	XASSERT(fabs(ref[k] - want) < 1.5) {
+		/* empty */
+	}
+
+	/* the cache is written once, and used for the same lens only */
+	char path[] = "/tmp/mg_undistort.XXXXXX";
+	int fd = mkstemp(path);
+	close(fd);
+	unlink(path);
+	mg_undistort_t c = mg_undistort_create_cached(&pincushion, W, H, path);
+	XASSERT(c && 0 == access(path, R_OK)) {
+		/* empty */
+	}
+	c = mg_undistort_destroy(c);
+
+	XASSERT(0 == truncate(path, sizeof(struct cache_header))) {
+		/* empty */
+	}
+	c = create(&pincushion, W, H);
+	XASSERT(!load(c, path)) {
+		/* empty */
+	}
+	c = mg_undistort_destroy(c);
+
+	c = mg_undistort_create_cached(&pincushion, W, H, path);
+	mg_undistort_t d = create(&pincushion, W, H);
+	XASSERT(load(d, path)) {
+		/* empty */
+	}
+	struct mg_point a = {70.3, 12.9};
+	struct mg_point b = a;
+	mg_undistort_points(u, &a, &a, 1);
+	mg_undistort_points(d, &b, &b, 1);
+	XASSERT(a.x == b.x && a.y == b.y) {
+		/* empty */
+	}
+	d = mg_undistort_destroy(d);
+	c = mg_undistort_destroy(c);
+
+	d = create(&identity, W, H);
+	XASSERT(!load(d, path)) {
+		/* empty */
+	}
+	d = mg_undistort_destroy(d);
+	unlink(path);
+
+	u = mg_undistort_destroy(u);
+	XASSERT(u == 0) {
+		/* empty */
+	}
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_undistort_test));
+}
+
+#endif /* TEST_MULTI_GEE_MG_UNDISTORT */
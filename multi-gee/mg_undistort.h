@@ -0,0 +1,193 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee lens distortion correction declaration
+ *
+ * A distortion corrector holds the lens model of one camera, and maps
+ * worked out from it once: where every pixel of the captured image ends
+ * up without distortion, and where every pixel of the corrected image
+ * comes from.  Marker coordinates are corrected by bilinear lookup in
+ * the first map instead of inverting the lens model point by point,
+ * and whole images for display or recording are resampled with the
+ * second.  The maps can be cached on disk, since working them out takes
+ * a moment at startup.
+ */
+#ifndef ITL_MULTI_GEE_MG_UNDISTORT_H
+#define ITL_MULTI_GEE_MG_UNDISTORT_H
+
+#include <stdbool.h> /* bool */
+#include <stdint.h> /* uint32_t */
+
+#include <cclass/classdef.h>
+#include <multi-gee/mg_image.h>
+#include <multi-gee/mg_simd.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Multi-gee distortion corrector object handle
+ */
+NEWHANDLE(mg_undistort_t);
+
+/**
+ * @brief Lens model
+ *
+ * the Brown-Conrady model with three radial and two tangential terms,
+ * as most calibration tools estimate it.  a point (x, y) on the ideal
+ * image plane, at unit distance from the lens, shows up in the
+ * captured image at
+ *
+ *   x' = x (1 + k1 r^2 + k2 r^4 + k3 r^6) + 2 p1 x y + p2 (r^2 + 2 x^2)
+ *   y' = y (1 + k1 r^2 + k2 r^4 + k3 r^6) + p1 (r^2 + 2 y^2) + 2 p2 x y
+ *
+ * with r^2 = x^2 + y^2, in pixel (fx x' + cx, fy y' + cy).
+ */
+struct mg_lens
+{
+	double fx; /**< Focal length in column pixels */
+	double fy; /**< Focal length in line pixels */
+	double cx; /**< Principal point column */
+	double cy; /**< Principal point line */
+	double k1; /**< Radial term of r^2 */
+	double k2; /**< Radial term of r^4 */
+	double k3; /**< Radial term of r^6 */
+	double p1; /**< First tangential term */
+	double p2; /**< Second tangential term */
+};
+
+/**
+ * @brief Create distortion corrector object
+ *
+ * corrected coordinates are those of an ideal camera with the focal
+ * lengths and principal point of the lens.
+ *
+ * @param lens  lens model
+ * @param width  width of the captured images, at least 2
+ * @param height  height of the captured images, at least 2
+ *
+ * @return a newly created distortion corrector object handle, or 0 on
+ * failure
+ */
+mg_undistort_t
+mg_undistort_create(const struct mg_lens *lens,
+		    uint32_t width,
+		    uint32_t height);
+
+/**
+ * @brief Create distortion corrector object with a map cache
+ *
+ * as mg_undistort_create(), but the maps are read from the cache file
+ * if it was written for the same lens and image size.  otherwise they
+ * are worked out and the cache file is written, if possible.
+ *
+ * @param lens  lens model
+ * @param width  width of the captured images, at least 2
+ * @param height  height of the captured images, at least 2
+ * @param path  cache file
+ *
+ * @return a newly created distortion corrector object handle, or 0 on
+ * failure
+ */
+mg_undistort_t
+mg_undistort_create_cached(const struct mg_lens *lens,
+			   uint32_t width,
+			   uint32_t height,
+			   const char *path);
+
+/**
+ * @brief Destroy distortion corrector object
+ *
+ * @param undistort  object handle
+ *
+ * @return 0
+ */
+mg_undistort_t
+mg_undistort_destroy(mg_undistort_t undistort);
+
+/**
+ * @brief Lens model
+ *
+ * @param undistort  object handle
+ *
+ * @return the lens model, or 0 on failure
+ */
+const struct mg_lens *
+mg_undistort_get_lens(mg_undistort_t undistort);
+
+/**
+ * @brief Correct an image
+ *
+ * every pixel of the corrected image is interpolated from the four
+ * captured pixels around where it comes from, and is 0 if that is
+ * outside the captured image.  SSE2 lacks the gathers of AVX2 and uses
+ * the scalar kernel.
+ *
+ * @param undistort  object handle
+ * @param src  8-bit captured image, of the size given on creation
+ * @param dst  8-bit image to fill in, of the same size
+ * @param simd  kernel to use, at most mg_simd_detect()
+ *
+ * @return
+ * - @c false if the images do not have the right size, else
+ * - @c true
+ */
+bool
+mg_undistort_image(mg_undistort_t undistort,
+		   const struct mg_image *src,
+		   struct mg_image *dst,
+		   enum mg_simd simd);
+
+/**
+ * @brief Correct points
+ *
+ * points outside the captured image come out as NAN.  @a in and @a out
+ * may be the same array.
+ *
+ * @param undistort  object handle
+ * @param in  captured image points, such as ellipse centres
+ * @param out  corrected points to fill in
+ * @param n  number of points
+ *
+ * @return the number of points inside the captured image
+ */
+unsigned int
+mg_undistort_points(mg_undistort_t undistort,
+		    const struct mg_point *in,
+		    struct mg_point *out,
+		    unsigned int n);
+
+/**
+ * @brief Write the maps to a cache file
+ *
+ * see mg_undistort_create_cached().  the file is replaced atomically.
+ *
+ * @param undistort  object handle
+ * @param path  cache file
+ *
+ * @return
+ * - @c false on failure, else
+ * - @c true
+ */
+bool
+mg_undistort_save(mg_undistort_t undistort,
+		  const char *path);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_UNDISTORT_H */
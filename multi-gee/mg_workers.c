@@ -0,0 +1,373 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee worker pool definition
+ */
+#define _GNU_SOURCE /* pthread_attr_setaffinity_np, pthread_setname_np */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h> /* bool */
+#include <stdio.h> /* snprintf */
+
+#include "mg_workers.h" /* class implemented */
+
+USE_XASSERT
+
+/**
+ * @brief Worker thread
+ */
+struct worker
+{
+	mg_workers_t workers; /**< Pool the worker belongs to */
+	unsigned int index; /**< Worker number */
+	pthread_t thread; /**< Thread */
+	int cpu; /**< Processor pinned to, or -1 */
+};
+
+/**
+ * @brief Worker pool object structure
+ */
+CLASS(mg_workers, mg_workers_t)
+{
+	struct worker *worker; /**< Workers */
+	unsigned int num_workers; /**< Number of workers started */
+	pthread_mutex_t lock; /**< Guards the batch */
+	pthread_cond_t start; /**< Signals a new batch, or stop */
+	pthread_cond_t done; /**< Signals a worker finished its part */
+	const struct mg_task *task; /**< Tasks of the batch */
+	unsigned int num_tasks; /**< Number of tasks */
+	unsigned long batch; /**< Number of batches handed out */
+	unsigned int pending; /**< Workers still on the batch */
+	bool stop; /**< Workers to exit? */
+	log_t log; /**< Log object handle */
+};
+
+/**
+ * @brief Worker thread body
+ *
+ * @param arg  worker
+ *
+ * @return 0
+ */
+static
+void *
+work(void *arg);
+
+mg_workers_t
+mg_workers_create(unsigned int num_workers,
+		  log_t log)
+{
+	if (!num_workers) {
+		return 0;
+	}
+
+	mg_workers_t mg_workers;
+	NEWOBJ(mg_workers);
+
+	mg_workers->worker = MALLOC(num_workers * sizeof(*mg_workers->worker));
+	mg_workers->num_workers = 0;
+	pthread_mutex_init(&mg_workers->lock, 0);
+	pthread_cond_init(&mg_workers->start, 0);
+	pthread_cond_init(&mg_workers->done, 0);
+	mg_workers->task = 0;
+	mg_workers->num_tasks = 0;
+	mg_workers->batch = 0;
+	mg_workers->pending = 0;
+	mg_workers->stop = false;
+	mg_workers->log = log;
+
+	/* processors this process may run on, in order */
+	cpu_set_t allowed;
+	int cpu[CPU_SETSIZE];
+	int num_cpus = 0;
+	if (0 == sched_getaffinity(0, sizeof(allowed), &allowed)) {
+		for (int c = 0; c < CPU_SETSIZE; c++) {
+			if (CPU_ISSET(c, &allowed)) {
+				cpu[num_cpus++] = c;
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < num_workers; i++) {
+		struct worker *w = &mg_workers->worker[mg_workers->num_workers];
+		w->workers = mg_workers;
+		w->index = mg_workers->num_workers;
+		w->cpu = num_cpus ? cpu[i % num_cpus] : -1;
+
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		if (-1 != w->cpu) {
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(w->cpu, &set);
+			pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+		}
+		int err = pthread_create(&w->thread, &attr, work, w);
+		if (err && -1 != w->cpu) {
+			errno = err;
+			lg_errno(log, "cannot pin worker %u to cpu %d", i, w->cpu);
+			w->cpu = -1;
+			err = pthread_create(&w->thread, 0, work, w);
+		}
+		pthread_attr_destroy(&attr);
+		if (err) {
+			errno = err;
+			lg_errno(log, "cannot start worker %u", i);
+			break;
+		}
+
+		char name[16];
+		snprintf(name, sizeof(name), "mg-worker-%u", w->index);
+		pthread_setname_np(w->thread, name);
+		mg_workers->num_workers++;
+	}
+
+	if (!mg_workers->num_workers) {
+		return mg_workers_destroy(mg_workers);
+	}
+
+	return mg_workers;
+}
+
+mg_workers_t
+mg_workers_destroy(mg_workers_t mg_workers)
+{
+	VERIFYZ(mg_workers) {
+		pthread_mutex_lock(&mg_workers->lock);
+		mg_workers->stop = true;
+		pthread_cond_broadcast(&mg_workers->start);
+		pthread_mutex_unlock(&mg_workers->lock);
+		for (unsigned int i = 0; i < mg_workers->num_workers; i++) {
+			pthread_join(mg_workers->worker[i].thread, 0);
+		}
+
+		pthread_mutex_destroy(&mg_workers->lock);
+		pthread_cond_destroy(&mg_workers->start);
+		pthread_cond_destroy(&mg_workers->done);
+		FREEOBJ(mg_workers->worker);
+
+		FREEOBJ(mg_workers);
+	}
+
+	return 0;
+}
+
+unsigned int
+mg_workers_get_count(mg_workers_t mg_workers)
+{
+	unsigned int count = 0;
+
+	VERIFY(mg_workers) {
+		count = mg_workers->num_workers;
+	}
+
+	return count;
+}
+
+int
+mg_workers_get_cpu(mg_workers_t mg_workers,
+		   unsigned int worker)
+{
+	int cpu = -1;
+
+	VERIFY(mg_workers) {
+		if (worker < mg_workers->num_workers) {
+			cpu = mg_workers->worker[worker].cpu;
+		}
+	}
+
+	return cpu;
+}
+
+void
+mg_workers_run(mg_workers_t mg_workers,
+	       const struct mg_task *task,
+	       unsigned int num_tasks)
+{
+	VERIFY(mg_workers) {
+		if (!num_tasks) {
+			return;
+		}
+
+		pthread_mutex_lock(&mg_workers->lock);
+		mg_workers->task = task;
+		mg_workers->num_tasks = num_tasks;
+		mg_workers->pending = mg_workers->num_workers;
+		mg_workers->batch++;
+		pthread_cond_broadcast(&mg_workers->start);
+		while (mg_workers->pending) {
+			pthread_cond_wait(&mg_workers->done, &mg_workers->lock);
+		}
+		mg_workers->task = 0;
+		mg_workers->num_tasks = 0;
+		pthread_mutex_unlock(&mg_workers->lock);
+	}
+}
+
+void *
+work(void *arg)
+{
+	struct worker *w = arg;
+	mg_workers_t mg_workers = w->workers;
+	unsigned long batch = 0;
+
+	pthread_mutex_lock(&mg_workers->lock);
+	for (;;) {
+		while (batch == mg_workers->batch && !mg_workers->stop) {
+			pthread_cond_wait(&mg_workers->start, &mg_workers->lock);
+		}
+		if (mg_workers->stop) {
+			break;
+		}
+		batch = mg_workers->batch;
+		const struct mg_task *task = mg_workers->task;
+		unsigned int num_tasks = mg_workers->num_tasks;
+		unsigned int num_workers = mg_workers->num_workers;
+		pthread_mutex_unlock(&mg_workers->lock);
+
+		for (unsigned int i = 0; i < num_tasks; i++) {
+			if (task[i].worker % num_workers == w->index) {
+				task[i].run(task[i].arg);
+			}
+		}
+
+		pthread_mutex_lock(&mg_workers->lock);
+		if (!--mg_workers->pending) {
+			pthread_cond_signal(&mg_workers->done);
+		}
+	}
+	pthread_mutex_unlock(&mg_workers->lock);
+
+	return 0;
+}
+
+#ifdef TEST_MULTI_GEE_MG_WORKERS
+
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/**
+ * @brief Where a test task ran
+ */
+struct probe
+{
+	pthread_t thread; /**< Thread it ran on */
+	int cpu; /**< Processor it ran on */
+	int runs; /**< Number of times it ran */
+	useconds_t sleep; /**< Time to take */
+};
+
+static
+void
+probe(void *arg)
+{
+	struct probe *p = arg;
+
+	p->thread = pthread_self();
+	p->cpu = sched_getcpu();
+	p->runs++;
+	if (p->sleep) {
+		usleep(p->sleep);
+	}
+}
+
+void
+mg_workers_test()
+{
+	log_t log = lg_create("mg_workers", "stderr");
+
+	XASSERT(!mg_workers_create(0, log)) {
+		/* empty */
+	}
+
+	mg_workers_t workers = mg_workers_create(3, log);
+	XASSERT(3 == mg_workers_get_count(workers)
+		&& -1 == mg_workers_get_cpu(workers, 3)) {
+		/* empty */
+	}
+
+	/* every task runs once, on its own worker */
+	enum { TASKS = 10 };
+	struct probe p[TASKS] = {{0, 0, 0, 0}};
+	struct mg_task task[TASKS];
+	for (unsigned int i = 0; i < TASKS; i++) {
+		task[i].run = probe;
+		task[i].arg = &p[i];
+		task[i].worker = i;
+	}
+	mg_workers_run(workers, task, TASKS);
+	pthread_t first[TASKS];
+	for (unsigned int i = 0; i < TASKS; i++) {
+		XASSERT(1 == p[i].runs) {
+			/* empty */
+		}
+		first[i] = p[i].thread;
+		int cpu = mg_workers_get_cpu(workers, i % 3);
+		XASSERT(-1 == cpu || cpu == p[i].cpu) {
+			/* empty */
+		}
+	}
+	XASSERT(pthread_equal(first[0], first[3])
+		&& !pthread_equal(first[0], first[1])
+		&& !pthread_equal(first[1], first[2])
+		&& !pthread_equal(first[0], pthread_self())) {
+		/* empty */
+	}
+
+	/* and on the same worker the next time */
+	mg_workers_run(workers, task, TASKS);
+	for (unsigned int i = 0; i < TASKS; i++) {
+		XASSERT(2 == p[i].runs && pthread_equal(first[i], p[i].thread)) {
+			/* empty */
+		}
+	}
+
+	/* tasks of different workers run at the same time */
+	for (unsigned int i = 0; i < 3; i++) {
+		p[i].sleep = 100000;
+	}
+	struct timeval start;
+	struct timeval end;
+	gettimeofday(&start, 0);
+	mg_workers_run(workers, task, 3);
+	gettimeofday(&end, 0);
+	long elapsed = (end.tv_sec - start.tv_sec) * 1000000
+		+ (end.tv_usec - start.tv_usec);
+	XASSERT(elapsed >= 100000 && elapsed < 250000) {
+		/* empty */
+	}
+
+	mg_workers_run(workers, task, 0);
+	workers = mg_workers_destroy(workers);
+	XASSERT(workers == 0) {
+		/* empty */
+	}
+	log = lg_destroy(log);
+}
+
+int
+main()
+{
+	exit(cclass_assert_test(mg_workers_test));
+}
+
+#endif /* TEST_MULTI_GEE_MG_WORKERS */
@@ -0,0 +1,122 @@
+/* $Id$
+ * Copyright (C) 2026 The multi-gee developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+/**
+ * @file
+ * @brief Multi-gee worker pool declaration
+ *
+ * The pool keeps a fixed set of threads, each pinned to a processor of
+ * its own, for work handed out once per frameset.  A task names the
+ * worker it runs on, so work for the same camera can go to the same
+ * worker every frameset and find its data in that processor's cache.
+ * Running a batch of tasks returns when all of them are done.
+ */
+#ifndef ITL_MULTI_GEE_MG_WORKERS_H
+#define ITL_MULTI_GEE_MG_WORKERS_H
+
+#include <cclass/classdef.h>
+#include <multi-gee/log.h>
+
+__BEGIN_DECLS
+
+/**
+ * @brief Multi-gee worker pool object handle
+ */
+NEWHANDLE(mg_workers_t);
+
+/**
+ * @brief Task for a worker
+ */
+struct mg_task
+{
+	void (*run)(void *arg); /**< Function to run */
+	void *arg; /**< Argument of the function */
+	unsigned int worker; /**< Worker to run on, modulo the number of
+			       workers */
+};
+
+/**
+ * @brief Create worker pool object
+ *
+ * worker i is pinned to the i-th processor the process may run on,
+ * wrapping around if there are more workers than processors.  failure
+ * to pin a worker is logged, and the worker runs unpinned.
+ *
+ * @param num_workers  number of worker threads, at least 1
+ * @param log  object handle, to log error messages to
+ *
+ * @return a newly created worker pool object handle, or 0 if no worker
+ * thread could be started
+ */
+mg_workers_t
+mg_workers_create(unsigned int num_workers,
+		  log_t log);
+
+/**
+ * @brief Destroy worker pool object
+ *
+ * waits for the workers to exit.  must not be called while tasks run.
+ *
+ * @param workers  object handle
+ *
+ * @return 0
+ */
+mg_workers_t
+mg_workers_destroy(mg_workers_t workers);
+
+/**
+ * @brief Number of workers accessor
+ *
+ * @param workers  object handle
+ *
+ * @return the number of worker threads running
+ */
+unsigned int
+mg_workers_get_count(mg_workers_t workers);
+
+/**
+ * @brief Processor of a worker accessor
+ *
+ * @param workers  object handle
+ * @param worker  worker number
+ *
+ * @return the processor the worker is pinned to, or -1 if it is not
+ * pinned
+ */
+int
+mg_workers_get_cpu(mg_workers_t workers,
+		   unsigned int worker);
+
+/**
+ * @brief Run a batch of tasks
+ *
+ * the tasks of one worker run one after the other, in order; those of
+ * different workers run at the same time.  returns when all tasks are
+ * done.  one batch runs at a time.
+ *
+ * @param workers  object handle
+ * @param task  tasks
+ * @param num_tasks  number of tasks
+ */
+void
+mg_workers_run(mg_workers_t workers,
+	       const struct mg_task *task,
+	       unsigned int num_tasks);
+
+__END_DECLS
+
+#endif /* ITL_MULTI_GEE_MG_WORKERS_H */
@@ -20,8 +20,10 @@
  * @brief Multi-gee Frame Grabber Library definition
  */
 #include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h> /* sysconf */
 
 #include <stdint.h>
 #include <asm/types.h> /* needed for videodev2.h */
@@ -31,6 +33,8 @@
 #include "log.h"
 #include "mg_device.h"
 #include "mg_frame.h"
+#include "mg_hotplug.h"
+#include "mg_workers.h"
 #include "multi-gee.h" /* class implemented */
 #include "sllist.h"
 #include "tv_util.h"
@@ -47,6 +51,20 @@ enum sync_status
 	SYNC_FAIL /**< frames not in sync */
 };
 
+/**
+ * @brief Number of framesets over which buffer use is observed
+ *
+ * at most one buffer per device is retired per window.
+ */
+#define RESIZE_WINDOW 250
+
+/**
+ * @brief Most control changes applied per device and frameset
+ *
+ * further changes stay queued for the next frameset.
+ */
+#define MAX_CONTROLS 32
+
 /**
  * @brief Create a list of device frames
  *
@@ -85,6 +103,32 @@ enum sync_status
 capture_frameset(multi_gee_t multi_gee,
 		 int *count);
 
+/**
+ * @brief Apply queued control changes
+ *
+ * Called between framesets.  The changes queued for a device are set
+ * with one ioctl.  The frame being captured keeps the old values, so
+ * they take effect from the frame after it.
+ *
+ * @param multi_gee  object handle
+ */
+static
+void
+apply_controls(multi_gee_t multi_gee);
+
+/**
+ * @brief Apply queued regions of interest
+ *
+ * Called between framesets.  A new hardware crop can only apply to
+ * frames captured into buffers queued after the change, so it takes
+ * effect after the frames already queued.
+ *
+ * @param multi_gee  object handle
+ */
+static
+void
+apply_rois(multi_gee_t multi_gee);
+
 /**
  * @brief Find device in list given the file descriptor
  *
@@ -124,6 +168,159 @@ mg_frame_t
 find_frame_device(sllist_t list,
 		  mg_device_t device);
 
+/**
+ * @brief Discard frames captured before the current capture run
+ *
+ * Hands the buffers held by the frame list back to the driver, replaces
+ * the frames with dummy frames and drains the frames the driver
+ * captured while the application was not capturing.
+ *
+ * @param multi_gee  object handle
+ */
+static
+void
+flush_frames(multi_gee_t multi_gee);
+
+/**
+ * @brief Give a device at least a number of capture buffers
+ *
+ * Cancels pending retirements first, then returns retired buffers to
+ * the driver, and only then creates new buffers.
+ *
+ * @param multi_gee  object handle
+ * @param device  object handle
+ * @param need  number of buffers needed
+ */
+static
+void
+grow_buffers(multi_gee_t multi_gee,
+	     mg_device_t device,
+	     unsigned int need);
+
+/**
+ * @brief Open and initialise a device of a registration batch
+ *
+ * @param arg  struct init_job of the device
+ *
+ * @return 0
+ */
+static
+void *
+init_device(void *arg);
+
+/**
+ * @brief Add cameras the hot-plug watcher has initialised
+ *
+ * does not block.  the cameras start streaming, unless capture is
+ * paused, and join the frame list.
+ *
+ * @param multi_gee  object handle
+ */
+static
+void
+join_devices(multi_gee_t multi_gee);
+
+/**
+ * @brief Test whether a device number is registered or parked
+ *
+ * @param arg  multi-gee object handle
+ * @param devno  device number
+ *
+ * @return \c true if the device is registered or parked, else \c false
+ */
+static
+bool
+known_device(void *arg,
+	     dev_t devno);
+
+/**
+ * @brief Drop devices that have been unplugged
+ *
+ * every dropped device gets a hot-plug rule, so that it joins again
+ * when it is plugged back in.
+ *
+ * @param multi_gee  object handle
+ *
+ * @return \c true if a device was dropped, else \c false
+ */
+static
+bool
+lose_devices(multi_gee_t multi_gee);
+
+/**
+ * @brief Worker a device's frames are processed on
+ *
+ * a device without a worker, or with one the pool no longer has, gets
+ * the worker with the fewest devices.
+ *
+ * @param multi_gee  object handle
+ * @param device  capture device
+ *
+ * @return worker number
+ */
+static
+unsigned int
+pick_worker(multi_gee_t multi_gee,
+	    mg_device_t device);
+
+/**
+ * @brief Hand the frameset to the pyramid worker
+ *
+ * the frames of devices configured with an image pyramid get their
+ * levels built, those of devices with a background model their
+ * foreground image made, and those configured with image statistics
+ * their statistics worked out, on the worker thread while the callback
+ * function runs.  the worker thread is started on first use.
+ *
+ * @param multi_gee  object handle
+ */
+static
+void
+post_pyramid(multi_gee_t multi_gee);
+
+/**
+ * @brief Build image pyramids, foregrounds and statistics of posted
+ * framesets
+ *
+ * @param arg  multi-gee object handle
+ *
+ * @return 0
+ */
+static
+void *
+pyramid_worker(void *arg);
+
+/**
+ * @brief Adjust the number of capture buffers to the callback duration
+ *
+ * The frame list holds on to one buffer per device for as long as the
+ * callback function runs, and the driver needs another buffer to fill.
+ * Every frame period the callback function takes beyond that needs one
+ * more buffer, else frames are dropped.  The frame period comes from the
+ * buffer time stamps and sequence numbers of one device, not from the
+ * callback timing.  Devices are grown as soon as a long callback is seen,
+ * up to the number of buffers their driver accepted, and shrunk by one buffer at the end of a
+ * window of RESIZE_WINDOW framesets that needed fewer buffers.
+ *
+ * @param multi_gee  object handle
+ * @param start  time stamp of callback entry
+ * @param end  time stamp of callback exit
+ */
+static
+void
+resize_buffers(multi_gee_t multi_gee,
+	       struct timeval *start,
+	       struct timeval *end);
+
+/**
+ * @brief Restart streaming on all devices after a pause
+ *
+ * @param multi_gee  object handle
+ */
+static
+void
+resume_capture(multi_gee_t multi_gee);
+
 /**
  * @brief Enqueue old frame, dequeue new frame
  *
@@ -174,6 +371,67 @@ static
 enum sync_status
 sync_test(multi_gee_t multi_gee);
 
+/**
+ * @brief Highest sequence number dequeued from a device
+ *
+ * @param device  object handle
+ *
+ * @return sequence number, 0 if no frame was dequeued yet
+ */
+static
+uint32_t
+last_sequence(mg_device_t device);
+
+/**
+ * @brief Wait for the pyramid worker to finish the posted frameset
+ *
+ * @param multi_gee  object handle
+ */
+static
+void
+wait_pyramid(multi_gee_t multi_gee);
+
+/**
+ * @brief Frame of mg_frameset_parallel_for()
+ */
+struct frame_job
+{
+	mg_frame_t frame; /**< Frame */
+	void (*fn)(mg_frame_t, void *); /**< Function to call */
+	void *arg; /**< Argument of the function */
+};
+
+/**
+ * @brief Process a frame of mg_frameset_parallel_for()
+ *
+ * @param arg  frame job
+ */
+static
+void
+run_frame(void *arg);
+
+/**
+ * @brief Start the worker pool, or restart it with a new size
+ *
+ * @param multi_gee  object handle
+ */
+static
+void
+start_workers(multi_gee_t multi_gee);
+
+/**
+ * @brief Device of a registration batch
+ */
+struct init_job
+{
+	mg_device_t device; /**< Device, 0 if not to be initialised */
+	log_t log; /**< Log object handle */
+	pthread_t thread; /**< Initialising thread */
+	bool threaded; /**< Initialised on its own thread? */
+	bool ok; /**< Opened and initialised? */
+	struct timeval elapsed; /**< Time taken to initialise */
+};
+
 /**
  * @brief Multi-gee object structure
  */
@@ -181,6 +439,7 @@ CLASS(multi_gee, multi_gee_t)
 {
 	bool busy; /**< \c true while mg_capture() in progress */
 	bool halt; /**< \c true if mg_capture_halt() called */
+	bool paused; /**< \c true if mg_capture_pause() stopped streaming */
 
 	void (*callback)(multi_gee_t, sllist_t); /**< Pointer to user
 						   defined callback
@@ -188,8 +447,12 @@ CLASS(multi_gee, multi_gee_t)
 
 	sllist_t frame; /**< List of frames */
 	sllist_t device; /**< List of devices */
+	sllist_t parked; /**< Devices kept ready, but not captured from */
+	mg_hotplug_t hotplug; /**< Hot-plug watcher, 0 if not watching */
 
 	struct timeval last_sync; /**< Time stamp when last in sync */
+	struct timeval capture_start; /**< Time stamp of mg_capture() entry */
+	struct timeval first_frameset; /**< Time to first frameset */
 
 	log_t log; /**< Log object handle */
 
@@ -197,6 +460,32 @@ CLASS(multi_gee, multi_gee_t)
 	struct timeval TV_NO_SYNC; /**< Failure to achieve sync criterion */
 
 	unsigned int num_bufs; /**< Number of capture buffers */
+	unsigned int min_bufs; /**< Lower bound on capture buffers */
+	unsigned int max_bufs; /**< Upper bound on capture buffers */
+
+	struct timeval frame_period; /**< Frame period, from buffer time stamps */
+	mg_device_t period_device; /**< Device the period is measured on */
+	struct timeval period_stamp; /**< Its last buffer time stamp */
+	uint32_t period_sequence; /**< Its last buffer sequence number */
+	struct timeval max_callback; /**< Longest callback in window */
+	unsigned int window; /**< Framesets in current window */
+	unsigned int overruns; /**< Callbacks longer than a frame period
+				 in current window */
+
+	pthread_mutex_t device_lock; /**< Guards the device list against
+				       threads other than the capture thread */
+
+	pthread_t pyramid; /**< Pyramid worker thread */
+	bool pyramid_running; /**< Pyramid worker thread started? */
+	bool pyramid_stop; /**< Pyramid worker thread to exit? */
+	pthread_mutex_t pyramid_lock; /**< Guards the pyramid job */
+	pthread_cond_t pyramid_cond; /**< Signals pyramid job changes */
+	sllist_t pyramid_job; /**< Frames the worker builds pyramids of */
+
+	mg_workers_t workers; /**< Pool of mg_frameset_parallel_for() */
+	unsigned int num_workers; /**< Workers asked for, 0 for one per
+				    device */
+	unsigned int workers_for; /**< Workers the pool was started with */
 };
 
 multi_gee_t
@@ -207,13 +496,19 @@ mg_create(const char* log_file)
 
 	multi_gee->busy = false;
 	multi_gee->halt = false;
+	multi_gee->paused = false;
 
 	multi_gee->callback = 0;
 
 	multi_gee->frame = 0;
 	multi_gee->device = 0;
+	multi_gee->parked = 0;
+	multi_gee->hotplug = 0;
+	pthread_mutex_init(&multi_gee->device_lock, 0);
 
 	timerclear(&multi_gee->last_sync);
+	timerclear(&multi_gee->capture_start);
+	timerclear(&multi_gee->first_frameset);
 
 	multi_gee->log = lg_create("multi-gee", log_file);
 
@@ -221,6 +516,24 @@ mg_create(const char* log_file)
 	timerset(&multi_gee->TV_NO_SYNC, 0, 168000); /* 4 frames + 5% */
 
 	multi_gee->num_bufs = 3;
+	multi_gee->min_bufs = 3;
+	multi_gee->max_bufs = 3;
+
+	timerclear(&multi_gee->frame_period);
+	multi_gee->period_device = 0;
+	timerclear(&multi_gee->max_callback);
+	multi_gee->window = 0;
+	multi_gee->overruns = 0;
+
+	multi_gee->pyramid_running = false;
+	multi_gee->pyramid_stop = false;
+	pthread_mutex_init(&multi_gee->pyramid_lock, 0);
+	pthread_cond_init(&multi_gee->pyramid_cond, 0);
+	multi_gee->pyramid_job = 0;
+
+	multi_gee->workers = 0;
+	multi_gee->num_workers = 0;
+	multi_gee->workers_for = 0;
 
 	lg_log(multi_gee->log, "startup");
 
@@ -239,6 +552,8 @@ mg_create_special(const char* log_file,
 		multi_gee->TV_IN_SYNC = tv_in_sync;
 		multi_gee->TV_NO_SYNC = tv_no_sync;
 		multi_gee->num_bufs = num_bufs;
+		multi_gee->min_bufs = num_bufs;
+		multi_gee->max_bufs = num_bufs;
 	}
 	return multi_gee;
 }
@@ -247,11 +562,29 @@ multi_gee_t
 mg_destroy(multi_gee_t multi_gee)
 {
 	VERIFYZ(multi_gee) {
+		if (multi_gee->pyramid_running) {
+			pthread_mutex_lock(&multi_gee->pyramid_lock);
+			multi_gee->pyramid_stop = true;
+			pthread_cond_broadcast(&multi_gee->pyramid_cond);
+			pthread_mutex_unlock(&multi_gee->pyramid_lock);
+			pthread_join(multi_gee->pyramid, 0);
+		}
+		pthread_mutex_destroy(&multi_gee->pyramid_lock);
+		pthread_cond_destroy(&multi_gee->pyramid_cond);
+		multi_gee->workers = mg_workers_destroy(multi_gee->workers);
+
+		multi_gee->hotplug = mg_hotplug_destroy(multi_gee->hotplug);
+
 		while (multi_gee->device) {
 			int id = mg_device_get_fd(sllist_data(multi_gee->device));
 			mg_deregister_device(multi_gee, id);
 		}
+		while (multi_gee->parked) {
+			int id = mg_device_get_fd(sllist_data(multi_gee->parked));
+			mg_deregister_device(multi_gee, id);
+		}
 		multi_gee->device = sllist_empty(multi_gee->device);
+		pthread_mutex_destroy(&multi_gee->device_lock);
 		multi_gee->frame = add_frame(multi_gee->frame, 0);
 		multi_gee->log = lg_destroy(multi_gee->log);
 		FREEOBJ(multi_gee);
@@ -322,6 +655,7 @@ capture_frameset(multi_gee_t multi_gee,
 		 int *count)
 {
 	fd_set fds;
+	join_devices(multi_gee);
 	enum sync_status sync = sync_select(multi_gee, &fds);
 
 	for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
@@ -332,13 +666,36 @@ capture_frameset(multi_gee_t multi_gee,
 
 			if (swap_ok) {
 				sync = sync_test(multi_gee);
+			} else if (lose_devices(multi_gee)) {
+				/* the device list changed, select again */
+				sync = SYNC_FAIL;
+				break;
 			} else {
 				sync = SYNC_FATAL;
 			}
 
 			if (SYNC_OK == sync) {
+				if (!timerisset(&multi_gee->first_frameset)) {
+					struct timeval *tv =
+						&multi_gee->first_frameset;
+					gettimeofday(tv, 0);
+					timersub(tv, &multi_gee->capture_start, tv);
+					lg_log(multi_gee->log,
+					       "first frameset after %ld.%06ld",
+					       tv->tv_sec,
+					       tv->tv_usec);
+				}
+				struct timeval start;
+				struct timeval end;
+				gettimeofday(&start, 0);
+				post_pyramid(multi_gee);
 				multi_gee->callback(multi_gee,
 						    multi_gee->frame);
+				wait_pyramid(multi_gee);
+				gettimeofday(&end, 0);
+				resize_buffers(multi_gee, &start, &end);
+				apply_controls(multi_gee);
+				apply_rois(multi_gee);
 				if (count) {
 					(*count)++;
 				}
@@ -350,6 +707,28 @@ capture_frameset(multi_gee_t multi_gee,
 
 	return sync;
 }
+
+bool
+mg_add_device_rule(multi_gee_t multi_gee,
+		   dev_t devno,
+		   const char *bus_info,
+		   void *userptr,
+		   mg_config_t config)
+{
+	bool ok = false;
+
+	VERIFY(multi_gee) {
+		ok = multi_gee->hotplug
+			&& mg_hotplug_add_rule(multi_gee->hotplug,
+					       devno,
+					       bus_info,
+					       userptr,
+					       config);
+	}
+
+	return ok;
+}
+
 enum mg_RETURN
 mg_capture(multi_gee_t multi_gee,
 	   int n)
@@ -366,12 +745,25 @@ mg_capture(multi_gee_t multi_gee,
 			ret = RET_BUSY;
 		} else {
 			multi_gee->busy = true;
-		}
 
-		/* update sync time to now */
-		gettimeofday(&multi_gee->last_sync, 0);
+			/* start from fresh frames */
+			if (multi_gee->paused) {
+				resume_capture(multi_gee);
+			} else {
+				flush_frames(multi_gee);
+			}
+			join_devices(multi_gee);
+			apply_controls(multi_gee);
+			apply_rois(multi_gee);
+
+			/* update sync time to now */
+			gettimeofday(&multi_gee->last_sync, 0);
+			multi_gee->capture_start = multi_gee->last_sync;
+			timerclear(&multi_gee->first_frameset);
+			multi_gee->period_device = 0;
 
-		debug_print_tv(multi_gee->last_sync);
+			debug_print_tv(multi_gee->last_sync);
+		}
 
 		while (!done) {
 			/* assume we are done */
@@ -388,6 +780,7 @@ mg_capture(multi_gee_t multi_gee,
 				ret = count;
 			} else if (SYNC_FATAL == sync) {
 				ret = RET_SYNC;
+				mg_check_buffers(multi_gee);
 			} else {
 				/* OK, so we're not done yet */
 				done = false;
@@ -408,6 +801,105 @@ mg_capture_halt(multi_gee_t multi_gee)
 	}
 }
 
+bool
+mg_capture_pause(multi_gee_t multi_gee)
+{
+	bool ok = false;
+
+	VERIFY(multi_gee) {
+		if (!multi_gee->busy) {
+			if (!multi_gee->paused) {
+				for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
+					/* ignore failures */
+					fg_stop_capture(sllist_data(d),
+							multi_gee->log);
+				}
+
+				/* stopping returns all buffers to us */
+				multi_gee->frame = add_frame(multi_gee->frame, 0);
+				multi_gee->frame = add_frame(0, multi_gee->device);
+				multi_gee->paused = true;
+			}
+			ok = true;
+		}
+	}
+
+	return ok;
+}
+
+int
+mg_check_buffers(multi_gee_t multi_gee)
+{
+	int leaked = -1;
+
+	VERIFY(multi_gee) {
+		leaked = 0;
+		for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
+			mg_device_t dev = sllist_data(d);
+			mg_buffer_t dev_buf = mg_device_get_buffer(dev);
+			mg_frame_t frame = find_frame_device(multi_gee->frame, dev);
+			int held = frame ? mg_frame_get_index(frame) : -1;
+
+			unsigned int bufs = mg_buffer_get_number(dev_buf);
+			unsigned int count = 0;
+			for (unsigned int i = 0; i < bufs; i++) {
+				enum mg_buffer_state state =
+					mg_buffer_get_state(dev_buf, i);
+
+				bool leak = false;
+				switch (state) {
+				case MG_BUFFER_IDLE:
+					leak = !multi_gee->paused;
+					break;
+				case MG_BUFFER_HELD:
+					leak = (int) i != held;
+					break;
+				case MG_BUFFER_LOST:
+					leak = true;
+					break;
+				default:
+					break;
+				}
+
+				if (leak) {
+					struct timeval tv =
+						mg_buffer_get_timestamp(dev_buf, i);
+					struct timeval hold =
+						mg_buffer_get_hold_time(dev_buf, i);
+					lg_log(multi_gee->log,
+					       "%s buffer %u leaked in state %d: "
+					       "sequence %u, time stamp %ld.%06ld, "
+					       "held %ld.%06ld",
+					       mg_device_get_name(dev), i, state,
+					       mg_buffer_get_sequence(dev_buf, i),
+					       tv.tv_sec, tv.tv_usec,
+					       hold.tv_sec, hold.tv_usec);
+					count++;
+				}
+			}
+
+			if (count) {
+				lg_log(multi_gee->log,
+				       "%s buffers: %u queued, %u held, %u idle, "
+				       "%u retired, %u lost; "
+				       "%lu dequeues, %lu enqueues, %lu failed",
+				       mg_device_get_name(dev),
+				       mg_buffer_get_count(dev_buf, MG_BUFFER_QUEUED),
+				       mg_buffer_get_count(dev_buf, MG_BUFFER_HELD),
+				       mg_buffer_get_count(dev_buf, MG_BUFFER_IDLE),
+				       mg_buffer_get_count(dev_buf, MG_BUFFER_RETIRED),
+				       mg_buffer_get_count(dev_buf, MG_BUFFER_LOST),
+				       mg_buffer_get_dequeued(dev_buf),
+				       mg_buffer_get_enqueued(dev_buf),
+				       mg_buffer_get_lost(dev_buf));
+			}
+			leaked += count;
+		}
+	}
+
+	return leaked;
+}
+
 int
 mg_deregister_device(multi_gee_t multi_gee,
 		     int id)
@@ -415,12 +907,24 @@ mg_deregister_device(multi_gee_t multi_gee,
 	int ret = -1;
 
 	VERIFY(multi_gee) {
+		mg_device_t parked = find_device_fd(multi_gee->parked, id);
 		mg_device_t device = find_device_fd(multi_gee->device, id);
-		if (device) {
+		if (parked) {
+			multi_gee->parked =
+				sllist_remove_data(multi_gee->parked, parked);
+			fg_uninit_device(parked, multi_gee->log);
+			mg_device_destroy(parked);
+			ret = id;
+		} else if (device) {
+			/* the callback may deregister while pyramids build */
+			wait_pyramid(multi_gee);
+
 			/* remove device and frame from lists */
+			pthread_mutex_lock(&multi_gee->device_lock);
 			multi_gee->device =
 				sllist_remove_data(multi_gee->device,
 						device);
+			pthread_mutex_unlock(&multi_gee->device_lock);
 			multi_gee->frame =
 				add_frame(multi_gee->frame,
 					  multi_gee->device);
@@ -431,6 +935,95 @@ mg_deregister_device(multi_gee_t multi_gee,
 
 			mg_device_destroy(device);
 			ret = id;
+		} else if (multi_gee->hotplug
+			   && mg_hotplug_drop_lost(multi_gee->hotplug, id)) {
+			/* an unplugged camera is not to come back */
+			ret = id;
+		}
+	}
+
+	return ret;
+}
+
+void
+mg_frameset_parallel_for(multi_gee_t multi_gee,
+			 sllist_t frame_list,
+			 void (*fn)(mg_frame_t frame, void *arg),
+			 void *arg)
+{
+	VERIFY(multi_gee) {
+		unsigned int n = 0;
+		for (sllist_t f = frame_list; f; f = sllist_next(f)) {
+			n++;
+		}
+		if (!n || !fn) {
+			return;
+		}
+
+		start_workers(multi_gee);
+
+		struct frame_job job[n];
+		struct mg_task task[n];
+		unsigned int i = 0;
+		for (sllist_t f = frame_list; f; f = sllist_next(f), i++) {
+			job[i].frame = sllist_data(f);
+			job[i].fn = fn;
+			job[i].arg = arg;
+			task[i].run = run_frame;
+			task[i].arg = &job[i];
+			task[i].worker = multi_gee->workers
+				? pick_worker(multi_gee,
+					      mg_frame_get_device(job[i].frame))
+				: 0;
+		}
+
+		if (multi_gee->workers) {
+			mg_workers_run(multi_gee->workers, task, n);
+		} else {
+			for (i = 0; i < n; i++) {
+				run_frame(&job[i]);
+			}
+		}
+	}
+}
+
+struct timeval
+mg_get_first_frameset_time(multi_gee_t multi_gee)
+{
+	struct timeval tv = {0, 0};
+
+	VERIFY(multi_gee) {
+		tv = multi_gee->first_frameset;
+	}
+
+	return tv;
+}
+
+int
+mg_park_device(multi_gee_t multi_gee,
+	       int id)
+{
+	int ret = -1;
+
+	VERIFY(multi_gee) {
+		mg_device_t device = find_device_fd(multi_gee->device, id);
+		if (device) {
+			wait_pyramid(multi_gee);
+		}
+
+		/* a device still streaming stays registered */
+		if (device && fg_stop_capture(device, multi_gee->log)) {
+			/* out of sync, but open, configured and mapped */
+			pthread_mutex_lock(&multi_gee->device_lock);
+			multi_gee->device =
+				sllist_remove_data(multi_gee->device, device);
+			pthread_mutex_unlock(&multi_gee->device_lock);
+			multi_gee->frame =
+				add_frame(multi_gee->frame, multi_gee->device);
+
+			multi_gee->parked =
+				sllist_insert_data(multi_gee->parked, device);
+			ret = id;
 		}
 	}
 
@@ -457,6 +1050,15 @@ int
 mg_register_device(multi_gee_t multi_gee,
 		   const char *name,
 		   void *userptr)
+{
+	return mg_register_device_special(multi_gee, name, userptr, 0);
+}
+
+int
+mg_register_device_special(multi_gee_t multi_gee,
+			   const char *name,
+			   void *userptr,
+			   mg_config_t config)
 {
 	int ret = -1;
 
@@ -466,10 +1068,22 @@ mg_register_device(multi_gee_t multi_gee,
 						   multi_gee->log,
 						   userptr);
 
+		mg_device_t parked = find_device_number(multi_gee->parked,
+							mg_device_get_devno(dev));
+
 		/* can device be registered? */
 		if (mg_device_get_devno(dev) == makedev(-1, -1)) {
 			dev = mg_device_destroy(dev);
 			ret = -1;
+		} else if (parked && !config) {
+			/* ready to go, only streaming needs to restart */
+			dev = mg_device_destroy(dev);
+			mg_device_set_userptr(parked, userptr);
+			ret = mg_unpark_device(multi_gee,
+					       mg_device_get_fd(parked));
+		} else if (parked) {
+			/* a new configuration needs a fresh start */
+			mg_deregister_device(multi_gee, mg_device_get_fd(parked));
 		} else {
 			/* is device already registered? */
 			mg_device_t dup =
@@ -483,6 +1097,10 @@ mg_register_device(multi_gee_t multi_gee,
 
 		/* try to start capture on device */
 		if (dev) {
+			if (config) {
+				mg_device_set_config(dev, config);
+			}
+
 			ret = mg_device_open(dev);
 			if (-1 != ret) {
 				ret = mg_device_get_fd(dev);
@@ -492,15 +1110,18 @@ mg_register_device(multi_gee_t multi_gee,
 				if (!fg_init_device(dev,
 						    multi_gee->log)) {
 					ret = -1;
-				} else if (!fg_start_capture(dev,
-							     multi_gee->log)) {
+				} else if (!multi_gee->paused
+					   && !fg_start_capture(dev,
+								multi_gee->log)) {
 					ret = -1;
 				}
 			}
 
 			if (-1 != ret) {
 				/* everything OK, add it to device list */
+				pthread_mutex_lock(&multi_gee->device_lock);
 				multi_gee->device = sllist_insert_data(multi_gee->device, dev);
+				pthread_mutex_unlock(&multi_gee->device_lock);
 				multi_gee->frame =
 					add_frame(multi_gee->frame,
 						  multi_gee->device);
@@ -514,11 +1135,323 @@ mg_register_device(multi_gee_t multi_gee,
 	return ret;
 }
 
-sllist_t
-add_frame(sllist_t frame,
-	  sllist_t device)
+unsigned int
+mg_register_devices(multi_gee_t multi_gee,
+		    unsigned int n,
+		    const char *const device_name[],
+		    void *const userptr[],
+		    const mg_config_t config[],
+		    int id[])
 {
-	sllist_t list = 0;
+	unsigned int count = 0;
+
+	VERIFY(multi_gee) {
+		struct init_job *job = MALLOC(n * sizeof(*job));
+		struct timeval start;
+		struct timeval opened;
+		struct timeval streaming;
+
+		/* phase 1: identify, skipping duplicates */
+		gettimeofday(&start, 0);
+		for (unsigned int i = 0; i < n; i++) {
+			id[i] = -1;
+			job[i].log = multi_gee->log;
+			job[i].threaded = false;
+			job[i].ok = false;
+			job[i].elapsed.tv_sec = 0;
+			job[i].elapsed.tv_usec = 0;
+			job[i].device = mg_device_create(device_name[i],
+							 multi_gee->num_bufs,
+							 multi_gee->log,
+							 userptr ? userptr[i] : 0);
+
+			dev_t devno = mg_device_get_devno(job[i].device);
+			mg_device_t dup = find_device_number(multi_gee->device,
+							     devno);
+			mg_device_t parked = find_device_number(multi_gee->parked,
+								devno);
+			bool twice = false;
+			for (unsigned int j = 0; j < i; j++) {
+				twice = twice || (job[j].device
+					&& mg_device_get_devno(job[j].device)
+					== devno);
+			}
+			if (devno == makedev(-1, -1)) {
+				job[i].device = mg_device_destroy(job[i].device);
+			} else if (parked && !(config && config[i])) {
+				/* ready to go, only streaming needs to restart */
+				mg_device_destroy(job[i].device);
+				mg_device_set_userptr(parked,
+						      userptr ? userptr[i] : 0);
+				multi_gee->parked =
+					sllist_remove_data(multi_gee->parked, parked);
+				job[i].device = parked;
+				job[i].ok = true;
+				continue;
+			} else if (parked) {
+				/* a new configuration needs a fresh start */
+				mg_deregister_device(multi_gee,
+						     mg_device_get_fd(parked));
+			} else if (dup) {
+				/* already registered */
+				id[i] = mg_device_get_fd(dup);
+				job[i].device = mg_device_destroy(job[i].device);
+			} else if (twice) {
+				lg_log(multi_gee->log, "%s listed twice",
+				       device_name[i]);
+				job[i].device = mg_device_destroy(job[i].device);
+			}
+			if (job[i].device && config && config[i]) {
+				mg_device_set_config(job[i].device, config[i]);
+			}
+		}
+
+		/* phase 2: open and initialise in parallel */
+		for (unsigned int i = 0; i < n; i++) {
+			bool init = job[i].device && !job[i].ok;
+			job[i].threaded = init
+				&& !pthread_create(&job[i].thread, 0,
+						   init_device, &job[i]);
+			if (init && !job[i].threaded) {
+				init_device(&job[i]);
+			}
+		}
+		for (unsigned int i = 0; i < n; i++) {
+			if (job[i].threaded) {
+				pthread_join(job[i].thread, 0);
+			}
+		}
+		gettimeofday(&opened, 0);
+
+		/* phase 3: start streaming back to back */
+		if (!multi_gee->paused) {
+			for (unsigned int i = 0; i < n; i++) {
+				if (job[i].ok) {
+					fg_queue_buffers(job[i].device,
+							 multi_gee->log);
+				}
+			}
+			for (unsigned int i = 0; i < n; i++) {
+				if (job[i].ok
+				    && !fg_stream_on(job[i].device,
+						     multi_gee->log)) {
+					fg_uninit_device(job[i].device,
+							 multi_gee->log);
+					job[i].ok = false;
+				}
+			}
+		}
+		gettimeofday(&streaming, 0);
+
+		for (unsigned int i = 0; i < n; i++) {
+			mg_device_t dev = job[i].device;
+			if (job[i].ok) {
+				pthread_mutex_lock(&multi_gee->device_lock);
+				multi_gee->device =
+					sllist_insert_data(multi_gee->device, dev);
+				pthread_mutex_unlock(&multi_gee->device_lock);
+				id[i] = mg_device_get_fd(dev);
+				lg_log(multi_gee->log, "%s initialised in %ld.%06ld",
+				       device_name[i],
+				       job[i].elapsed.tv_sec,
+				       job[i].elapsed.tv_usec);
+			} else if (dev) {
+				lg_log(multi_gee->log, "cannot register %s",
+				       device_name[i]);
+				mg_device_destroy(dev);
+			}
+			if (-1 != id[i]) {
+				count++;
+			}
+		}
+		multi_gee->frame = add_frame(multi_gee->frame, multi_gee->device);
+
+		timersub(&streaming, &opened, &streaming);
+		timersub(&opened, &start, &opened);
+		lg_log(multi_gee->log,
+		       "registered %u of %u devices: "
+		       "open and init %ld.%06ld, stream on %ld.%06ld",
+		       count, n,
+		       opened.tv_sec, opened.tv_usec,
+		       streaming.tv_sec, streaming.tv_usec);
+
+		FREEOBJ(job);
+	}
+
+	return count;
+}
+
+bool
+mg_set_background(multi_gee_t multi_gee,
+		  int id,
+		  mg_background_t background)
+{
+	bool ok = false;
+
+	VERIFY(multi_gee) {
+		mg_device_t device = find_device_fd(multi_gee->device, id);
+		if (device) {
+			/* the worker may be using the old model */
+			wait_pyramid(multi_gee);
+			mg_device_set_background(device, background);
+			ok = true;
+		}
+	}
+
+	return ok;
+}
+
+bool
+mg_set_buffer_bounds(multi_gee_t multi_gee,
+		     unsigned int min_bufs,
+		     unsigned int max_bufs)
+{
+	bool ok = false;
+
+	VERIFY(multi_gee) {
+		if (2 <= min_bufs && min_bufs <= max_bufs) {
+			multi_gee->min_bufs = min_bufs;
+			multi_gee->max_bufs = max_bufs;
+
+			/* devices registered from now on start in bounds */
+			if (multi_gee->num_bufs < min_bufs) {
+				multi_gee->num_bufs = min_bufs;
+			} else if (multi_gee->num_bufs > max_bufs) {
+				multi_gee->num_bufs = max_bufs;
+			}
+			ok = true;
+		}
+	}
+
+	return ok;
+}
+
+bool
+mg_set_control(multi_gee_t multi_gee,
+	       int id,
+	       uint32_t control,
+	       int32_t value)
+{
+	bool ok = false;
+
+	VERIFY(multi_gee) {
+		/* the capture thread may be removing the device */
+		pthread_mutex_lock(&multi_gee->device_lock);
+		mg_device_t device = find_device_fd(multi_gee->device, id);
+		if (device) {
+			ok = 0 != mg_device_queue_control(device, control, value);
+		}
+		pthread_mutex_unlock(&multi_gee->device_lock);
+	}
+
+	return ok;
+}
+
+bool
+mg_set_roi(multi_gee_t multi_gee,
+	   int id,
+	   struct mg_rect roi)
+{
+	bool ok = false;
+
+	VERIFY(multi_gee) {
+		pthread_mutex_lock(&multi_gee->device_lock);
+		mg_device_t device = find_device_fd(multi_gee->device, id);
+		if (device) {
+			mg_device_queue_roi(device, roi);
+			ok = true;
+		}
+		pthread_mutex_unlock(&multi_gee->device_lock);
+	}
+
+	return ok;
+}
+
+bool
+mg_set_search_windows(multi_gee_t multi_gee,
+		      int id,
+		      const struct mg_rect *window,
+		      unsigned int num_windows)
+{
+	bool ok = false;
+
+	VERIFY(multi_gee) {
+		pthread_mutex_lock(&multi_gee->device_lock);
+		mg_device_t device = find_device_fd(multi_gee->device, id);
+		if (device) {
+			ok = (0 != mg_device_set_windows(device, window,
+							  num_windows));
+		}
+		pthread_mutex_unlock(&multi_gee->device_lock);
+	}
+
+	return ok;
+}
+
+bool
+mg_set_workers(multi_gee_t multi_gee,
+	       unsigned int num_workers)
+{
+	bool ok = false;
+
+	VERIFY(multi_gee) {
+		multi_gee->num_workers = num_workers;
+		ok = true;
+	}
+
+	return ok;
+}
+
+int
+mg_unpark_device(multi_gee_t multi_gee,
+		 int id)
+{
+	int ret = -1;
+
+	VERIFY(multi_gee) {
+		mg_device_t device = find_device_fd(multi_gee->parked, id);
+
+		/* streaming is restarted with the rest when paused */
+		if (device && (multi_gee->paused
+			       || fg_start_capture(device, multi_gee->log))) {
+			multi_gee->parked =
+				sllist_remove_data(multi_gee->parked, device);
+			pthread_mutex_lock(&multi_gee->device_lock);
+			multi_gee->device =
+				sllist_insert_data(multi_gee->device, device);
+			pthread_mutex_unlock(&multi_gee->device_lock);
+			multi_gee->frame =
+				add_frame(multi_gee->frame, multi_gee->device);
+			ret = id;
+		}
+	}
+
+	return ret;
+}
+
+bool
+mg_watch_devices(multi_gee_t multi_gee,
+		 const char *dir)
+{
+	bool ok = false;
+
+	VERIFY(multi_gee) {
+		if (!multi_gee->hotplug) {
+			multi_gee->hotplug = mg_hotplug_create(dir ? dir : "/dev",
+							       multi_gee->num_bufs,
+							       multi_gee->log);
+		}
+		ok = 0 != multi_gee->hotplug;
+	}
+
+	return ok;
+}
+
+sllist_t
+add_frame(sllist_t frame,
+	  sllist_t device)
+{
+	sllist_t list = 0;
 
 	for (sllist_t d = device; d; d = sllist_next(d)) {
 		mg_device_t dev = sllist_data(d);
@@ -541,6 +1474,50 @@ add_frame(sllist_t frame,
 	return list;
 }
 
+void
+apply_controls(multi_gee_t multi_gee)
+{
+	for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
+		mg_device_t dev = sllist_data(d);
+		struct mg_control control[MAX_CONTROLS];
+		unsigned int n = mg_device_take_controls(dev, control,
+							 MAX_CONTROLS);
+		if (!n) {
+			continue;
+		}
+
+		uint32_t sequence = last_sequence(dev) + 2;
+		if (!fg_set_controls(dev, control, n, sequence,
+				     multi_gee->log)) {
+			lg_log(multi_gee->log, "cannot set controls on %s",
+			       mg_device_get_name(dev));
+		}
+	}
+}
+
+void
+apply_rois(multi_gee_t multi_gee)
+{
+	for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
+		mg_device_t dev = sllist_data(d);
+		struct mg_rect roi;
+		if (!mg_device_take_roi(dev, &roi)) {
+			continue;
+		}
+
+		/* only a crop of the same image size relies on the estimate */
+		mg_buffer_t dev_buf = mg_device_get_buffer(dev);
+		uint32_t sequence = last_sequence(dev)
+			+ mg_buffer_get_count(dev_buf, MG_BUFFER_QUEUED) + 1;
+
+		if (!fg_set_roi(dev, roi, sequence, multi_gee->log)) {
+			lg_log(multi_gee->log,
+			       "cannot set region of interest on %s",
+			       mg_device_get_name(dev));
+		}
+	}
+}
+
 mg_device_t
 find_device_fd(sllist_t list,
 	       int fd)
@@ -583,14 +1560,465 @@ find_frame_device(sllist_t list,
 	return 0;
 }
 
+void
+flush_frames(multi_gee_t multi_gee)
+{
+	for (sllist_t f = multi_gee->frame; f; f = sllist_next(f)) {
+		mg_frame_t frame = sllist_data(f);
+		int index = mg_frame_get_index(frame);
+		if (0 <= index) {
+			mg_device_t dev = mg_frame_get_device(frame);
+			fg_enqueue(dev, index, multi_gee->log);
+		}
+	}
+
+	multi_gee->frame = add_frame(multi_gee->frame, 0);
+	multi_gee->frame = add_frame(0, multi_gee->device);
+
+	for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
+		/* ignore failures, sync_test() catches a starved device */
+		fg_drain(sllist_data(d), multi_gee->log);
+	}
+}
+
+void
+grow_buffers(multi_gee_t multi_gee,
+	     mg_device_t dev,
+	     unsigned int need)
+{
+	mg_buffer_t dev_buf = mg_device_get_buffer(dev);
+	unsigned int active = mg_buffer_get_active(dev_buf);
+	unsigned int retiring = mg_buffer_get_retiring(dev_buf);
+
+	while (retiring && active - retiring < need) {
+		retiring--;
+	}
+	mg_buffer_set_retiring(dev_buf, retiring);
+
+	unsigned int bufs = mg_buffer_get_number(dev_buf);
+	for (unsigned int i = 0; i < bufs && active - retiring < need; i++) {
+		if (MG_BUFFER_RETIRED == mg_buffer_get_state(dev_buf, i)
+		    && fg_enqueue(dev, i, multi_gee->log)) {
+			active++;
+		}
+	}
+
+	if (active - retiring < need) {
+		unsigned int count = need - (active - retiring);
+		if (!fg_create_buffers(dev, count, multi_gee->log)) {
+			/* do not try again on every frameset */
+			lg_log(multi_gee->log,
+			       "cannot add buffers to %s, keeping %u",
+			       mg_device_get_name(dev),
+			       mg_buffer_get_active(dev_buf));
+			mg_buffer_set_limit(dev_buf,
+					    mg_buffer_get_active(dev_buf));
+			return;
+		}
+	}
+
+	lg_log(multi_gee->log, "%s has %u buffers",
+	       mg_device_get_name(dev),
+	       mg_buffer_get_active(dev_buf) - retiring);
+}
+
+void *
+init_device(void *arg)
+{
+	struct init_job *job = arg;
+	struct timeval start;
+	struct timeval end;
+
+	gettimeofday(&start, 0);
+	job->ok = -1 != mg_device_open(job->device)
+		&& fg_init_device(job->device, job->log);
+	gettimeofday(&end, 0);
+	timersub(&end, &start, &job->elapsed);
+
+	return 0;
+}
+
+void
+join_devices(multi_gee_t multi_gee)
+{
+	if (!multi_gee->hotplug) {
+		return;
+	}
+
+	mg_hotplug_poll(multi_gee->hotplug, known_device, multi_gee);
+
+	mg_device_t dev;
+	while ((dev = mg_hotplug_take(multi_gee->hotplug))) {
+		if (known_device(multi_gee, mg_device_get_devno(dev))
+		    || (!multi_gee->paused
+			&& !fg_start_capture(dev, multi_gee->log))) {
+			fg_uninit_device(dev, multi_gee->log);
+			mg_device_destroy(dev);
+			continue;
+		}
+
+		pthread_mutex_lock(&multi_gee->device_lock);
+		multi_gee->device = sllist_insert_data(multi_gee->device, dev);
+		pthread_mutex_unlock(&multi_gee->device_lock);
+		multi_gee->frame = add_frame(multi_gee->frame, multi_gee->device);
+		mg_hotplug_found(multi_gee->hotplug, dev);
+		lg_log(multi_gee->log, "%s joined as device %d",
+		       mg_device_get_name(dev),
+		       mg_device_get_fd(dev));
+	}
+}
+
+bool
+known_device(void *arg,
+	     dev_t devno)
+{
+	multi_gee_t multi_gee = arg;
+
+	return find_device_number(multi_gee->device, devno)
+		|| find_device_number(multi_gee->parked, devno);
+}
+
+bool
+lose_devices(multi_gee_t multi_gee)
+{
+	if (!multi_gee->hotplug) {
+		return false;
+	}
+
+	sllist_t lost = 0;
+	for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
+		mg_device_t dev = sllist_data(d);
+		if (!fg_present(dev)) {
+			lost = sllist_insert_data(lost, dev);
+		}
+	}
+	if (!lost) {
+		return false;
+	}
+
+	wait_pyramid(multi_gee);
+	pthread_mutex_lock(&multi_gee->device_lock);
+	for (sllist_t d = lost; d; d = sllist_next(d)) {
+		multi_gee->device =
+			sllist_remove_data(multi_gee->device, sllist_data(d));
+	}
+	pthread_mutex_unlock(&multi_gee->device_lock);
+	multi_gee->frame = add_frame(multi_gee->frame, multi_gee->device);
+
+	for (sllist_t d = lost; d; d = sllist_next(d)) {
+		mg_device_t dev = sllist_data(d);
+		lg_log(multi_gee->log, "%s unplugged",
+		       mg_device_get_name(dev));
+
+		/* the rule keeps the identifier from other devices */
+		fg_uninit_device(dev, multi_gee->log);
+		mg_hotplug_add_lost(multi_gee->hotplug, dev);
+		mg_device_destroy(dev);
+	}
+	lost = sllist_empty(lost);
+
+	/* the remaining devices get a full period to get in sync */
+	gettimeofday(&multi_gee->last_sync, 0);
+
+	return true;
+}
+
+uint32_t
+last_sequence(mg_device_t dev)
+{
+	mg_buffer_t dev_buf = mg_device_get_buffer(dev);
+	unsigned int bufs = mg_buffer_get_number(dev_buf);
+	uint32_t sequence = 0;
+	for (unsigned int i = 0; i < bufs; i++) {
+		uint32_t s = mg_buffer_get_sequence(dev_buf, i);
+		if (s > sequence) {
+			sequence = s;
+		}
+	}
+
+	return sequence;
+}
+
+unsigned int
+pick_worker(multi_gee_t multi_gee,
+	    mg_device_t device)
+{
+	unsigned int count = mg_workers_get_count(multi_gee->workers);
+	int worker = mg_device_get_worker(device);
+	if (0 <= worker && (unsigned int) worker < count) {
+		return worker;
+	}
+
+	unsigned int load[count];
+	for (unsigned int w = 0; w < count; w++) {
+		load[w] = 0;
+	}
+	for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
+		int w = mg_device_get_worker(sllist_data(d));
+		if (0 <= w && (unsigned int) w < count) {
+			load[w]++;
+		}
+	}
+
+	unsigned int least = 0;
+	for (unsigned int w = 1; w < count; w++) {
+		if (load[w] < load[least]) {
+			least = w;
+		}
+	}
+	mg_device_set_worker(device, least);
+
+	return least;
+}
+
+void
+post_pyramid(multi_gee_t multi_gee)
+{
+	sllist_t job = 0;
+	for (sllist_t f = multi_gee->frame; f; f = sllist_next(f)) {
+		mg_frame_t frame = sllist_data(f);
+		mg_device_t dev = mg_frame_get_device(frame);
+		if (0 <= mg_frame_get_index(frame)
+		    && (mg_config_get_pyramid(mg_device_get_config(dev))
+			|| mg_config_get_stats(mg_device_get_config(dev))
+			|| mg_device_get_background(dev))) {
+			job = sllist_insert_data(job, frame);
+		}
+	}
+	if (!job) {
+		return;
+	}
+
+	if (!multi_gee->pyramid_running) {
+		int err = pthread_create(&multi_gee->pyramid, 0,
+					 pyramid_worker, multi_gee);
+		if (err) {
+			/* levels are built on first use instead */
+			errno = err;
+			lg_errno(multi_gee->log, "cannot start pyramid worker");
+			sllist_empty(job);
+			return;
+		}
+		multi_gee->pyramid_running = true;
+	}
+
+	pthread_mutex_lock(&multi_gee->pyramid_lock);
+	multi_gee->pyramid_job = job;
+	pthread_cond_broadcast(&multi_gee->pyramid_cond);
+	pthread_mutex_unlock(&multi_gee->pyramid_lock);
+}
+
+void *
+pyramid_worker(void *arg)
+{
+	multi_gee_t multi_gee = arg;
+
+	pthread_mutex_lock(&multi_gee->pyramid_lock);
+	for (;;) {
+		while (!multi_gee->pyramid_job && !multi_gee->pyramid_stop) {
+			pthread_cond_wait(&multi_gee->pyramid_cond,
+					  &multi_gee->pyramid_lock);
+		}
+		if (!multi_gee->pyramid_job) {
+			break;
+		}
+		sllist_t job = multi_gee->pyramid_job;
+		pthread_mutex_unlock(&multi_gee->pyramid_lock);
+
+		/* images the callback asks for first are made there */
+		for (sllist_t f = job; f; f = sllist_next(f)) {
+			mg_frame_t frame = sllist_data(f);
+			mg_device_t dev = mg_frame_get_device(frame);
+			if (mg_device_get_background(dev)) {
+				mg_frame_get_foreground(frame);
+			}
+			mg_config_t config = mg_device_get_config(dev);
+			mg_frame_get_level(frame, mg_config_get_pyramid(config));
+			if (mg_config_get_stats(config)) {
+				mg_frame_get_stats(frame);
+			}
+		}
+
+		pthread_mutex_lock(&multi_gee->pyramid_lock);
+		multi_gee->pyramid_job = sllist_empty(job);
+		pthread_cond_broadcast(&multi_gee->pyramid_cond);
+	}
+	pthread_mutex_unlock(&multi_gee->pyramid_lock);
+
+	return 0;
+}
+
+void
+resize_buffers(multi_gee_t multi_gee,
+	       struct timeval *start,
+	       struct timeval *end)
+{
+	if (multi_gee->min_bufs == multi_gee->max_bufs) {
+		return;
+	}
+
+	/*
+	 * the period follows from the buffers rather than from when the
+	 * callbacks ran, as frames queued up during an overrun are handed
+	 * over back to back.  dropped frames show as sequence gaps.
+	 */
+	struct timeval tv;
+	mg_frame_t frame = multi_gee->period_device
+		? find_frame_device(multi_gee->frame, multi_gee->period_device)
+		: 0;
+	if (!frame) {
+		/* measure on the first device with a frame, while it stays */
+		for (sllist_t f = multi_gee->frame; f; f = sllist_next(f)) {
+			if (0 <= mg_frame_get_index(sllist_data(f))) {
+				frame = sllist_data(f);
+				multi_gee->period_device = mg_frame_get_device(frame);
+				timerclear(&multi_gee->period_stamp);
+				break;
+			}
+		}
+	}
+	if (frame && 0 <= mg_frame_get_index(frame)) {
+		struct timeval stamp = mg_frame_get_timestamp(frame);
+		uint32_t sequence = mg_frame_get_sequence(frame);
+		if (timerisset(&multi_gee->period_stamp)
+		    && sequence > multi_gee->period_sequence) {
+			timersub(&stamp, &multi_gee->period_stamp, &tv);
+			long us = (tv.tv_sec * 1000000 + tv.tv_usec)
+				/ (long) (sequence - multi_gee->period_sequence);
+			if (0 < us) {
+				multi_gee->frame_period.tv_sec = us / 1000000;
+				multi_gee->frame_period.tv_usec = us % 1000000;
+			}
+		}
+		multi_gee->period_stamp = stamp;
+		multi_gee->period_sequence = sequence;
+	}
+
+	if (!timerisset(&multi_gee->frame_period)) {
+		return;
+	}
+
+	timersub(end, start, &tv);
+	if (timercmp(&tv, &multi_gee->max_callback, >)) {
+		multi_gee->max_callback = tv;
+	}
+	if (timercmp(&tv, &multi_gee->frame_period, >)) {
+		multi_gee->overruns++;
+	}
+
+	long period = multi_gee->frame_period.tv_sec * 1000000
+		+ multi_gee->frame_period.tv_usec;
+	long duration = tv.tv_sec * 1000000 + tv.tv_usec;
+	unsigned int need = (duration + period - 1) / period + 2;
+	if (need < multi_gee->min_bufs) {
+		need = multi_gee->min_bufs;
+	} else if (need > multi_gee->max_bufs) {
+		need = multi_gee->max_bufs;
+	}
+
+	for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
+		mg_device_t dev = sllist_data(d);
+		mg_buffer_t dev_buf = mg_device_get_buffer(dev);
+		unsigned int limit = mg_buffer_get_limit(dev_buf);
+		unsigned int want = (limit && need > limit) ? limit : need;
+		if (mg_buffer_get_active(dev_buf)
+		    - mg_buffer_get_retiring(dev_buf) < want) {
+			grow_buffers(multi_gee, dev, want);
+		}
+	}
+
+	if (++multi_gee->window < RESIZE_WINDOW) {
+		return;
+	}
+
+	duration = multi_gee->max_callback.tv_sec * 1000000
+		+ multi_gee->max_callback.tv_usec;
+	need = (duration + period - 1) / period + 2;
+	if (need < multi_gee->min_bufs) {
+		need = multi_gee->min_bufs;
+	}
+
+	if (multi_gee->overruns) {
+		lg_log(multi_gee->log,
+		       "%u of %u callbacks overran the frame period",
+		       multi_gee->overruns,
+		       multi_gee->window);
+	}
+
+	/* retire buffers as they come back from the frame list */
+	for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
+		mg_buffer_t dev_buf = mg_device_get_buffer(sllist_data(d));
+		unsigned int retiring = mg_buffer_get_retiring(dev_buf);
+		if (mg_buffer_get_active(dev_buf) - retiring > need) {
+			mg_buffer_set_retiring(dev_buf, retiring + 1);
+		}
+	}
+
+	timerclear(&multi_gee->max_callback);
+	multi_gee->window = 0;
+	multi_gee->overruns = 0;
+}
+
+void
+resume_capture(multi_gee_t multi_gee)
+{
+	for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
+		mg_device_t dev = sllist_data(d);
+		if (!fg_start_capture(dev, multi_gee->log)) {
+			lg_log(multi_gee->log, "cannot restart %s",
+			       mg_device_get_name(dev));
+		}
+	}
+
+	multi_gee->paused = false;
+}
+
+void
+run_frame(void *arg)
+{
+	struct frame_job *job = arg;
+
+	job->fn(job->frame, job->arg);
+}
+
+void
+start_workers(multi_gee_t multi_gee)
+{
+	unsigned int n = multi_gee->num_workers;
+	if (!n) {
+		for (sllist_t d = multi_gee->device; d; d = sllist_next(d)) {
+			n++;
+		}
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		if (cpus > 0 && n > (unsigned long) cpus) {
+			n = cpus;
+		}
+		if (!n) {
+			n = 1;
+		}
+	}
+
+	/* a pool that failed to start is not retried every frameset */
+	if (n == multi_gee->workers_for) {
+		return;
+	}
+	multi_gee->workers_for = n;
+
+	/* devices keep their worker if the new pool still has it */
+	multi_gee->workers = mg_workers_destroy(multi_gee->workers);
+	multi_gee->workers = mg_workers_create(n, multi_gee->log);
+	if (multi_gee->workers) {
+		lg_log(multi_gee->log, "%u frameset workers",
+		       mg_workers_get_count(multi_gee->workers));
+	}
+}
+
 bool
 swap_frame(multi_gee_t multi_gee,
 	   mg_device_t dev)
 {
-	int fd = mg_device_get_fd(dev);
-
 	struct v4l2_buffer buf;
-	if (!fg_dequeue(fd, &buf, multi_gee->log)) {
+	if (!fg_dequeue(dev, &buf, multi_gee->log)) {
 		return false;
 	}
 
@@ -600,10 +2028,20 @@ swap_frame(multi_gee_t multi_gee,
 			mg_frame_t frame = sllist_data(f);
 			if (mg_frame_get_device(frame) == dev) {
 				int index = mg_frame_get_index(frame);
-				if (0 <= index) {
-					if (!fg_enqueue(mg_device_get_fd(dev), index, multi_gee->log)) {
-						return false;
-					}
+				unsigned int retiring =
+					mg_buffer_get_retiring(dev_buf);
+				if (0 > index) {
+					/* no buffer held */
+				} else if (retiring) {
+					/* take the buffer out of circulation */
+					mg_buffer_set_state(dev_buf, index,
+							    MG_BUFFER_RETIRED);
+					mg_buffer_set_retiring(dev_buf, retiring - 1);
+					lg_log(multi_gee->log, "%s has %u buffers",
+					       mg_device_get_name(dev),
+					       mg_buffer_get_active(dev_buf));
+				} else if (!fg_enqueue(dev, index, multi_gee->log)) {
+					return false;
 				}
 
 				multi_gee->frame =
@@ -654,7 +2092,7 @@ sync_select(multi_gee_t multi_gee,
 		if (0 == ret) {
 			/* select timeout */
 			lg_log(multi_gee->log, "wait too long for frame");
-			sync = SYNC_FATAL;
+			sync = lose_devices(multi_gee) ? SYNC_FAIL : SYNC_FATAL;
 		}
 
 		break;
@@ -728,6 +2166,17 @@ sync_test(multi_gee_t multi_gee)
 	return sync;
 }
 
+void
+wait_pyramid(multi_gee_t multi_gee)
+{
+	pthread_mutex_lock(&multi_gee->pyramid_lock);
+	while (multi_gee->pyramid_job) {
+		pthread_cond_wait(&multi_gee->pyramid_cond,
+				  &multi_gee->pyramid_lock);
+	}
+	pthread_mutex_unlock(&multi_gee->pyramid_lock);
+}
+
 #ifdef TEST_MULTI_GEE_MULTI_GEE
 
 #include <stdio.h>
@@ -782,13 +2231,12 @@ process_images(multi_gee_t mg, sllist_t frame_list)
 	static int dev_id = -1;
 	if (count % 1 == 0) {
 		static bool flag = true;
+		/* switch cameras; parked ones come back within a frame */
 		if (flag) {
-			printf("deregister %d\n",
-			       mg_deregister_device(mg, dev_id));
+			printf("park %d\n", mg_park_device(mg, dev_id));
 			dev_id = register_device(mg, 3);
 		} else {
-			printf("deregister %d\n",
-			       mg_deregister_device(mg, dev_id));
+			printf("park %d\n", mg_park_device(mg, dev_id));
 			dev_id = register_device(mg, 4);
 		}
 		flag = !flag;
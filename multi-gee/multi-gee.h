@@ -26,6 +26,7 @@
 
 #include <multi-gee/sllist.h>
 #include <multi-gee/mg_buffer.h>
+#include <multi-gee/mg_config.h>
 #include <multi-gee/mg_device.h>
 #include <multi-gee/mg_frame.h>
 
@@ -125,6 +126,31 @@ mg_create_special(const char *file_name,
 multi_gee_t
 mg_destroy(multi_gee_t multi_gee);
 
+/**
+ * @brief Add a rule for a camera to join when it is plugged in
+ *
+ * a camera that is unplugged while capturing leaves the frame list and
+ * gets a rule of its own, so it rejoins when it is plugged in again.
+ * explicit rules add cameras that are not plugged in yet.  a camera
+ * that joins gets a new device identifier.
+ *
+ * @param multi_gee  object handle
+ * @param devno  device number to match, or 0 to match any
+ * @param bus_info  bus information to match, as VIDIOC_QUERYCAP reports
+ * it, or 0 to match any
+ * @param userptr  user defined pointer of the camera
+ * @param config  capture configuration of the camera, copied, or 0 for
+ * the default configuration
+ *
+ * @return \c true on success, \c false if devices are not watched
+ */
+bool
+mg_add_device_rule(multi_gee_t multi_gee,
+		   dev_t devno,
+		   const char *bus_info,
+		   void *userptr,
+		   mg_config_t config);
+
 /**
  * @brief Error return values for mg_capture
  */
@@ -157,9 +183,49 @@ mg_capture(multi_gee_t multi_gee,
 void
 mg_capture_halt(multi_gee_t multi_gee);
 
+/**
+ * @brief Pause streaming between capture runs
+ *
+ * stops streaming on all registered devices, so that no stale frames
+ * accumulate in the capture buffers while the application is not
+ * capturing.  the next call to mg_capture() restarts streaming.  if
+ * capture is not paused, mg_capture() instead drains the frames that
+ * were captured since the previous run.  either way the first frameset
+ * passed to the callback function holds fresh frames.
+ *
+ * @param multi_gee  object handle
+ *
+ * @return \c true on success, \c false if called while mg_capture()
+ * is in progress
+ */
+bool
+mg_capture_pause(multi_gee_t multi_gee);
+
+/**
+ * @brief Check for leaked capture buffers
+ *
+ * a buffer is leaked if it is lost, if it is held but not by the frame
+ * list, or if it is idle while streaming.  leaked buffers shrink the
+ * pool until the driver starves and sync is lost, so the check is also
+ * done when mg_capture() returns with RET_SYNC.  every leaked buffer is
+ * logged with the sequence number and time stamp of the last frame it
+ * held.
+ *
+ * @param multi_gee  object handle
+ *
+ * @return the number of leaked buffers, or -1 on failure
+ */
+int
+mg_check_buffers(multi_gee_t multi_gee);
+
 /**
  * @brief Deregister capture device
  *
+ * a watched camera that was unplugged is not brought back when it is
+ * plugged in again.  no other device gets its identifier while it is
+ * away.  once it has rejoined, under a new identifier, the old one
+ * names no device and may be handed out again.
+ *
  * @param multi_gee  object handle
  * @param device_id  device identifier
  *
@@ -171,6 +237,66 @@ int
 mg_deregister_device(multi_gee_t multi_gee,
 		     int device_id);
 
+/**
+ * @brief Process the frames of a frameset in parallel
+ *
+ * calls the function once per frame, on a pool of worker threads kept
+ * by the object, and returns when all frames are done; meant for
+ * per-camera work in the callback function.  the frames of a device go
+ * to the same worker every frameset, so the device's data stays in the
+ * cache of that worker's processor.  each worker is pinned to a
+ * processor, and devices are spread evenly over the workers.  the pool
+ * is started on first use, see mg_set_workers(); if it cannot be
+ * started, the frames are processed one after the other on the calling
+ * thread.  must not be called from the function itself.
+ *
+ * @param multi_gee  object handle
+ * @param frame_list  frames, as handed to the callback function
+ * @param fn  function to call per frame
+ * @param arg  argument passed on to the function
+ */
+void
+mg_frameset_parallel_for(multi_gee_t multi_gee,
+			 sllist_t frame_list,
+			 void (*fn)(mg_frame_t frame, void *arg),
+			 void *arg);
+
+/**
+ * @brief Time to first frameset accessor
+ *
+ * the time from entry into the last mg_capture() call to the first
+ * call of the callback function.  it is bounded by the sync failure
+ * criterion: if no frameset is in sync by then, mg_capture() returns
+ * with RET_SYNC.
+ *
+ * @param multi_gee  object handle
+ *
+ * @return time to first frameset, or zero if no frameset was captured
+ */
+struct timeval
+mg_get_first_frameset_time(multi_gee_t multi_gee);
+
+/**
+ * @brief Take a capture device out of sync, keeping it ready
+ *
+ * the device stops streaming and leaves the frame list, but stays
+ * open, configured and mapped.  mg_unpark_device(), or registering the
+ * same device again without a configuration, brings it back with only
+ * a buffer refill and VIDIOC_STREAMON.  mg_deregister_device() releases
+ * a parked device for good.  a device that cannot stop streaming stays
+ * registered.
+ *
+ * @param multi_gee  object handle
+ * @param device_id  device identifier
+ *
+ * @return status value:
+ *   -1 - failed to park device,
+ *   value >= 0 - device identifier of parked device
+ */
+int
+mg_park_device(multi_gee_t multi_gee,
+	       int device_id);
+
 /**
  * @brief Register callback function
  *
@@ -199,6 +325,227 @@ mg_register_device(multi_gee_t multi_gee,
 		   const char *device_name,
 		   void *userptr);
 
+/**
+ * @brief Register capture device with a capture configuration
+ *
+ * like mg_register_device(), but the capture format is negotiated with
+ * the given configuration instead of the defaults.  the negotiated
+ * format is available from mg_device_get_format().  a device that is
+ * already registered keeps its configuration.
+ *
+ * @param multi_gee  object handle
+ * @param device_name  device to register
+ * @param userptr  user defined pointer
+ * @param config  capture configuration, or 0 for the defaults
+ *
+ * @return status value:
+ *   -1 - failed to register device,
+ *   value >= 0 - device identifier
+ */
+int
+mg_register_device_special(multi_gee_t multi_gee,
+			   const char *device_name,
+			   void *userptr,
+			   mg_config_t config);
+
+/**
+ * @brief Register a number of capture devices at once
+ *
+ * the devices are opened and initialised in parallel, one thread per
+ * device, and then started streaming back to back, so that they start
+ * close together.  the time taken by each phase is logged.  devices
+ * that fail are left out; the others are registered regardless.
+ *
+ * @param multi_gee  object handle
+ * @param n  number of devices
+ * @param device_name  devices to register
+ * @param userptr  user defined pointer per device, or 0 for none
+ * @param config  capture configuration per device, or 0 for the
+ * defaults
+ * @param [out]id  device identifier per device, -1 for devices that
+ * failed to register
+ *
+ * @return number of devices registered
+ */
+unsigned int
+mg_register_devices(multi_gee_t multi_gee,
+		    unsigned int n,
+		    const char *const device_name[],
+		    void *const userptr[],
+		    const mg_config_t config[],
+		    int id[]);
+
+/**
+ * @brief Set the background model of a registered device
+ *
+ * every frame of the device is put through the model on the pyramid
+ * worker thread while the callback function runs, see
+ * mg_frame_get_foreground(), and the model learns from it.  the device
+ * takes the model over and destroys it when it is replaced or the
+ * device is deregistered; if the device is not registered, the model
+ * stays the caller's.  may be called from the callback function.
+ *
+ * @param multi_gee  object handle
+ * @param device_id  device identifier
+ * @param background  background model, or 0 for none
+ *
+ * @return \c true if the model was set, \c false if the device is not
+ * registered
+ */
+bool
+mg_set_background(multi_gee_t multi_gee,
+		  int device_id,
+		  mg_background_t background);
+
+/**
+ * @brief Set the bounds on the number of capture buffers
+ *
+ * while capturing, the number of capture buffers of every device is
+ * adjusted within these bounds.  buffers are added when the callback
+ * function holds on to a frameset for longer than the frame period, so
+ * that frames arriving in the meantime are not dropped.  buffers are
+ * retired again, one at a time, when the callback function has been
+ * quick for a while.  the bounds are equal by default, which disables
+ * the adjustment.
+ *
+ * @param multi_gee  object handle
+ * @param min_bufs  minimum number of buffers per device, at least 2
+ * @param max_bufs  maximum number of buffers per device
+ *
+ * @return \c true if the bounds were set, \c false if they are not
+ * valid
+ */
+bool
+mg_set_buffer_bounds(multi_gee_t multi_gee,
+		     unsigned int min_bufs,
+		     unsigned int max_bufs);
+
+/**
+ * @brief Queue a control change on a capture device
+ *
+ * changes such as exposure, gain or brightness are queued per device,
+ * and set with one VIDIOC_S_EXT_CTRLS per device between framesets, so
+ * they do not race with the capture loop.  a later change of the same
+ * control replaces a queued one.  the frame being captured when the
+ * change is set keeps the old value; mg_frame_get_control() tells
+ * which value a frame was captured with, and mg_device_get_control()
+ * from which sequence number a value is in effect.  may be called from
+ * any thread, also while the capture thread adds or removes devices.
+ *
+ * @param multi_gee  object handle
+ * @param device_id  device identifier
+ * @param control  video4linux2 control identifier, V4L2_CID_*
+ * @param value  new value
+ *
+ * @return \c true if the change was queued, \c false if the device is
+ * not registered
+ */
+bool
+mg_set_control(multi_gee_t multi_gee,
+	       int device_id,
+	       uint32_t control,
+	       int32_t value);
+
+/**
+ * @brief Set the region of interest of a device
+ *
+ * the region is applied between framesets, after the callback function
+ * returns, without stopping the stream.  where the hardware can crop to
+ * the region, less image data is captured; elsewhere the region is a
+ * view on the full frame.  either way mg_frame_get_view() returns the
+ * region, and mg_frame_get_roi() the region a frame was captured with.
+ * frames that were already being captured when the region changed keep
+ * the previous region.
+ *
+ * @param multi_gee  object handle
+ * @param device_id  device identifier
+ * @param roi  region of interest, in full frame coordinates, or a zero
+ * width for the full frame
+ *
+ * @return \c true if the region was queued, \c false if the device is
+ * not registered
+ */
+bool
+mg_set_roi(multi_gee_t multi_gee,
+	   int device_id,
+	   struct mg_rect roi);
+
+/**
+ * @brief Set the search windows of a registered device
+ *
+ * typically called from the callback function with a box around the
+ * predicted position of every tracked marker.  frames taken from the
+ * device after the call keep the windows, see mg_frame_get_windows(),
+ * and mg_frame_threshold() and the image pyramid only look inside them.
+ * every so many frames the full frame is searched instead, see
+ * mg_config_set_sweep().
+ *
+ * @param multi_gee  object handle
+ * @param device_id  device identifier
+ * @param window  search windows, in full frame coordinates
+ * @param num_windows  number of search windows, at most MG_MAX_WINDOWS,
+ * or 0 to search the full frame
+ *
+ * @return \c true if the windows were set, \c false if the device is
+ * not registered or there are too many windows
+ */
+bool
+mg_set_search_windows(multi_gee_t multi_gee,
+		      int device_id,
+		      const struct mg_rect *window,
+		      unsigned int num_windows);
+
+/**
+ * @brief Set the number of workers of mg_frameset_parallel_for()
+ *
+ * by default there is one worker per registered device, up to the
+ * number of processors.  the pool is restarted with the new number on
+ * the next mg_frameset_parallel_for().  devices keep their worker if
+ * the new pool still has it.
+ *
+ * @param multi_gee  object handle
+ * @param num_workers  number of workers, or 0 for the default
+ *
+ * @return \c true
+ */
+bool
+mg_set_workers(multi_gee_t multi_gee,
+	       unsigned int num_workers);
+
+/**
+ * @brief Bring a parked capture device back into sync
+ *
+ * @param multi_gee  object handle
+ * @param device_id  identifier of a device parked by mg_park_device()
+ *
+ * @return status value:
+ *   -1 - failed to unpark device,
+ *   value >= 0 - device identifier
+ */
+int
+mg_unpark_device(multi_gee_t multi_gee,
+		 int device_id);
+
+/**
+ * @brief Watch for cameras that are plugged in and unplugged
+ *
+ * a camera that disappears no longer makes mg_capture() return with
+ * RET_SYNC; it leaves the frame list and the remaining cameras carry
+ * on.  cameras that match a rule are opened and initialised on a
+ * worker thread, and join the frame list between framesets.  when no
+ * camera is left, mg_capture() returns with RET_DEVICE, and cameras
+ * that have been plugged in since join on the next call.
+ *
+ * @param multi_gee  object handle
+ * @param dir  directory holding the device nodes, or 0 for "/dev"
+ *
+ * @return \c true on success, \c false if the directory cannot be
+ * watched
+ */
+bool
+mg_watch_devices(multi_gee_t multi_gee,
+		 const char *dir);
+
 __END_DECLS
 
 #endif /* ITL_MULTI_GEE_MULTI_GEE_H */